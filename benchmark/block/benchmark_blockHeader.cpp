@@ -0,0 +1,67 @@
+#include "block/blockHeader.h"
+
+// system includes
+#include <cstdint>
+
+// library includes
+#include <benchmark/benchmark.h>
+
+// project includes
+#include "types/types.h"
+
+// Build a header with non-trivial field values
+static Block::BlockHeader makeHeader() {
+  Block::BlockHeader block;
+  block.setVersion(0x20000000);
+  block.setTimestamp(1700000000);
+  block.setBits(0x1d00ffff);
+
+  Hash prev_hash, merkle_hash;
+  for (size_t i = 0; i < 32; ++i) {
+    prev_hash[i] = static_cast<unsigned char>(i);
+    merkle_hash[i] = static_cast<unsigned char>(255 - i);
+  }
+  block.setPrevBlockHash(prev_hash);
+  block.setMerkleRoot(merkle_hash);
+  return block;
+}
+
+// Benchmark: hash all 80 header bytes (three compressions)
+static void BM_blockHash_full(benchmark::State &state) {
+  Block::BlockHeader block = makeHeader();
+  uint32_t nonce = 0;
+
+  for (auto _ : state) {
+    block.setNonce(nonce++);
+    Hash hash = block.calculateBlockHash();
+    benchmark::DoNotOptimize(hash);
+  }
+}
+BENCHMARK(BM_blockHash_full);
+
+// Benchmark: hash from the cached first-block midstate (two compressions)
+static void BM_blockHash_midstate(benchmark::State &state) {
+  Block::BlockHeader block = makeHeader();
+  block.updateMidstate();
+  uint32_t nonce = 0;
+
+  for (auto _ : state) {
+    block.setNonce(nonce++);
+    Hash hash = block.calculateBlockHash();
+    benchmark::DoNotOptimize(hash);
+  }
+}
+BENCHMARK(BM_blockHash_midstate);
+
+// Benchmark: nonce search throughput, reported as hashes per second
+static void BM_calculateNonce(benchmark::State &state) {
+  Block::BlockHeader block = makeHeader();
+  const uint32_t attempts = static_cast<uint32_t>(state.range(0));
+
+  for (auto _ : state) {
+    bool found = block.calculateNonce(attempts);
+    benchmark::DoNotOptimize(found);
+  }
+  state.SetItemsProcessed(state.iterations() * attempts);
+}
+BENCHMARK(BM_calculateNonce)->Arg(4096);
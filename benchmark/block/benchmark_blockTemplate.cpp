@@ -0,0 +1,42 @@
+#include "block/blockTemplate.h"
+
+// system includes
+#include <cstdint>
+#include <string>
+
+// library includes
+#include <benchmark/benchmark.h>
+
+// A full-mempool sized template: n transactions of about 250 bytes each
+static std::string makeTemplate(size_t n) {
+  const std::string data(500, 'a');
+  const std::string hash(64, 'b');
+  std::string json = R"({"version": 536870912, "previousblockhash": ")" +
+                     hash + R"(", "transactions": [)";
+  for (size_t i = 0; i < n; ++i) {
+    json += (i == 0 ? "" : ", ");
+    json += R"({"data": ")" + data + R"(", "txid": ")" + hash +
+            R"(", "hash": ")" + hash + R"(", "depends": [], "fee": 1000, )" +
+            R"("sigops": 4, "weight": 1000})";
+  }
+  json += R"(], "coinbasevalue": 312500000, "bits": "17034219", )"
+          R"("curtime": 1700000000, "mintime": 1699999000, "height": 840000})";
+  return json;
+}
+
+// Benchmark: ingest a multi-megabyte template with a warm parser
+static void BM_blockTemplateParse(benchmark::State &state) {
+  const std::string json = makeTemplate(static_cast<size_t>(state.range(0)));
+  Block::BlockTemplateParser parser;
+  parser.parse(json);
+
+  for (auto _ : state) {
+    const Block::BlockTemplate &gbt = parser.parse(json);
+    benchmark::DoNotOptimize(gbt.transactions.data());
+  }
+  state.SetBytesProcessed(state.iterations() *
+                          static_cast<int64_t>(json.size()));
+}
+BENCHMARK(BM_blockTemplateParse)->Arg(4000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
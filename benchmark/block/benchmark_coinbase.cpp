@@ -0,0 +1,63 @@
+#include "block/coinbase.h"
+
+// system includes
+#include <cstdint>
+#include <vector>
+
+// library includes
+#include <benchmark/benchmark.h>
+
+// project includes
+#include "block/witnessCommitment.h"
+#include "sha256/sha256.h"
+#include "types/types.h"
+
+// A pool-style coinbase: tag, two payouts and a witness commitment
+static Block::CoinbaseBuilder makeBuilder(const Block::WitnessCommitment &wc) {
+  Block::CoinbaseParams params;
+  params.height = 840000;
+  params.tag.assign(40, 0x2f);
+  params.payouts.push_back({312500000, std::vector<uint8_t>(22, 0x14)});
+  params.payouts.push_back({1000, std::vector<uint8_t>(34, 0x20)});
+  return Block::CoinbaseBuilder(params, &wc);
+}
+
+// Benchmark: txid per extranonce, resuming from the prefix midstate
+static void BM_coinbaseTxid_midstate(benchmark::State &state) {
+  const Block::WitnessCommitment wc;
+  const Block::CoinbaseBuilder builder = makeBuilder(wc);
+  uint64_t extranonce = 0;
+
+  for (auto _ : state) {
+    Hash txid = builder.computeTxid(std::span<const uint8_t>(
+        reinterpret_cast<const uint8_t *>(&extranonce), 8));
+    benchmark::DoNotOptimize(txid);
+    ++extranonce;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_coinbaseTxid_midstate);
+
+// Benchmark: txid per extranonce, serializing and hashing the whole coinbase
+static void BM_coinbaseTxid_full(benchmark::State &state) {
+  const Block::WitnessCommitment wc;
+  const Block::CoinbaseBuilder builder = makeBuilder(wc);
+  uint64_t extranonce = 0;
+
+  for (auto _ : state) {
+    const std::vector<uint8_t> tx = builder.serialize(
+        std::span<const uint8_t>(
+            reinterpret_cast<const uint8_t *>(&extranonce), 8),
+        false);
+    Hash first;
+    Hash txid;
+    SHA256::sha256_bytes(tx.data(), tx.size(), first.data());
+    SHA256::sha256_bytes(first.data(), first.size(), txid.data());
+    benchmark::DoNotOptimize(txid);
+    ++extranonce;
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_coinbaseTxid_full);
+
+BENCHMARK_MAIN();
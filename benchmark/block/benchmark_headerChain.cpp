@@ -0,0 +1,48 @@
+#include "block/headerChain.h"
+
+// system includes
+#include <cstdint>
+#include <vector>
+
+// library includes
+#include <benchmark/benchmark.h>
+
+// project includes
+#include "block/blockHeader.h"
+#include "block/packedHeader.h"
+#include "types/types.h"
+
+// Mine a linked chain of regtest-difficulty headers
+static std::vector<uint8_t> mineChain(size_t count) {
+  std::vector<uint8_t> chain;
+  chain.reserve(count * Block::PackedHeader::SIZE);
+  Hash prev{};
+  for (size_t i = 0; i < count; ++i) {
+    Block::BlockHeader header;
+    header.setVersion(0x20000000);
+    header.setPrevBlockHash(prev);
+    header.setTimestamp(1700000000 + static_cast<uint32_t>(i));
+    header.setBits(0x207fffff);
+    header.calculateNonce(1000);
+    prev = header.calculateBlockHash();
+    const auto bytes = header.getPackedHeader().bytes();
+    chain.insert(chain.end(), bytes.begin(), bytes.end());
+  }
+  return chain;
+}
+
+// Benchmark: validate a 100k header chain with the given thread count
+static void BM_validateChain(benchmark::State &state) {
+  static const std::vector<uint8_t> chain = mineChain(100000);
+  const Block::HeaderChainValidator validator(
+      static_cast<unsigned int>(state.range(0)));
+
+  for (auto _ : state) {
+    Block::ChainValidation result = validator.validate(chain, Hash{});
+    benchmark::DoNotOptimize(result);
+  }
+  state.SetItemsProcessed(state.iterations() * 100000);
+}
+BENCHMARK(BM_validateChain)->Arg(1)->Arg(4)->UseRealTime();
+
+BENCHMARK_MAIN();
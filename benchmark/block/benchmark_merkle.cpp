@@ -0,0 +1,53 @@
+#include "block/merkle.h"
+
+// system includes
+#include <cstdint>
+#include <vector>
+
+// library includes
+#include <benchmark/benchmark.h>
+
+// project includes
+#include "types/types.h"
+
+static std::vector<Hash> makeLeaves(size_t count) {
+  std::vector<Hash> leaves(count);
+  for (size_t i = 0; i < count; ++i) {
+    leaves[i].fill(static_cast<uint8_t>(i));
+    leaves[i][1] = static_cast<uint8_t>(i >> 8);
+  }
+  return leaves;
+}
+
+// Benchmark: root of a full block computed from scratch
+static void BM_merkleRoot_full(benchmark::State &state) {
+  const std::vector<Hash> leaves =
+      makeLeaves(static_cast<size_t>(state.range(0)));
+
+  for (auto _ : state) {
+    Hash root = Block::computeMerkleRoot(leaves);
+    benchmark::DoNotOptimize(root);
+  }
+}
+BENCHMARK(BM_merkleRoot_full)->Arg(4000);
+
+// Benchmark: root after replacing four transactions of a full block
+static void BM_merkleRoot_incremental(benchmark::State &state) {
+  const std::vector<Hash> leaves =
+      makeLeaves(static_cast<size_t>(state.range(0)));
+  Block::MerkleTree tree(leaves);
+  tree.getRoot();
+  size_t round = 0;
+
+  for (auto _ : state) {
+    for (size_t i = 0; i < 4; ++i) {
+      tree.set((round * 977 + i * 1009) % leaves.size(), leaves[round % 64]);
+    }
+    Hash root = tree.getRoot();
+    benchmark::DoNotOptimize(root);
+    ++round;
+  }
+}
+BENCHMARK(BM_merkleRoot_incremental)->Arg(4000);
+
+BENCHMARK_MAIN();
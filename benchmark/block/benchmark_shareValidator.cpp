@@ -0,0 +1,78 @@
+#include "block/shareValidator.h"
+
+// system includes
+#include <cstdint>
+#include <vector>
+
+// library includes
+#include <benchmark/benchmark.h>
+
+// project includes
+#include "block/packedHeader.h"
+#include "types/types.h"
+
+// Shares between two new blocks, well below the duplicate set's capacity
+static constexpr uint32_t SHARES_PER_BLOCK = 1 << 19;
+
+static constexpr uint32_t WORKERS = 64;
+
+// A job with a pool-sized coinbase and a 12-level branch (~4000
+// transactions)
+static uint32_t addJob(Block::ShareValidator &validator) {
+  const std::vector<uint8_t> coinbase1(90, 0x11);
+  const std::vector<uint8_t> coinbase2(140, 0x22);
+  const std::vector<Hash> branch(12, Hash{0x33});
+  Block::PackedHeader header;
+  header.setVersion(0x20000000);
+  header.setTimestamp(1700000000);
+  header.setBits(0x17034219);
+  return validator.addJob(coinbase1, coinbase2, branch, header, 0x1fffe000);
+}
+
+// Benchmark: one thread validating batches of 256 shares from WORKERS
+// workers, each rolling its extranonce2 every range(0) of its shares; every
+// share is accepted, so each one also goes through the duplicate set
+static void BM_shareBatch(benchmark::State &state) {
+  const uint32_t per_extranonce = static_cast<uint32_t>(state.range(0));
+  Block::ValidatorConfig config;
+  config.maxShares = SHARES_PER_BLOCK;
+  Block::ShareValidator validator(config);
+  uint32_t job = addJob(validator);
+
+  Block::VarDiffConfig easy;
+  easy.initialDifficulty = 1e-12;
+  easy.minDifficulty = 1e-12;
+  std::vector<Block::Worker> workers;
+  for (uint32_t i = 0; i < WORKERS; ++i) {
+    const uint8_t extranonce1[4] = {static_cast<uint8_t>(i), 0, 0, 1};
+    workers.emplace_back(extranonce1, easy,
+                         std::chrono::steady_clock::time_point());
+  }
+
+  Block::ShareBatch batch(256);
+  uint32_t submitted = 0;
+  for (auto _ : state) {
+    if (submitted >= SHARES_PER_BLOCK / 2) {
+      validator.newBlock();
+      job = addJob(validator);
+      submitted = 0;
+    }
+    for (uint32_t i = 0; i < 256; ++i, ++submitted) {
+      Block::Share share;
+      share.worker = &workers[i % WORKERS];
+      share.job = job;
+      const uint32_t roll = submitted / WORKERS / per_extranonce;
+      share.extranonce2[0] = static_cast<uint8_t>(roll);
+      share.extranonce2[1] = static_cast<uint8_t>(roll >> 8);
+      share.extranonce2[2] = static_cast<uint8_t>(roll >> 16);
+      share.time = 1700000000;
+      share.nonce = submitted;
+      batch.push(share);
+    }
+    benchmark::DoNotOptimize(batch.flush(validator).data());
+  }
+  state.SetItemsProcessed(state.iterations() * 256);
+}
+BENCHMARK(BM_shareBatch)->Arg(1)->Arg(16)->Arg(1 << 20);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,60 @@
+#include "block/templateBuilder.h"
+
+// system includes
+#include <cstdint>
+#include <random>
+#include <vector>
+
+// library includes
+#include <benchmark/benchmark.h>
+
+// A mempool of n transactions; a quarter spend one or two recent ones
+static void fillMempool(Block::TemplateBuilder &builder, size_t n) {
+  std::mt19937 rng(1);
+  std::vector<uint32_t> parents;
+  for (size_t i = 0; i < n; ++i) {
+    Block::MempoolEntry entry;
+    entry.txid[0] = static_cast<uint8_t>(i);
+    entry.weight = 400 + rng() % 3000;
+    entry.fee = static_cast<int64_t>(entry.weight / 4) * (1 + rng() % 50);
+    entry.sigops = rng() % 8;
+    parents.clear();
+    if (i > 64 && rng() % 4 == 0) {
+      parents.push_back(static_cast<uint32_t>(i - 1 - rng() % 64));
+      if (rng() % 4 == 0) {
+        parents.push_back(static_cast<uint32_t>(i - 1 - rng() % 64));
+      }
+    }
+    builder.addTransaction(entry, parents);
+  }
+}
+
+// Benchmark: rebuild a template from a loaded mempool
+static void BM_templateBuild(benchmark::State &state) {
+  Block::TemplateBuilder builder;
+  fillMempool(builder, static_cast<size_t>(state.range(0)));
+  builder.build(840000);
+
+  for (auto _ : state) {
+    const Block::SelectedTemplate &selected = builder.build(840000);
+    benchmark::DoNotOptimize(selected.coinbaseValue);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_templateBuild)->Arg(300000)->Unit(benchmark::kMillisecond);
+
+// Benchmark: load a mempool snapshot and build
+static void BM_templateLoadAndBuild(benchmark::State &state) {
+  Block::TemplateBuilder builder;
+
+  for (auto _ : state) {
+    builder.clear();
+    fillMempool(builder, static_cast<size_t>(state.range(0)));
+    const Block::SelectedTemplate &selected = builder.build(840000);
+    benchmark::DoNotOptimize(selected.coinbaseValue);
+  }
+  state.SetItemsProcessed(state.iterations() * state.range(0));
+}
+BENCHMARK(BM_templateLoadAndBuild)->Arg(300000)->Unit(benchmark::kMillisecond);
+
+BENCHMARK_MAIN();
@@ -0,0 +1,93 @@
+#include "miner/sharedChannel.h"
+
+// system includes
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+
+// library includes
+#include <benchmark/benchmark.h>
+
+// project includes
+#include "block/packedHeader.h"
+#include "types/uint256.h"
+
+using Role = Miner::SharedChannel::Role;
+
+static std::string segmentName(const std::string &benchmark) {
+  return "/hfm-bench-" + benchmark + "-" + std::to_string(::getpid());
+}
+
+// Publishing with no reader asleep: no syscall
+static void BM_publishJob(benchmark::State &state) {
+  Miner::SharedChannel owner(segmentName("publish"), Role::Owner);
+  const Block::PackedHeader header;
+  uint64_t id = 0;
+  for (auto _ : state) {
+    benchmark::DoNotOptimize(owner.publishJob(++id, 0, header, uint256(1)));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_publishJob);
+
+static void BM_readJob(benchmark::State &state) {
+  Miner::SharedChannel owner(segmentName("read"), Role::Owner);
+  const Block::PackedHeader header;
+  Miner::SharedJob job;
+  for (auto _ : state) {
+    uint64_t cursor = owner.publishJob(1, 0, header, uint256(1));
+    benchmark::DoNotOptimize(owner.readJob(cursor, job));
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_readJob);
+
+// A job to a worker process and its share back; half of each iteration is
+// one delivery across the process boundary. Arg is the spin count of both
+// sides: 0 sleeps on the futex every time.
+static void BM_roundTrip(benchmark::State &state) {
+  const std::string name = segmentName("roundtrip");
+  Miner::SharedChannelConfig config;
+  config.spinCount = static_cast<uint32_t>(state.range(0));
+  Miner::SharedChannel owner(name, Role::Owner, config);
+
+  const pid_t pid = ::fork();
+  if (pid == 0) {
+    int status = 1;
+    try {
+      Miner::SharedChannel peer(name, Role::Peer, config);
+      uint64_t cursor = 0;
+      Miner::SharedJob job;
+      Miner::Share share;
+      while (peer.waitJob(cursor, job, std::chrono::microseconds(-1))) {
+        share.jobId = job.id;
+        peer.pushResult(share);
+      }
+      status = 0;
+    } catch (...) {
+    }
+    ::_exit(status);
+  }
+
+  const Block::PackedHeader header;
+  Miner::Share share;
+  uint64_t id = 0;
+  for (auto _ : state) {
+    owner.publishJob(++id, 0, header, uint256(1));
+    if (!owner.waitResult(share, std::chrono::seconds(5)) ||
+        share.jobId != id) {
+      state.SkipWithError("Worker did not answer");
+      break;
+    }
+  }
+  owner.close();
+  int status = 0;
+  ::waitpid(pid, &status, 0);
+  state.counters["wakes"] = static_cast<double>(owner.getWakeCount());
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_roundTrip)->Arg(0)->Arg(1 << 16)->UseRealTime();
+
+BENCHMARK_MAIN();
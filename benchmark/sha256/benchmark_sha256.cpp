@@ -110,4 +110,32 @@ static void BM_hashArrayToString(benchmark::State &state) {
 }
 BENCHMARK(BM_hashArrayToString);
 
+// Benchmark: double SHA-256 of 80-byte headers, one at a time
+static void BM_sha256d_80_oneShot(benchmark::State &state) {
+  std::vector<uint8_t> input(80 * 1024, 0x5a);
+  std::vector<uint8_t> out(32 * 1024);
+  for (auto _ : state) {
+    for (size_t i = 0; i < 1024; ++i) {
+      uint8_t first[SHA256::SHA256_BYTES_SIZE];
+      SHA256::sha256_bytes(input.data() + i * 80, 80, first);
+      SHA256::sha256_bytes(first, sizeof(first), out.data() + i * 32);
+    }
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations() * 1024);
+}
+BENCHMARK(BM_sha256d_80_oneShot);
+
+// Benchmark: double SHA-256 of 80-byte headers with the batch kernel
+static void BM_sha256d_80_batch(benchmark::State &state) {
+  std::vector<uint8_t> input(80 * 1024, 0x5a);
+  std::vector<uint8_t> out(32 * 1024);
+  for (auto _ : state) {
+    SHA256::sha256d_80_bytes(input.data(), 1024, out.data());
+    benchmark::DoNotOptimize(out.data());
+  }
+  state.SetItemsProcessed(state.iterations() * 1024);
+}
+BENCHMARK(BM_sha256d_80_batch);
+
 BENCHMARK_MAIN();
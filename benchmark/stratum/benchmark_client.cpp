@@ -0,0 +1,87 @@
+#include "stratum/client.h"
+
+// system includes
+#include <atomic>
+#include <cstdint>
+#include <string>
+#include <thread>
+#include <vector>
+
+// library includes
+#include <benchmark/benchmark.h>
+
+// project includes
+#include "block/miningJob.h"
+#include "stratum/mockPool.h"
+#include "stratum/notify.h"
+
+// A mainnet-sized job: 12 branch hashes
+static std::string makeParams(uint32_t job) {
+  std::string params = "[\"" + std::to_string(job) + "\",\"" +
+                       std::string(64, '1') + "\",\"" + std::string(200, '2') +
+                       "\",\"" + std::string(180, '3') + "\",[";
+  for (int i = 0; i < 12; ++i) {
+    params += (i == 0 ? "\"" : ",\"") + std::string(64, 'a' + i % 6) + "\"";
+  }
+  return params + "],\"20000000\",\"17034219\",\"6650e1a0\",true]";
+}
+
+// Benchmark: decode a notification and set up its job, without the socket
+static void BM_notifyToJob(benchmark::State &state) {
+  const std::string params = makeParams(1);
+  const uint8_t extranonce1[] = {8, 0, 0, 2};
+  Stratum::Notify notify;
+  Block::MiningJob job;
+
+  for (auto _ : state) {
+    Stratum::parseNotify(params, notify);
+    job.set(notify.coinbase1, extranonce1, 4, notify.coinbase2,
+            notify.merkleBranch, notify.getHeader());
+    benchmark::DoNotOptimize(job.getHeader());
+  }
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_notifyToJob);
+
+// Benchmark: from the pool's send() of a notification to the job handler
+// of a client on loopback, which is when hashing can start
+static void BM_notifyLatency(benchmark::State &state) {
+  Stratum::MockPool pool;
+  std::thread handshake([&] {
+    pool.accept();
+    pool.reply(pool.expect("mining.configure"), "{}");
+    pool.reply(pool.expect("mining.subscribe"),
+               R"([[["mining.notify","1"]],"08000002",4])");
+    pool.reply(pool.expect("mining.authorize"), "true");
+  });
+
+  Stratum::ClientConfig config;
+  config.port = pool.getPort();
+  config.user = "bench";
+  Stratum::Client client(config);
+  std::atomic<uint32_t> jobs{0};
+  client.setJobHandler(
+      [&](const Stratum::Notify &, const Block::MiningJob &) { ++jobs; });
+  client.connect();
+  handshake.join();
+  std::thread loop([&] { client.run(); });
+
+  std::vector<std::string> lines;
+  for (uint32_t i = 0; i < 64; ++i) {
+    lines.push_back(R"({"id":null,"method":"mining.notify","params":)" +
+                    makeParams(i) + "}");
+  }
+  uint32_t sent = 0;
+  for (auto _ : state) {
+    pool.send(lines[sent % lines.size()]);
+    ++sent;
+    while (jobs.load(std::memory_order_acquire) != sent) {
+    }
+  }
+  client.stop();
+  loop.join();
+  state.SetItemsProcessed(state.iterations());
+}
+BENCHMARK(BM_notifyLatency)->UseRealTime();
+
+BENCHMARK_MAIN();
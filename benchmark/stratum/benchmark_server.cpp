@@ -0,0 +1,94 @@
+#include "stratum/server.h"
+
+// system includes
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <sys/resource.h>
+#include <vector>
+
+// library includes
+#include <benchmark/benchmark.h>
+
+// project includes
+#include "stratum/notify.h"
+#include "stratum/swarm.h"
+
+// A mainnet-sized job: 12 branch hashes
+static Stratum::Notify makeJob(uint32_t job) {
+  Stratum::Notify notify;
+  notify.jobId = std::to_string(job);
+  notify.coinbase1.assign(100, 0x11);
+  notify.coinbase2.assign(90, 0x22);
+  notify.merkleBranch.assign(12, Hash{0x33});
+  notify.version = 0x20000000;
+  notify.bits = 0x17034219;
+  notify.time = 1700000000 + job;
+  notify.clean = true;
+  return notify;
+}
+
+// Miners that fit in the file descriptor limit, raised as far as allowed;
+// each miner uses one descriptor here and one in the server
+static size_t fitMiners(size_t wanted) {
+  rlimit limit{};
+  ::getrlimit(RLIMIT_NOFILE, &limit);
+  limit.rlim_cur = limit.rlim_max;
+  ::setrlimit(RLIMIT_NOFILE, &limit);
+  ::getrlimit(RLIMIT_NOFILE, &limit);
+  const size_t spare = 64;
+  return std::min(wanted, limit.rlim_cur > 2 * spare
+                              ? (limit.rlim_cur - spare) / 2
+                              : size_t{0});
+}
+
+// Benchmark: broadcast a job to range(0) miners on loopback and wait until
+// all have read it; reports the server's time to hand the job to the
+// kernel for every connection and the swarm's last arrival, at p50 and p99
+static void BM_broadcast(benchmark::State &state) {
+  const size_t miners = fitMiners(static_cast<size_t>(state.range(0)));
+  Stratum::ServerConfig config;
+  config.host = "127.0.0.1";
+  config.port = 0;
+  Stratum::Server server(config);
+  server.start();
+  Stratum::Swarm swarm("127.0.0.1", server.getPort(), miners,
+                       std::chrono::seconds(120));
+
+  std::vector<double> arrivals;
+  uint32_t job = 0;
+  for (auto _ : state) {
+    const Stratum::Notify notify = makeJob(job++);
+    const auto start = std::chrono::steady_clock::now();
+    server.broadcast(notify);
+    const std::vector<Stratum::Swarm::TimePoint> received =
+        swarm.waitForJob(notify.jobId, std::chrono::seconds(30));
+    const Stratum::Swarm::TimePoint last =
+        *std::max_element(received.begin(), received.end());
+    arrivals.push_back(
+        std::chrono::duration<double, std::micro>(last - start).count());
+  }
+  server.stop();
+
+  const Stratum::BroadcastStats stats = server.getBroadcastStats();
+  std::sort(arrivals.begin(), arrivals.end());
+  state.counters["miners"] = static_cast<double>(miners);
+  state.counters["sent_p50_us"] =
+      std::chrono::duration<double, std::micro>(stats.p50).count();
+  state.counters["sent_p99_us"] =
+      std::chrono::duration<double, std::micro>(stats.p99).count();
+  if (!arrivals.empty()) {
+    state.counters["arrived_p50_us"] = arrivals[(arrivals.size() - 1) / 2];
+    state.counters["arrived_p99_us"] =
+        arrivals[(arrivals.size() - 1) * 99 / 100];
+  }
+  state.SetItemsProcessed(state.iterations() * static_cast<int64_t>(miners));
+}
+BENCHMARK(BM_broadcast)
+    ->Arg(1000)
+    ->Arg(10000)
+    ->Unit(benchmark::kMillisecond)
+    ->UseRealTime();
+
+BENCHMARK_MAIN();
@@ -0,0 +1,166 @@
+#ifndef __BLOCK_FILE_H__
+#define __BLOCK_FILE_H__
+
+// system includes
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <string>
+#include <utility>
+#include <vector>
+
+// project includes
+#include "block/headerView.h"
+
+namespace Block {
+
+/// \brief Network magic framing every block in a block file.
+using NetworkMagic = std::array<uint8_t, 4>;
+
+/// \brief Bitcoin mainnet message start bytes.
+static constexpr NetworkMagic MAINNET_MAGIC = {0xf9, 0xbe, 0xb4, 0xd9};
+
+/// \brief Key Bitcoin Core XORs block files with (blocks/xor.dat). Byte i of
+/// a file is stored XORed with key[i % 8]; an all-zero key means plain files.
+using XorKey = std::array<uint8_t, 8>;
+
+/// \brief Read the obfuscation key of a blocks directory.
+/// \param blocksDir Directory holding blk*.dat and xor.dat.
+/// \return The key, or all zeros if xor.dat does not exist.
+XorKey readXorKey(const std::string &blocksDir);
+
+/// \brief One block located in a block file.
+struct BlockRecord {
+  /// \brief Offset of the block data (past magic and size) in the file.
+  uint64_t offset = 0;
+
+  /// \brief Serialized block as stored in the file, starting with its
+  /// 80-byte header. Still obfuscated if the file is; use bytes() to read it.
+  std::span<const uint8_t> stored;
+
+  /// \brief Key the stored bytes are XORed with (all zeros if plain).
+  XorKey key{};
+
+  /// \brief Decoded header of an obfuscated block.
+  std::array<uint8_t, PackedHeader::SIZE> decodedHeader{};
+
+  /// \brief Whether the stored bytes are obfuscated.
+  bool obfuscated = false;
+
+  /// \brief Block size in bytes.
+  inline uint32_t size() const {
+    return static_cast<uint32_t>(stored.size());
+  }
+
+  /// \brief View of the block header; zero-copy for plain files.
+  inline BlockHeaderView header() const {
+    if (obfuscated) {
+      return BlockHeaderView(
+          std::span<const uint8_t, PackedHeader::SIZE>(decodedHeader));
+    }
+    return BlockHeaderView(
+        std::span<const uint8_t, PackedHeader::SIZE>(stored.data(),
+                                                     PackedHeader::SIZE));
+  }
+
+  /// \brief Get the serialized block.
+  /// \param buffer Receives the decoded block of an obfuscated file; left
+  /// untouched for a plain file.
+  /// \return The block, pointing into the mapping for a plain file and into
+  /// the buffer otherwise.
+  std::span<const uint8_t> bytes(std::vector<uint8_t> &buffer) const;
+};
+
+/// \brief XOR bytes with a block file key.
+/// \param key Obfuscation key.
+/// \param offset File offset of the first byte, which selects the key byte
+/// each byte is XORed with.
+/// \param in Bytes to decode.
+/// \param size Number of bytes.
+/// \param out Receives the decoded bytes; may be the same as in.
+void xorBytes(const XorKey &key, uint64_t offset, const uint8_t *in,
+              size_t size, uint8_t *out);
+
+/// \brief Read-only memory-mapped Bitcoin Core block file (blk*.dat).
+/// \note A block file is a sequence of records: 4 magic bytes, a 4-byte
+/// little-endian size and the serialized block. Core preallocates files, so
+/// the records are followed by zero padding, which ends the walk.
+///
+/// Files are mapped shared and read-only whether obfuscated or not, and
+/// every record points straight into the mapping. For an obfuscated file
+/// only the framing and the 80-byte header are decoded while walking; a
+/// block body is decoded into a caller buffer by BlockRecord::bytes(), so
+/// indexing touches no more memory than for a plain file.
+class BlockFile {
+public:
+  /// \brief Map a block file.
+  /// \param path File to map.
+  /// \param key Obfuscation key (all zeros for plain files).
+  /// \param magic Network magic expected before every block.
+  /// \throws std::system_error if the file cannot be opened or mapped, or
+  /// memory mapping is not supported on this platform.
+  explicit BlockFile(const std::string &path, const XorKey &key = {},
+                     const NetworkMagic &magic = MAINNET_MAGIC);
+
+  /// \brief Destructor. Unmaps the file.
+  ~BlockFile();
+
+  BlockFile(const BlockFile &) = delete;
+  BlockFile &operator=(const BlockFile &) = delete;
+
+  /// \brief Read the record whose framing starts at an offset.
+  /// \param offset File offset of the record's magic bytes.
+  /// \return The record, or nothing at the end of the data, on a magic
+  /// mismatch or if the record is truncated.
+  std::optional<BlockRecord> readAt(uint64_t offset) const;
+
+  /// \brief Read the block whose data starts at an offset (as stored in a
+  /// BlockLocation).
+  /// \param offset File offset of the block data.
+  /// \param size Block size in bytes.
+  /// \return The record, or nothing if the range is outside the file.
+  std::optional<BlockRecord> readBlock(uint64_t offset, uint32_t size) const;
+
+  /// \brief Visit every block in file order.
+  /// \param visit Callback taking a const BlockRecord&.
+  /// \param offset File offset of the first record to visit; receives the
+  /// end of the last complete record, where a later walk can resume.
+  /// \return Number of blocks visited.
+  template <typename Visitor>
+  size_t forEachBlock(Visitor &&visit, uint64_t &offset) const {
+    size_t blocks = 0;
+    while (const std::optional<BlockRecord> record = readAt(offset)) {
+      visit(*record);
+      ++blocks;
+      offset = record->offset + record->size();
+    }
+    return blocks;
+  }
+
+  /// \brief Visit every block in file order from the start of the file.
+  template <typename Visitor> size_t forEachBlock(Visitor &&visit) const {
+    uint64_t offset = 0;
+    return forEachBlock(std::forward<Visitor>(visit), offset);
+  }
+
+  /// \brief Size of the mapped file in bytes.
+  inline size_t getSize() const { return mSize; }
+
+  /// \brief Whether the file is read with a non-zero key.
+  inline bool isObfuscated() const { return mObfuscated; }
+
+  /// \brief Size of the framing before every block.
+  static constexpr size_t FRAME_SIZE = 8;
+
+private:
+  const uint8_t *mData;
+  size_t mSize;
+  XorKey mKey;
+  bool mObfuscated;
+  NetworkMagic mMagic;
+};
+
+} // namespace Block
+#endif // __BLOCK_FILE_H__
@@ -3,12 +3,18 @@
 
 // system includes
 #include <array>
+#include <atomic>
 #include <bit>
 #include <cstdint>
+#include <span>
 #include <vector>
 
 // project includes
+#include "block/packedHeader.h"
+#include "block/search.h"
+#include "sha256/sha256.h"
 #include "types/types.h"
+#include "types/uint256.h"
 
 namespace Block {
 
@@ -23,26 +29,47 @@ public:
   /// (zeros).
   BlockHeader();
 
+  /// \brief Construct from an already serialized header.
+  /// \param header 80-byte wire-format header.
+  explicit BlockHeader(const PackedHeader &header);
+
+  /// \brief Copy constructor. A valid cached hash is carried over.
+  BlockHeader(const BlockHeader &other);
+
+  /// \brief Copy assignment. A valid cached hash is carried over.
+  BlockHeader &operator=(const BlockHeader &other);
+
   /// \brief Destructor.
   ~BlockHeader();
 
   // Setters
   /// \brief Set the block version.
   /// \param version 32-bit version number to store in the block.
-  inline void setVersion(uint32_t version) { mVersion = version; }
+  /// \note Invalidates the cached first-block midstate.
+  inline void setVersion(uint32_t version) {
+    mHeader.setVersion(version);
+    mMidstateValid = false;
+    markHashDirty();
+  }
 
   /// \brief Set the previous block hash.
   /// \param prev_block_hash 32-byte array containing the previous block hash.
   /// \note The data is copied into the block's internal buffer.
+  /// Invalidates the cached first-block midstate.
   inline void setPrevBlockHash(const Hash &prev_block_hash) {
-    mPrevBlockHash = prev_block_hash;
+    mHeader.setPrevBlockHash(prev_block_hash);
+    mMidstateValid = false;
+    markHashDirty();
   }
 
   /// \brief Set the Merkle root.
   /// \param merkle_root 32-byte array containing the Merkle root.
   /// \note The data is copied into the block's internal buffer.
+  /// Invalidates the cached first-block midstate.
   inline void setMerkleRoot(const Hash &merkle_root) {
-    mMerkleRoot = merkle_root;
+    mHeader.setMerkleRoot(merkle_root);
+    mMidstateValid = false;
+    markHashDirty();
   }
 
   /// \brief Compute the Merkle root from a list of transaction hashes.
@@ -52,40 +79,56 @@ public:
 
   /// \brief Set the block timestamp.
   /// \param timestamp 32-bit UNIX epoch timestamp to store in the block.
-  inline void setTimestamp(uint32_t timestamp) { mTimestamp = timestamp; }
+  inline void setTimestamp(uint32_t timestamp) {
+    mHeader.setTimestamp(timestamp);
+    markHashDirty();
+  }
 
   /// \brief Set the encoded difficulty target (bits).
   /// \param bits 32-bit bits field to store in the block.
-  inline void setBits(uint32_t bits) { mBits = bits; }
+  inline void setBits(uint32_t bits) {
+    mHeader.setBits(bits);
+    markHashDirty();
+  }
 
   /// \brief Set the block nonce.
   /// \param nonce 32-bit nonce value to store in the block.
-  inline void setNonce(uint32_t nonce) { mNonce = nonce; }
+  /// \note Patches the last 4 bytes of the packed header in place.
+  inline void setNonce(uint32_t nonce) {
+    mHeader.setNonce(nonce);
+    markHashDirty();
+  }
 
   // Getters
   /// \brief Get the block version.
   /// \return 32-bit version number.
-  inline uint32_t getVersion() const { return mVersion; }
+  inline uint32_t getVersion() const { return mHeader.getVersion(); }
 
   /// \brief Get pointer to the previous block hash (32 bytes).
   /// \return Pointer to a 32-byte array containing the previous block hash.
-  inline const Hash getPrevBlockHash() const { return mPrevBlockHash; }
+  inline const Hash getPrevBlockHash() const {
+    return mHeader.getPrevBlockHash();
+  }
 
   /// \brief Get pointer to the Merkle root (32 bytes).
   /// \return Pointer to a 32-byte array containing the Merkle root.
-  inline const Hash getMerkleRoot() const { return mMerkleRoot; }
+  inline const Hash getMerkleRoot() const { return mHeader.getMerkleRoot(); }
 
   /// \brief Get the block timestamp.
   /// \return 32-bit UNIX epoch timestamp.
-  inline uint32_t getTimestamp() const { return mTimestamp; }
+  inline uint32_t getTimestamp() const { return mHeader.getTimestamp(); }
 
   /// \brief Get the encoded difficulty target (bits).
   /// \return 32-bit bits field.
-  inline uint32_t getBits() const { return mBits; }
+  inline uint32_t getBits() const { return mHeader.getBits(); }
 
   /// \brief Get the block nonce.
   /// \return 32-bit nonce value.
-  inline uint32_t getNonce() const { return mNonce; }
+  inline uint32_t getNonce() const { return mHeader.getNonce(); }
+
+  /// \brief Get the serialized header.
+  /// \return Reference to the 80-byte wire-format buffer.
+  inline const PackedHeader &getPackedHeader() const { return mHeader; }
 
   /// \brief Convert a 32-bit value either little-endian to big-endian in place.
   /// \param value Reference to the 32-bit value
@@ -103,26 +146,88 @@ public:
   /// \note Modifies mNonce to the calculated valid value on success.
   bool calculateNonce(uint32_t maxAttempts = 0xFFFFFFFF);
 
+  /// \brief Search for a valid header, rolling ntime and version bits once
+  /// the nonce window is exhausted.
+  /// \param policy Version mask, ntime drift and nonce window to walk.
+  /// \param solution Receives the nonce, rolled version/timestamp and hash.
+  /// \param maxAttempts Maximum number of hashes before giving up.
+  /// \return true if a valid header was found.
+  /// \note On success the header holds the solved fields. On failure the
+  /// version and timestamp are restored to their original values.
+  bool calculateNonce(const RollingPolicy &policy, Solution &solution,
+                      uint64_t maxAttempts = UINT64_MAX);
+
+  /// \brief Hash a nonce range and record every hash that meets any target.
+  /// \param firstNonce First nonce to hash.
+  /// \param count Number of nonces to hash (at most 2^32 - firstNonce).
+  /// \param targets Decoded targets ordered easiest (largest) first, e.g.
+  /// share, network and an optional local audit target. At most 256.
+  /// \param hits Caller-provided buffer receiving the hits in nonce order.
+  /// \return Number of nonces hashed and number of hits written.
+  /// \note The scan does not stop at the first hit, or at a hit on the
+  /// hardest target. It stops early only when the hit buffer is full, so no
+  /// hit is ever dropped. A miss on the easiest target costs one word
+  /// compare in the common case.
+  ScanResult scanNonces(uint32_t firstNonce, uint64_t count,
+                        std::span<const uint256> targets,
+                        std::span<ScanHit> hits);
+
   /// \brief Calculate the hash of the block header.
-  /// \return The computed double SHA-256 hash of the block header.
+  /// \return The double SHA-256 hash of the block header.
+  /// \note The hash is memoized until a setter changes the header. Concurrent
+  /// calls on a header that is not being modified are safe: the first caller
+  /// to finish publishes the cached value, the others return their own
+  /// (identical) result. Recomputation resumes from the first-block midstate
+  /// when it is valid.
   Hash calculateBlockHash() const;
 
+  /// \brief Check whether calculateBlockHash() will return a cached value.
+  inline bool isHashCached() const {
+    return mHashState.load(std::memory_order_acquire) == HASH_VALID;
+  }
+
+  /// \brief Compute the first-block midstate if it has been invalidated.
+  /// \note Called by the nonce search before its loop. Only version, previous
+  /// block hash and Merkle root feed the first 64 bytes, so nonce, timestamp
+  /// and bits updates keep the midstate valid.
+  void updateMidstate();
+
+  /// \brief Check whether the cached first-block midstate is current.
+  inline bool hasMidstate() const { return mMidstateValid; }
+
 private:
-  // Block data members
-  uint32_t mVersion;   // little-endian
-  Hash mPrevBlockHash; // natural byte order
-  Hash mMerkleRoot;    // natural byte order
-  uint32_t mTimestamp; // little-endian
-  uint32_t mBits;      // little-endian
-  uint32_t mNonce;     // little-endian
-
-  // Byte sizes of fields
-  static constexpr int mBits_bytesize = 4;
-  static constexpr int mNonce_bytesize = 4;
-  static constexpr int mVersion_bytesize = 4;
-  static constexpr int mTimestamp_bytesize = 4;
-  static constexpr int mMerkleRoot_bytesize = 32;
-  static constexpr int mPrevBlockHash_bytesize = 32;
+  // Cached hash states
+  static constexpr uint8_t HASH_DIRTY = 0;
+  static constexpr uint8_t HASH_PUBLISHING = 1;
+  static constexpr uint8_t HASH_VALID = 2;
+
+  /// \brief Drop the cached hash. Setters hold exclusive access to the
+  /// header, so a relaxed store is enough.
+  inline void markHashDirty() {
+    mHashState.store(HASH_DIRTY, std::memory_order_relaxed);
+  }
+
+  /// \brief Store a freshly computed hash as the cached value.
+  /// \note May be called from const methods; only one caller publishes.
+  void publishHash(const Hash &hash) const;
+
+  /// \brief Compute the double SHA-256 of the header without the cache.
+  Hash computeBlockHash() const;
+
+  /// \brief Finish the double SHA-256 from the cached midstate.
+  Hash hashFromMidstate() const;
+
+  // Block data, kept in wire format (all integers little-endian, hashes in
+  // natural byte order)
+  PackedHeader mHeader;
+
+  // SHA-256 context after absorbing header bytes 0..63
+  SHA256::sha256 mMidstate;
+  bool mMidstateValid;
+
+  // Memoized block hash, guarded by mHashState
+  mutable Hash mCachedHash;
+  mutable std::atomic<uint8_t> mHashState;
 };
 
 } // namespace Block
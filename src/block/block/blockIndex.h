@@ -0,0 +1,92 @@
+#ifndef __BLOCK_INDEX_H__
+#define __BLOCK_INDEX_H__
+
+// system includes
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <string>
+#include <vector>
+
+// project includes
+#include "block/blockFile.h"
+#include "types/types.h"
+
+namespace Block {
+
+/// \brief Where a block is stored.
+struct BlockLocation {
+  uint32_t file = 0;   // NNNNN of blkNNNNN.dat
+  uint32_t offset = 0; // offset of the block data in the file
+  uint32_t size = 0;   // block size in bytes
+};
+
+/// \brief Block hash to file position index over a blocks directory.
+/// \note Entries are kept sorted by hash and looked up by binary search. The
+/// index is saved as a flat file together with the end of the last complete
+/// record in every block file it covers. Core preallocates block files, so a
+/// file's size does not tell whether blocks were appended: every build keeps
+/// the saved entries and resumes each file at its saved end, which costs one
+/// framing check for an unchanged file. Files are scanned in parallel, one
+/// file per thread at a time.
+class BlockIndex {
+public:
+  /// \brief Load the saved index, rescan changed block files and save it.
+  /// \param blocksDir Directory holding blk*.dat (and xor.dat, if any).
+  /// \param indexPath Saved index file; created if it does not exist.
+  /// \param threads Files scanned in parallel (0 selects the hardware
+  /// concurrency).
+  /// \param magic Network magic of the block files.
+  /// \return The up-to-date index.
+  /// \throws std::system_error if a block file cannot be mapped or the index
+  /// cannot be written.
+  static BlockIndex build(const std::string &blocksDir,
+                          const std::string &indexPath,
+                          unsigned int threads = 0,
+                          const NetworkMagic &magic = MAINNET_MAGIC);
+
+  /// \brief Find a block by its hash.
+  /// \param hash Block hash (raw little-endian bytes).
+  /// \return Its location, or nothing if the block is not indexed.
+  std::optional<BlockLocation> find(const Hash &hash) const;
+
+  /// \brief Number of indexed blocks.
+  inline size_t size() const { return mEntries.size(); }
+
+  /// \brief Number of block files the last build found new blocks in (the
+  /// entries of the others all came from the saved index).
+  inline size_t getScannedFiles() const { return mScannedFiles; }
+
+  /// \brief Path of a block file.
+  static std::string blockFilePath(const std::string &blocksDir,
+                                   uint32_t file);
+
+private:
+  /// \brief An index entry.
+  struct Entry {
+    Hash hash;
+    BlockLocation location;
+  };
+
+  /// \brief A covered block file and where its last scan ended.
+  struct FileState {
+    uint32_t file;
+    uint64_t end; // end of the last complete record
+  };
+
+  /// \brief Read a saved index; false if missing or invalid.
+  bool load(const std::string &indexPath);
+
+  /// \brief Write the index.
+  void save(const std::string &indexPath) const;
+
+  static constexpr uint64_t MAGIC = 0x58444e494b4c4248; // "HBLKINDX"
+  static constexpr uint32_t FORMAT = 2;
+
+  std::vector<Entry> mEntries;
+  std::vector<FileState> mFiles;
+  size_t mScannedFiles = 0;
+};
+
+} // namespace Block
+#endif // __BLOCK_INDEX_H__
@@ -0,0 +1,102 @@
+#ifndef __BLOCK_TEMPLATE_H__
+#define __BLOCK_TEMPLATE_H__
+
+// system includes
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+#include <span>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+// project includes
+#include "block/blockHeader.h"
+#include "types/types.h"
+
+namespace Block {
+
+/// \brief A transaction of a block template.
+struct TemplateTransaction {
+  /// \brief Serialized transaction, in the parser's arena.
+  std::span<const uint8_t> data;
+
+  /// \brief txid and wtxid (raw little-endian bytes).
+  Hash txid{};
+  Hash wtxid{};
+
+  /// \brief Fee in satoshis.
+  int64_t fee = 0;
+
+  /// \brief Weight units and signature operation cost.
+  uint32_t weight = 0;
+  uint32_t sigops = 0;
+
+  /// \brief 1-based template indexes of the transactions this one spends.
+  std::span<const uint32_t> depends;
+};
+
+/// \brief Work from a node's getblocktemplate (BIP22/BIP23).
+struct BlockTemplate {
+  /// \brief Version, previous block hash, bits and curtime. The Merkle root
+  /// and nonce are left zero for the miner to fill.
+  BlockHeader header;
+
+  /// \brief Height of the block to build.
+  uint32_t height = 0;
+
+  /// \brief Maximum coinbase output value: subsidy plus fees.
+  int64_t coinbaseValue = 0;
+
+  /// \brief Earliest acceptable block timestamp.
+  uint32_t minTime = 0;
+
+  /// \brief Transactions after the coinbase, in template order.
+  std::vector<TemplateTransaction> transactions;
+
+  /// \brief Witness commitment output script suggested by the node (empty
+  /// if the template has none), in the parser's arena.
+  std::span<const uint8_t> defaultWitnessCommitment;
+
+  /// \brief Sum of the transaction fees.
+  int64_t getTotalFees() const;
+};
+
+/// \brief Reads getblocktemplate JSON into a BlockTemplate.
+/// \note The JSON is read in one streaming pass (util::JsonReader); no
+/// document tree is built. Transaction hex is decoded straight into an arena
+/// sized from the input, and hashes are decoded in place. The arena, the
+/// transaction list and the dependency lists are owned by the parser and
+/// reused, so after the first template of a given size a parse does not
+/// allocate. The returned template, and every span in it, stays valid until
+/// the next parse.
+class BlockTemplateParser {
+public:
+  /// \brief Construct a parser.
+  BlockTemplateParser();
+
+  /// \brief Parse a template.
+  /// \param json A getblocktemplate result object, or the whole JSON-RPC
+  /// response wrapping one in "result".
+  /// \return The template.
+  /// \throws std::runtime_error if the JSON is malformed, a required field
+  /// is missing or invalid, or the response carries an RPC error.
+  const BlockTemplate &parse(std::string_view json);
+
+private:
+  /// \brief Reserve arena space for decoded bytes.
+  uint8_t *allocate(size_t bytes);
+
+  BlockTemplate mTemplate;
+  std::unique_ptr<uint8_t[]> mArena;
+  size_t mArenaCapacity;
+  size_t mArenaUsed;
+  std::vector<uint32_t> mDepends;
+
+  /// \brief Offset and length of each transaction's list in mDepends,
+  /// resolved to spans once mDepends stops growing.
+  std::vector<std::pair<size_t, size_t>> mDependRanges;
+};
+
+} // namespace Block
+#endif // __BLOCK_TEMPLATE_H__
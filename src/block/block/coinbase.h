@@ -0,0 +1,131 @@
+#ifndef __COINBASE_H__
+#define __COINBASE_H__
+
+// system includes
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+// project includes
+#include "block/witnessCommitment.h"
+#include "sha256/sha256.h"
+#include "types/types.h"
+
+namespace Block {
+
+/// \brief One coinbase output.
+struct CoinbasePayout {
+  int64_t value = 0;           // satoshis
+  std::vector<uint8_t> script; // locking script
+};
+
+/// \brief What goes into a coinbase transaction.
+struct CoinbaseParams {
+  /// \brief Block height, pushed first in the scriptSig (BIP34).
+  uint32_t height = 0;
+
+  /// \brief Extra scriptSig bytes between the height and the extranonce
+  /// (a pool tag, for instance).
+  std::vector<uint8_t> tag;
+
+  /// \brief Size of the extranonce slot that ends the scriptSig.
+  size_t extranonceSize = 8;
+
+  /// \brief Outputs, in order. The witness commitment, if any, follows them.
+  std::vector<CoinbasePayout> payouts;
+
+  uint32_t version = 2;
+  uint32_t sequence = 0xffffffff;
+  uint32_t lockTime = 0;
+};
+
+/// \brief A coinbase transaction laid out as prefix, extranonce slot and
+/// suffix, with the txid recomputed cheaply for every extranonce.
+/// \note The extranonce ends the scriptSig, so the prefix holds the version,
+/// the null prevout and the scriptSig up to the extranonce, and the suffix
+/// the sequence, the outputs and the lock time. These are the coinb1 and
+/// coinb2 halves Stratum sends to miners. The whole 64-byte blocks of the
+/// prefix are hashed once into a SHA-256 midstate; each txid resumes from a
+/// copy of it and compresses only the prefix tail, the extranonce and the
+/// suffix, followed by the second SHA-256.
+///
+/// The witness commitment output sits in the suffix, so a new transaction
+/// set swaps its 32 bytes in place and leaves the midstate valid.
+class CoinbaseBuilder {
+public:
+  /// \brief Lay out a coinbase.
+  /// \param params Height, tag, extranonce size, payouts and fields.
+  /// \param commitment Witness commitment to add as the last output, or
+  /// nullptr for a coinbase without one.
+  /// \throws std::invalid_argument if the scriptSig would be outside the
+  /// 2 to 100 bytes consensus allows, or a payout value is negative.
+  explicit CoinbaseBuilder(const CoinbaseParams &params,
+                           const WitnessCommitment *commitment = nullptr);
+
+  /// \brief Compute the txid for an extranonce.
+  /// \param extranonce Exactly getExtranonceSize() bytes.
+  /// \return The txid (raw little-endian bytes).
+  /// \throws std::invalid_argument on an extranonce of the wrong size.
+  Hash computeTxid(std::span<const uint8_t> extranonce) const;
+
+  /// \brief Serialize the coinbase with an extranonce.
+  /// \param extranonce Exactly getExtranonceSize() bytes.
+  /// \param withWitness Use the segwit serialization, whose coinbase
+  /// witness is the commitment's reserved value. Ignored without a
+  /// commitment.
+  /// \return The serialized transaction.
+  /// \throws std::invalid_argument on an extranonce of the wrong size.
+  std::vector<uint8_t> serialize(std::span<const uint8_t> extranonce,
+                                 bool withWitness = true) const;
+
+  /// \brief Replace the witness commitment for a new transaction set.
+  /// \param commitment The updated commitment.
+  /// \throws std::invalid_argument if the coinbase was built without one.
+  void setWitnessCommitment(const WitnessCommitment &commitment);
+
+  /// \brief Get the serialization before the extranonce (coinb1).
+  inline std::span<const uint8_t> getPrefix() const {
+    return std::span<const uint8_t>(mBytes).first(mExtranonceOffset);
+  }
+
+  /// \brief Get the serialization after the extranonce (coinb2).
+  inline std::span<const uint8_t> getSuffix() const {
+    return std::span<const uint8_t>(mBytes).subspan(mExtranonceOffset +
+                                                    mExtranonceSize);
+  }
+
+  /// \brief Get the size of the extranonce slot.
+  inline size_t getExtranonceSize() const { return mExtranonceSize; }
+
+  /// \brief Get the number of prefix bytes covered by the midstate.
+  inline size_t getMidstateSize() const { return mMidstateSize; }
+
+  /// \brief Whether the coinbase carries a witness commitment.
+  inline bool hasWitnessCommitment() const {
+    return mCommitmentOffset.has_value();
+  }
+
+  /// \brief Encode a height the way BIP34 requires it at the start of the
+  /// scriptSig (a minimal script number push).
+  /// \param height Block height.
+  /// \return The push opcode and its data.
+  static std::vector<uint8_t> encodeHeight(uint32_t height);
+
+private:
+  /// \brief Serialization without witness data, zero extranonce.
+  std::vector<uint8_t> mBytes;
+  size_t mExtranonceOffset;
+  size_t mExtranonceSize;
+
+  /// \brief Context after the whole 64-byte blocks of the prefix.
+  SHA256::SHA256::Context mMidstate;
+  size_t mMidstateSize;
+
+  std::optional<size_t> mCommitmentOffset;
+  Hash mReservedValue;
+};
+
+} // namespace Block
+#endif // __COINBASE_H__
@@ -0,0 +1,146 @@
+#ifndef __DIFFICULTY_H__
+#define __DIFFICULTY_H__
+
+// system includes
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// project includes
+#include "types/uint256.h"
+
+namespace Block {
+
+/// \brief Proof-of-work consensus parameters.
+struct ConsensusParams {
+  /// \brief Easiest allowed target.
+  uint256 powLimit;
+
+  /// \brief Intended duration of one retarget window in seconds.
+  int64_t powTargetTimespan = 14 * 24 * 60 * 60;
+
+  /// \brief Intended time between two blocks in seconds.
+  int64_t powTargetSpacing = 10 * 60;
+
+  /// \brief Keep the difficulty fixed (regtest).
+  bool noRetargeting = false;
+
+  /// \brief Number of blocks between two retargets (2016 on mainnet).
+  constexpr int64_t getAdjustmentInterval() const {
+    return powTargetTimespan / powTargetSpacing;
+  }
+
+  /// \brief Bitcoin mainnet parameters.
+  static constexpr ConsensusParams mainnet() {
+    ConsensusParams params;
+    params.powLimit = uint256(
+        "00000000ffffffffffffffffffffffffffffffffffffffffffffffffffffffff");
+    return params;
+  }
+
+  /// \brief Bitcoin regtest parameters.
+  static constexpr ConsensusParams regtest() {
+    ConsensusParams params;
+    params.powLimit = uint256(
+        "7fffffffffffffffffffffffffffffffffffffffffffffffffffffffffffffff");
+    params.noRetargeting = true;
+    return params;
+  }
+};
+
+/// \brief Compute the compact target of the block after a retarget window.
+/// \param lastBits Compact target of the last block of the window.
+/// \param firstBlockTime Timestamp of the first block of the window.
+/// \param lastBlockTime Timestamp of the last block of the window.
+/// \param params Consensus parameters.
+/// \return The new compact target. The measured timespan is clamped to a
+/// factor of 4 either way and the result never exceeds params.powLimit.
+uint32_t calculateNextWorkRequired(uint32_t lastBits, int64_t firstBlockTime,
+                                   int64_t lastBlockTime,
+                                   const ConsensusParams &params);
+
+/// \brief Expected number of hashes to find a block: 2^256 / (target + 1).
+/// \param target Decoded target.
+/// \return The work of one block at that target.
+/// \note Computed as ~target / (target + 1) + 1, which stays within 256 bits.
+constexpr uint256 getBlockProof(const uint256 &target) {
+  if (target == ~uint256()) {
+    return uint256(1); // target + 1 would wrap to zero
+  }
+  return (~target / (target + 1)) + 1;
+}
+
+/// \brief Target a pool share must meet at a Stratum difficulty.
+/// \param difficulty Share difficulty, as sent by mining.set_difficulty.
+/// \return The difficulty-1 target (0xffff << 208) divided by difficulty,
+/// saturated at 2^256 - 1.
+/// \throws std::invalid_argument unless difficulty is positive.
+/// \note The quotient is formed in double precision, so targets above
+/// 2^53 keep only their top 53 bits, as pools compute them.
+uint256 getShareTarget(double difficulty);
+
+/// \brief Direct-mapped cache of compact target decodes and their work.
+/// \note The compact target only changes once per retarget window, so a
+/// header batch touches a handful of distinct values; the division behind
+/// the work is done once per value instead of once per header. Not
+/// thread-safe: use one cache per thread.
+class CompactTargetCache {
+public:
+  /// \brief A decoded compact target.
+  struct Entry {
+    uint32_t bits = 0;
+    bool valid = false; // false if negative, overflowing or zero
+    uint256 target;
+    uint256 work;
+  };
+
+  CompactTargetCache();
+
+  /// \brief Decode a compact target, from the cache when possible.
+  /// \param bits Compact target.
+  /// \return The decoded target and its work (zero work if invalid).
+  const Entry &lookup(uint32_t bits);
+
+  /// \brief Number of lookups answered from the cache.
+  inline uint64_t getHits() const { return mHits; }
+
+  /// \brief Number of lookups that had to decode.
+  inline uint64_t getMisses() const { return mMisses; }
+
+private:
+  static constexpr size_t SLOTS = 64;
+
+  std::array<Entry, SLOTS> mEntries;
+  std::array<bool, SLOTS> mUsed;
+  uint64_t mHits;
+  uint64_t mMisses;
+};
+
+/// \brief Compute the running chainwork of a header batch.
+/// \param headers Contiguous 80-byte serialized headers.
+/// \param baseWork Chainwork of the block before the first header.
+/// \param chainWork Receives one entry per header: baseWork plus the work of
+/// every header up to and including it. Must hold the header count.
+/// \param cache Target decode cache.
+/// \note The prefix array makes the chainwork of any header, and so the
+/// comparison of competing tips within the batch, a single lookup.
+void computeChainWork(std::span<const uint8_t> headers, const uint256 &baseWork,
+                      std::span<uint256> chainWork, CompactTargetCache &cache);
+
+/// \brief Check the compact target of every header against the retarget
+/// rules.
+/// \param headers Contiguous 80-byte serialized headers.
+/// \param firstHeight Height of the first header.
+/// \param params Consensus parameters.
+/// \return Index of the first header with an unexpected target, or the
+/// header count if all match.
+/// \note Outside retarget boundaries a header must repeat its predecessor's
+/// target. At a boundary the window start must be inside the batch;
+/// boundaries whose window starts before the batch, and the first header,
+/// are not checked.
+size_t findBadTransition(std::span<const uint8_t> headers,
+                         uint64_t firstHeight, const ConsensusParams &params);
+
+} // namespace Block
+#endif // __DIFFICULTY_H__
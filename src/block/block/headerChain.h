@@ -0,0 +1,69 @@
+#ifndef __HEADER_CHAIN_H__
+#define __HEADER_CHAIN_H__
+
+// system includes
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// project includes
+#include "types/types.h"
+
+namespace Block {
+
+/// \brief Why a header chain failed validation.
+enum class ChainError : uint8_t {
+  None,          // every header is valid
+  Truncated,     // the buffer ends inside a header
+  InvalidBits,   // compact target is negative, overflows or is zero
+  HighHash,      // header hash is above its target
+  BrokenLinkage, // previous-block hash does not match the preceding header
+};
+
+/// \brief Outcome of a header chain validation.
+struct ChainValidation {
+  /// \brief ChainError::None if the whole chain is valid.
+  ChainError error = ChainError::None;
+
+  /// \brief Index of the first failing header (the header count if valid).
+  size_t firstFailure = 0;
+
+  /// \brief Hash of the last header, if the chain is valid.
+  Hash tipHash{};
+};
+
+/// \brief Validates long runs of serialized block headers in bulk.
+/// \note Headers are read in place from a contiguous buffer of 80-byte
+/// records. The buffer is split into one contiguous range per thread; each
+/// thread hashes its headers a batch at a time with the multi-lane double
+/// SHA-256 kernel, then checks every hash against the header's compact
+/// target and every previous-block hash against the hash of the header
+/// before it. Threads past an already found failure stop early, and the
+/// lowest failing index is reported.
+class HeaderChainValidator {
+public:
+  /// \brief Construct a validator.
+  /// \param threads Worker threads per validation (0 selects the hardware
+  /// concurrency).
+  explicit HeaderChainValidator(unsigned int threads = 0);
+
+  /// \brief Validate a chain of headers.
+  /// \param headers Contiguous 80-byte serialized headers.
+  /// \param prevHash Expected previous-block hash of the first header (all
+  /// zeros for a chain starting at genesis).
+  /// \return The first failure, or ChainError::None with the tip hash.
+  ChainValidation validate(std::span<const uint8_t> headers,
+                           const Hash &prevHash) const;
+
+  /// \brief Get the number of worker threads used per validation.
+  inline unsigned int getThreadCount() const { return mThreads; }
+
+  /// \brief Headers hashed per kernel call by each thread.
+  static constexpr size_t BATCH_SIZE = 1024;
+
+private:
+  unsigned int mThreads;
+};
+
+} // namespace Block
+#endif // __HEADER_CHAIN_H__
@@ -0,0 +1,164 @@
+#ifndef __HEADER_STORE_H__
+#define __HEADER_STORE_H__
+
+// system includes
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+
+// project includes
+#include "block/headerView.h"
+#include "types/types.h"
+#include "types/uint256.h"
+
+namespace Block {
+
+/// \brief Append-only header chain kept in a memory-mapped file.
+/// \note The file holds the raw 80-byte wire records plus column arrays
+/// derived from them: bits, timestamps, block hashes and cumulative
+/// chainwork. Scans over one field walk a dense column instead of striding
+/// over whole headers, and headers are handed out as zero-copy views into
+/// the mapping.
+///
+/// Layout: a 64-byte file header, then one section per column, each sized
+/// for the current capacity (a multiple of 64 headers, so every section is
+/// cache-line aligned). Growing the capacity doubles it and moves the
+/// columns up; the records section never moves. The header count is
+/// committed after the columns are written, and a flag marks the columns
+/// stale while they move, so reopening after a crash either sees a
+/// consistent store or rebuilds the columns from the records.
+///
+/// Reopening maps the file once; nothing is parsed. Columns use the host
+/// byte order, and a file written with another byte order is rejected.
+class HeaderStore {
+public:
+  /// \brief Open a store, creating an empty one if the file does not exist.
+  /// \param path Store file.
+  /// \throws std::system_error if the file cannot be opened or mapped, or
+  /// memory mapping is not supported on this platform.
+  /// \throws std::runtime_error if the file is not a valid store.
+  explicit HeaderStore(const std::string &path);
+
+  /// \brief Destructor. Flushes and unmaps the file.
+  ~HeaderStore();
+
+  HeaderStore(const HeaderStore &) = delete;
+  HeaderStore &operator=(const HeaderStore &) = delete;
+
+  /// \brief Append serialized headers.
+  /// \param headers Contiguous 80-byte wire records.
+  /// \throws std::invalid_argument if the size is not a multiple of 80.
+  /// \note Headers are stored as given; validate them first with
+  /// HeaderChainValidator. Views and spans obtained before an append may be
+  /// invalidated if the store grows.
+  void append(std::span<const uint8_t> headers);
+
+  /// \brief Append one header.
+  inline void append(const BlockHeader &header) {
+    append(header.getPackedHeader().bytes());
+  }
+
+  /// \brief Recompute every column from the raw records.
+  void rebuildColumns();
+
+  /// \brief Flush the mapping to disk.
+  void sync();
+
+  /// \brief Number of headers stored.
+  inline size_t size() const { return mCount; }
+
+  /// \brief Number of headers that fit before the file has to grow.
+  inline size_t capacity() const { return mCapacity; }
+
+  /// \brief Zero-copy view of a header.
+  inline BlockHeaderView getHeader(size_t index) const {
+    return BlockHeaderView(std::span<const uint8_t, PackedHeader::SIZE>(
+        records() + index * PackedHeader::SIZE, PackedHeader::SIZE));
+  }
+
+  /// \brief All raw wire records, back to back.
+  inline std::span<const uint8_t> getRecords() const {
+    return {records(), mCount * PackedHeader::SIZE};
+  }
+
+  /// \brief Compact target column.
+  inline std::span<const uint32_t> getBits() const {
+    return {bitsColumn(), mCount};
+  }
+
+  /// \brief Timestamp column.
+  inline std::span<const uint32_t> getTimestamps() const {
+    return {timestampColumn(), mCount};
+  }
+
+  /// \brief Block hash column.
+  inline std::span<const Hash> getHashes() const {
+    return {hashColumn(), mCount};
+  }
+
+  /// \brief Cumulative work up to and including a header.
+  inline uint256 getChainWork(size_t index) const {
+    return uint256(workColumn()[index]);
+  }
+
+private:
+  /// \brief On-disk file header.
+  struct alignas(64) FileHeader {
+    uint64_t magic;
+    uint32_t format;
+    uint32_t columnsValid;
+    uint64_t count;
+    uint64_t capacity;
+  };
+
+  static constexpr uint64_t MAGIC = 0x45524f5453524448; // "HDRSTORE"
+  static constexpr uint32_t FORMAT = 1;
+  static constexpr size_t CAPACITY_STEP = 64;
+
+  /// \brief File size needed for a capacity.
+  static size_t fileSize(size_t capacity);
+
+  /// \brief Section offsets for a capacity.
+  static size_t bitsOffset(size_t capacity);
+  static size_t timestampOffset(size_t capacity);
+  static size_t hashOffset(size_t capacity);
+  static size_t workOffset(size_t capacity);
+
+  /// \brief Map the file at its current size.
+  void map(size_t size);
+
+  /// \brief Grow the file so at least the given number of headers fits.
+  void reserve(size_t headers);
+
+  /// \brief Derive the columns of headers [begin, end) from their records.
+  void fillColumns(size_t begin, size_t end);
+
+  inline FileHeader *header() const {
+    return static_cast<FileHeader *>(mMapping);
+  }
+  inline uint8_t *base() const { return static_cast<uint8_t *>(mMapping); }
+  inline uint8_t *records() const { return base() + sizeof(FileHeader); }
+  inline uint32_t *bitsColumn() const {
+    return reinterpret_cast<uint32_t *>(base() + bitsOffset(mCapacity));
+  }
+  inline uint32_t *timestampColumn() const {
+    return reinterpret_cast<uint32_t *>(base() + timestampOffset(mCapacity));
+  }
+  inline Hash *hashColumn() const {
+    return reinterpret_cast<Hash *>(base() + hashOffset(mCapacity));
+  }
+  inline Hash *workColumn() const {
+    return reinterpret_cast<Hash *>(base() + workOffset(mCapacity));
+  }
+
+  std::string mPath;
+  int mFd;
+  void *mMapping;
+  size_t mMappedSize;
+  size_t mCount;
+  size_t mCapacity;
+};
+
+} // namespace Block
+#endif // __HEADER_STORE_H__
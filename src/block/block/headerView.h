@@ -0,0 +1,87 @@
+#ifndef __HEADER_VIEW_H__
+#define __HEADER_VIEW_H__
+
+// system includes
+#include <algorithm>
+#include <cstdint>
+#include <span>
+
+// project includes
+#include "block/blockHeader.h"
+#include "block/packedHeader.h"
+#include "sha256/sha256.h"
+#include "types/types.h"
+#include "util/endian.h"
+
+namespace Block {
+
+/// \brief Read-only view of an 80-byte serialized header owned elsewhere.
+/// \note Getters decode straight from the viewed bytes, so handing out a
+/// view over a memory-mapped file or a network buffer copies nothing. The
+/// viewed bytes must outlive the view. Use toBlockHeader() to get an owned,
+/// mutable header.
+class BlockHeaderView {
+public:
+  /// \brief View 80 bytes of serialized header.
+  /// \param bytes Header in wire format.
+  explicit BlockHeaderView(std::span<const uint8_t, PackedHeader::SIZE> bytes)
+      : mData(bytes.data()) {}
+
+  /// \brief View a packed header.
+  /// \param header Header to view.
+  explicit BlockHeaderView(const PackedHeader &header)
+      : mData(header.data()) {}
+
+  // Getters (decode from the viewed bytes)
+  inline uint32_t getVersion() const {
+    return util::ReadLE32(mData + PackedHeader::VERSION_OFFSET);
+  }
+  inline Hash getPrevBlockHash() const {
+    Hash hash;
+    std::copy_n(mData + PackedHeader::PREV_BLOCK_HASH_OFFSET, hash.size(),
+                hash.begin());
+    return hash;
+  }
+  inline Hash getMerkleRoot() const {
+    Hash hash;
+    std::copy_n(mData + PackedHeader::MERKLE_ROOT_OFFSET, hash.size(),
+                hash.begin());
+    return hash;
+  }
+  inline uint32_t getTimestamp() const {
+    return util::ReadLE32(mData + PackedHeader::TIMESTAMP_OFFSET);
+  }
+  inline uint32_t getBits() const {
+    return util::ReadLE32(mData + PackedHeader::BITS_OFFSET);
+  }
+  inline uint32_t getNonce() const {
+    return util::ReadLE32(mData + PackedHeader::NONCE_OFFSET);
+  }
+
+  /// \brief Pointer to the 80 wire-format bytes.
+  inline const uint8_t *data() const { return mData; }
+
+  /// \brief The 80 wire-format bytes as a span.
+  inline std::span<const uint8_t, PackedHeader::SIZE> bytes() const {
+    return std::span<const uint8_t, PackedHeader::SIZE>(mData,
+                                                        PackedHeader::SIZE);
+  }
+
+  /// \brief Compute the double SHA-256 of the viewed header.
+  inline Hash calculateBlockHash() const {
+    Hash hash;
+    SHA256::SHA256::double_bytes_80(mData, 1, hash.data());
+    return hash;
+  }
+
+  /// \brief Copy the viewed header into an owned BlockHeader.
+  inline BlockHeader toBlockHeader() const {
+    return BlockHeader(PackedHeader(bytes()));
+  }
+
+private:
+  const uint8_t *mData;
+};
+
+} // namespace Block
+#endif // __HEADER_VIEW_H__
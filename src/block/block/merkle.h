@@ -0,0 +1,113 @@
+#ifndef __MERKLE_H__
+#define __MERKLE_H__
+
+// system includes
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// project includes
+#include "types/types.h"
+
+namespace Block {
+
+/// \brief Compute the Merkle root of a list of hashes.
+/// \param leaves Leaf hashes (txids or wtxids), raw little-endian bytes.
+/// \return The root (all zeros for no leaves, the leaf itself for one).
+/// \note Each level is hashed in one go through the multi-lane double SHA-256
+/// kernel: adjacent pairs already form contiguous 64-byte messages, so only
+/// a duplicated odd last hash is copied.
+Hash computeMerkleRoot(std::span<const Hash> leaves);
+
+/// \brief Merkle tree that keeps every level, for templates that change a
+/// few transactions at a time.
+/// \note All levels live in one flat array, each level sized for a
+/// power-of-two leaf capacity so that growing within it moves nothing.
+/// Changes only record dirty leaves; getRoot() then rehashes just the nodes
+/// on their paths, level by level, batching each level's nodes through the
+/// multi-lane double SHA-256 kernel. Updating k leaves of n costs
+/// O(k log n) hashes instead of the n of a full computation. Inserting or
+/// erasing shifts the leaves after the position, which dirties all of them.
+class MerkleTree {
+public:
+  /// \brief Construct an empty tree.
+  MerkleTree();
+
+  /// \brief Construct a tree over a list of leaves.
+  /// \param leaves Leaf hashes (txids or wtxids), raw little-endian bytes.
+  explicit MerkleTree(std::span<const Hash> leaves);
+
+  /// \brief Replace every leaf.
+  void assign(std::span<const Hash> leaves);
+
+  /// \brief Replace one leaf.
+  /// \throws std::out_of_range for an index past the end.
+  void set(size_t index, const Hash &leaf);
+
+  /// \brief Swap two leaves, to reorder transactions.
+  /// \throws std::out_of_range for an index past the end.
+  void swap(size_t a, size_t b);
+
+  /// \brief Append a leaf.
+  void push_back(const Hash &leaf);
+
+  /// \brief Remove the last leaf.
+  /// \throws std::out_of_range if the tree is empty.
+  void pop_back();
+
+  /// \brief Insert a leaf before a position.
+  /// \throws std::out_of_range for an index past the end.
+  void insert(size_t index, const Hash &leaf);
+
+  /// \brief Remove a leaf.
+  /// \throws std::out_of_range for an index past the end.
+  void erase(size_t index);
+
+  /// \brief Number of leaves.
+  inline size_t size() const { return mSize; }
+
+  /// \brief Get a leaf.
+  inline const Hash &getLeaf(size_t index) const { return mNodes[index]; }
+
+  /// \brief Get the root, rehashing the paths of the changed leaves.
+  /// \return The root (all zeros for no leaves, the leaf itself for one).
+  const Hash &getRoot();
+
+  /// \brief Get the Merkle branch of a leaf: the sibling at each level from
+  /// the leaves up, a node being its own sibling at the odd end of a level.
+  /// For leaf 0 this is the coinbase branch Stratum sends.
+  /// \throws std::out_of_range for an index past the end.
+  std::vector<Hash> getBranch(size_t index);
+
+  /// \brief Number of nodes hashed by the last update.
+  inline size_t getHashCount() const { return mHashCount; }
+
+private:
+  /// \brief Lay the levels out for a leaf capacity, keeping the leaves.
+  void reserve(size_t capacity);
+
+  /// \brief Record a leaf whose path must be rehashed.
+  void markDirty(size_t index);
+
+  /// \brief Rehash the dirty paths.
+  void update();
+
+  /// \brief Number of nodes at a level.
+  inline size_t levelSize(size_t level) const {
+    return ((mSize - 1) >> level) + 1;
+  }
+
+  std::vector<Hash> mNodes;         // level after level, leaves first
+  std::vector<size_t> mLevelOffset; // start of each level in mNodes
+  size_t mSize;
+  size_t mCapacity;
+  std::vector<size_t> mDirty;  // leaf indexes, then parents while updating
+  std::vector<size_t> mParents;
+  bool mAllDirty;
+  Hash mRoot;
+  size_t mHashCount;
+};
+
+} // namespace Block
+#endif // __MERKLE_H__
@@ -0,0 +1,85 @@
+#ifndef __MINING_JOB_H__
+#define __MINING_JOB_H__
+
+// system includes
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// project includes
+#include "block/packedHeader.h"
+#include "sha256/sha256.h"
+#include "types/types.h"
+
+namespace Block {
+
+/// \brief Work described by coinbase halves and a Merkle branch, the way a
+/// Stratum mining.notify hands it out.
+/// \note The coinbase is coinb1, the extranonce1 the pool assigned to the
+/// connection, an extranonce2 the miner rolls, and coinb2. The whole 64-byte
+/// blocks of coinb1 + extranonce1 are hashed into a SHA-256 midstate when the
+/// job is set, so each extranonce2 costs the rest of the coinbase, the
+/// second SHA-256 and one double SHA-256 per branch hash. set() reuses the
+/// buffers and does not allocate once they are large enough.
+class MiningJob {
+public:
+  /// \brief Construct an empty job.
+  MiningJob();
+
+  /// \brief Set the job.
+  /// \param coinbase1 Coinbase serialization before the extranonce.
+  /// \param extranonce1 Extranonce part fixed by the pool.
+  /// \param extranonce2Size Size of the extranonce part the miner rolls.
+  /// \param coinbase2 Coinbase serialization after the extranonce.
+  /// \param merkleBranch Hashes the coinbase txid is paired with, from the
+  /// leaves up (raw little-endian bytes).
+  /// \param header Version, previous block hash, timestamp and bits; the
+  /// Merkle root and nonce are ignored.
+  void set(std::span<const uint8_t> coinbase1,
+           std::span<const uint8_t> extranonce1, size_t extranonce2Size,
+           std::span<const uint8_t> coinbase2,
+           std::span<const Hash> merkleBranch, const PackedHeader &header);
+
+  /// \brief Compute the coinbase txid for an extranonce2.
+  /// \param extranonce2 Exactly getExtranonce2Size() bytes.
+  /// \return The txid (raw little-endian bytes).
+  /// \throws std::invalid_argument on an extranonce2 of the wrong size.
+  Hash computeCoinbaseTxid(std::span<const uint8_t> extranonce2) const;
+
+  /// \brief Compute the Merkle root for an extranonce2.
+  /// \param extranonce2 Exactly getExtranonce2Size() bytes.
+  /// \return The root (raw little-endian bytes).
+  /// \throws std::invalid_argument on an extranonce2 of the wrong size.
+  Hash computeMerkleRoot(std::span<const uint8_t> extranonce2) const;
+
+  /// \brief Build the header for an extranonce2.
+  /// \param extranonce2 Exactly getExtranonce2Size() bytes.
+  /// \return The job's header with the Merkle root filled in and a zero
+  /// nonce.
+  /// \throws std::invalid_argument on an extranonce2 of the wrong size.
+  PackedHeader makeHeader(std::span<const uint8_t> extranonce2) const;
+
+  /// \brief Get the header fields given to set().
+  inline const PackedHeader &getHeader() const { return mHeader; }
+
+  /// \brief Get the size of the extranonce part the miner rolls.
+  inline size_t getExtranonce2Size() const { return mExtranonce2Size; }
+
+  /// \brief Get the Merkle branch.
+  inline std::span<const Hash> getMerkleBranch() const { return mBranch; }
+
+private:
+  /// \brief Context after the whole 64-byte blocks of coinb1 + extranonce1.
+  SHA256::SHA256::Context mMidstate;
+
+  /// \brief The bytes of coinb1 + extranonce1 after the midstate.
+  std::vector<uint8_t> mPrefixTail;
+  size_t mExtranonce2Size;
+  std::vector<uint8_t> mSuffix;
+  std::vector<Hash> mBranch;
+  PackedHeader mHeader;
+};
+
+} // namespace Block
+#endif // __MINING_JOB_H__
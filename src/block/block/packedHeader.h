@@ -0,0 +1,110 @@
+#ifndef __PACKED_HEADER_H__
+#define __PACKED_HEADER_H__
+
+// system includes
+#include <algorithm>
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// project includes
+#include "types/types.h"
+#include "util/endian.h"
+
+namespace Block {
+
+/// \brief Block header stored in its 80-byte wire format.
+/// \note The buffer is 64-byte aligned so the first SHA-256 block (bytes
+/// 0..63) sits in a single cache line and the nonce, timestamp and bits live
+/// in the next one. Setters patch the affected bytes in place, so the hash
+/// kernels can read the header directly without re-serializing it.
+class alignas(64) PackedHeader {
+public:
+  // Wire-format layout
+  static constexpr size_t SIZE = 80;
+  static constexpr size_t VERSION_OFFSET = 0;
+  static constexpr size_t PREV_BLOCK_HASH_OFFSET = 4;
+  static constexpr size_t MERKLE_ROOT_OFFSET = 36;
+  static constexpr size_t TIMESTAMP_OFFSET = 68;
+  static constexpr size_t BITS_OFFSET = 72;
+  static constexpr size_t NONCE_OFFSET = 76;
+
+  /// \brief Bytes covered by the first SHA-256 block (version, previous block
+  /// hash and the first 28 bytes of the Merkle root).
+  static constexpr size_t FIRST_BLOCK_SIZE = 64;
+
+  /// \brief Default constructor. All header bytes are zero.
+  PackedHeader() : mBytes() {}
+
+  /// \brief Construct from 80 bytes of serialized header.
+  /// \param bytes Header in wire format.
+  explicit PackedHeader(std::span<const uint8_t, SIZE> bytes) {
+    std::copy(bytes.begin(), bytes.end(), mBytes.begin());
+  }
+
+  // Setters (write through to the wire bytes)
+  inline void setVersion(uint32_t version) {
+    util::WriteLE32(mBytes.data() + VERSION_OFFSET, version);
+  }
+  inline void setPrevBlockHash(const Hash &prev_block_hash) {
+    std::copy(prev_block_hash.begin(), prev_block_hash.end(),
+              mBytes.begin() + PREV_BLOCK_HASH_OFFSET);
+  }
+  inline void setMerkleRoot(const Hash &merkle_root) {
+    std::copy(merkle_root.begin(), merkle_root.end(),
+              mBytes.begin() + MERKLE_ROOT_OFFSET);
+  }
+  inline void setTimestamp(uint32_t timestamp) {
+    util::WriteLE32(mBytes.data() + TIMESTAMP_OFFSET, timestamp);
+  }
+  inline void setBits(uint32_t bits) {
+    util::WriteLE32(mBytes.data() + BITS_OFFSET, bits);
+  }
+  inline void setNonce(uint32_t nonce) {
+    util::WriteLE32(mBytes.data() + NONCE_OFFSET, nonce);
+  }
+
+  // Getters (decode from the wire bytes)
+  inline uint32_t getVersion() const {
+    return util::ReadLE32(mBytes.data() + VERSION_OFFSET);
+  }
+  inline Hash getPrevBlockHash() const {
+    Hash hash;
+    std::copy_n(mBytes.begin() + PREV_BLOCK_HASH_OFFSET, hash.size(),
+                hash.begin());
+    return hash;
+  }
+  inline Hash getMerkleRoot() const {
+    Hash hash;
+    std::copy_n(mBytes.begin() + MERKLE_ROOT_OFFSET, hash.size(),
+                hash.begin());
+    return hash;
+  }
+  inline uint32_t getTimestamp() const {
+    return util::ReadLE32(mBytes.data() + TIMESTAMP_OFFSET);
+  }
+  inline uint32_t getBits() const {
+    return util::ReadLE32(mBytes.data() + BITS_OFFSET);
+  }
+  inline uint32_t getNonce() const {
+    return util::ReadLE32(mBytes.data() + NONCE_OFFSET);
+  }
+
+  /// \brief Pointer to the 80 wire-format bytes.
+  inline const uint8_t *data() const { return mBytes.data(); }
+
+  /// \brief The 80 wire-format bytes as a span.
+  inline std::span<const uint8_t, SIZE> bytes() const {
+    return std::span<const uint8_t, SIZE>(mBytes);
+  }
+
+private:
+  std::array<uint8_t, SIZE> mBytes;
+};
+
+static_assert(alignof(PackedHeader) == 64,
+              "PackedHeader must be cache-line aligned");
+
+} // namespace Block
+#endif // __PACKED_HEADER_H__
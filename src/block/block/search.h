@@ -0,0 +1,81 @@
+#ifndef __SEARCH_H__
+#define __SEARCH_H__
+
+// system includes
+#include <cstddef>
+#include <cstdint>
+
+// project includes
+#include "types/types.h"
+
+namespace Block {
+
+/// \brief Version bits BIP320 reserves for general-purpose use (version
+/// rolling).
+static constexpr uint32_t BIP320_VERSION_MASK = 0x1fffe000;
+
+/// \brief Maximum number of seconds a block timestamp may be ahead of network
+/// adjusted time before nodes reject it.
+static constexpr uint32_t MAX_FUTURE_BLOCK_TIME = 2 * 60 * 60;
+
+/// \brief Describes which header fields a nonce search may roll once the
+/// nonce window is exhausted.
+/// \note The search order is nonce (inner), then ntime, then version (outer).
+/// Rolling ntime keeps the first 64 header bytes unchanged, so it is the
+/// cheaper dimension and is walked before the version.
+struct RollingPolicy {
+  /// \brief Version bits that may be rolled (0 disables version rolling).
+  uint32_t versionMask = 0;
+
+  /// \brief Seconds the timestamp may be advanced past the job's timestamp.
+  /// Clamped to MAX_FUTURE_BLOCK_TIME.
+  uint32_t maxNtimeDrift = 0;
+
+  /// \brief First nonce of the window searched for every version/ntime pair.
+  uint32_t nonceStart = 0;
+
+  /// \brief Number of nonces searched for every version/ntime pair.
+  uint64_t nonceCount = uint64_t{1} << 32;
+};
+
+/// \brief A header that meets its target, with the rolled field values.
+struct Solution {
+  uint32_t nonce = 0;
+  uint32_t version = 0;
+  uint32_t timestamp = 0;
+  Hash hash{};
+};
+
+/// \brief A hash that met at least one of the scan targets.
+struct ScanHit {
+  /// \brief Nonce that produced the hash.
+  uint32_t nonce = 0;
+
+  /// \brief Index of the hardest target met (targets are ordered easiest
+  /// first, so a higher index is a better hit).
+  uint8_t targetIndex = 0;
+
+  /// \brief The header hash.
+  Hash hash{};
+};
+
+/// \brief Progress of a multi-target nonce scan.
+struct ScanResult {
+  /// \brief Number of nonces hashed. Less than requested only when the hit
+  /// buffer filled up; resume at firstNonce + scanned.
+  uint64_t scanned = 0;
+
+  /// \brief Number of hits written to the caller's buffer.
+  size_t hits = 0;
+};
+
+/// \brief Step to the next value of the rolled version bits.
+/// \param rolled Current rolled bits (only bits inside mask are set).
+/// \param mask Bits that may be rolled.
+/// \return Next combination of the mask bits, wrapping to zero.
+constexpr uint32_t nextRolledVersion(uint32_t rolled, uint32_t mask) {
+  return ((rolled | ~mask) + 1) & mask;
+}
+
+} // namespace Block
+#endif // __SEARCH_H__
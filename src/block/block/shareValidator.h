@@ -0,0 +1,306 @@
+#ifndef __SHARE_VALIDATOR_H__
+#define __SHARE_VALIDATOR_H__
+
+// system includes
+#include <array>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <shared_mutex>
+#include <span>
+#include <vector>
+
+// project includes
+#include "block/miningJob.h"
+#include "block/packedHeader.h"
+#include "types/types.h"
+#include "types/uint256.h"
+#include "util/concurrentHashSet.h"
+
+namespace Block {
+
+/// \brief Variable difficulty settings.
+struct VarDiffConfig {
+  double initialDifficulty = 1024;
+  double minDifficulty = 1;
+  double maxDifficulty = 1e15;
+
+  /// \brief Time between shares the difficulty is tuned for.
+  std::chrono::milliseconds shareInterval{10000};
+
+  /// \brief Retarget after this long, or after retargetShares shares,
+  /// whichever comes first; a step changes the difficulty by at most a
+  /// factor of 4.
+  std::chrono::milliseconds retargetInterval{60000};
+  uint32_t retargetShares = 30;
+};
+
+/// \brief A miner connection as the validator sees it: its extranonce1 and
+/// its variable share difficulty.
+/// \note Share difficulty follows the worker's share rate. When it changes,
+/// shares for jobs created before the change are still credited at the
+/// easier of the two targets, since the miner may have found them before
+/// it heard of the change. A worker must only be validated by one thread
+/// at a time.
+class Worker {
+public:
+  /// \brief Longest extranonce1.
+  static constexpr size_t MAX_EXTRANONCE1_SIZE = 8;
+
+  /// \brief Construct a worker.
+  /// \param extranonce1 Extranonce part given to the connection.
+  /// \param config Variable difficulty settings.
+  /// \param now Current time.
+  /// \throws std::invalid_argument if extranonce1 is longer than
+  /// MAX_EXTRANONCE1_SIZE.
+  Worker(std::span<const uint8_t> extranonce1, const VarDiffConfig &config,
+         std::chrono::steady_clock::time_point now);
+
+  /// \brief Set the difficulty, for instance one suggested by the miner.
+  /// \param difficulty New difficulty, clamped to the configured range.
+  /// \param nextJob Id the next job will get (ShareValidator::getNextJobId).
+  void setDifficulty(double difficulty, uint32_t nextJob);
+
+  /// \brief Whether the difficulty changed since the last call; the pool
+  /// then sends mining.set_difficulty.
+  bool takeDifficultyChange();
+
+  /// \brief Get the extranonce part given to the connection.
+  inline std::span<const uint8_t> getExtranonce1() const {
+    return std::span<const uint8_t>(mExtranonce1).first(mExtranonce1Size);
+  }
+
+  /// \brief Get the current share difficulty.
+  inline double getDifficulty() const { return mDifficulty; }
+
+  /// \brief Get the current share target.
+  inline const uint256 &getTarget() const { return mTarget; }
+
+  /// \brief Get the number of shares credited.
+  inline uint64_t getAcceptedShares() const { return mAccepted; }
+
+  /// \brief Get the sum of the difficulty of the credited shares.
+  inline double getAcceptedWork() const { return mAcceptedWork; }
+
+private:
+  friend class ShareBatch;
+
+  /// \brief Target and credited difficulty of a share for a job.
+  inline const uint256 &targetFor(uint32_t job, double &difficulty) const {
+    if (job < mChangeJob && mPreviousTarget > mTarget) {
+      difficulty = mPreviousDifficulty;
+      return mPreviousTarget;
+    }
+    difficulty = mDifficulty;
+    return mTarget;
+  }
+
+  /// \brief Count a credited share and retarget when due.
+  void credit(double difficulty, uint32_t nextJob,
+              std::chrono::steady_clock::time_point now);
+
+  VarDiffConfig mConfig;
+  std::array<uint8_t, MAX_EXTRANONCE1_SIZE> mExtranonce1;
+  size_t mExtranonce1Size;
+
+  double mDifficulty;
+  uint256 mTarget;
+  double mPreviousDifficulty;
+  uint256 mPreviousTarget;
+  uint32_t mChangeJob; // first job id created at mDifficulty
+  bool mChanged;
+
+  // Retarget window
+  std::chrono::steady_clock::time_point mWindowStart;
+  uint32_t mWindowShares;
+
+  uint64_t mAccepted;
+  double mAcceptedWork;
+
+  // The last Merkle root, as miners roll the nonce, time and version far
+  // more often than the extranonce
+  bool mRootValid;
+  uint32_t mRootPending; // index in a batch's fold list while computed
+  uint32_t mRootJob;
+  uint64_t mRootExtranonce2;
+  Hash mRoot;
+};
+
+/// \brief A share as submitted with mining.submit, decoded.
+struct Share {
+  /// \brief The submitting connection.
+  Worker *worker = nullptr;
+
+  /// \brief Id returned by ShareValidator::addJob.
+  uint32_t job = 0;
+
+  /// \brief Extranonce2, in its first ShareValidator::getExtranonce2Size()
+  /// bytes.
+  std::array<uint8_t, 8> extranonce2{};
+
+  uint32_t time = 0;
+  uint32_t nonce = 0;
+
+  /// \brief Rolled version bits; only bits in the job's version mask may
+  /// be set.
+  uint32_t versionBits = 0;
+};
+
+/// \brief Outcome of a share.
+enum class ShareStatus : uint8_t {
+  Accepted,
+  Block,         // also meets the network target
+  LowDifficulty, // above the share target
+  Duplicate,
+  UnknownJob,    // never added, evicted, or before the last new block
+  BadExtranonce, // the worker's extranonce1 has the wrong size
+  BadTime,       // before the job's time or too far after it
+  BadVersion,    // version bits outside the mask
+  Overloaded,    // the duplicate set is full
+};
+
+/// \brief Validation result of one share.
+struct ShareResult {
+  ShareStatus status = ShareStatus::UnknownJob;
+
+  /// \brief Difficulty credited (0 unless accepted).
+  double difficulty = 0;
+
+  /// \brief Header hash (raw little-endian bytes), when the job was found.
+  Hash hash{};
+};
+
+/// \brief Validation settings.
+struct ValidatorConfig {
+  /// \brief Sizes of the per-connection extranonce part and of the part
+  /// miners roll.
+  size_t extranonce1Size = 4;
+  size_t extranonce2Size = 8;
+
+  /// \brief Jobs kept; adding more evicts the oldest.
+  size_t maxJobs = 32;
+
+  /// \brief Seconds a share's time may run ahead of its job's.
+  uint32_t maxTimeDrift = 7200;
+
+  /// \brief Distinct shares remembered between two new blocks.
+  size_t maxShares = 1 << 22;
+};
+
+/// \brief Validates shares against the pool's current jobs. Shared by all
+/// validating threads.
+/// \note Each job keeps a SHA-256 midstate of its coinbase up to the
+/// extranonce and the Merkle branch (see MiningJob), so rebuilding a header
+/// costs the coinbase tail and the branch; workers cache their last root
+/// on top. The hashing itself happens in ShareBatch, one per thread. Jobs
+/// are guarded by a reader-writer lock taken once per batch, and duplicate
+/// headers are caught across all threads by a lock-free hash set of header
+/// hashes.
+class ShareValidator {
+public:
+  /// \brief Construct a validator without jobs.
+  /// \param config Settings.
+  /// \throws std::invalid_argument if an extranonce size is above 8 or
+  /// maxJobs is zero.
+  explicit ShareValidator(const ValidatorConfig &config = ValidatorConfig());
+
+  /// \brief Add a job. Thread-safe.
+  /// \param coinbase1 Coinbase serialization before the extranonce.
+  /// \param coinbase2 Coinbase serialization after the extranonce.
+  /// \param merkleBranch Branch of the coinbase, from the leaves up.
+  /// \param header Version, previous block hash, time and bits.
+  /// \param versionMask Version bits miners may roll.
+  /// \return The job id, sent to miners in mining.notify.
+  uint32_t addJob(std::span<const uint8_t> coinbase1,
+                  std::span<const uint8_t> coinbase2,
+                  std::span<const Hash> merkleBranch,
+                  const PackedHeader &header, uint32_t versionMask);
+
+  /// \brief Retire every job and forget the shares seen, after a new block.
+  /// Thread-safe.
+  void newBlock();
+
+  /// \brief Get the id the next job will get. Thread-safe.
+  uint32_t getNextJobId() const;
+
+  /// \brief Get the size of the extranonce part miners roll.
+  inline size_t getExtranonce2Size() const {
+    return mConfig.extranonce2Size;
+  }
+
+private:
+  friend class ShareBatch;
+
+  /// \brief A job and what checking its shares needs.
+  struct Job {
+    uint32_t id = 0;
+    bool valid = false;
+    MiningJob mining; // extranonce1 + extranonce2 make its extranonce
+    uint32_t versionMask = 0;
+    uint256 networkTarget;
+  };
+
+  ValidatorConfig mConfig;
+  mutable std::shared_mutex mMutex;
+  std::vector<Job> mJobs; // by id % maxJobs
+  uint32_t mNextJob;
+  uint32_t mFirstValidJob;
+  util::ConcurrentHashSet mSeen;
+};
+
+/// \brief Collects shares and validates them a batch at a time.
+/// \note Submissions are queued as they arrive and validated together by
+/// flush(), so the header double SHA-256 runs LANES headers at a time in
+/// the multi-lane kernel, and Merkle roots that are not cached are folded
+/// level by level across the batch. Use one batch per thread; buffers are
+/// reused.
+class ShareBatch {
+public:
+  /// \brief Construct an empty batch.
+  /// \param capacity Shares queued before full() turns true.
+  explicit ShareBatch(size_t capacity = 256);
+
+  /// \brief Queue a share.
+  /// \return Its index in the results of the next flush().
+  size_t push(const Share &share);
+
+  /// \brief Number of shares queued.
+  inline size_t size() const { return mShares.size(); }
+
+  /// \brief Whether the batch reached its capacity.
+  inline bool full() const { return mShares.size() >= mCapacity; }
+
+  /// \brief Validate the queued shares, credit them to their workers and
+  /// empty the batch.
+  /// \param validator Jobs and seen shares.
+  /// \param now Current time, for variable difficulty.
+  /// \return One result per share, in push() order; valid until the next
+  /// flush().
+  std::span<const ShareResult>
+  flush(ShareValidator &validator,
+        std::chrono::steady_clock::time_point now =
+            std::chrono::steady_clock::now());
+
+private:
+  size_t mCapacity;
+  std::vector<Share> mShares;
+  std::vector<ShareResult> mResults;
+
+  // Scratch, by share
+  std::vector<const ShareValidator::Job *> mJobs; // null once rejected
+  std::vector<uint32_t> mRootFrom; // fold index, or NO_FOLD if cached
+  std::vector<uint32_t> mLive;     // shares whose header is hashed
+  std::vector<uint8_t> mHeaders;   // contiguous 80-byte headers
+  std::vector<Hash> mHashes;
+
+  // Merkle roots computed in the batch
+  std::vector<uint32_t> mFold;     // share that computes each root
+  std::vector<uint8_t> mPairs;     // 64 bytes per root: node, sibling
+  std::vector<Hash> mFolded;
+  std::vector<const void *> mSources;
+  std::vector<size_t> mSizes;
+  std::vector<void *> mDestinations;
+};
+
+} // namespace Block
+#endif // __SHARE_VALIDATOR_H__
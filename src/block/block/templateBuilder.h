@@ -0,0 +1,202 @@
+#ifndef __TEMPLATE_BUILDER_H__
+#define __TEMPLATE_BUILDER_H__
+
+// system includes
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// project includes
+#include "types/types.h"
+
+namespace Block {
+
+/// \brief A mempool transaction offered to the template builder.
+struct MempoolEntry {
+  /// \brief txid and wtxid (raw little-endian bytes).
+  Hash txid{};
+  Hash wtxid{};
+
+  /// \brief Fee in satoshis, including any prioritisation.
+  int64_t fee = 0;
+
+  /// \brief Weight units and signature operation cost.
+  uint32_t weight = 0;
+  uint32_t sigops = 0;
+};
+
+/// \brief Block limits applied by the template builder.
+struct TemplateLimits {
+  uint32_t maxWeight = 4000000;
+  uint32_t maxSigops = 80000;
+
+  /// \brief Weight and sigops kept free for the coinbase.
+  uint32_t coinbaseWeight = 4000;
+  uint32_t coinbaseSigops = 400;
+
+  /// \brief Transactions with more in-mempool ancestors are never selected.
+  uint32_t maxAncestors = 25;
+
+  /// \brief Give up after this many packages in a row did not fit, once the
+  /// block is within coinbaseWeight of full.
+  uint32_t maxConsecutiveFailures = 1000;
+};
+
+/// \brief Transactions chosen for a block.
+struct SelectedTemplate {
+  /// \brief Mempool indexes in block order (after the coinbase). Parents
+  /// always precede their children.
+  std::vector<uint32_t> indexes;
+
+  /// \brief txids and wtxids of the selected transactions, in block order,
+  /// without the coinbase.
+  std::vector<Hash> txids;
+  std::vector<Hash> wtxids;
+
+  /// \brief Sum of the selected fees, and the coinbase value: subsidy plus
+  /// fees.
+  int64_t fees = 0;
+  int64_t coinbaseValue = 0;
+
+  /// \brief Weight and sigops of the selected transactions, coinbase
+  /// reservation included.
+  uint64_t weight = 0;
+  uint64_t sigops = 0;
+
+  /// \brief Merkle leaves for BlockHeader::createMerkleRoot.
+  /// \param coinbaseTxid txid of the coinbase, which comes first.
+  std::vector<Hash> getMerkleLeaves(const Hash &coinbaseTxid) const;
+};
+
+/// \brief Builds block templates from a mempool snapshot by ancestor-package
+/// fee rate.
+/// \note The same selection as Bitcoin Core's BlockAssembler: repeatedly
+/// take the transaction whose not-yet-selected ancestors, together with it,
+/// pay the highest fee rate, and add that package if it fits. Ancestor sets
+/// and their fee, weight and sigop sums are computed once as transactions
+/// are added. A build keeps the packages in a max-heap with lazy deletion:
+/// selecting a package subtracts it from the sums of its unselected
+/// descendants, which are pushed again with their new score while their old
+/// entries go stale. Only the best few thousand packages are heapified at a
+/// time, cut off at a score estimated from a sample; the rest wait in a
+/// reserve until the heap drains below that score. Every array is owned by
+/// the builder and reused, so rebuilding after a fee change or a new block
+/// does not allocate.
+class TemplateBuilder {
+public:
+  /// \brief Construct an empty builder.
+  /// \param limits Block limits.
+  explicit TemplateBuilder(const TemplateLimits &limits = TemplateLimits());
+
+  /// \brief Remove every transaction.
+  void clear();
+
+  /// \brief Add a mempool transaction.
+  /// \param entry Ids, fee, weight and sigops.
+  /// \param parents Indexes of the in-mempool transactions it spends.
+  /// \return Its index.
+  /// \throws std::invalid_argument if a parent has not been added yet:
+  /// transactions must be added parents first.
+  uint32_t addTransaction(const MempoolEntry &entry,
+                          std::span<const uint32_t> parents = {});
+
+  /// \brief Change the fee of a transaction (a fee bump or prioritisation).
+  /// \param index Its index.
+  /// \param fee New fee.
+  /// \throws std::out_of_range for an unknown index.
+  void setFee(uint32_t index, int64_t fee);
+
+  /// \brief Number of transactions added.
+  inline size_t size() const { return mEntries.size(); }
+
+  /// \brief Select the transactions of a block.
+  /// \param height Height of the block, for the subsidy.
+  /// \return The selection; valid until the next build.
+  const SelectedTemplate &build(uint32_t height);
+
+  /// \brief Block subsidy at a height.
+  /// \param height Block height.
+  /// \param halvingInterval Blocks between two halvings.
+  /// \return Subsidy in satoshis.
+  static int64_t getBlockSubsidy(uint32_t height,
+                                 uint32_t halvingInterval = 210000);
+
+private:
+  /// \brief Build state of a transaction.
+  enum State : uint8_t {
+    UNTOUCHED, // package sums are the ancestor sums
+    MODIFIED,  // ancestors were selected; see mPackage*
+    INCLUDED,
+  };
+
+  /// \brief Heap entry: a package score and the version it was computed at.
+  struct Candidate {
+    double score;
+    uint32_t index;
+    uint32_t version;
+  };
+
+  /// \brief Heap order: best score on top, ties to the earlier transaction.
+  static inline bool lowerScore(const Candidate &a, const Candidate &b) {
+    return a.score < b.score || (a.score == b.score && a.index > b.index);
+  }
+
+  /// \brief Move the best reserve candidates into the heap.
+  /// \return Score that every candidate left in the reserve is below.
+  double refill();
+
+  /// \brief Make the children lists current.
+  void buildChildren();
+
+  /// \brief Add one transaction to the selection and take it out of the
+  /// package sums of its descendants.
+  void include(uint32_t index);
+
+  /// \brief Fee rate of the unselected package ending at a transaction.
+  inline double score(uint32_t index) const {
+    const bool modified = mState[index] == MODIFIED;
+    const int64_t fee = modified ? mPackageFee[index] : mAncestorFee[index];
+    const uint64_t weight =
+        modified ? mPackageWeight[index] : mAncestorWeight[index];
+    return static_cast<double>(fee) /
+           static_cast<double>(std::max<uint64_t>(weight, 1));
+  }
+
+  TemplateLimits mLimits;
+  SelectedTemplate mSelected;
+
+  // Mempool, by index
+  std::vector<MempoolEntry> mEntries;
+  std::vector<uint32_t> mParentBegin; // size() + 1 offsets into mParents
+  std::vector<uint32_t> mParents;
+  std::vector<uint32_t> mAncestorBegin; // size() + 1 offsets into mAncestors
+  std::vector<uint32_t> mAncestors;     // ascending, without the entry
+  std::vector<uint8_t> mEligible;       // within the ancestor limit
+  std::vector<int64_t> mAncestorFee;    // sums include the entry
+  std::vector<uint64_t> mAncestorWeight;
+  std::vector<uint64_t> mAncestorSigops;
+
+  // Children lists, rebuilt lazily from the parents
+  bool mChildrenValid;
+  std::vector<uint32_t> mChildBegin;
+  std::vector<uint32_t> mChildren;
+
+  // Build state
+  std::vector<int64_t> mPackageFee;
+  std::vector<uint64_t> mPackageWeight;
+  std::vector<uint64_t> mPackageSigops;
+  std::vector<uint8_t> mState;
+  std::vector<uint32_t> mVersion;
+  std::vector<uint32_t> mVisited; // stamp of the last descendant walk
+  uint32_t mStamp;
+  std::vector<uint32_t> mStack;
+  std::vector<uint32_t> mTouched;
+  std::vector<Candidate> mHeap;
+  std::vector<Candidate> mReserve; // not yet heapified
+  std::vector<uint32_t> mMerged; // scratch for ancestor set unions
+};
+
+} // namespace Block
+#endif // __TEMPLATE_BUILDER_H__
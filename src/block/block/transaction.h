@@ -0,0 +1,137 @@
+#ifndef __TRANSACTION_H__
+#define __TRANSACTION_H__
+
+// system includes
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <vector>
+
+// project includes
+#include "types/types.h"
+
+namespace Block {
+
+/// \brief A transaction input. Every span points into the serialized
+/// transaction.
+struct TxInput {
+  /// \brief Spent output: 32-byte txid and 4-byte little-endian index.
+  std::span<const uint8_t> prevout;
+
+  /// \brief Unlocking script.
+  std::span<const uint8_t> scriptSig;
+
+  /// \brief Sequence number.
+  uint32_t sequence = 0;
+
+  /// \brief Serialized witness stack (item count, then length-prefixed
+  /// items); empty for transactions without witness data.
+  std::span<const uint8_t> witness;
+};
+
+/// \brief A transaction output. The script points into the serialized
+/// transaction.
+struct TxOutput {
+  /// \brief Amount in satoshis.
+  int64_t value = 0;
+
+  /// \brief Locking script.
+  std::span<const uint8_t> scriptPubKey;
+};
+
+/// \brief Zero-copy view of a serialized transaction.
+/// \note The view borrows the buffer it was parsed from, which must outlive
+/// it. Legacy transactions serialize as version, inputs, outputs and lock
+/// time. Segwit transactions (BIP144) add a 0x00 marker and 0x01 flag after
+/// the version and the input witnesses before the lock time; their txid
+/// covers the legacy serialization only.
+struct Transaction {
+  uint32_t version = 0;
+  uint32_t lockTime = 0;
+  std::vector<TxInput> inputs;
+  std::vector<TxOutput> outputs;
+
+  /// \brief Full serialization.
+  std::span<const uint8_t> bytes;
+
+  /// \brief Input and output section: the serialization between the version
+  /// (and segwit marker and flag) and the witnesses or lock time.
+  std::span<const uint8_t> body;
+
+  /// \brief Double SHA-256 of the serialization without witness data.
+  Hash txid{};
+
+  /// \brief Double SHA-256 of the full serialization (equal to txid without
+  /// witness data).
+  Hash wtxid{};
+
+  /// \brief Whether the transaction uses the segwit serialization.
+  inline bool hasWitness() const { return bytes.size() != getBaseSize(); }
+
+  /// \brief Size of the serialization without witness data.
+  inline size_t getBaseSize() const { return body.size() + 8; }
+
+  /// \brief Transaction weight (BIP141).
+  inline size_t getWeight() const { return getBaseSize() * 3 + bytes.size(); }
+};
+
+/// \brief Parse one serialized transaction.
+/// \param data Buffer holding the transaction.
+/// \param offset Position of the transaction; advanced past it on success.
+/// \param tx Receives the view. Its input and output vectors are reused.
+/// \param computeIds Also compute the txid and wtxid. The serializations
+/// are fed in place into streaming SHA-256 contexts right after the parse,
+/// while the bytes are still in cache; nothing is copied.
+/// \return false if the transaction is truncated or malformed.
+bool parseTransaction(std::span<const uint8_t> data, size_t &offset,
+                      Transaction &tx, bool computeIds = true);
+
+/// \brief Parses whole serialized blocks into transactions and their ids.
+/// \note Transaction boundaries are found in one sequential pass that only
+/// reads length prefixes. The transactions are then split into one
+/// contiguous range of roughly equal bytes per thread for hashing. Small
+/// transactions go through the variable-length multi-lane double SHA-256
+/// kernel; larger ones, and the txids of small segwit transactions, whose
+/// legacy serialization is not contiguous, are fed in place into streaming
+/// contexts.
+class BlockParser {
+public:
+  /// \brief Construct a parser.
+  /// \param threads Worker threads per block (0 selects the hardware
+  /// concurrency).
+  explicit BlockParser(unsigned int threads = 0);
+
+  /// \brief Parse the transactions of a block and compute their ids.
+  /// \param block Serialized block: 80-byte header, transaction count and
+  /// transactions.
+  /// \param txs Receives one view per transaction. Views of a previous call
+  /// are reused to avoid reallocating their vectors.
+  /// \return false if the block is truncated, malformed or has trailing
+  /// bytes.
+  bool parse(std::span<const uint8_t> block,
+             std::vector<Transaction> &txs) const;
+
+  /// \brief Re-derive the Merkle root of a block and compare it with the one
+  /// in its header.
+  /// \param block Serialized block.
+  /// \return true if the block parses and the roots match.
+  bool checkMerkleRoot(std::span<const uint8_t> block) const;
+
+  /// \brief Compute the Merkle root of parsed transactions.
+  /// \param txs Transactions with their ids computed.
+  /// \return The root of their txids (all zeros for no transactions).
+  static Hash computeMerkleRoot(const std::vector<Transaction> &txs);
+
+  /// \brief Get the number of worker threads used per block.
+  inline unsigned int getThreadCount() const { return mThreads; }
+
+  /// \brief Blocks below this many transactions are hashed on the calling
+  /// thread only.
+  static constexpr size_t MIN_PARALLEL_TXS = 512;
+
+private:
+  unsigned int mThreads;
+};
+
+} // namespace Block
+#endif // __TRANSACTION_H__
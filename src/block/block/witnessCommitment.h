@@ -0,0 +1,97 @@
+#ifndef __WITNESS_COMMITMENT_H__
+#define __WITNESS_COMMITMENT_H__
+
+// system includes
+#include <array>
+#include <cstddef>
+#include <cstdint>
+#include <optional>
+#include <span>
+#include <vector>
+
+// project includes
+#include "block/transaction.h"
+#include "types/types.h"
+
+namespace Block {
+
+/// \brief Coinbase witness commitment of a segwit block (BIP141).
+/// \note The commitment is the double SHA-256 of the wtxid Merkle root
+/// (with the coinbase wtxid taken as zero) followed by the witness reserved
+/// value. It is kept as a ready-serialized coinbase output of fixed size;
+/// when the transaction set changes only the 32 commitment bytes move, so a
+/// serialized coinbase is patched in place with swapInto() instead of being
+/// rebuilt.
+class WitnessCommitment {
+public:
+  /// \brief OP_RETURN, push of 36 bytes and the commitment header.
+  static constexpr std::array<uint8_t, 6> SCRIPT_PREFIX = {0x6a, 0x24, 0xaa,
+                                                           0x21, 0xa9, 0xed};
+
+  /// \brief Size of the commitment output script.
+  static constexpr size_t SCRIPT_SIZE = SCRIPT_PREFIX.size() + 32;
+
+  /// \brief Size of the serialized output: value, script length and script.
+  static constexpr size_t OUTPUT_SIZE = 8 + 1 + SCRIPT_SIZE;
+
+  /// \brief Offset of the commitment hash in the serialized output.
+  static constexpr size_t HASH_OFFSET = OUTPUT_SIZE - 32;
+
+  /// \brief Construct the commitment of a block with only a coinbase.
+  /// \param reservedValue Witness reserved value, which the coinbase input
+  /// carries as its single witness item.
+  explicit WitnessCommitment(const Hash &reservedValue = {});
+
+  /// \brief Recompute the commitment for a new transaction set.
+  /// \param wtxids wtxids of the block's transactions after the coinbase.
+  void update(std::span<const Hash> wtxids);
+
+  /// \brief Recompute the commitment from parsed transactions.
+  /// \param txs The block's transactions, coinbase first.
+  void update(const std::vector<Transaction> &txs);
+
+  /// \brief Get the wtxid Merkle root.
+  inline const Hash &getWitnessRoot() const { return mWitnessRoot; }
+
+  /// \brief Get the commitment hash.
+  inline const Hash &getCommitment() const { return mCommitment; }
+
+  /// \brief Get the witness reserved value.
+  inline const Hash &getReservedValue() const { return mReservedValue; }
+
+  /// \brief Get the serialized commitment output.
+  inline std::span<const uint8_t, OUTPUT_SIZE> getOutput() const {
+    return mOutput;
+  }
+
+  /// \brief Get the commitment output script.
+  inline std::span<const uint8_t> getScript() const {
+    return std::span<const uint8_t>(mOutput).subspan(9);
+  }
+
+  /// \brief Overwrite the commitment hash in a serialized coinbase.
+  /// \param coinbase Serialized coinbase transaction.
+  /// \param hashOffset Offset of the commitment hash, as returned by find().
+  /// \throws std::invalid_argument if no commitment script starts there.
+  void swapInto(std::span<uint8_t> coinbase, size_t hashOffset) const;
+
+  /// \brief Locate the commitment hash in a serialized coinbase.
+  /// \param coinbase Serialized coinbase transaction.
+  /// \return Offset of the hash in the highest-index output whose script
+  /// starts with the commitment header, or nothing if there is none or the
+  /// coinbase does not parse.
+  static std::optional<size_t> find(std::span<const uint8_t> coinbase);
+
+private:
+  /// \brief Hash the root with the reserved value into the output.
+  void commit();
+
+  Hash mReservedValue;
+  Hash mWitnessRoot;
+  Hash mCommitment;
+  std::array<uint8_t, OUTPUT_SIZE> mOutput;
+  std::vector<Hash> mLeaves;
+};
+
+} // namespace Block
+#endif // __WITNESS_COMMITMENT_H__
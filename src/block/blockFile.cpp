@@ -0,0 +1,142 @@
+#include "block/blockFile.h"
+
+// system includes
+#include <algorithm>
+#include <bit>
+#include <cerrno>
+#include <cstring>
+#include <fstream>
+#include <system_error>
+
+// project includes
+#include "util/endian.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define HFM_BLOCK_FILE_MMAP 1
+#endif
+
+Block::XorKey Block::readXorKey(const std::string &blocksDir) {
+  XorKey key{};
+  std::ifstream file(blocksDir + "/xor.dat", std::ios::binary);
+  if (file) {
+    file.read(reinterpret_cast<char *>(key.data()), key.size());
+    if (file.gcount() != static_cast<std::streamsize>(key.size())) {
+      key.fill(0);
+    }
+  }
+  return key;
+}
+
+void Block::xorBytes(const XorKey &key, uint64_t offset, const uint8_t *in,
+                     size_t size, uint8_t *out) {
+  // Eight bytes at a time with the key rotated to the starting offset
+  const uint64_t word_key = std::rotr(util::ReadLE64(key.data()),
+                                      static_cast<int>(offset % 8) * 8);
+  size_t i = 0;
+  for (; i + 8 <= size; i += 8) {
+    util::WriteLE64(out + i, util::ReadLE64(in + i) ^ word_key);
+  }
+  for (; i < size; ++i) {
+    out[i] = in[i] ^ key[(offset + i) % key.size()];
+  }
+}
+
+std::span<const uint8_t>
+Block::BlockRecord::bytes(std::vector<uint8_t> &buffer) const {
+  if (!obfuscated) {
+    return stored;
+  }
+  buffer.resize(stored.size());
+  xorBytes(key, offset, stored.data(), stored.size(), buffer.data());
+  return buffer;
+}
+
+Block::BlockFile::BlockFile(const std::string &path, const XorKey &key,
+                            const NetworkMagic &magic)
+    : mData(nullptr), mSize(0), mKey(key),
+      mObfuscated(std::any_of(key.begin(), key.end(),
+                              [](uint8_t byte) { return byte != 0; })),
+      mMagic(magic) {
+#ifdef HFM_BLOCK_FILE_MMAP
+  const int fd = ::open(path.c_str(), O_RDONLY);
+  if (fd < 0) {
+    throw std::system_error(errno, std::generic_category(),
+                            "Cannot open block file " + path);
+  }
+  struct stat info;
+  if (::fstat(fd, &info) != 0) {
+    const int error = errno;
+    ::close(fd);
+    throw std::system_error(error, std::generic_category(),
+                            "Cannot stat block file " + path);
+  }
+  mSize = static_cast<size_t>(info.st_size);
+  if (mSize == 0) {
+    ::close(fd);
+    return;
+  }
+
+  // Obfuscated files are mapped as is and decoded as they are read
+  void *mapping = ::mmap(nullptr, mSize, PROT_READ, MAP_SHARED, fd, 0);
+  const int error = errno;
+  ::close(fd);
+  if (mapping == MAP_FAILED) {
+    throw std::system_error(error, std::generic_category(),
+                            "Cannot map block file " + path);
+  }
+  ::madvise(mapping, mSize, MADV_SEQUENTIAL);
+  mData = static_cast<const uint8_t *>(mapping);
+#else
+  (void)path;
+  throw std::system_error(std::make_error_code(std::errc::not_supported),
+                          "Memory-mapped block files are not supported");
+#endif
+}
+
+Block::BlockFile::~BlockFile() {
+#ifdef HFM_BLOCK_FILE_MMAP
+  if (mData != nullptr) {
+    ::munmap(const_cast<uint8_t *>(mData), mSize);
+  }
+#endif
+}
+
+std::optional<Block::BlockRecord>
+Block::BlockFile::readAt(uint64_t offset) const {
+  if (offset > mSize || mSize - offset < FRAME_SIZE) {
+    return std::nullopt;
+  }
+  uint8_t frame[FRAME_SIZE];
+  if (mObfuscated) {
+    xorBytes(mKey, offset, mData + offset, FRAME_SIZE, frame);
+  } else {
+    std::memcpy(frame, mData + offset, FRAME_SIZE);
+  }
+  // Zero padding or a foreign network ends the walk
+  if (std::memcmp(frame, mMagic.data(), mMagic.size()) != 0) {
+    return std::nullopt;
+  }
+  const uint32_t size = util::ReadLE32(frame + mMagic.size());
+  return readBlock(offset + FRAME_SIZE, size);
+}
+
+std::optional<Block::BlockRecord>
+Block::BlockFile::readBlock(uint64_t offset, uint32_t size) const {
+  if (size < PackedHeader::SIZE || offset > mSize || mSize - offset < size) {
+    return std::nullopt;
+  }
+  BlockRecord record;
+  record.offset = offset;
+  record.stored = std::span<const uint8_t>(mData + offset, size);
+  if (mObfuscated) {
+    record.key = mKey;
+    record.obfuscated = true;
+    xorBytes(mKey, offset, record.stored.data(), PackedHeader::SIZE,
+             record.decodedHeader.data());
+  }
+  return record;
+}
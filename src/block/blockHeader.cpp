@@ -5,13 +5,41 @@
 #include <vector>
 
 // project includes
+#include "block/merkle.h"
 #include "sha256/sha256.h"
+#include "types/uint256.h"
 
 Block::BlockHeader::BlockHeader()
-    : mVersion(0), mTimestamp(0), mBits(0), mNonce(0) {
-  // Initialize previous block hash and Merkle root to zeros
-  std::fill(std::begin(mPrevBlockHash), std::end(mPrevBlockHash), 0);
-  std::fill(std::begin(mMerkleRoot), std::end(mMerkleRoot), 0);
+    : mHeader(), mMidstate(), mMidstateValid(false), mCachedHash(),
+      mHashState(HASH_DIRTY) {}
+
+Block::BlockHeader::BlockHeader(const PackedHeader &header)
+    : mHeader(header), mMidstate(), mMidstateValid(false), mCachedHash(),
+      mHashState(HASH_DIRTY) {}
+
+Block::BlockHeader::BlockHeader(const BlockHeader &other)
+    : mHeader(other.mHeader), mMidstate(other.mMidstate),
+      mMidstateValid(other.mMidstateValid), mCachedHash(),
+      mHashState(HASH_DIRTY) {
+  if (other.isHashCached()) {
+    mCachedHash = other.mCachedHash;
+    mHashState.store(HASH_VALID, std::memory_order_relaxed);
+  }
+}
+
+Block::BlockHeader &
+Block::BlockHeader::operator=(const BlockHeader &other) {
+  if (this != &other) {
+    mHeader = other.mHeader;
+    mMidstate = other.mMidstate;
+    mMidstateValid = other.mMidstateValid;
+    markHashDirty();
+    if (other.isHashCached()) {
+      mCachedHash = other.mCachedHash;
+      mHashState.store(HASH_VALID, std::memory_order_relaxed);
+    }
+  }
+  return *this;
 }
 
 Block::BlockHeader::~BlockHeader() {}
@@ -33,12 +61,9 @@ Hash Block::BlockHeader::doubleSHA256(const Hash &left, const Hash &right) {
 }
 
 Hash Block::BlockHeader::createMerkleRoot(const std::vector<Hash> &tx_hashes) {
-  if (tx_hashes.empty()) {
-    std::fill(std::begin(mMerkleRoot), std::end(mMerkleRoot), 0);
-    return mMerkleRoot;
-  }
-  mMerkleRoot = recursiveMerkleCompute(tx_hashes).front();
-  return mMerkleRoot;
+  const Hash merkle_root = computeMerkleRoot(tx_hashes);
+  setMerkleRoot(merkle_root);
+  return merkle_root;
 }
 
 std::vector<Hash>
@@ -61,101 +86,178 @@ Block::BlockHeader::recursiveMerkleCompute(const std::vector<Hash> &hashes) {
   return recursiveMerkleCompute(new_level);
 }
 
-Hash Block::BlockHeader::calculateBlockHash() const {
-  // Serialize the block header (80 bytes total)
-  uint8_t header[80];
-  uint8_t *cursor = header;
-
-  // Version (4 bytes, little-endian)
-  uint32_t version = mVersion;
-  std::copy(reinterpret_cast<uint8_t *>(&version),
-            reinterpret_cast<uint8_t *>(&version) + 4, cursor);
-  cursor += mVersion_bytesize;
-
-  // Previous block hash (32 bytes)
-  std::copy(mPrevBlockHash.begin(), mPrevBlockHash.end(), cursor);
-  cursor += mPrevBlockHash_bytesize;
-
-  // Merkle root (32 bytes)
-  std::copy(mMerkleRoot.begin(), mMerkleRoot.end(), cursor);
-  cursor += mMerkleRoot_bytesize;
-
-  // Timestamp (4 bytes, little-endian)
-  uint32_t timestamp = mTimestamp;
-  std::copy(reinterpret_cast<uint8_t *>(&timestamp),
-            reinterpret_cast<uint8_t *>(&timestamp) + 4, cursor);
-  cursor += mTimestamp_bytesize;
-
-  // Bits (4 bytes, little-endian)
-  uint32_t bits = mBits;
-  std::copy(reinterpret_cast<uint8_t *>(&bits),
-            reinterpret_cast<uint8_t *>(&bits) + 4, cursor);
-  cursor += mBits_bytesize;
-
-  // Nonce (4 bytes, little-endian)
-  uint32_t nonce = mNonce;
-  std::copy(reinterpret_cast<uint8_t *>(&nonce),
-            reinterpret_cast<uint8_t *>(&nonce) + mNonce_bytesize, cursor);
-
-  // Compute double SHA-256 of the entire header
-  Hash hash;
-  SHA256::sha256_bytes(header, 80, hash.data());
-  uint8_t hash1[32];
-  std::copy(hash.begin(), hash.end(), hash1);
-  SHA256::sha256_bytes(hash1, 32, hash.data());
+void Block::BlockHeader::updateMidstate() {
+  if (mMidstateValid) {
+    return;
+  }
+  SHA256::sha256_init(&mMidstate);
+  SHA256::sha256_append(&mMidstate, mHeader.data(),
+                        PackedHeader::FIRST_BLOCK_SIZE);
+  mMidstateValid = true;
+}
+
+Hash Block::BlockHeader::hashFromMidstate() const {
+  // Only the last 16 header bytes (end of Merkle root, timestamp, bits and
+  // nonce) remain to be absorbed
+  SHA256::sha256 ctx = mMidstate;
+  SHA256::sha256_append(&ctx, mHeader.data() + PackedHeader::FIRST_BLOCK_SIZE,
+                        PackedHeader::SIZE - PackedHeader::FIRST_BLOCK_SIZE);
+  Hash hash1;
+  SHA256::sha256_finalize_bytes(&ctx, hash1.data());
+
+  Hash hash2;
+  SHA256::sha256_bytes(hash1.data(), SHA256::SHA256_BYTES_SIZE, hash2.data());
 
+  return hash2;
+}
+
+void Block::BlockHeader::publishHash(const Hash &hash) const {
+  // Claim the slot so only one reader writes mCachedHash, then release it
+  // to readers that observe HASH_VALID
+  uint8_t expected = HASH_DIRTY;
+  if (mHashState.compare_exchange_strong(expected, HASH_PUBLISHING,
+                                         std::memory_order_acquire,
+                                         std::memory_order_relaxed)) {
+    mCachedHash = hash;
+    mHashState.store(HASH_VALID, std::memory_order_release);
+  }
+}
+
+Hash Block::BlockHeader::calculateBlockHash() const {
+  if (mHashState.load(std::memory_order_acquire) == HASH_VALID) {
+    return mCachedHash;
+  }
+  const Hash hash = computeBlockHash();
+  publishHash(hash);
   return hash;
 }
 
+Hash Block::BlockHeader::computeBlockHash() const {
+  if (mMidstateValid) {
+    return hashFromMidstate();
+  }
+
+  // The header is already serialized, hash the wire bytes directly
+  Hash hash1;
+  SHA256::sha256_bytes(mHeader.data(), PackedHeader::SIZE, hash1.data());
+
+  Hash hash2;
+  SHA256::sha256_bytes(hash1.data(), SHA256::SHA256_BYTES_SIZE, hash2.data());
+
+  return hash2;
+}
+
 bool Block::BlockHeader::calculateNonce(uint32_t maxAttempts) {
-  // Parse the difficulty target from bits
-  // bits format: high byte is exponent, next 3 bytes are mantissa
-  uint32_t bits = mBits;
-  uint32_t exponent = (bits >> 24) & 0xFF;
-  uint32_t mantissa = bits & 0x00FFFFFF;
-
-  // Calculate target as mantissa * 2^(8*(exponent-3))
-  // For now, we'll use a simple comparison: hash must be less than target
-  // Create target hash from bits
-  Hash target;
-  target.fill(0xFF);
-
-  if (exponent <= 3) [[unlikely]] {
-    // Target is less than 1 (should not happen in practice)
+  // Decode the difficulty target from bits once, outside the search loop.
+  bool negative = false;
+  bool overflow = false;
+  const uint256 target = uint256().SetCompact(getBits(), &negative, &overflow);
+  if (negative || overflow || target.IsNull()) [[unlikely]] {
     return false;
   }
 
-  // Set the target bytes based on bits encoding
-  for (size_t i = 0; i < target.size(); ++i) {
-    if (i < (exponent - 3)) {
-      target[i] = 0x00;
-    } else if (i == (exponent - 3)) {
-      target[i] = static_cast<uint8_t>(mantissa & 0xFF);
-    } else if (i == (exponent - 2)) {
-      target[i] = static_cast<uint8_t>((mantissa >> 8) & 0xFF);
-    } else if (i == (exponent - 1)) {
-      target[i] = static_cast<uint8_t>((mantissa >> 16) & 0xFF);
-    } else {
-      target[i] = 0xFF;
-    }
-  }
+  updateMidstate();
 
   // Try nonces from 0 to maxAttempts
   for (uint32_t attempt = 0; attempt < maxAttempts; ++attempt) {
     setNonce(attempt);
-    Hash blockHash = calculateBlockHash();
-
-    // Check if hash is less than target (difficulty met)
-    bool valid = true;
-    for (int i = static_cast<int>(blockHash.size()) - 1; i >= 0; --i) {
-      if (blockHash[i] < target[i]) {
-        return true; // Found valid nonce
-      } else if (blockHash[i] > target[i]) {
-        break; // Hash too high, continue to next nonce
-      }
-      // If equal, continue checking lower bytes
+    const Hash hash = hashFromMidstate();
+    if (MeetsTarget(hash, target)) {
+      publishHash(hash);
+      return true; // Found valid nonce
     }
   }
 
   return false; // No valid nonce found within maxAttempts
 }
+
+bool Block::BlockHeader::calculateNonce(const RollingPolicy &policy,
+                                        Solution &solution,
+                                        uint64_t maxAttempts) {
+  bool negative = false;
+  bool overflow = false;
+  const uint256 target = uint256().SetCompact(getBits(), &negative, &overflow);
+  if (negative || overflow || target.IsNull()) [[unlikely]] {
+    return false;
+  }
+
+  const uint32_t base_version = getVersion();
+  const uint32_t base_timestamp = getTimestamp();
+  const uint32_t mask = policy.versionMask;
+  const uint32_t drift = std::min(policy.maxNtimeDrift, MAX_FUTURE_BLOCK_TIME);
+  const uint64_t nonce_end =
+      std::min<uint64_t>(uint64_t{policy.nonceStart} + policy.nonceCount,
+                         uint64_t{1} << 32);
+
+  uint64_t attempts = 0;
+  uint32_t rolled = base_version & mask;
+  do {
+    setVersion((base_version & ~mask) | rolled);
+    updateMidstate();
+
+    for (uint64_t offset = 0; offset <= drift && attempts < maxAttempts;
+         ++offset) {
+      setTimestamp(base_timestamp + static_cast<uint32_t>(offset));
+
+      for (uint64_t nonce = policy.nonceStart;
+           nonce < nonce_end && attempts < maxAttempts; ++nonce, ++attempts) {
+        setNonce(static_cast<uint32_t>(nonce));
+        const Hash hash = hashFromMidstate();
+        if (MeetsTarget(hash, target)) {
+          solution.nonce = static_cast<uint32_t>(nonce);
+          solution.version = getVersion();
+          solution.timestamp = getTimestamp();
+          solution.hash = hash;
+          publishHash(hash);
+          return true;
+        }
+      }
+    }
+
+    rolled = nextRolledVersion(rolled, mask);
+  } while (rolled != (base_version & mask) && attempts < maxAttempts);
+
+  setVersion(base_version);
+  setTimestamp(base_timestamp);
+  return false;
+}
+
+Block::ScanResult
+Block::BlockHeader::scanNonces(uint32_t firstNonce, uint64_t count,
+                               std::span<const uint256> targets,
+                               std::span<ScanHit> hits) {
+  ScanResult result;
+  if (targets.empty() || hits.empty()) {
+    return result;
+  }
+
+  updateMidstate();
+
+  const uint256 &easiest = targets.front();
+  const uint64_t end = std::min<uint64_t>(uint64_t{firstNonce} + count,
+                                          uint64_t{1} << 32);
+  for (uint64_t nonce = firstNonce; nonce < end; ++nonce) {
+    setNonce(static_cast<uint32_t>(nonce));
+    const Hash hash = hashFromMidstate();
+    ++result.scanned;
+    if (!MeetsTarget(hash, easiest)) [[likely]] {
+      continue;
+    }
+
+    // Walk up to the hardest target this hash still meets
+    size_t met = 0;
+    while (met + 1 < targets.size() && MeetsTarget(hash, targets[met + 1])) {
+      ++met;
+    }
+
+    ScanHit &hit = hits[result.hits++];
+    hit.nonce = static_cast<uint32_t>(nonce);
+    hit.targetIndex = static_cast<uint8_t>(met);
+    hit.hash = hash;
+    if (result.hits == hits.size()) {
+      break;
+    }
+  }
+
+  return result;
+}
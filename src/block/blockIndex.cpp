@@ -0,0 +1,273 @@
+#include "block/blockIndex.h"
+
+// system includes
+#include <algorithm>
+#include <atomic>
+#include <cstdio>
+#include <exception>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <system_error>
+#include <thread>
+
+// project includes
+#include "sha256/sha256.h"
+#include "util/endian.h"
+
+namespace Block {
+namespace BlockIndex_internal {
+
+// Serialized sizes
+static constexpr size_t HEADER_SIZE = 24;
+static constexpr size_t FILE_STATE_SIZE = 12;
+static constexpr size_t ENTRY_SIZE = 32 + 12;
+
+// Headers hashed per kernel call while scanning
+static constexpr size_t HASH_BATCH = 64;
+
+// Parse NNNNN out of blkNNNNN.dat
+static std::optional<uint32_t> blockFileNumber(const std::string &name) {
+  if (name.size() != 12 || name.rfind("blk", 0) != 0 ||
+      name.substr(8) != ".dat") {
+    return std::nullopt;
+  }
+  const std::string digits = name.substr(3, 5);
+  if (!std::all_of(digits.begin(), digits.end(), ::isdigit)) {
+    return std::nullopt;
+  }
+  return static_cast<uint32_t>(std::stoul(digits));
+}
+
+} // namespace BlockIndex_internal
+} // namespace Block
+
+std::string Block::BlockIndex::blockFilePath(const std::string &blocksDir,
+                                             uint32_t file) {
+  char name[16];
+  std::snprintf(name, sizeof(name), "blk%05u.dat", file);
+  return (std::filesystem::path(blocksDir) / name).string();
+}
+
+Block::BlockIndex Block::BlockIndex::build(const std::string &blocksDir,
+                                           const std::string &indexPath,
+                                           unsigned int threads,
+                                           const NetworkMagic &magic) {
+  using namespace BlockIndex_internal;
+
+  // Current block files, in file order
+  std::map<uint32_t, uint64_t> files;
+  for (const auto &entry : std::filesystem::directory_iterator(blocksDir)) {
+    const std::optional<uint32_t> number =
+        blockFileNumber(entry.path().filename().string());
+    if (number && entry.is_regular_file()) {
+      files[*number] = entry.file_size();
+    }
+  }
+
+  BlockIndex saved;
+  const bool have_saved = saved.load(indexPath);
+
+  // Resume every file at the end of its last complete record: Core
+  // preallocates files, so blocks are appended without changing the size.
+  // A file now shorter than that was replaced and is scanned from the start.
+  std::map<uint32_t, uint64_t> ends;
+  if (have_saved) {
+    for (const FileState &state : saved.mFiles) {
+      const auto current = files.find(state.file);
+      if (current != files.end() && state.end <= current->second) {
+        ends[state.file] = state.end;
+      }
+    }
+  }
+
+  BlockIndex index;
+  for (const Entry &entry : saved.mEntries) {
+    if (ends.count(entry.location.file)) {
+      index.mEntries.push_back(entry);
+    }
+  }
+
+  // A file filled up to its end has no room for another block
+  std::vector<uint32_t> to_scan;
+  std::vector<uint64_t> offsets;
+  for (const auto &[file, size] : files) {
+    const uint64_t end = ends[file];
+    if (end < size) {
+      to_scan.push_back(file);
+      offsets.push_back(end);
+    }
+  }
+
+  // Scan the rest of every file in parallel, one file per thread at a time
+  const XorKey key = readXorKey(blocksDir);
+  std::vector<std::vector<Entry>> scanned(to_scan.size());
+  std::vector<std::exception_ptr> errors(to_scan.size());
+  std::atomic<size_t> next_file(0);
+  const auto scan = [&]() {
+    size_t j;
+    while ((j = next_file.fetch_add(1)) < to_scan.size()) {
+      try {
+        const BlockFile block_file(blockFilePath(blocksDir, to_scan[j]), key,
+                                   magic);
+        std::vector<Entry> &entries = scanned[j];
+        uint64_t &offset = offsets[j];
+        std::vector<uint8_t> headers;
+        headers.reserve(HASH_BATCH * PackedHeader::SIZE);
+        std::vector<Hash> digests(HASH_BATCH);
+
+        // Gather headers so their hashes go through the batch kernel
+        const auto flush = [&]() {
+          const size_t count = headers.size() / PackedHeader::SIZE;
+          SHA256::SHA256::double_bytes_80(headers.data(), count,
+                                          digests.data());
+          for (size_t i = 0; i < count; ++i) {
+            entries[entries.size() - count + i].hash = digests[i];
+          }
+          headers.clear();
+        };
+        const auto visit = [&](const BlockRecord &record) {
+          Entry entry;
+          entry.location.file = to_scan[j];
+          entry.location.offset = static_cast<uint32_t>(record.offset);
+          entry.location.size = record.size();
+          entries.push_back(entry);
+          const BlockHeaderView header = record.header();
+          headers.insert(headers.end(), header.data(),
+                         header.data() + PackedHeader::SIZE);
+          if (headers.size() == HASH_BATCH * PackedHeader::SIZE) {
+            flush();
+          }
+        };
+        block_file.forEachBlock(visit, offset);
+        flush();
+      } catch (...) {
+        errors[j] = std::current_exception();
+      }
+    }
+  };
+
+  const unsigned int workers = static_cast<unsigned int>(std::min<size_t>(
+      threads == 0 ? std::max(1u, std::thread::hardware_concurrency())
+                   : threads,
+      std::max<size_t>(1, to_scan.size())));
+  std::vector<std::thread> pool;
+  for (unsigned int t = 1; t < workers; ++t) {
+    pool.emplace_back(scan);
+  }
+  scan();
+  for (auto &thread : pool) {
+    thread.join();
+  }
+  for (const std::exception_ptr &error : errors) {
+    if (error) {
+      std::rethrow_exception(error);
+    }
+  }
+
+  for (size_t j = 0; j < to_scan.size(); ++j) {
+    ends[to_scan[j]] = offsets[j];
+    if (!scanned[j].empty()) {
+      ++index.mScannedFiles;
+    }
+    index.mEntries.insert(index.mEntries.end(),
+                          std::make_move_iterator(scanned[j].begin()),
+                          std::make_move_iterator(scanned[j].end()));
+  }
+  for (const auto &[file, size] : files) {
+    index.mFiles.push_back({file, ends[file]});
+  }
+  std::sort(index.mEntries.begin(), index.mEntries.end(),
+            [](const Entry &a, const Entry &b) { return a.hash < b.hash; });
+
+  index.save(indexPath);
+  return index;
+}
+
+std::optional<Block::BlockLocation>
+Block::BlockIndex::find(const Hash &hash) const {
+  const auto it = std::lower_bound(
+      mEntries.begin(), mEntries.end(), hash,
+      [](const Entry &entry, const Hash &key) { return entry.hash < key; });
+  if (it == mEntries.end() || it->hash != hash) {
+    return std::nullopt;
+  }
+  return it->location;
+}
+
+bool Block::BlockIndex::load(const std::string &indexPath) {
+  using namespace BlockIndex_internal;
+
+  std::ifstream file(indexPath, std::ios::binary);
+  if (!file) {
+    return false;
+  }
+  const std::vector<uint8_t> data((std::istreambuf_iterator<char>(file)),
+                                  std::istreambuf_iterator<char>());
+  if (data.size() < HEADER_SIZE || util::ReadLE64(data.data()) != MAGIC ||
+      util::ReadLE32(data.data() + 8) != FORMAT) {
+    return false;
+  }
+  const uint32_t file_count = util::ReadLE32(data.data() + 12);
+  const uint64_t entry_count = util::ReadLE64(data.data() + 16);
+  if (data.size() != HEADER_SIZE + file_count * FILE_STATE_SIZE +
+                         entry_count * ENTRY_SIZE) {
+    return false;
+  }
+
+  const uint8_t *p = data.data() + HEADER_SIZE;
+  mFiles.resize(file_count);
+  for (FileState &state : mFiles) {
+    state.file = util::ReadLE32(p);
+    state.end = util::ReadLE64(p + 4);
+    p += FILE_STATE_SIZE;
+  }
+  mEntries.resize(entry_count);
+  for (Entry &entry : mEntries) {
+    std::copy_n(p, entry.hash.size(), entry.hash.begin());
+    entry.location.file = util::ReadLE32(p + 32);
+    entry.location.offset = util::ReadLE32(p + 36);
+    entry.location.size = util::ReadLE32(p + 40);
+    p += ENTRY_SIZE;
+  }
+  return true;
+}
+
+void Block::BlockIndex::save(const std::string &indexPath) const {
+  using namespace BlockIndex_internal;
+
+  std::vector<uint8_t> data(HEADER_SIZE + mFiles.size() * FILE_STATE_SIZE +
+                            mEntries.size() * ENTRY_SIZE);
+  util::WriteLE64(data.data(), MAGIC);
+  util::WriteLE32(data.data() + 8, FORMAT);
+  util::WriteLE32(data.data() + 12, static_cast<uint32_t>(mFiles.size()));
+  util::WriteLE64(data.data() + 16, mEntries.size());
+
+  uint8_t *p = data.data() + HEADER_SIZE;
+  for (const FileState &state : mFiles) {
+    util::WriteLE32(p, state.file);
+    util::WriteLE64(p + 4, state.end);
+    p += FILE_STATE_SIZE;
+  }
+  for (const Entry &entry : mEntries) {
+    std::copy(entry.hash.begin(), entry.hash.end(), p);
+    util::WriteLE32(p + 32, entry.location.file);
+    util::WriteLE32(p + 36, entry.location.offset);
+    util::WriteLE32(p + 40, entry.location.size);
+    p += ENTRY_SIZE;
+  }
+
+  // Write a temporary file and rename it, so a crash leaves the old index
+  const std::string temp_path = indexPath + ".tmp";
+  {
+    std::ofstream file(temp_path, std::ios::binary | std::ios::trunc);
+    file.write(reinterpret_cast<const char *>(data.data()),
+               static_cast<std::streamsize>(data.size()));
+    if (!file) {
+      throw std::system_error(std::make_error_code(std::errc::io_error),
+                              "Cannot write block index " + temp_path);
+    }
+  }
+  std::filesystem::rename(temp_path, indexPath);
+}
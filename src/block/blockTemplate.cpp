@@ -0,0 +1,290 @@
+#include "block/blockTemplate.h"
+
+// system includes
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+// project includes
+#include "block/transaction.h"
+#include "util/endian.h"
+#include "util/jsonReader.h"
+#include "util/transcode.h"
+
+namespace Block {
+namespace BlockTemplate_internal {
+
+using util::JsonReader;
+using util::JsonToken;
+
+// Required template fields
+enum Field : uint32_t {
+  VERSION = 1 << 0,
+  PREV_HASH = 1 << 1,
+  BITS = 1 << 2,
+  CURTIME = 1 << 3,
+  HEIGHT = 1 << 4,
+  COINBASE_VALUE = 1 << 5,
+  TRANSACTIONS = 1 << 6,
+  ALL_FIELDS = (1 << 7) - 1,
+};
+
+[[noreturn]] static void fail(const JsonReader &reader,
+                              const std::string &what) {
+  throw std::runtime_error("Invalid block template at offset " +
+                           std::to_string(reader.getOffset()) + ": " + what);
+}
+
+static void expect(JsonReader &reader, JsonToken token,
+                   const std::string &what) {
+  if (reader.next() != token) {
+    fail(reader, what);
+  }
+}
+
+static int64_t readInt(JsonReader &reader, const char *name) {
+  int64_t value = 0;
+  if (reader.next() != JsonToken::Number || !reader.getInt(value)) {
+    fail(reader, std::string(name) + " must be an integer");
+  }
+  return value;
+}
+
+static uint32_t readUint32(JsonReader &reader, const char *name) {
+  uint64_t value = 0;
+  if (reader.next() != JsonToken::Number || !reader.getUint(value) ||
+      value > 0xffffffff) {
+    fail(reader, std::string(name) + " must be a 32-bit unsigned integer");
+  }
+  return static_cast<uint32_t>(value);
+}
+
+// A hash as the RPC displays it: big-endian hex, reversed into raw bytes
+static Hash readHash(JsonReader &reader, const char *name) {
+  Hash hash;
+  if (reader.next() != JsonToken::String ||
+      reader.getValue().size() != 2 * hash.size() ||
+      !util::DecodeHex(reader.getValue(), hash.data())) {
+    fail(reader, std::string(name) + " must be a 64-digit hex hash");
+  }
+  std::reverse(hash.begin(), hash.end());
+  return hash;
+}
+
+} // namespace BlockTemplate_internal
+} // namespace Block
+
+int64_t Block::BlockTemplate::getTotalFees() const {
+  int64_t total = 0;
+  for (const TemplateTransaction &tx : transactions) {
+    total += tx.fee;
+  }
+  return total;
+}
+
+Block::BlockTemplateParser::BlockTemplateParser()
+    : mTemplate(), mArena(), mArenaCapacity(0), mArenaUsed(0), mDepends(),
+      mDependRanges() {}
+
+uint8_t *Block::BlockTemplateParser::allocate(size_t bytes) {
+  // Sized from the input up front, so spans handed out stay valid
+  if (mArenaCapacity - mArenaUsed < bytes) {
+    throw std::runtime_error("Block template arena exhausted");
+  }
+  uint8_t *block = mArena.get() + mArenaUsed;
+  mArenaUsed += bytes;
+  return block;
+}
+
+const Block::BlockTemplate &
+Block::BlockTemplateParser::parse(std::string_view json) {
+  using namespace BlockTemplate_internal;
+
+  // Hex decodes to half its length, which bounds every arena allocation
+  if (mArenaCapacity < json.size() / 2) {
+    mArenaCapacity = json.size() / 2;
+    mArena.reset(new uint8_t[mArenaCapacity]);
+  }
+  mArenaUsed = 0;
+  mDepends.clear();
+  mDependRanges.clear();
+  mTemplate.transactions.clear();
+  mTemplate.defaultWitnessCommitment = {};
+  mTemplate.header = BlockHeader();
+  mTemplate.minTime = 0;
+
+  JsonReader reader(json);
+  uint32_t seen = 0;
+
+  const auto read_hex = [&](const char *name) {
+    if (reader.next() != JsonToken::String ||
+        reader.getValue().size() % 2 != 0) {
+      fail(reader, std::string(name) + " must be hex");
+    }
+    const std::string_view hex = reader.getValue();
+    uint8_t *bytes = allocate(hex.size() / 2);
+    if (!util::DecodeHex(hex, bytes)) {
+      fail(reader, std::string(name) + " must be hex");
+    }
+    return std::span<const uint8_t>(bytes, hex.size() / 2);
+  };
+
+  const auto read_transaction = [&]() {
+    TemplateTransaction tx;
+    bool have_txid = false;
+    bool have_wtxid = false;
+    const size_t depends_begin = mDepends.size();
+    JsonToken token;
+    while ((token = reader.next()) == JsonToken::Key) {
+      const std::string_view key = reader.getValue();
+      if (key == "data") {
+        tx.data = read_hex("data");
+      } else if (key == "txid") {
+        tx.txid = readHash(reader, "txid");
+        have_txid = true;
+      } else if (key == "hash") {
+        tx.wtxid = readHash(reader, "hash");
+        have_wtxid = true;
+      } else if (key == "fee") {
+        tx.fee = readInt(reader, "fee");
+      } else if (key == "weight") {
+        tx.weight = readUint32(reader, "weight");
+      } else if (key == "sigops") {
+        tx.sigops = readUint32(reader, "sigops");
+      } else if (key == "depends") {
+        expect(reader, JsonToken::BeginArray, "depends must be an array");
+        JsonToken item;
+        while ((item = reader.next()) == JsonToken::Number) {
+          uint64_t index = 0;
+          if (!reader.getUint(index) || index == 0 ||
+              index > mTemplate.transactions.size()) {
+            fail(reader, "depends must name earlier transactions");
+          }
+          mDepends.push_back(static_cast<uint32_t>(index));
+        }
+        if (item != JsonToken::EndArray) {
+          fail(reader, "depends must be an array of indexes");
+        }
+      } else if (!reader.skipValue()) {
+        fail(reader, "malformed JSON");
+      }
+    }
+    if (token != JsonToken::EndObject) {
+      fail(reader, "malformed transaction");
+    }
+    if (tx.data.empty()) {
+      fail(reader, "transaction without data");
+    }
+
+    // Nodes without segwit support omit the ids we need; derive them
+    if (!have_txid || !have_wtxid) {
+      Transaction parsed;
+      size_t offset = 0;
+      if (!parseTransaction(tx.data, offset, parsed) ||
+          offset != tx.data.size()) {
+        fail(reader, "transaction data does not parse");
+      }
+      tx.txid = have_txid ? tx.txid : parsed.txid;
+      tx.wtxid = have_wtxid ? tx.wtxid : parsed.wtxid;
+      tx.weight = tx.weight != 0 ? tx.weight
+                                 : static_cast<uint32_t>(parsed.getWeight());
+    }
+    mDependRanges.emplace_back(depends_begin, mDepends.size() - depends_begin);
+    mTemplate.transactions.push_back(tx);
+  };
+
+  // Reads the members of the current object; "result" recurses, so a bare
+  // template and a JSON-RPC response are read alike
+  const auto read_members = [&](const auto &self) -> void {
+    JsonToken token;
+    while ((token = reader.next()) == JsonToken::Key) {
+      const std::string_view key = reader.getValue();
+      if (key == "result") {
+        const JsonToken value = reader.next();
+        if (value == JsonToken::BeginObject) {
+          self(self);
+        } else if (value != JsonToken::Null) {
+          fail(reader, "result must be an object");
+        }
+      } else if (key == "error") {
+        const JsonToken value = reader.next();
+        if (value == JsonToken::Null) {
+          continue;
+        }
+        // Report the node's message
+        std::string message = "RPC error";
+        if (value == JsonToken::BeginObject) {
+          JsonToken member;
+          while ((member = reader.next()) == JsonToken::Key) {
+            if (reader.getValue() == "message" &&
+                reader.next() == JsonToken::String) {
+              reader.getString(message);
+            } else if (!reader.skipValue()) {
+              break;
+            }
+          }
+        }
+        throw std::runtime_error("getblocktemplate failed: " + message);
+      } else if (key == "version") {
+        const int64_t version = readInt(reader, "version");
+        mTemplate.header.setVersion(static_cast<uint32_t>(version));
+        seen |= VERSION;
+      } else if (key == "previousblockhash") {
+        mTemplate.header.setPrevBlockHash(
+            readHash(reader, "previousblockhash"));
+        seen |= PREV_HASH;
+      } else if (key == "bits") {
+        uint8_t bits[4];
+        if (reader.next() != JsonToken::String ||
+            reader.getValue().size() != 8 ||
+            !util::DecodeHex(reader.getValue(), bits)) {
+          fail(reader, "bits must be 8 hex digits");
+        }
+        mTemplate.header.setBits(util::ReadBE32(bits));
+        seen |= BITS;
+      } else if (key == "curtime") {
+        mTemplate.header.setTimestamp(readUint32(reader, "curtime"));
+        seen |= CURTIME;
+      } else if (key == "mintime") {
+        mTemplate.minTime = readUint32(reader, "mintime");
+      } else if (key == "height") {
+        mTemplate.height = readUint32(reader, "height");
+        seen |= HEIGHT;
+      } else if (key == "coinbasevalue") {
+        mTemplate.coinbaseValue = readInt(reader, "coinbasevalue");
+        seen |= COINBASE_VALUE;
+      } else if (key == "default_witness_commitment") {
+        mTemplate.defaultWitnessCommitment =
+            read_hex("default_witness_commitment");
+      } else if (key == "transactions") {
+        expect(reader, JsonToken::BeginArray, "transactions must be an array");
+        JsonToken item;
+        while ((item = reader.next()) == JsonToken::BeginObject) {
+          read_transaction();
+        }
+        if (item != JsonToken::EndArray) {
+          fail(reader, "transactions must be an array of objects");
+        }
+        seen |= TRANSACTIONS;
+      } else if (!reader.skipValue()) {
+        fail(reader, "malformed JSON");
+      }
+    }
+    if (token != JsonToken::EndObject) {
+      fail(reader, "malformed JSON");
+    }
+  };
+
+  expect(reader, JsonToken::BeginObject, "expected an object");
+  read_members(read_members);
+  expect(reader, JsonToken::End, "trailing data");
+  if (seen != ALL_FIELDS) {
+    throw std::runtime_error("Block template is missing required fields");
+  }
+
+  for (size_t i = 0; i < mTemplate.transactions.size(); ++i) {
+    mTemplate.transactions[i].depends = std::span<const uint32_t>(
+        mDepends.data() + mDependRanges[i].first, mDependRanges[i].second);
+  }
+  return mTemplate;
+}
@@ -0,0 +1,175 @@
+#include "block/coinbase.h"
+
+// system includes
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+// project includes
+#include "util/compactSize.h"
+#include "util/endian.h"
+
+namespace Block {
+namespace Coinbase_internal {
+
+// Consensus bounds on the coinbase scriptSig
+static constexpr size_t MIN_SCRIPT_SIG = 2;
+static constexpr size_t MAX_SCRIPT_SIG = 100;
+
+// Script opcodes
+static constexpr uint8_t OP_0 = 0x00;
+static constexpr uint8_t OP_1 = 0x51;
+
+static void putLE32(std::vector<uint8_t> &out, uint32_t value) {
+  uint8_t bytes[4];
+  util::WriteLE32(bytes, value);
+  out.insert(out.end(), bytes, bytes + sizeof(bytes));
+}
+
+static void putLE64(std::vector<uint8_t> &out, uint64_t value) {
+  uint8_t bytes[8];
+  util::WriteLE64(bytes, value);
+  out.insert(out.end(), bytes, bytes + sizeof(bytes));
+}
+
+static void putCompactSize(std::vector<uint8_t> &out, uint64_t value) {
+  uint8_t bytes[util::MAX_COMPACT_SIZE_LENGTH];
+  out.insert(out.end(), bytes, bytes + util::WriteCompactSize(bytes, value));
+}
+
+static void checkExtranonce(std::span<const uint8_t> extranonce,
+                            size_t expected) {
+  if (extranonce.size() != expected) {
+    throw std::invalid_argument("Extranonce must be " +
+                                std::to_string(expected) + " bytes");
+  }
+}
+
+} // namespace Coinbase_internal
+} // namespace Block
+
+std::vector<uint8_t> Block::CoinbaseBuilder::encodeHeight(uint32_t height) {
+  using namespace Coinbase_internal;
+
+  // Small heights use the OP_0 and OP_1..OP_16 opcodes
+  if (height == 0) {
+    return {OP_0};
+  }
+  if (height <= 16) {
+    return {static_cast<uint8_t>(OP_1 + height - 1)};
+  }
+
+  // Minimal little-endian script number; a set top bit needs a sign byte
+  std::vector<uint8_t> push(1);
+  for (uint32_t value = height; value != 0; value >>= 8) {
+    push.push_back(static_cast<uint8_t>(value));
+  }
+  if (push.back() & 0x80) {
+    push.push_back(0x00);
+  }
+  push[0] = static_cast<uint8_t>(push.size() - 1);
+  return push;
+}
+
+Block::CoinbaseBuilder::CoinbaseBuilder(const CoinbaseParams &params,
+                                        const WitnessCommitment *commitment)
+    : mBytes(), mExtranonceOffset(0), mExtranonceSize(params.extranonceSize),
+      mMidstate(), mMidstateSize(0), mCommitmentOffset(), mReservedValue() {
+  using namespace Coinbase_internal;
+
+  const std::vector<uint8_t> height = encodeHeight(params.height);
+  const size_t script_size =
+      height.size() + params.tag.size() + params.extranonceSize;
+  if (script_size < MIN_SCRIPT_SIG || script_size > MAX_SCRIPT_SIG) {
+    throw std::invalid_argument("Coinbase scriptSig must be 2 to 100 bytes");
+  }
+
+  // Prefix: version, one null input and the scriptSig up to the extranonce
+  putLE32(mBytes, params.version);
+  putCompactSize(mBytes, 1);
+  mBytes.insert(mBytes.end(), 32, 0x00);
+  putLE32(mBytes, 0xffffffff);
+  putCompactSize(mBytes, script_size);
+  mBytes.insert(mBytes.end(), height.begin(), height.end());
+  mBytes.insert(mBytes.end(), params.tag.begin(), params.tag.end());
+  mExtranonceOffset = mBytes.size();
+  mBytes.insert(mBytes.end(), mExtranonceSize, 0x00);
+
+  // Suffix: sequence, outputs and lock time
+  putLE32(mBytes, params.sequence);
+  putCompactSize(mBytes, params.payouts.size() + (commitment ? 1 : 0));
+  for (const CoinbasePayout &payout : params.payouts) {
+    if (payout.value < 0) {
+      throw std::invalid_argument("Coinbase payouts must not be negative");
+    }
+    putLE64(mBytes, static_cast<uint64_t>(payout.value));
+    putCompactSize(mBytes, payout.script.size());
+    mBytes.insert(mBytes.end(), payout.script.begin(), payout.script.end());
+  }
+  if (commitment) {
+    mCommitmentOffset = mBytes.size() + WitnessCommitment::HASH_OFFSET;
+    mBytes.insert(mBytes.end(), commitment->getOutput().begin(),
+                  commitment->getOutput().end());
+    mReservedValue = commitment->getReservedValue();
+  }
+  putLE32(mBytes, params.lockTime);
+
+  // Hash the whole blocks of the prefix once
+  mMidstateSize = mExtranonceOffset - mExtranonceOffset % 64;
+  SHA256::SHA256::init(mMidstate);
+  SHA256::SHA256::append(mMidstate, mBytes.data(), mMidstateSize);
+}
+
+Hash Block::CoinbaseBuilder::computeTxid(
+    std::span<const uint8_t> extranonce) const {
+  using namespace Coinbase_internal;
+  checkExtranonce(extranonce, mExtranonceSize);
+
+  SHA256::SHA256::Context ctx = mMidstate;
+  SHA256::SHA256::append(ctx, mBytes.data() + mMidstateSize,
+                         mExtranonceOffset - mMidstateSize);
+  SHA256::SHA256::append(ctx, extranonce.data(), extranonce.size());
+  const std::span<const uint8_t> suffix = getSuffix();
+  SHA256::SHA256::append(ctx, suffix.data(), suffix.size());
+
+  Hash first;
+  Hash txid;
+  SHA256::SHA256::finalize_bytes(ctx, first.data());
+  SHA256::SHA256::bytes(first.data(), first.size(), txid.data());
+  return txid;
+}
+
+std::vector<uint8_t>
+Block::CoinbaseBuilder::serialize(std::span<const uint8_t> extranonce,
+                                  bool withWitness) const {
+  using namespace Coinbase_internal;
+  checkExtranonce(extranonce, mExtranonceSize);
+
+  std::vector<uint8_t> tx(mBytes);
+  std::copy(extranonce.begin(), extranonce.end(),
+            tx.begin() + mExtranonceOffset);
+  if (!withWitness || !mCommitmentOffset) {
+    return tx;
+  }
+
+  // Marker and flag after the version; the single input's witness is the
+  // reserved value, before the lock time
+  const uint8_t marker_flag[] = {0x00, 0x01};
+  tx.insert(tx.begin() + 4, marker_flag, marker_flag + 2);
+  std::vector<uint8_t> witness;
+  putCompactSize(witness, 1);
+  putCompactSize(witness, mReservedValue.size());
+  witness.insert(witness.end(), mReservedValue.begin(), mReservedValue.end());
+  tx.insert(tx.end() - 4, witness.begin(), witness.end());
+  return tx;
+}
+
+void Block::CoinbaseBuilder::setWitnessCommitment(
+    const WitnessCommitment &commitment) {
+  if (!mCommitmentOffset) {
+    throw std::invalid_argument("Coinbase was built without a witness "
+                                "commitment");
+  }
+  commitment.swapInto(mBytes, *mCommitmentOffset);
+  mReservedValue = commitment.getReservedValue();
+}
@@ -0,0 +1,138 @@
+#include "block/difficulty.h"
+
+// system includes
+#include <algorithm>
+#include <cmath>
+#include <stdexcept>
+
+// project includes
+#include "block/packedHeader.h"
+#include "util/endian.h"
+
+uint32_t Block::calculateNextWorkRequired(uint32_t lastBits,
+                                          int64_t firstBlockTime,
+                                          int64_t lastBlockTime,
+                                          const ConsensusParams &params) {
+  if (params.noRetargeting) {
+    return lastBits;
+  }
+
+  // Limit the adjustment step
+  const int64_t actual_timespan =
+      std::clamp(lastBlockTime - firstBlockTime, params.powTargetTimespan / 4,
+                 params.powTargetTimespan * 4);
+
+  uint256 target;
+  target.SetCompact(lastBits);
+  target *= static_cast<uint32_t>(actual_timespan);
+  target /= static_cast<uint32_t>(params.powTargetTimespan);
+  if (target > params.powLimit) {
+    target = params.powLimit;
+  }
+  return target.GetCompact();
+}
+
+uint256 Block::getShareTarget(double difficulty) {
+  if (!(difficulty > 0)) {
+    throw std::invalid_argument("Share difficulty must be positive");
+  }
+  // 0xffff * 2^208 / difficulty = mantissa * 2^(shift), mantissa < 2^53
+  const double quotient = 65535.0 / difficulty;
+  if (std::isinf(quotient)) {
+    return ~uint256();
+  }
+  int exponent = 0;
+  const double fraction = std::frexp(quotient, &exponent);
+  const uint64_t mantissa = static_cast<uint64_t>(std::ldexp(fraction, 53));
+  const int shift = 208 + exponent - 53;
+  if (shift + 53 > 256) {
+    return ~uint256();
+  }
+  if (shift >= 0) {
+    return uint256(mantissa) << static_cast<unsigned int>(shift);
+  }
+  return shift > -64 ? uint256(mantissa >> -shift) : uint256();
+}
+
+Block::CompactTargetCache::CompactTargetCache()
+    : mEntries(), mUsed(), mHits(0), mMisses(0) {}
+
+const Block::CompactTargetCache::Entry &
+Block::CompactTargetCache::lookup(uint32_t bits) {
+  // The mantissa's low bits vary the most between neighbouring targets
+  const size_t slot = (bits ^ (bits >> 24)) % SLOTS;
+  Entry &entry = mEntries[slot];
+  if (mUsed[slot] && entry.bits == bits) {
+    ++mHits;
+    return entry;
+  }
+
+  ++mMisses;
+  bool negative = false;
+  bool overflow = false;
+  entry.bits = bits;
+  entry.target.SetCompact(bits, &negative, &overflow);
+  entry.valid = !negative && !overflow && entry.target != 0;
+  entry.work = entry.valid ? getBlockProof(entry.target) : uint256();
+  mUsed[slot] = true;
+  return entry;
+}
+
+void Block::computeChainWork(std::span<const uint8_t> headers,
+                             const uint256 &baseWork,
+                             std::span<uint256> chainWork,
+                             CompactTargetCache &cache) {
+  const size_t count =
+      std::min(headers.size() / PackedHeader::SIZE, chainWork.size());
+
+  // Consecutive headers almost always share their target, so only look it
+  // up again when the bits change
+  uint256 total = baseWork;
+  uint32_t last_bits = 0;
+  const uint256 *work = nullptr;
+  for (size_t i = 0; i < count; ++i) {
+    const uint32_t bits = util::ReadLE32(
+        headers.data() + i * PackedHeader::SIZE + PackedHeader::BITS_OFFSET);
+    if (work == nullptr || bits != last_bits) {
+      work = &cache.lookup(bits).work;
+      last_bits = bits;
+    }
+    total += *work;
+    chainWork[i] = total;
+  }
+}
+
+size_t Block::findBadTransition(std::span<const uint8_t> headers,
+                                uint64_t firstHeight,
+                                const ConsensusParams &params) {
+  const size_t count = headers.size() / PackedHeader::SIZE;
+  const uint64_t interval =
+      static_cast<uint64_t>(params.getAdjustmentInterval());
+  const auto field = [&headers](size_t index, size_t offset) {
+    return util::ReadLE32(headers.data() + index * PackedHeader::SIZE + offset);
+  };
+
+  for (size_t i = 1; i < count; ++i) {
+    const uint32_t bits = field(i, PackedHeader::BITS_OFFSET);
+    const uint32_t prev_bits = field(i - 1, PackedHeader::BITS_OFFSET);
+
+    if (params.noRetargeting || (firstHeight + i) % interval != 0) {
+      if (bits != prev_bits) {
+        return i;
+      }
+      continue;
+    }
+
+    // Retarget boundary: the window runs from i - interval to i - 1
+    if (i < interval) {
+      continue;
+    }
+    const uint32_t expected = calculateNextWorkRequired(
+        prev_bits, field(i - interval, PackedHeader::TIMESTAMP_OFFSET),
+        field(i - 1, PackedHeader::TIMESTAMP_OFFSET), params);
+    if (bits != expected) {
+      return i;
+    }
+  }
+  return count;
+}
@@ -0,0 +1,151 @@
+#include "block/headerChain.h"
+
+// system includes
+#include <algorithm>
+#include <atomic>
+#include <cstring>
+#include <thread>
+#include <vector>
+
+// project includes
+#include "block/packedHeader.h"
+#include "sha256/sha256.h"
+#include "types/uint256.h"
+#include "util/endian.h"
+
+namespace Block {
+namespace HeaderChain_internal {
+
+static_assert(sizeof(Hash) == SHA256::SHA256_BYTES_SIZE,
+              "Hash arrays must be contiguous digests");
+
+struct Failure {
+  size_t index;
+  ChainError error;
+};
+
+// Lower the shared first-failure index so later ranges can stop early
+static void recordFailure(std::atomic<size_t> &firstFailure, size_t index) {
+  size_t current = firstFailure.load(std::memory_order_relaxed);
+  while (index < current && !firstFailure.compare_exchange_weak(
+                                current, index, std::memory_order_relaxed)) {
+  }
+}
+
+// Validate headers [begin, end); expected is the hash header begin must
+// link to
+static Failure validateRange(const uint8_t *data, size_t begin, size_t end,
+                             Hash expected, std::atomic<size_t> &firstFailure,
+                             Hash &lastHash) {
+  std::vector<Hash> hashes(HeaderChainValidator::BATCH_SIZE);
+
+  for (size_t batch = begin; batch < end;
+       batch += HeaderChainValidator::BATCH_SIZE) {
+    if (firstFailure.load(std::memory_order_relaxed) < batch) {
+      break; // An earlier header already failed
+    }
+
+    const size_t count =
+        std::min(HeaderChainValidator::BATCH_SIZE, end - batch);
+    SHA256::SHA256::double_bytes_80(data + batch * PackedHeader::SIZE, count,
+                                    hashes.data());
+
+    for (size_t j = 0; j < count; ++j) {
+      const uint8_t *header = data + (batch + j) * PackedHeader::SIZE;
+
+      if (std::memcmp(header + PackedHeader::PREV_BLOCK_HASH_OFFSET,
+                      expected.data(), expected.size()) != 0) {
+        recordFailure(firstFailure, batch + j);
+        return {batch + j, ChainError::BrokenLinkage};
+      }
+
+      bool negative = false;
+      bool overflow = false;
+      uint256 target;
+      target.SetCompact(util::ReadLE32(header + PackedHeader::BITS_OFFSET),
+                        &negative, &overflow);
+      if (negative || overflow || target == 0) {
+        recordFailure(firstFailure, batch + j);
+        return {batch + j, ChainError::InvalidBits};
+      }
+
+      if (!MeetsTarget(hashes[j], target)) {
+        recordFailure(firstFailure, batch + j);
+        return {batch + j, ChainError::HighHash};
+      }
+
+      expected = hashes[j];
+    }
+  }
+
+  lastHash = expected;
+  return {end, ChainError::None};
+}
+
+} // namespace HeaderChain_internal
+} // namespace Block
+
+Block::HeaderChainValidator::HeaderChainValidator(unsigned int threads)
+    : mThreads(threads == 0 ? std::max(1u, std::thread::hardware_concurrency())
+                            : threads) {}
+
+Block::ChainValidation
+Block::HeaderChainValidator::validate(std::span<const uint8_t> headers,
+                                      const Hash &prevHash) const {
+  using namespace HeaderChain_internal;
+
+  const uint8_t *data = headers.data();
+  const size_t count = headers.size() / PackedHeader::SIZE;
+
+  // No more threads than batches
+  const size_t batches = (count + BATCH_SIZE - 1) / BATCH_SIZE;
+  const size_t threads =
+      std::max<size_t>(1, std::min<size_t>(mThreads, batches));
+
+  std::atomic<size_t> first_failure(count);
+  std::vector<Failure> failures(threads, Failure{count, ChainError::None});
+  std::vector<Hash> last_hashes(threads);
+
+  const auto work = [&](size_t t) {
+    const size_t begin = count * t / threads;
+    const size_t end = count * (t + 1) / threads;
+    if (begin == end) {
+      failures[t] = {end, ChainError::None};
+      return;
+    }
+    // Each range links to the header just before it
+    Hash expected = prevHash;
+    if (begin > 0) {
+      SHA256::SHA256::double_bytes_80(
+          data + (begin - 1) * PackedHeader::SIZE, 1, expected.data());
+    }
+    failures[t] = validateRange(data, begin, end, expected, first_failure,
+                                last_hashes[t]);
+  };
+
+  std::vector<std::thread> pool;
+  for (size_t t = 1; t < threads; ++t) {
+    pool.emplace_back(work, t);
+  }
+  work(0);
+  for (auto &thread : pool) {
+    thread.join();
+  }
+
+  ChainValidation result;
+  for (const Failure &failure : failures) {
+    if (failure.error != ChainError::None) {
+      result.error = failure.error;
+      result.firstFailure = failure.index;
+      return result; // Ranges are ordered, the first failure is the lowest
+    }
+  }
+
+  result.firstFailure = count;
+  if (headers.size() % PackedHeader::SIZE != 0) {
+    result.error = ChainError::Truncated;
+    return result;
+  }
+  result.tipHash = count == 0 ? prevHash : last_hashes[threads - 1];
+  return result;
+}
@@ -0,0 +1,234 @@
+#include "block/headerStore.h"
+
+// system includes
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+// project includes
+#include "block/difficulty.h"
+#include "sha256/sha256.h"
+#include "util/endian.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define HFM_HEADER_STORE_MMAP 1
+#endif
+
+Block::HeaderStore::HeaderStore(const std::string &path)
+    : mPath(path), mFd(-1), mMapping(nullptr), mMappedSize(0), mCount(0),
+      mCapacity(0) {
+#ifdef HFM_HEADER_STORE_MMAP
+  mFd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (mFd < 0) {
+    throw std::system_error(errno, std::generic_category(),
+                            "Cannot open header store " + path);
+  }
+
+  struct stat info;
+  if (::fstat(mFd, &info) != 0) {
+    const int error = errno;
+    ::close(mFd);
+    throw std::system_error(error, std::generic_category(),
+                            "Cannot stat header store " + path);
+  }
+
+  if (info.st_size == 0) {
+    // New store
+    if (::ftruncate(mFd, static_cast<off_t>(fileSize(CAPACITY_STEP))) != 0) {
+      const int error = errno;
+      ::close(mFd);
+      throw std::system_error(error, std::generic_category(),
+                              "Cannot size header store " + path);
+    }
+    map(fileSize(CAPACITY_STEP));
+    mCapacity = CAPACITY_STEP;
+    header()->magic = MAGIC;
+    header()->format = FORMAT;
+    header()->columnsValid = 1;
+    header()->count = 0;
+    header()->capacity = mCapacity;
+    return;
+  }
+
+  const size_t size = static_cast<size_t>(info.st_size);
+  if (size < sizeof(FileHeader)) {
+    ::close(mFd);
+    throw std::runtime_error("Not a header store: " + path);
+  }
+  map(size);
+
+  const FileHeader *file_header = header();
+  if (file_header->magic != MAGIC || file_header->format != FORMAT ||
+      file_header->capacity % CAPACITY_STEP != 0 ||
+      file_header->count > file_header->capacity ||
+      fileSize(file_header->capacity) > size) {
+    ::munmap(mMapping, mMappedSize);
+    ::close(mFd);
+    throw std::runtime_error("Not a header store, or written on a host with "
+                             "another byte order: " +
+                             path);
+  }
+  mCount = file_header->count;
+  mCapacity = file_header->capacity;
+
+  // Interrupted while growing: the records are intact, the columns are not
+  if (file_header->columnsValid == 0) {
+    rebuildColumns();
+  }
+#else
+  throw std::system_error(std::make_error_code(std::errc::not_supported),
+                          "Memory-mapped header stores are not supported");
+#endif
+}
+
+Block::HeaderStore::~HeaderStore() {
+#ifdef HFM_HEADER_STORE_MMAP
+  sync();
+  ::munmap(mMapping, mMappedSize);
+  ::close(mFd);
+#endif
+}
+
+size_t Block::HeaderStore::bitsOffset(size_t capacity) {
+  return sizeof(FileHeader) + capacity * PackedHeader::SIZE;
+}
+
+size_t Block::HeaderStore::timestampOffset(size_t capacity) {
+  return bitsOffset(capacity) + capacity * sizeof(uint32_t);
+}
+
+size_t Block::HeaderStore::hashOffset(size_t capacity) {
+  return timestampOffset(capacity) + capacity * sizeof(uint32_t);
+}
+
+size_t Block::HeaderStore::workOffset(size_t capacity) {
+  return hashOffset(capacity) + capacity * sizeof(Hash);
+}
+
+size_t Block::HeaderStore::fileSize(size_t capacity) {
+  return workOffset(capacity) + capacity * sizeof(Hash);
+}
+
+void Block::HeaderStore::map(size_t size) {
+#ifdef HFM_HEADER_STORE_MMAP
+  void *mapping =
+      ::mmap(nullptr, size, PROT_READ | PROT_WRITE, MAP_SHARED, mFd, 0);
+  if (mapping == MAP_FAILED) {
+    const int error = errno;
+    ::close(mFd);
+    throw std::system_error(error, std::generic_category(),
+                            "Cannot map header store " + mPath);
+  }
+  mMapping = mapping;
+  mMappedSize = size;
+#else
+  (void)size;
+#endif
+}
+
+void Block::HeaderStore::reserve(size_t headers) {
+#ifdef HFM_HEADER_STORE_MMAP
+  if (headers <= mCapacity) {
+    return;
+  }
+  size_t capacity = mCapacity;
+  while (capacity < headers) {
+    capacity *= 2;
+  }
+
+  // Mark the columns stale while they move
+  header()->columnsValid = 0;
+  ::msync(mMapping, sizeof(FileHeader), MS_SYNC);
+
+  ::munmap(mMapping, mMappedSize);
+  mMapping = nullptr;
+  if (::ftruncate(mFd, static_cast<off_t>(fileSize(capacity))) != 0) {
+    const int error = errno;
+    map(mMappedSize);
+    throw std::system_error(error, std::generic_category(),
+                            "Cannot grow header store " + mPath);
+  }
+  map(fileSize(capacity));
+
+  // Every section moves up, so move the last one first
+  const size_t old_capacity = mCapacity;
+  std::memmove(base() + workOffset(capacity), base() + workOffset(old_capacity),
+               mCount * sizeof(Hash));
+  std::memmove(base() + hashOffset(capacity), base() + hashOffset(old_capacity),
+               mCount * sizeof(Hash));
+  std::memmove(base() + timestampOffset(capacity),
+               base() + timestampOffset(old_capacity),
+               mCount * sizeof(uint32_t));
+  std::memmove(base() + bitsOffset(capacity), base() + bitsOffset(old_capacity),
+               mCount * sizeof(uint32_t));
+
+  mCapacity = capacity;
+  header()->capacity = capacity;
+  ::msync(mMapping, mMappedSize, MS_SYNC);
+  header()->columnsValid = 1;
+#else
+  (void)headers;
+#endif
+}
+
+void Block::HeaderStore::fillColumns(size_t begin, size_t end) {
+  if (begin >= end) {
+    return;
+  }
+  uint32_t *bits = bitsColumn();
+  uint32_t *timestamps = timestampColumn();
+  for (size_t i = begin; i < end; ++i) {
+    const uint8_t *record = records() + i * PackedHeader::SIZE;
+    bits[i] = util::ReadLE32(record + PackedHeader::BITS_OFFSET);
+    timestamps[i] = util::ReadLE32(record + PackedHeader::TIMESTAMP_OFFSET);
+  }
+
+  SHA256::SHA256::double_bytes_80(records() + begin * PackedHeader::SIZE,
+                                  end - begin, hashColumn() + begin);
+
+  // Chainwork continues from the header before the range
+  CompactTargetCache cache;
+  Hash *work = workColumn();
+  uint256 total = begin == 0 ? uint256() : uint256(work[begin - 1]);
+  for (size_t i = begin; i < end; ++i) {
+    total += cache.lookup(bits[i]).work;
+    work[i] = total.ToHash();
+  }
+}
+
+void Block::HeaderStore::append(std::span<const uint8_t> headers) {
+  if (headers.size() % PackedHeader::SIZE != 0) {
+    throw std::invalid_argument(
+        "Header store appends must be whole 80-byte records");
+  }
+  const size_t added = headers.size() / PackedHeader::SIZE;
+  if (added == 0) {
+    return;
+  }
+  reserve(mCount + added);
+
+  std::memcpy(records() + mCount * PackedHeader::SIZE, headers.data(),
+              headers.size());
+  fillColumns(mCount, mCount + added);
+
+  // Commit: the new headers become visible on reopen only now
+  mCount += added;
+  header()->count = mCount;
+}
+
+void Block::HeaderStore::rebuildColumns() {
+  header()->columnsValid = 0;
+  fillColumns(0, mCount);
+  header()->columnsValid = 1;
+}
+
+void Block::HeaderStore::sync() {
+#ifdef HFM_HEADER_STORE_MMAP
+  ::msync(mMapping, mMappedSize, MS_SYNC);
+#endif
+}
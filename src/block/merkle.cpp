@@ -0,0 +1,281 @@
+#include "block/merkle.h"
+
+// system includes
+#include <algorithm>
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+#include <utility>
+#include <vector>
+
+// project includes
+#include "sha256/sha256.h"
+
+namespace Block {
+namespace Merkle_internal {
+
+static_assert(sizeof(Hash) == SHA256::SHA256_BYTES_SIZE,
+              "Hash arrays must be contiguous digests");
+
+// Messages gathered per batch kernel call
+static constexpr size_t HASH_BATCH = 256;
+
+// A node at the odd end of a level is paired with itself
+static void hashDuplicate(const Hash &in, Hash &out) {
+  uint8_t pair[2 * sizeof(Hash)];
+  std::memcpy(pair, in.data(), sizeof(Hash));
+  std::memcpy(pair + sizeof(Hash), in.data(), sizeof(Hash));
+  Hash first;
+  SHA256::SHA256::bytes(pair, sizeof(pair), first.data());
+  SHA256::SHA256::bytes(first.data(), first.size(), out.data());
+}
+
+// Hash one level of n hashes into (n + 1) / 2 parents
+static void hashLevel(const Hash *in, size_t n, Hash *out) {
+  const void *src[HASH_BATCH] = {};
+  size_t n_bytes[HASH_BATCH] = {};
+  void *dst[HASH_BATCH] = {};
+  std::fill_n(n_bytes, HASH_BATCH, 2 * sizeof(Hash));
+
+  const size_t pairs = n / 2;
+  for (size_t begin = 0; begin < pairs; begin += HASH_BATCH) {
+    const size_t count = std::min(HASH_BATCH, pairs - begin);
+    for (size_t i = 0; i < count; ++i) {
+      src[i] = in + 2 * (begin + i);
+      dst[i] = out + begin + i;
+    }
+    SHA256::SHA256::double_bytes_many(src, n_bytes, count, dst);
+  }
+
+  if (n % 2 == 1) {
+    hashDuplicate(in[n - 1], out[pairs]);
+  }
+}
+
+// Hash the given parents (ascending) of a level of n hashes
+static void hashParents(const Hash *in, size_t n, const size_t *parents,
+                        size_t count, Hash *out) {
+  const void *src[HASH_BATCH] = {};
+  size_t n_bytes[HASH_BATCH] = {};
+  void *dst[HASH_BATCH] = {};
+  std::fill_n(n_bytes, HASH_BATCH, 2 * sizeof(Hash));
+
+  // Only the last parent can have a single child
+  const bool odd_end = count > 0 && 2 * parents[count - 1] + 1 == n;
+  const size_t pairs = odd_end ? count - 1 : count;
+  for (size_t begin = 0; begin < pairs; begin += HASH_BATCH) {
+    const size_t batch = std::min(HASH_BATCH, pairs - begin);
+    for (size_t i = 0; i < batch; ++i) {
+      src[i] = in + 2 * parents[begin + i];
+      dst[i] = out + parents[begin + i];
+    }
+    SHA256::SHA256::double_bytes_many(src, n_bytes, batch, dst);
+  }
+  if (odd_end) {
+    hashDuplicate(in[n - 1], out[parents[count - 1]]);
+  }
+}
+
+static void checkIndex(size_t index, size_t size) {
+  if (index >= size) {
+    throw std::out_of_range("Merkle leaf " + std::to_string(index) +
+                            " out of range for " + std::to_string(size) +
+                            " leaves");
+  }
+}
+
+} // namespace Merkle_internal
+} // namespace Block
+
+Hash Block::computeMerkleRoot(std::span<const Hash> leaves) {
+  using namespace Merkle_internal;
+
+  if (leaves.empty()) {
+    return Hash{};
+  }
+  if (leaves.size() == 1) {
+    return leaves[0];
+  }
+
+  // Levels alternate between two buffers
+  std::vector<Hash> front((leaves.size() + 1) / 2);
+  std::vector<Hash> back((front.size() + 1) / 2);
+  hashLevel(leaves.data(), leaves.size(), front.data());
+  size_t n = front.size();
+  while (n > 1) {
+    hashLevel(front.data(), n, back.data());
+    n = (n + 1) / 2;
+    std::swap(front, back);
+  }
+  return front[0];
+}
+
+Block::MerkleTree::MerkleTree()
+    : mNodes(), mLevelOffset(), mSize(0), mCapacity(0), mDirty(), mParents(),
+      mAllDirty(false), mRoot(), mHashCount(0) {}
+
+Block::MerkleTree::MerkleTree(std::span<const Hash> leaves) : MerkleTree() {
+  assign(leaves);
+}
+
+void Block::MerkleTree::reserve(size_t capacity) {
+  capacity = std::bit_ceil(std::max<size_t>(capacity, 1));
+  if (capacity <= mCapacity) {
+    return;
+  }
+  std::vector<Hash> nodes(2 * capacity - 1);
+  std::vector<size_t> offsets;
+  for (size_t offset = 0, width = capacity; width > 0; width /= 2) {
+    offsets.push_back(offset);
+    offset += width;
+  }
+  // Levels stay as computed; the dirty leaves are still recorded
+  for (size_t level = 0; mSize > 0 && level < mLevelOffset.size(); ++level) {
+    std::copy_n(mNodes.begin() + mLevelOffset[level], levelSize(level),
+                nodes.begin() + offsets[level]);
+  }
+  mNodes = std::move(nodes);
+  mLevelOffset = std::move(offsets);
+  mCapacity = capacity;
+}
+
+void Block::MerkleTree::markDirty(size_t index) {
+  if (!mAllDirty) {
+    mDirty.push_back(index);
+  }
+}
+
+void Block::MerkleTree::assign(std::span<const Hash> leaves) {
+  reserve(leaves.size());
+  std::copy(leaves.begin(), leaves.end(), mNodes.begin());
+  mSize = leaves.size();
+  mDirty.clear();
+  mAllDirty = true;
+}
+
+void Block::MerkleTree::set(size_t index, const Hash &leaf) {
+  using namespace Merkle_internal;
+
+  checkIndex(index, mSize);
+  mNodes[index] = leaf;
+  markDirty(index);
+}
+
+void Block::MerkleTree::swap(size_t a, size_t b) {
+  using namespace Merkle_internal;
+
+  checkIndex(a, mSize);
+  checkIndex(b, mSize);
+  std::swap(mNodes[a], mNodes[b]);
+  markDirty(a);
+  markDirty(b);
+}
+
+void Block::MerkleTree::push_back(const Hash &leaf) {
+  reserve(mSize + 1);
+  mNodes[mSize] = leaf;
+  markDirty(mSize++);
+}
+
+void Block::MerkleTree::pop_back() {
+  using namespace Merkle_internal;
+
+  checkIndex(0, mSize);
+  --mSize;
+  // The new last leaf loses its sibling
+  if (mSize > 0) {
+    markDirty(mSize - 1);
+  }
+}
+
+void Block::MerkleTree::insert(size_t index, const Hash &leaf) {
+  using namespace Merkle_internal;
+
+  checkIndex(index, mSize + 1);
+  reserve(mSize + 1);
+  std::copy_backward(mNodes.begin() + index, mNodes.begin() + mSize,
+                     mNodes.begin() + mSize + 1);
+  mNodes[index] = leaf;
+  ++mSize;
+  for (size_t i = index; i < mSize && !mAllDirty; ++i) {
+    markDirty(i);
+  }
+}
+
+void Block::MerkleTree::erase(size_t index) {
+  using namespace Merkle_internal;
+
+  checkIndex(index, mSize);
+  std::copy(mNodes.begin() + index + 1, mNodes.begin() + mSize,
+            mNodes.begin() + index);
+  --mSize;
+  for (size_t i = index > 0 && index == mSize ? index - 1 : index;
+       i < mSize && !mAllDirty; ++i) {
+    markDirty(i);
+  }
+}
+
+void Block::MerkleTree::update() {
+  using namespace Merkle_internal;
+
+  mHashCount = 0;
+  if (mSize <= 1) {
+    mRoot = mSize == 1 ? mNodes[0] : Hash{};
+    mDirty.clear();
+    mAllDirty = false;
+    return;
+  }
+  if (!mAllDirty && mDirty.empty()) {
+    return;
+  }
+
+  // Leaves dropped since they were marked are no longer on any path
+  std::sort(mDirty.begin(), mDirty.end());
+  mDirty.erase(std::unique(mDirty.begin(), mDirty.end()), mDirty.end());
+  mDirty.erase(std::lower_bound(mDirty.begin(), mDirty.end(), mSize),
+               mDirty.end());
+
+  size_t level = 0;
+  for (; levelSize(level) > 1; ++level) {
+    const size_t n = levelSize(level);
+    const Hash *in = mNodes.data() + mLevelOffset[level];
+    Hash *out = mNodes.data() + mLevelOffset[level + 1];
+    if (mAllDirty) {
+      hashLevel(in, n, out);
+      mHashCount += (n + 1) / 2;
+      continue;
+    }
+    mParents.clear();
+    for (const size_t index : mDirty) {
+      if (mParents.empty() || mParents.back() != index / 2) {
+        mParents.push_back(index / 2);
+      }
+    }
+    hashParents(in, n, mParents.data(), mParents.size(), out);
+    mHashCount += mParents.size();
+    std::swap(mDirty, mParents);
+  }
+  mRoot = mNodes[mLevelOffset[level]];
+  mDirty.clear();
+  mAllDirty = false;
+}
+
+const Hash &Block::MerkleTree::getRoot() {
+  update();
+  return mRoot;
+}
+
+std::vector<Hash> Block::MerkleTree::getBranch(size_t index) {
+  using namespace Merkle_internal;
+
+  checkIndex(index, mSize);
+  update();
+  std::vector<Hash> branch;
+  for (size_t level = 0; levelSize(level) > 1; ++level, index /= 2) {
+    const size_t sibling =
+        (index ^ 1) < levelSize(level) ? (index ^ 1) : index;
+    branch.push_back(mNodes[mLevelOffset[level] + sibling]);
+  }
+  return branch;
+}
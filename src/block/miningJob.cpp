@@ -0,0 +1,94 @@
+#include "block/miningJob.h"
+
+// system includes
+#include <algorithm>
+#include <stdexcept>
+#include <string>
+
+namespace Block {
+namespace MiningJob_internal {
+
+static void checkExtranonce2(std::span<const uint8_t> extranonce2,
+                             size_t size) {
+  if (extranonce2.size() != size) {
+    throw std::invalid_argument("Extranonce2 must be " + std::to_string(size) +
+                                " bytes");
+  }
+}
+
+} // namespace MiningJob_internal
+} // namespace Block
+
+Block::MiningJob::MiningJob()
+    : mMidstate(), mPrefixTail(), mExtranonce2Size(0), mSuffix(), mBranch(),
+      mHeader() {
+  SHA256::SHA256::init(mMidstate);
+}
+
+void Block::MiningJob::set(std::span<const uint8_t> coinbase1,
+                           std::span<const uint8_t> extranonce1,
+                           size_t extranonce2Size,
+                           std::span<const uint8_t> coinbase2,
+                           std::span<const Hash> merkleBranch,
+                           const PackedHeader &header) {
+  // Hash the whole blocks of coinb1 + extranonce1, keep the rest
+  const size_t prefix_size = coinbase1.size() + extranonce1.size();
+  const size_t midstate_size = prefix_size - prefix_size % 64;
+  const size_t from_coinbase1 = std::min(midstate_size, coinbase1.size());
+  SHA256::SHA256::init(mMidstate);
+  SHA256::SHA256::append(mMidstate, coinbase1.data(), from_coinbase1);
+  SHA256::SHA256::append(mMidstate, extranonce1.data(),
+                         midstate_size - from_coinbase1);
+
+  mPrefixTail.assign(coinbase1.begin() + from_coinbase1, coinbase1.end());
+  mPrefixTail.insert(mPrefixTail.end(),
+                     extranonce1.begin() + (midstate_size - from_coinbase1),
+                     extranonce1.end());
+  mExtranonce2Size = extranonce2Size;
+  mSuffix.assign(coinbase2.begin(), coinbase2.end());
+  mBranch.assign(merkleBranch.begin(), merkleBranch.end());
+  mHeader = header;
+  mHeader.setMerkleRoot(Hash{});
+  mHeader.setNonce(0);
+}
+
+Hash Block::MiningJob::computeCoinbaseTxid(
+    std::span<const uint8_t> extranonce2) const {
+  using namespace MiningJob_internal;
+  checkExtranonce2(extranonce2, mExtranonce2Size);
+
+  SHA256::SHA256::Context ctx = mMidstate;
+  SHA256::SHA256::append(ctx, mPrefixTail.data(), mPrefixTail.size());
+  SHA256::SHA256::append(ctx, extranonce2.data(), extranonce2.size());
+  SHA256::SHA256::append(ctx, mSuffix.data(), mSuffix.size());
+
+  Hash first;
+  Hash txid;
+  SHA256::SHA256::finalize_bytes(ctx, first.data());
+  SHA256::SHA256::bytes(first.data(), first.size(), txid.data());
+  return txid;
+}
+
+Hash Block::MiningJob::computeMerkleRoot(
+    std::span<const uint8_t> extranonce2) const {
+  // The coinbase is the leftmost leaf, so it is always the left half
+  uint8_t pair[64];
+  const Hash txid = computeCoinbaseTxid(extranonce2);
+  std::copy(txid.begin(), txid.end(), pair);
+  Hash first;
+  for (const Hash &hash : mBranch) {
+    std::copy(hash.begin(), hash.end(), pair + 32);
+    SHA256::SHA256::bytes(pair, sizeof(pair), first.data());
+    SHA256::SHA256::bytes(first.data(), first.size(), pair);
+  }
+  Hash root;
+  std::copy(pair, pair + 32, root.begin());
+  return root;
+}
+
+Block::PackedHeader
+Block::MiningJob::makeHeader(std::span<const uint8_t> extranonce2) const {
+  PackedHeader header = mHeader;
+  header.setMerkleRoot(computeMerkleRoot(extranonce2));
+  return header;
+}
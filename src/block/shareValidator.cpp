@@ -0,0 +1,333 @@
+#include "block/shareValidator.h"
+
+// system includes
+#include <algorithm>
+#include <cstring>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+
+// project includes
+#include "block/difficulty.h"
+#include "sha256/sha256.h"
+#include "util/endian.h"
+
+namespace Block {
+namespace ShareValidator_internal {
+
+// Marks a worker root that no share of the batch computes
+static constexpr uint32_t NO_FOLD = ~uint32_t{0};
+
+// A retarget moves the difficulty at least this much, at most 4x
+static constexpr double MIN_STEP = 1.5;
+static constexpr double MAX_STEP = 4.0;
+
+// Pack an extranonce2 of up to 8 bytes into a cache key
+static inline uint64_t packExtranonce2(const std::array<uint8_t, 8> &bytes,
+                                       size_t size) {
+  uint64_t key = 0;
+  for (size_t i = 0; i < size; ++i) {
+    key |= uint64_t{bytes[i]} << (8 * i);
+  }
+  return key;
+}
+
+} // namespace ShareValidator_internal
+} // namespace Block
+
+Block::Worker::Worker(std::span<const uint8_t> extranonce1,
+                      const VarDiffConfig &config,
+                      std::chrono::steady_clock::time_point now)
+    : mConfig(config), mExtranonce1(), mExtranonce1Size(extranonce1.size()),
+      mDifficulty(0), mTarget(), mPreviousDifficulty(0), mPreviousTarget(),
+      mChangeJob(0), mChanged(false), mWindowStart(now), mWindowShares(0),
+      mAccepted(0), mAcceptedWork(0), mRootValid(false),
+      mRootPending(ShareValidator_internal::NO_FOLD), mRootJob(0),
+      mRootExtranonce2(0), mRoot() {
+  if (extranonce1.size() > MAX_EXTRANONCE1_SIZE) {
+    throw std::invalid_argument("Extranonce1 must be at most " +
+                                std::to_string(MAX_EXTRANONCE1_SIZE) +
+                                " bytes");
+  }
+  std::copy(extranonce1.begin(), extranonce1.end(), mExtranonce1.begin());
+  mDifficulty = std::clamp(config.initialDifficulty, config.minDifficulty,
+                           config.maxDifficulty);
+  mTarget = getShareTarget(mDifficulty);
+  mPreviousDifficulty = mDifficulty;
+  mPreviousTarget = mTarget;
+}
+
+void Block::Worker::setDifficulty(double difficulty, uint32_t nextJob) {
+  difficulty =
+      std::clamp(difficulty, mConfig.minDifficulty, mConfig.maxDifficulty);
+  if (difficulty == mDifficulty) {
+    return;
+  }
+  mPreviousDifficulty = mDifficulty;
+  mPreviousTarget = mTarget;
+  mDifficulty = difficulty;
+  mTarget = getShareTarget(difficulty);
+  mChangeJob = nextJob;
+  mChanged = true;
+}
+
+bool Block::Worker::takeDifficultyChange() {
+  const bool changed = mChanged;
+  mChanged = false;
+  return changed;
+}
+
+void Block::Worker::credit(double difficulty, uint32_t nextJob,
+                           std::chrono::steady_clock::time_point now) {
+  using namespace ShareValidator_internal;
+
+  ++mAccepted;
+  mAcceptedWork += difficulty;
+  ++mWindowShares;
+
+  const auto elapsed = now - mWindowStart;
+  if (elapsed < mConfig.retargetInterval &&
+      mWindowShares < mConfig.retargetShares) {
+    return;
+  }
+  // Scale by the ratio of the share rate to the one aimed for
+  double factor = MAX_STEP;
+  if (elapsed.count() > 0) {
+    const double seconds = std::chrono::duration<double>(elapsed).count();
+    const double interval =
+        std::chrono::duration<double>(mConfig.shareInterval).count();
+    factor = std::clamp(interval * mWindowShares / seconds, 1 / MAX_STEP,
+                        MAX_STEP);
+  }
+  if (factor >= MIN_STEP || factor <= 1 / MIN_STEP) {
+    setDifficulty(mDifficulty * factor, nextJob);
+  }
+  mWindowStart = now;
+  mWindowShares = 0;
+}
+
+Block::ShareValidator::ShareValidator(const ValidatorConfig &config)
+    : mConfig(config), mMutex(), mJobs(), mNextJob(0), mFirstValidJob(0),
+      mSeen(config.maxShares) {
+  if (config.extranonce1Size > Worker::MAX_EXTRANONCE1_SIZE ||
+      config.extranonce2Size > 8) {
+    throw std::invalid_argument("Extranonce parts must be at most 8 bytes");
+  }
+  if (config.maxJobs == 0) {
+    throw std::invalid_argument("A share validator needs room for a job");
+  }
+  mJobs.resize(config.maxJobs);
+}
+
+uint32_t Block::ShareValidator::addJob(std::span<const uint8_t> coinbase1,
+                                       std::span<const uint8_t> coinbase2,
+                                       std::span<const Hash> merkleBranch,
+                                       const PackedHeader &header,
+                                       uint32_t versionMask) {
+  std::unique_lock lock(mMutex);
+  const uint32_t id = mNextJob++;
+  Job &job = mJobs[id % mJobs.size()];
+  job.id = id;
+  job.valid = true;
+  job.mining.set(coinbase1, {},
+                 mConfig.extranonce1Size + mConfig.extranonce2Size, coinbase2,
+                 merkleBranch, header);
+  job.versionMask = versionMask;
+  bool negative = false;
+  bool overflow = false;
+  job.networkTarget.SetCompact(header.getBits(), &negative, &overflow);
+  if (negative || overflow) {
+    job.networkTarget = uint256();
+  }
+  return id;
+}
+
+void Block::ShareValidator::newBlock() {
+  std::unique_lock lock(mMutex);
+  mFirstValidJob = mNextJob;
+  mSeen.clear();
+}
+
+uint32_t Block::ShareValidator::getNextJobId() const {
+  std::shared_lock lock(mMutex);
+  return mNextJob;
+}
+
+Block::ShareBatch::ShareBatch(size_t capacity)
+    : mCapacity(capacity), mShares(), mResults(), mJobs(), mRootFrom(),
+      mLive(), mHeaders(), mHashes(), mFold(), mPairs(), mFolded(),
+      mSources(), mSizes(), mDestinations() {
+  mShares.reserve(capacity);
+}
+
+size_t Block::ShareBatch::push(const Share &share) {
+  mShares.push_back(share);
+  return mShares.size() - 1;
+}
+
+std::span<const Block::ShareResult>
+Block::ShareBatch::flush(ShareValidator &validator,
+                         std::chrono::steady_clock::time_point now) {
+  using namespace ShareValidator_internal;
+
+  const size_t n = mShares.size();
+  mResults.assign(n, ShareResult());
+  mJobs.assign(n, nullptr);
+  mRootFrom.assign(n, NO_FOLD);
+  mLive.clear();
+  mFold.clear();
+  mFolded.clear();
+
+  std::shared_lock lock(validator.mMutex);
+  const ValidatorConfig &config = validator.mConfig;
+  const uint32_t next_job = validator.mNextJob;
+
+  // Find the jobs, check the fields, look up or start the Merkle roots
+  uint8_t extranonce[16];
+  for (size_t i = 0; i < n; ++i) {
+    const Share &share = mShares[i];
+    Worker &worker = *share.worker;
+    ShareResult &result = mResults[i];
+    const ShareValidator::Job &job =
+        validator.mJobs[share.job % validator.mJobs.size()];
+    if (!job.valid || job.id != share.job ||
+        share.job < validator.mFirstValidJob) {
+      result.status = ShareStatus::UnknownJob;
+      continue;
+    }
+    if (worker.mExtranonce1Size != config.extranonce1Size) {
+      result.status = ShareStatus::BadExtranonce;
+      continue;
+    }
+    const uint32_t job_time = job.mining.getHeader().getTimestamp();
+    if (share.time < job_time || share.time - job_time > config.maxTimeDrift) {
+      result.status = ShareStatus::BadTime;
+      continue;
+    }
+    if ((share.versionBits & ~job.versionMask) != 0) {
+      result.status = ShareStatus::BadVersion;
+      continue;
+    }
+    mJobs[i] = &job;
+
+    const uint64_t key =
+        packExtranonce2(share.extranonce2, config.extranonce2Size);
+    const bool same = worker.mRootJob == share.job &&
+                      worker.mRootExtranonce2 == key;
+    if (same && worker.mRootValid) {
+      continue;
+    }
+    if (same && worker.mRootPending != NO_FOLD) {
+      mRootFrom[i] = worker.mRootPending;
+      continue;
+    }
+    // The coinbase txid starts the fold
+    std::copy_n(worker.mExtranonce1.begin(), config.extranonce1Size,
+                extranonce);
+    std::copy_n(share.extranonce2.begin(), config.extranonce2Size,
+                extranonce + config.extranonce1Size);
+    mRootFrom[i] = static_cast<uint32_t>(mFold.size());
+    mFold.push_back(static_cast<uint32_t>(i));
+    mFolded.push_back(job.mining.computeCoinbaseTxid(
+        std::span<const uint8_t>(extranonce, config.extranonce1Size +
+                                                 config.extranonce2Size)));
+    worker.mRootValid = false;
+    worker.mRootPending = mRootFrom[i];
+    worker.mRootJob = share.job;
+    worker.mRootExtranonce2 = key;
+  }
+
+  // Fold the new roots up their branches, one level across the batch at a
+  // time
+  mPairs.resize(mFold.size() * 64);
+  for (size_t level = 0;; ++level) {
+    mSources.clear();
+    mSizes.clear();
+    mDestinations.clear();
+    for (size_t f = 0; f < mFold.size(); ++f) {
+      const std::span<const Hash> branch =
+          mJobs[mFold[f]]->mining.getMerkleBranch();
+      if (level >= branch.size()) {
+        continue;
+      }
+      uint8_t *pair = mPairs.data() + f * 64;
+      std::copy(mFolded[f].begin(), mFolded[f].end(), pair);
+      std::copy(branch[level].begin(), branch[level].end(), pair + 32);
+      mSources.push_back(pair);
+      mSizes.push_back(64);
+      mDestinations.push_back(mFolded[f].data());
+    }
+    if (mSources.empty()) {
+      break;
+    }
+    SHA256::SHA256::double_bytes_many(mSources.data(), mSizes.data(),
+                                      mSources.size(), mDestinations.data());
+  }
+  for (size_t f = 0; f < mFold.size(); ++f) {
+    Worker &worker = *mShares[mFold[f]].worker;
+    if (worker.mRootPending == f) {
+      worker.mRoot = mFolded[f];
+      worker.mRootValid = true;
+      worker.mRootPending = NO_FOLD;
+    }
+  }
+
+  // Build the headers of the shares still standing, contiguously
+  mHeaders.resize(n * PackedHeader::SIZE);
+  for (size_t i = 0; i < n; ++i) {
+    const ShareValidator::Job *job = mJobs[i];
+    if (job == nullptr) {
+      continue;
+    }
+    const Share &share = mShares[i];
+    const Hash &root = mRootFrom[i] == NO_FOLD ? share.worker->mRoot
+                                               : mFolded[mRootFrom[i]];
+    uint8_t *header = mHeaders.data() + mLive.size() * PackedHeader::SIZE;
+    std::memcpy(header, job->mining.getHeader().data(), PackedHeader::SIZE);
+    const uint32_t version =
+        (job->mining.getHeader().getVersion() & ~job->versionMask) |
+        share.versionBits;
+    util::WriteLE32(header + PackedHeader::VERSION_OFFSET, version);
+    std::copy(root.begin(), root.end(),
+              header + PackedHeader::MERKLE_ROOT_OFFSET);
+    util::WriteLE32(header + PackedHeader::TIMESTAMP_OFFSET, share.time);
+    util::WriteLE32(header + PackedHeader::NONCE_OFFSET, share.nonce);
+    mLive.push_back(static_cast<uint32_t>(i));
+  }
+
+  mHashes.resize(mLive.size());
+  SHA256::SHA256::double_bytes_80(mHeaders.data(), mLive.size(),
+                                  mHashes.data());
+
+  // Judge them
+  for (size_t l = 0; l < mLive.size(); ++l) {
+    const uint32_t i = mLive[l];
+    const Share &share = mShares[i];
+    ShareResult &result = mResults[i];
+    result.hash = mHashes[l];
+
+    double difficulty = 0;
+    const uint256 hash(mHashes[l]);
+    if (hash > share.worker->targetFor(share.job, difficulty)) {
+      result.status = ShareStatus::LowDifficulty;
+      continue;
+    }
+    switch (validator.mSeen.insert(util::ReadLE64(mHashes[l].data()))) {
+    case util::ConcurrentHashSet::Insert::Present:
+      result.status = ShareStatus::Duplicate;
+      continue;
+    case util::ConcurrentHashSet::Insert::Full:
+      result.status = ShareStatus::Overloaded;
+      continue;
+    case util::ConcurrentHashSet::Insert::Inserted:
+      break;
+    }
+    result.status = hash <= mJobs[i]->networkTarget ? ShareStatus::Block
+                                                    : ShareStatus::Accepted;
+    result.difficulty = difficulty;
+    share.worker->credit(difficulty, next_job, now);
+  }
+
+  mShares.clear();
+  return mResults;
+}
@@ -0,0 +1,336 @@
+#include "block/templateBuilder.h"
+
+// system includes
+#include <algorithm>
+#include <array>
+#include <functional>
+#include <limits>
+#include <stdexcept>
+#include <string>
+
+namespace Block {
+namespace TemplateBuilder_internal {
+
+static constexpr int64_t COIN = 100000000;
+
+// Candidates moved into the heap at a time; a block holds a few thousand
+// transactions, so most of a large mempool is never heapified
+static constexpr size_t HEAP_BATCH = 8192;
+
+// Scores sampled to estimate the cut-off of a batch
+static constexpr size_t THRESHOLD_SAMPLES = 256;
+
+} // namespace TemplateBuilder_internal
+} // namespace Block
+
+std::vector<Hash>
+Block::SelectedTemplate::getMerkleLeaves(const Hash &coinbaseTxid) const {
+  std::vector<Hash> leaves;
+  leaves.reserve(txids.size() + 1);
+  leaves.push_back(coinbaseTxid);
+  leaves.insert(leaves.end(), txids.begin(), txids.end());
+  return leaves;
+}
+
+Block::TemplateBuilder::TemplateBuilder(const TemplateLimits &limits)
+    : mLimits(limits), mSelected(), mEntries(), mParentBegin(1, 0),
+      mParents(), mAncestorBegin(1, 0), mAncestors(), mEligible(),
+      mAncestorFee(), mAncestorWeight(), mAncestorSigops(),
+      mChildrenValid(true), mChildBegin(1, 0), mChildren(), mPackageFee(),
+      mPackageWeight(), mPackageSigops(), mState(), mVersion(),
+      mVisited(), mStamp(0), mStack(), mTouched(), mHeap(), mReserve(),
+      mMerged() {}
+
+void Block::TemplateBuilder::clear() {
+  mEntries.clear();
+  mParentBegin.assign(1, 0);
+  mParents.clear();
+  mAncestorBegin.assign(1, 0);
+  mAncestors.clear();
+  mEligible.clear();
+  mAncestorFee.clear();
+  mAncestorWeight.clear();
+  mAncestorSigops.clear();
+  mChildrenValid = false;
+}
+
+uint32_t Block::TemplateBuilder::addTransaction(
+    const MempoolEntry &entry, std::span<const uint32_t> parents) {
+  const uint32_t index = static_cast<uint32_t>(mEntries.size());
+  bool eligible = true;
+  mMerged.clear();
+  for (const uint32_t parent : parents) {
+    if (parent >= index) {
+      throw std::invalid_argument("Transaction " + std::to_string(index) +
+                                  " added before its parent " +
+                                  std::to_string(parent));
+    }
+    eligible = eligible && mEligible[parent];
+    if (eligible) {
+      mMerged.insert(mMerged.end(),
+                     mAncestors.begin() + mAncestorBegin[parent],
+                     mAncestors.begin() + mAncestorBegin[parent + 1]);
+      mMerged.push_back(parent);
+    }
+  }
+  // A single parent's set is ascending already
+  if (eligible && parents.size() > 1) {
+    std::sort(mMerged.begin(), mMerged.end());
+    mMerged.erase(std::unique(mMerged.begin(), mMerged.end()), mMerged.end());
+  }
+  // Past the limit no descendant can be eligible either, so its ancestor
+  // set is never needed
+  eligible = eligible && mMerged.size() <= mLimits.maxAncestors;
+
+  int64_t fee = entry.fee;
+  uint64_t weight = entry.weight;
+  uint64_t sigops = entry.sigops;
+  if (eligible) {
+    for (const uint32_t ancestor : mMerged) {
+      fee += mEntries[ancestor].fee;
+      weight += mEntries[ancestor].weight;
+      sigops += mEntries[ancestor].sigops;
+    }
+    mAncestors.insert(mAncestors.end(), mMerged.begin(), mMerged.end());
+  }
+
+  mEntries.push_back(entry);
+  mParents.insert(mParents.end(), parents.begin(), parents.end());
+  mParentBegin.push_back(static_cast<uint32_t>(mParents.size()));
+  mAncestorBegin.push_back(static_cast<uint32_t>(mAncestors.size()));
+  mEligible.push_back(eligible ? 1 : 0);
+  mAncestorFee.push_back(fee);
+  mAncestorWeight.push_back(weight);
+  mAncestorSigops.push_back(sigops);
+  mChildrenValid = false;
+  return index;
+}
+
+void Block::TemplateBuilder::buildChildren() {
+  if (mChildrenValid) {
+    return;
+  }
+  // Counting sort of the parent links by parent
+  const size_t count = mEntries.size();
+  mChildBegin.assign(count + 1, 0);
+  for (const uint32_t parent : mParents) {
+    ++mChildBegin[parent + 1];
+  }
+  for (size_t i = 0; i < count; ++i) {
+    mChildBegin[i + 1] += mChildBegin[i];
+  }
+  mChildren.resize(mParents.size());
+  mStack.assign(mChildBegin.begin(), mChildBegin.end() - 1);
+  for (uint32_t child = 0; child < count; ++child) {
+    for (uint32_t i = mParentBegin[child]; i < mParentBegin[child + 1]; ++i) {
+      mChildren[mStack[mParents[i]]++] = child;
+    }
+  }
+  mStack.clear();
+  mChildrenValid = true;
+}
+
+void Block::TemplateBuilder::setFee(uint32_t index, int64_t fee) {
+  if (index >= mEntries.size()) {
+    throw std::out_of_range("Unknown mempool index " + std::to_string(index));
+  }
+  buildChildren();
+  const int64_t delta = fee - mEntries[index].fee;
+  mEntries[index].fee = fee;
+  mAncestorFee[index] += delta;
+
+  // Every descendant counts the fee in its ancestor sum
+  if (mVisited.size() < mEntries.size()) {
+    mVisited.resize(mEntries.size(), 0);
+  }
+  if (++mStamp == 0) {
+    std::fill(mVisited.begin(), mVisited.end(), 0);
+    mStamp = 1;
+  }
+  mStack.assign(mChildren.begin() + mChildBegin[index],
+                mChildren.begin() + mChildBegin[index + 1]);
+  while (!mStack.empty()) {
+    const uint32_t descendant = mStack.back();
+    mStack.pop_back();
+    if (mVisited[descendant] == mStamp) {
+      continue;
+    }
+    mVisited[descendant] = mStamp;
+    mAncestorFee[descendant] += delta;
+    mStack.insert(mStack.end(), mChildren.begin() + mChildBegin[descendant],
+                  mChildren.begin() + mChildBegin[descendant + 1]);
+  }
+}
+
+void Block::TemplateBuilder::include(uint32_t index) {
+  const MempoolEntry &entry = mEntries[index];
+  mState[index] = INCLUDED;
+  mSelected.indexes.push_back(index);
+  mSelected.txids.push_back(entry.txid);
+  mSelected.wtxids.push_back(entry.wtxid);
+  mSelected.fees += entry.fee;
+  mSelected.weight += entry.weight;
+  mSelected.sigops += entry.sigops;
+
+  if (++mStamp == 0) {
+    std::fill(mVisited.begin(), mVisited.end(), 0);
+    mStamp = 1;
+  }
+  mStack.assign(mChildren.begin() + mChildBegin[index],
+                mChildren.begin() + mChildBegin[index + 1]);
+  while (!mStack.empty()) {
+    const uint32_t descendant = mStack.back();
+    mStack.pop_back();
+    if (mVisited[descendant] == mStamp) {
+      continue;
+    }
+    mVisited[descendant] = mStamp;
+    if (!mEligible[descendant]) {
+      continue; // and neither are its descendants
+    }
+    if (mState[descendant] == UNTOUCHED) {
+      mState[descendant] = MODIFIED;
+      mPackageFee[descendant] = mAncestorFee[descendant];
+      mPackageWeight[descendant] = mAncestorWeight[descendant];
+      mPackageSigops[descendant] = mAncestorSigops[descendant];
+    }
+    mPackageFee[descendant] -= entry.fee;
+    mPackageWeight[descendant] -= entry.weight;
+    mPackageSigops[descendant] -= entry.sigops;
+    mTouched.push_back(descendant);
+    mStack.insert(mStack.end(), mChildren.begin() + mChildBegin[descendant],
+                  mChildren.begin() + mChildBegin[descendant + 1]);
+  }
+}
+
+double Block::TemplateBuilder::refill() {
+  using namespace TemplateBuilder_internal;
+
+  double threshold = -std::numeric_limits<double>::infinity();
+  if (mReserve.size() > 2 * HEAP_BATCH) {
+    // Estimate the score of the HEAP_BATCH-th best from an even sample
+    std::array<double, THRESHOLD_SAMPLES> samples;
+    const size_t stride = mReserve.size() / THRESHOLD_SAMPLES;
+    for (size_t i = 0; i < THRESHOLD_SAMPLES; ++i) {
+      samples[i] = mReserve[i * stride].score;
+    }
+    std::sort(samples.begin(), samples.end(), std::greater<double>());
+    threshold = samples[HEAP_BATCH * THRESHOLD_SAMPLES / mReserve.size()];
+  }
+
+  size_t kept = 0;
+  for (const Candidate &candidate : mReserve) {
+    if (candidate.score >= threshold) {
+      mHeap.push_back(candidate);
+    } else {
+      mReserve[kept++] = candidate;
+    }
+  }
+  mReserve.resize(kept);
+  std::make_heap(mHeap.begin(), mHeap.end(), lowerScore);
+  return threshold;
+}
+
+const Block::SelectedTemplate &Block::TemplateBuilder::build(uint32_t height) {
+  buildChildren();
+  const size_t count = mEntries.size();
+  // Package sums start as the ancestor sums and are copied on first change
+  mPackageFee.resize(count);
+  mPackageWeight.resize(count);
+  mPackageSigops.resize(count);
+  mState.assign(count, UNTOUCHED);
+  mVersion.assign(count, 0);
+  mVisited.resize(count, 0);
+
+  mSelected.indexes.clear();
+  mSelected.txids.clear();
+  mSelected.wtxids.clear();
+  mSelected.fees = 0;
+  mSelected.weight = mLimits.coinbaseWeight;
+  mSelected.sigops = mLimits.coinbaseSigops;
+
+  mHeap.clear();
+  mReserve.clear();
+  for (uint32_t i = 0; i < count; ++i) {
+    if (mEligible[i]) {
+      mReserve.push_back(Candidate{score(i), i, 0});
+    }
+  }
+
+  // Everything in the reserve scores below the bound, so the heap top is
+  // the best candidate while it scores at least that much
+  double bound = std::numeric_limits<double>::infinity();
+  uint32_t failures = 0;
+  for (;;) {
+    if (mHeap.empty() || mHeap.front().score < bound) {
+      if (!mReserve.empty()) {
+        bound = refill();
+        continue;
+      }
+      if (mHeap.empty()) {
+        break;
+      }
+      bound = -std::numeric_limits<double>::infinity();
+    }
+    std::pop_heap(mHeap.begin(), mHeap.end(), lowerScore);
+    const Candidate candidate = mHeap.back();
+    mHeap.pop_back();
+    const uint32_t index = candidate.index;
+    if (mState[index] == INCLUDED || candidate.version != mVersion[index]) {
+      continue; // superseded by a rescored entry
+    }
+
+    const bool modified = mState[index] == MODIFIED;
+    if (mSelected.weight + (modified ? mPackageWeight[index]
+                                     : mAncestorWeight[index]) >=
+            mLimits.maxWeight ||
+        mSelected.sigops + (modified ? mPackageSigops[index]
+                                     : mAncestorSigops[index]) >=
+            mLimits.maxSigops) {
+      // Nearly full blocks rarely fit anything more
+      if (++failures > mLimits.maxConsecutiveFailures &&
+          mSelected.weight > mLimits.maxWeight - mLimits.coinbaseWeight) {
+        break;
+      }
+      continue;
+    }
+    failures = 0;
+
+    // Ancestors are ascending indexes, so parents go first
+    mTouched.clear();
+    for (uint32_t i = mAncestorBegin[index]; i < mAncestorBegin[index + 1];
+         ++i) {
+      if (mState[mAncestors[i]] != INCLUDED) {
+        include(mAncestors[i]);
+      }
+    }
+    include(index);
+
+    // Rescore the descendants whose packages shrank
+    std::sort(mTouched.begin(), mTouched.end());
+    mTouched.erase(std::unique(mTouched.begin(), mTouched.end()),
+                   mTouched.end());
+    for (const uint32_t descendant : mTouched) {
+      if (mState[descendant] == INCLUDED) {
+        continue;
+      }
+      mHeap.push_back(
+          Candidate{score(descendant), descendant, ++mVersion[descendant]});
+      std::push_heap(mHeap.begin(), mHeap.end(), lowerScore);
+    }
+  }
+
+  mSelected.coinbaseValue = getBlockSubsidy(height) + mSelected.fees;
+  return mSelected;
+}
+
+int64_t Block::TemplateBuilder::getBlockSubsidy(uint32_t height,
+                                                uint32_t halvingInterval) {
+  using namespace TemplateBuilder_internal;
+
+  const uint32_t halvings = height / halvingInterval;
+  if (halvings >= 64) {
+    return 0;
+  }
+  return (50 * COIN) >> halvings;
+}
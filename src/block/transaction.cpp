@@ -0,0 +1,309 @@
+#include "block/transaction.h"
+
+// system includes
+#include <algorithm>
+#include <cstring>
+#include <thread>
+
+// project includes
+#include "block/merkle.h"
+#include "block/packedHeader.h"
+#include "sha256/sha256.h"
+#include "util/compactSize.h"
+#include "util/endian.h"
+
+namespace Block {
+namespace Transaction_internal {
+
+// Smallest serialized input (prevout, empty script, sequence) and output
+// (value, empty script); bounds counts before anything is reserved
+static constexpr size_t MIN_INPUT_SIZE = 36 + 1 + 4;
+static constexpr size_t MIN_OUTPUT_SIZE = 8 + 1;
+static constexpr size_t MIN_TX_SIZE =
+    4 + 1 + MIN_INPUT_SIZE + 1 + MIN_OUTPUT_SIZE + 4;
+
+// Longest message the batch kernel takes
+static constexpr size_t MAX_BATCH_MESSAGE =
+    SHA256::SHA256::BATCH_MAX_BLOCKS * 64 - 9;
+
+// Messages gathered per batch kernel call
+static constexpr size_t HASH_BATCH = 256;
+
+// Read a length-prefixed byte string
+static bool readBytes(std::span<const uint8_t> data, size_t &offset,
+                      std::span<const uint8_t> &bytes) {
+  uint64_t length = 0;
+  if (!util::ReadCompactSize(data, offset, length) ||
+      length > data.size() - offset) {
+    return false;
+  }
+  bytes = data.subspan(offset, static_cast<size_t>(length));
+  offset += static_cast<size_t>(length);
+  return true;
+}
+
+// Read a count of items at least minSize bytes each
+static bool readCount(std::span<const uint8_t> data, size_t &offset,
+                      size_t minSize, size_t &count) {
+  uint64_t value = 0;
+  if (!util::ReadCompactSize(data, offset, value) ||
+      value > (data.size() - offset) / minSize) {
+    return false;
+  }
+  count = static_cast<size_t>(value);
+  return true;
+}
+
+// Finish a double SHA-256 whose first pass was streamed into ctx
+static void finishDouble(SHA256::SHA256::Context &ctx, Hash &hash) {
+  Hash first;
+  SHA256::SHA256::finalize_bytes(ctx, first.data());
+  SHA256::SHA256::bytes(first.data(), first.size(), hash.data());
+}
+
+// txid of any transaction: version, body and lock time fed in place
+static void streamTxid(Transaction &tx) {
+  SHA256::SHA256::Context ctx;
+  SHA256::SHA256::init(ctx);
+  SHA256::SHA256::append(ctx, tx.bytes.data(), 4);
+  SHA256::SHA256::append(ctx, tx.body.data(), tx.body.size());
+  SHA256::SHA256::append(ctx, tx.bytes.data() + tx.bytes.size() - 4, 4);
+  finishDouble(ctx, tx.txid);
+}
+
+// wtxid of any transaction: the full serialization
+static void streamWtxid(Transaction &tx) {
+  SHA256::SHA256::Context ctx;
+  SHA256::SHA256::init(ctx);
+  SHA256::SHA256::append(ctx, tx.bytes.data(), tx.bytes.size());
+  finishDouble(ctx, tx.wtxid);
+}
+
+static void streamIds(Transaction &tx) {
+  if (tx.hasWitness()) {
+    streamTxid(tx);
+    streamWtxid(tx);
+  } else {
+    // Without witness data the body runs from the version to the lock time
+    streamWtxid(tx);
+    tx.txid = tx.wtxid;
+  }
+}
+
+// Compute the ids of txs[begin, end)
+static void hashRange(std::vector<Transaction> &txs, size_t begin,
+                      size_t end) {
+  const void *src[HASH_BATCH] = {};
+  size_t n_bytes[HASH_BATCH] = {};
+  void *dst[HASH_BATCH] = {};
+  size_t pending = 0;
+
+  const auto flush = [&]() {
+    SHA256::SHA256::double_bytes_many(src, n_bytes, pending, dst);
+    pending = 0;
+  };
+
+  for (size_t i = begin; i < end; ++i) {
+    Transaction &tx = txs[i];
+    if (tx.bytes.size() > MAX_BATCH_MESSAGE) {
+      streamIds(tx);
+      continue;
+    }
+    // The full serialization is contiguous: batch it
+    src[pending] = tx.bytes.data();
+    n_bytes[pending] = tx.bytes.size();
+    dst[pending] = tx.wtxid.data();
+    if (++pending == HASH_BATCH) {
+      flush();
+    }
+    if (tx.hasWitness()) {
+      streamTxid(tx);
+    }
+  }
+  flush();
+
+  // Legacy transactions were batched under their wtxid
+  for (size_t i = begin; i < end; ++i) {
+    if (!txs[i].hasWitness()) {
+      txs[i].txid = txs[i].wtxid;
+    }
+  }
+}
+
+} // namespace Transaction_internal
+} // namespace Block
+
+bool Block::parseTransaction(std::span<const uint8_t> data, size_t &offset,
+                             Transaction &tx, bool computeIds) {
+  using namespace Transaction_internal;
+
+  const size_t start = offset;
+  size_t pos = offset;
+  if (pos > data.size() || data.size() - pos < 4) {
+    return false;
+  }
+  tx.version = util::ReadLE32(data.data() + pos);
+  pos += 4;
+
+  // BIP144 marker and flag
+  bool segwit = false;
+  if (data.size() - pos >= 2 && data[pos] == 0x00 && data[pos + 1] == 0x01) {
+    segwit = true;
+    pos += 2;
+  }
+
+  const size_t body_start = pos;
+  size_t count = 0;
+  if (!readCount(data, pos, MIN_INPUT_SIZE, count)) {
+    return false;
+  }
+  tx.inputs.resize(count);
+  for (TxInput &input : tx.inputs) {
+    if (data.size() - pos < 36) {
+      return false;
+    }
+    input.prevout = data.subspan(pos, 36);
+    pos += 36;
+    if (!readBytes(data, pos, input.scriptSig) || data.size() - pos < 4) {
+      return false;
+    }
+    input.sequence = util::ReadLE32(data.data() + pos);
+    pos += 4;
+    input.witness = {};
+  }
+
+  if (!readCount(data, pos, MIN_OUTPUT_SIZE, count)) {
+    return false;
+  }
+  tx.outputs.resize(count);
+  for (TxOutput &output : tx.outputs) {
+    if (data.size() - pos < 8) {
+      return false;
+    }
+    output.value = static_cast<int64_t>(util::ReadLE64(data.data() + pos));
+    pos += 8;
+    if (!readBytes(data, pos, output.scriptPubKey)) {
+      return false;
+    }
+  }
+  tx.body = data.subspan(body_start, pos - body_start);
+
+  if (segwit) {
+    bool any_witness = false;
+    for (TxInput &input : tx.inputs) {
+      const size_t witness_start = pos;
+      size_t items = 0;
+      if (!readCount(data, pos, 1, items)) {
+        return false;
+      }
+      for (size_t i = 0; i < items; ++i) {
+        std::span<const uint8_t> item;
+        if (!readBytes(data, pos, item)) {
+          return false;
+        }
+      }
+      input.witness = data.subspan(witness_start, pos - witness_start);
+      any_witness |= items > 0;
+    }
+    // A segwit serialization without witness data is non-canonical
+    if (!any_witness) {
+      return false;
+    }
+  }
+
+  if (data.size() - pos < 4) {
+    return false;
+  }
+  tx.lockTime = util::ReadLE32(data.data() + pos);
+  pos += 4;
+
+  tx.bytes = data.subspan(start, pos - start);
+  offset = pos;
+  if (computeIds) {
+    streamIds(tx);
+  }
+  return true;
+}
+
+Block::BlockParser::BlockParser(unsigned int threads)
+    : mThreads(threads == 0 ? std::max(1u, std::thread::hardware_concurrency())
+                            : threads) {}
+
+bool Block::BlockParser::parse(std::span<const uint8_t> block,
+                               std::vector<Transaction> &txs) const {
+  using namespace Transaction_internal;
+
+  if (block.size() < PackedHeader::SIZE) {
+    return false;
+  }
+  size_t offset = PackedHeader::SIZE;
+  size_t count = 0;
+  if (!readCount(block, offset, MIN_TX_SIZE, count)) {
+    return false;
+  }
+
+  // Boundaries first: a sequential walk over the length prefixes
+  txs.resize(count);
+  for (Transaction &tx : txs) {
+    if (!parseTransaction(block, offset, tx, false)) {
+      return false;
+    }
+  }
+  if (offset != block.size()) {
+    return false;
+  }
+
+  // Then the hashing, in ranges of roughly equal bytes
+  const size_t threads =
+      count < MIN_PARALLEL_TXS
+          ? 1
+          : std::min<size_t>(mThreads, count / (MIN_PARALLEL_TXS / 2));
+  if (threads <= 1) {
+    hashRange(txs, 0, count);
+    return true;
+  }
+
+  const size_t body_bytes = block.size() - PackedHeader::SIZE;
+  std::vector<size_t> bounds(threads + 1, count);
+  bounds[0] = 0;
+  size_t t = 1;
+  for (size_t i = 0; i < count && t < threads; ++i) {
+    const size_t consumed = static_cast<size_t>(
+        txs[i].bytes.data() - block.data() - PackedHeader::SIZE);
+    if (consumed >= body_bytes * t / threads) {
+      bounds[t++] = i;
+    }
+  }
+
+  std::vector<std::thread> pool;
+  for (size_t w = 1; w < threads; ++w) {
+    pool.emplace_back(
+        [&txs, &bounds, w]() { hashRange(txs, bounds[w], bounds[w + 1]); });
+  }
+  hashRange(txs, bounds[0], bounds[1]);
+  for (auto &thread : pool) {
+    thread.join();
+  }
+  return true;
+}
+
+Hash Block::BlockParser::computeMerkleRoot(
+    const std::vector<Transaction> &txs) {
+  std::vector<Hash> txids;
+  txids.reserve(txs.size());
+  for (const Transaction &tx : txs) {
+    txids.push_back(tx.txid);
+  }
+  return Block::computeMerkleRoot(txids);
+}
+
+bool Block::BlockParser::checkMerkleRoot(
+    std::span<const uint8_t> block) const {
+  std::vector<Transaction> txs;
+  if (!parse(block, txs) || txs.empty()) {
+    return false;
+  }
+  return std::memcmp(computeMerkleRoot(txs).data(),
+                     block.data() + PackedHeader::MERKLE_ROOT_OFFSET,
+                     sizeof(Hash)) == 0;
+}
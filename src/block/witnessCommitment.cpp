@@ -0,0 +1,80 @@
+#include "block/witnessCommitment.h"
+
+// system includes
+#include <algorithm>
+#include <cstring>
+#include <stdexcept>
+
+// project includes
+#include "block/merkle.h"
+#include "sha256/sha256.h"
+
+Block::WitnessCommitment::WitnessCommitment(const Hash &reservedValue)
+    : mReservedValue(reservedValue), mWitnessRoot(), mCommitment(),
+      mOutput() {
+  // Zero value, script length and the fixed script header
+  mOutput[8] = static_cast<uint8_t>(SCRIPT_SIZE);
+  std::copy(SCRIPT_PREFIX.begin(), SCRIPT_PREFIX.end(), mOutput.begin() + 9);
+  update(std::span<const Hash>());
+}
+
+void Block::WitnessCommitment::update(std::span<const Hash> wtxids) {
+  // The coinbase wtxid is taken as zero
+  mLeaves.resize(wtxids.size() + 1);
+  mLeaves[0] = Hash{};
+  std::copy(wtxids.begin(), wtxids.end(), mLeaves.begin() + 1);
+  mWitnessRoot = computeMerkleRoot(mLeaves);
+  commit();
+}
+
+void Block::WitnessCommitment::update(const std::vector<Transaction> &txs) {
+  mLeaves.resize(std::max<size_t>(txs.size(), 1));
+  mLeaves[0] = Hash{};
+  for (size_t i = 1; i < txs.size(); ++i) {
+    mLeaves[i] = txs[i].wtxid;
+  }
+  mWitnessRoot = computeMerkleRoot(mLeaves);
+  commit();
+}
+
+void Block::WitnessCommitment::commit() {
+  uint8_t message[2 * sizeof(Hash)];
+  std::memcpy(message, mWitnessRoot.data(), sizeof(Hash));
+  std::memcpy(message + sizeof(Hash), mReservedValue.data(), sizeof(Hash));
+  Hash first;
+  SHA256::SHA256::bytes(message, sizeof(message), first.data());
+  SHA256::SHA256::bytes(first.data(), first.size(), mCommitment.data());
+  std::copy(mCommitment.begin(), mCommitment.end(),
+            mOutput.begin() + HASH_OFFSET);
+}
+
+void Block::WitnessCommitment::swapInto(std::span<uint8_t> coinbase,
+                                        size_t hashOffset) const {
+  if (hashOffset < SCRIPT_PREFIX.size() || hashOffset > coinbase.size() ||
+      coinbase.size() - hashOffset < sizeof(Hash) ||
+      !std::equal(SCRIPT_PREFIX.begin(), SCRIPT_PREFIX.end(),
+                  coinbase.begin() + (hashOffset - SCRIPT_PREFIX.size()))) {
+    throw std::invalid_argument("No witness commitment at the given offset");
+  }
+  std::copy(mCommitment.begin(), mCommitment.end(),
+            coinbase.begin() + hashOffset);
+}
+
+std::optional<size_t>
+Block::WitnessCommitment::find(std::span<const uint8_t> coinbase) {
+  Transaction tx;
+  size_t offset = 0;
+  if (!parseTransaction(coinbase, offset, tx, false)) {
+    return std::nullopt;
+  }
+  for (auto it = tx.outputs.rbegin(); it != tx.outputs.rend(); ++it) {
+    const std::span<const uint8_t> script = it->scriptPubKey;
+    if (script.size() >= SCRIPT_SIZE &&
+        std::equal(SCRIPT_PREFIX.begin(), SCRIPT_PREFIX.end(),
+                   script.begin())) {
+      return static_cast<size_t>(script.data() - coinbase.data()) +
+             SCRIPT_PREFIX.size();
+    }
+  }
+  return std::nullopt;
+}
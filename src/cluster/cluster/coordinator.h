@@ -0,0 +1,168 @@
+#ifndef __CLUSTER_COORDINATOR_H__
+#define __CLUSTER_COORDINATOR_H__
+
+// system includes
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <thread>
+#include <vector>
+
+// project includes
+#include "cluster/protocol.h"
+#include "stratum/notify.h"
+
+namespace Cluster {
+
+/// \brief Coordinator settings.
+struct CoordinatorConfig {
+  /// \brief IPv4 address and port to listen on; port 0 picks a free one.
+  std::string host = "0.0.0.0";
+  uint16_t port = 3334;
+
+  /// \brief Work per lease, in seconds of the node's reported hashrate. A
+  /// node gets its next lease when less than half of this is left.
+  std::chrono::milliseconds leaseTime{30000};
+};
+
+/// \brief A solution from a node, resolved for the upstream pool; views are
+/// valid during the handler.
+struct Submission {
+  uint32_t node = 0;
+
+  /// \brief The upstream job id.
+  std::string_view jobId;
+  std::span<const uint8_t> extranonce2;
+  uint32_t time = 0;
+  uint32_t nonce = 0;
+
+  /// \brief Rolled version bits; 0 if none.
+  uint32_t versionBits = 0;
+};
+
+/// \brief A connected node, as seen by the coordinator.
+struct NodeInfo {
+  uint32_t id = 0;
+  std::string name;
+  uint64_t hashrate = 0;
+
+  /// \brief Indices reported searched, all jobs.
+  uint64_t searched = 0;
+
+  /// \brief Solutions forwarded, and those outside the node's leases.
+  uint64_t solutions = 0;
+  uint64_t rejected = 0;
+
+  /// \brief Ranges leased to the node for the current job.
+  std::vector<WorkRange> leases;
+};
+
+/// \brief Splits each upstream job among mining nodes on other hosts or
+/// processes and gathers their solutions.
+/// \note Nodes connect over TCP and speak the binary protocol of
+/// cluster/protocol.h. Work is handed out as leases: ranges of the job's
+/// WorkSpace sized to the node's reported hashrate times leaseTime, cut
+/// from a cursor that only moves forward, so no two leases of a job ever
+/// overlap. A node reports progress as it goes and is topped up before it
+/// runs dry; faster nodes simply come back sooner. When a node leaves, the
+/// unsearched rest of its leases is recycled into later leases, and a
+/// node that joins gets its first lease at once, so the split follows the
+/// nodes without a global reshuffle. A new job restarts the space.
+///
+/// Solutions are checked against the sender's leases for that job or the
+/// one before and passed to the handler with the extranonce2 and version
+/// bits their index stands for. One thread runs the sockets; the state is
+/// guarded by a mutex so setJob() and getNodes() may be called from any
+/// thread. Linux only.
+class Coordinator {
+public:
+  /// \brief Called for every solution inside the sender's leases, on the
+  /// coordinator thread and outside its lock.
+  using SolutionHandler = std::function<void(const Submission &submission)>;
+
+  /// \brief Create the listener; the loop starts with start().
+  /// \param config Settings.
+  /// \throws std::invalid_argument on an unparsable host.
+  /// \throws std::system_error if the port cannot be bound, or with
+  /// std::errc::not_supported off Linux.
+  explicit Coordinator(const CoordinatorConfig &config);
+
+  /// \brief Stop the loop and close every connection.
+  ~Coordinator();
+
+  Coordinator(const Coordinator &) = delete;
+  Coordinator &operator=(const Coordinator &) = delete;
+
+  /// \brief Set the solution handler; call before start().
+  inline void setSolutionHandler(SolutionHandler handler) {
+    mSolutionHandler = std::move(handler);
+  }
+
+  /// \brief Start the loop thread.
+  void start();
+
+  /// \brief Stop the loop thread and wait for it.
+  void stop();
+
+  /// \brief Replace the job and lease its space afresh. Thread-safe.
+  /// \param notify The upstream job.
+  /// \param extranonce1 The upstream extranonce1.
+  /// \param extranonce2Size Bytes of extranonce2 the nodes roll.
+  /// \param versionMask Version bits the nodes may roll.
+  /// \return The coordinator job number.
+  /// \throws std::invalid_argument if the space has 2^64 indices or more.
+  uint32_t setJob(const Stratum::Notify &notify,
+                  std::span<const uint8_t> extranonce1,
+                  size_t extranonce2Size, uint32_t versionMask);
+
+  /// \brief Get the port listened on.
+  inline uint16_t getPort() const { return mPort; }
+
+  /// \brief Get the connected nodes. Thread-safe.
+  std::vector<NodeInfo> getNodes() const;
+
+private:
+  struct Peer;
+  struct JobState;
+  struct Pending;
+
+  void run();
+  void accept();
+  bool receive(Peer &node, std::vector<Pending> &pending);
+  bool process(Peer &node, MessageType type,
+               std::span<const uint8_t> payload,
+               std::vector<Pending> &pending);
+  void grant(Peer &node);
+  void send(Peer &node, std::span<const uint8_t> frame);
+  bool flush(Peer &node);
+  void close(Peer &node);
+
+  CoordinatorConfig mConfig;
+  SolutionHandler mSolutionHandler;
+  uint16_t mPort;
+  int mListener;
+  int mEpoll;
+  int mWakeup;
+  std::thread mThread;
+  std::atomic<bool> mRunning;
+
+  // Everything below is guarded by mMutex
+  mutable std::mutex mMutex;
+  std::vector<std::unique_ptr<Peer>> mNodes;
+  uint32_t mNextNode;
+
+  // The current job and the one before, for late solutions
+  std::unique_ptr<JobState> mJob;
+  std::unique_ptr<JobState> mPrevious;
+  uint32_t mNextJob;
+};
+
+} // namespace Cluster
+#endif // __CLUSTER_COORDINATOR_H__
@@ -0,0 +1,123 @@
+#ifndef __CLUSTER_NODE_H__
+#define __CLUSTER_NODE_H__
+
+// system includes
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <vector>
+
+// project includes
+#include "cluster/protocol.h"
+#include "net/tcpClient.h"
+
+namespace Cluster {
+
+/// \brief Settings of a mining node.
+struct NodeConfig {
+  std::string host = "127.0.0.1";
+  uint16_t port = 3334;
+
+  /// \brief Shown by the coordinator.
+  std::string name;
+
+  /// \brief Hashes per second, until progress reports say otherwise; sizes
+  /// the first lease.
+  uint64_t hashrate = 0;
+
+  /// \brief Bound on connecting and on the handshake.
+  std::chrono::milliseconds timeout{10000};
+};
+
+/// \brief A mining host's connection to a Coordinator.
+/// \note Like Stratum::Client, one thread drives the connection, a
+/// Net::TcpClient, with poll() or run() and the handlers run on it; other threads may report
+/// progress, submit solutions and stop(). Leases of one job arrive in the
+/// order they should be searched, and progress positions refer to them.
+/// Linux only.
+class Node {
+public:
+  /// \brief Called for every new job; earlier leases are void.
+  using JobHandler = std::function<void(const Job &job)>;
+
+  /// \brief Called for every lease, after its job.
+  using LeaseHandler = std::function<void(const Lease &lease)>;
+
+  /// \throws std::system_error as Net::TcpClient().
+  explicit Node(const NodeConfig &config);
+
+  ~Node();
+
+  Node(const Node &) = delete;
+  Node &operator=(const Node &) = delete;
+
+  /// \brief Set the job handler; call before connect().
+  inline void setJobHandler(JobHandler handler) {
+    mJobHandler = std::move(handler);
+  }
+
+  /// \brief Set the lease handler; call before connect().
+  inline void setLeaseHandler(LeaseHandler handler) {
+    mLeaseHandler = std::move(handler);
+  }
+
+  /// \brief Connect and introduce the node.
+  /// \note Returns once welcomed; a job and lease sent right after may
+  /// already have reached the handlers.
+  /// \throws std::system_error on socket errors.
+  /// \throws std::runtime_error if the coordinator closes the connection or
+  /// does not answer within the timeout.
+  void connect();
+
+  /// \brief Process socket events.
+  /// \param timeout Longest wait for an event; negative waits until one
+  /// arrives.
+  /// \return false once the connection is closed.
+  /// \throws std::system_error on socket errors.
+  inline bool poll(std::chrono::milliseconds timeout) {
+    return mConnection.poll(timeout);
+  }
+
+  /// \brief Process socket events until stop() or until the connection
+  /// closes.
+  inline void run() { mConnection.run(); }
+
+  /// \brief Make run() return. Thread-safe.
+  inline void stop() { mConnection.stop(); }
+
+  /// \brief Report that every leased index of a job below position is
+  /// searched. Thread-safe.
+  /// \param hashrate Current hashes per second; 0 keeps the last one.
+  void reportProgress(uint32_t job, uint64_t position, uint64_t hashrate);
+
+  /// \brief Send a solution. Thread-safe.
+  /// \param index The WorkSpace index it was found at.
+  void submit(uint32_t job, uint64_t index, uint32_t time, uint32_t nonce);
+
+  /// \brief Whether the connection is open.
+  inline bool isConnected() const { return mConnection.isConnected(); }
+
+  /// \brief Get the id the coordinator gave the node; 0 before connect().
+  inline uint32_t getId() const { return mId; }
+
+private:
+  void post(const std::vector<uint8_t> &frame);
+  size_t receive(std::span<const uint8_t> pending);
+  bool process(MessageType type, std::span<const uint8_t> payload);
+
+  NodeConfig mConfig;
+  JobHandler mJobHandler;
+  LeaseHandler mLeaseHandler;
+
+  Net::TcpClient mConnection;
+  uint32_t mId;
+
+  // Reused for every job
+  Job mJob;
+};
+
+} // namespace Cluster
+#endif // __CLUSTER_NODE_H__
@@ -0,0 +1,158 @@
+#ifndef __CLUSTER_PROTOCOL_H__
+#define __CLUSTER_PROTOCOL_H__
+
+// system includes
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <vector>
+
+// project includes
+#include "stratum/notify.h"
+
+namespace Cluster {
+
+/// \brief Version sent in Hello; the coordinator closes connections from
+/// nodes speaking another one.
+static constexpr uint32_t PROTOCOL_VERSION = 1;
+
+/// \brief Largest frame payload accepted; jobs with huge coinbases fit.
+static constexpr size_t MAX_PAYLOAD_SIZE = 1024 * 1024;
+
+/// \brief Frame types. A frame is the type byte, the payload length as a
+/// CompactSize, then the payload; integers in payloads are little-endian.
+enum class MessageType : uint8_t {
+  Hello = 1,    // node -> coordinator, first frame
+  Welcome = 2,  // coordinator -> node, answers Hello
+  Job = 3,      // coordinator -> node
+  Lease = 4,    // coordinator -> node
+  Progress = 5, // node -> coordinator
+  Solution = 6, // node -> coordinator
+};
+
+/// \brief A half-open range [begin, end) of WorkSpace indices.
+struct WorkRange {
+  uint64_t begin = 0;
+  uint64_t end = 0;
+
+  inline uint64_t size() const { return end - begin; }
+  inline bool contains(uint64_t index) const {
+    return index >= begin && index < end;
+  }
+  inline bool operator==(const WorkRange &) const = default;
+};
+
+/// \brief The search space of one job: every extranonce2 value paired with
+/// every rolled version, numbered so that the version varies fastest.
+/// \note Rolling the version keeps the Merkle root, so a node works through
+/// the versions of one extranonce2 before paying for the next root. Each
+/// index stands for 2^32 nonces.
+class WorkSpace {
+public:
+  /// \param extranonce2Size Bytes of extranonce2 nodes roll.
+  /// \param versionMask Version bits nodes may roll.
+  /// \throws std::invalid_argument if the space has 2^64 indices or more,
+  /// or extranonce2Size is above 8.
+  WorkSpace(size_t extranonce2Size, uint32_t versionMask);
+
+  /// \brief Get the number of indices.
+  inline uint64_t size() const { return uint64_t{1} << mBits; }
+
+  /// \brief Get the extranonce2 and version bits of an index.
+  /// \param index Index below size().
+  /// \param extranonce2 Receives extranonce2Size bytes, big-endian.
+  /// \param versionBits Receives the rolled version bits, within the mask.
+  void at(uint64_t index, uint8_t *extranonce2, uint32_t &versionBits) const;
+
+private:
+  size_t mExtranonce2Size;
+  uint32_t mVersionMask;
+  unsigned mVersionBits; // set bits in the mask
+  unsigned mBits;
+};
+
+/// \brief The first frame of a node, introducing it.
+struct Hello {
+  uint32_t version = PROTOCOL_VERSION;
+  uint64_t hashrate = 0; // hashes per second
+  std::string name;
+};
+
+/// \brief The coordinator's answer to Hello.
+struct Welcome {
+  /// \brief Id of the node, unique for the coordinator's lifetime.
+  uint32_t node = 0;
+};
+
+/// \brief A job as the coordinator got it from upstream, sent to every
+/// node before its leases.
+struct Job {
+  /// \brief Coordinator job number, counting from 1.
+  uint32_t id = 0;
+  Stratum::Notify notify;
+
+  /// \brief The upstream extranonce1, and the size of the extranonce2 and
+  /// the version bits the WorkSpace is built from.
+  std::vector<uint8_t> extranonce1;
+  size_t extranonce2Size = 0;
+  uint32_t versionMask = 0;
+};
+
+/// \brief Work granted to one node for one job, in addition to its earlier
+/// leases.
+struct Lease {
+  uint32_t job = 0;
+  WorkRange range;
+};
+
+/// \brief How far a node got: every index of its leases below position is
+/// searched.
+struct Progress {
+  uint32_t job = 0;
+  uint64_t position = 0;
+  uint64_t hashrate = 0;
+};
+
+/// \brief A header meeting the share target.
+struct Solution {
+  uint32_t job = 0;
+  uint64_t index = 0;
+  uint32_t time = 0;
+  uint32_t nonce = 0;
+};
+
+/// \brief Append a frame for a message.
+void encode(std::vector<uint8_t> &out, const Hello &message);
+void encode(std::vector<uint8_t> &out, const Welcome &message);
+void encode(std::vector<uint8_t> &out, const Job &message);
+void encode(std::vector<uint8_t> &out, const Lease &message);
+void encode(std::vector<uint8_t> &out, const Progress &message);
+void encode(std::vector<uint8_t> &out, const Solution &message);
+
+/// \brief Decode a frame payload.
+/// \return false if the payload is malformed or has trailing bytes.
+bool decode(std::span<const uint8_t> payload, Hello &message);
+bool decode(std::span<const uint8_t> payload, Welcome &message);
+bool decode(std::span<const uint8_t> payload, Job &message);
+bool decode(std::span<const uint8_t> payload, Lease &message);
+bool decode(std::span<const uint8_t> payload, Progress &message);
+bool decode(std::span<const uint8_t> payload, Solution &message);
+
+/// \brief Outcome of readFrame().
+enum class FrameStatus : uint8_t {
+  Complete,
+  Incomplete, // more bytes needed
+  Malformed,  // oversized payload or non-canonical length
+};
+
+/// \brief Find the next frame in received bytes.
+/// \param data Received bytes.
+/// \param offset Read position; advanced past the frame when Complete.
+/// \param type Receives the frame type when Complete.
+/// \param payload Receives the payload, a view into data, when Complete.
+FrameStatus readFrame(std::span<const uint8_t> data, size_t &offset,
+                      MessageType &type, std::span<const uint8_t> &payload);
+
+} // namespace Cluster
+#endif // __CLUSTER_PROTOCOL_H__
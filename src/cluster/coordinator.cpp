@@ -0,0 +1,580 @@
+#include "cluster/coordinator.h"
+
+// system includes
+#include <algorithm>
+#include <cerrno>
+#include <deque>
+#include <stdexcept>
+#include <system_error>
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#define HFM_CLUSTER_COORDINATOR_EPOLL 1
+#endif
+
+namespace Cluster {
+namespace Coordinator_internal {
+
+// epoll tags; a node's tag is its id, which starts at 1
+static constexpr uint64_t LISTENER_TAG = ~uint64_t{0};
+static constexpr uint64_t WAKEUP_TAG = ~uint64_t{0} - 1;
+
+static constexpr int MAX_EVENTS = 64;
+static constexpr size_t RECEIVE_SIZE = 16 * 1024;
+
+} // namespace Coordinator_internal
+} // namespace Cluster
+
+struct Cluster::Coordinator::JobState {
+  JobState(uint32_t number, const Job &job)
+      : id(number), upstreamId(job.notify.jobId),
+        space(job.extranonce2Size, job.versionMask),
+        extranonce2Size(job.extranonce2Size), cursor(0), recycled(),
+        frame() {}
+
+  uint32_t id;
+  std::string upstreamId;
+  WorkSpace space;
+  size_t extranonce2Size;
+
+  // Never leased below cursor, except the recycled ranges of nodes gone
+  uint64_t cursor;
+  std::vector<WorkRange> recycled;
+
+  // The encoded Job, sent as is to every node
+  std::vector<uint8_t> frame;
+};
+
+struct Cluster::Coordinator::Peer {
+  int fd = -1;
+  uint32_t id = 0;
+  bool greeted = false; // Hello received
+  std::string name;
+  uint64_t hashrate = 0;
+  uint64_t searched = 0;
+  uint64_t solutions = 0;
+  uint64_t rejected = 0;
+
+  // Current job: unsearched leases in the order granted, and every lease;
+  // the previous job's leases are kept for late solutions
+  std::deque<WorkRange> leases;
+  std::vector<WorkRange> granted;
+  std::vector<WorkRange> previous;
+
+  std::vector<uint8_t> received;
+  std::vector<uint8_t> sending;
+  size_t sent = 0;
+  bool writing = false; // EPOLLOUT registered
+};
+
+// A solution copied out of the lock for the handler
+struct Cluster::Coordinator::Pending {
+  uint32_t node = 0;
+  std::string jobId;
+  uint8_t extranonce2[8] = {};
+  size_t extranonce2Size = 0;
+  uint32_t time = 0;
+  uint32_t nonce = 0;
+  uint32_t versionBits = 0;
+};
+
+Cluster::Coordinator::Coordinator(const CoordinatorConfig &config)
+    : mConfig(config), mSolutionHandler(), mPort(0), mListener(-1),
+      mEpoll(-1), mWakeup(-1), mThread(), mRunning(false), mMutex(),
+      mNodes(), mNextNode(1), mJob(), mPrevious(), mNextJob(1) {
+  using namespace Coordinator_internal;
+
+#ifdef HFM_CLUSTER_COORDINATOR_EPOLL
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(config.port);
+  if (::inet_pton(AF_INET, config.host.c_str(), &address.sin_addr) != 1) {
+    throw std::invalid_argument("Not an IPv4 address: " + config.host);
+  }
+  mListener =
+      ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK | SOCK_CLOEXEC, 0);
+  if (mListener < 0) {
+    throw std::system_error(errno, std::generic_category(),
+                            "Cannot create the coordinator socket");
+  }
+  const int on = 1;
+  ::setsockopt(mListener, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+  socklen_t length = sizeof(address);
+  if (::bind(mListener, reinterpret_cast<sockaddr *>(&address), length) !=
+          0 ||
+      ::listen(mListener, SOMAXCONN) != 0 ||
+      ::getsockname(mListener, reinterpret_cast<sockaddr *>(&address),
+                    &length) != 0) {
+    const int error = errno;
+    ::close(mListener);
+    throw std::system_error(error, std::generic_category(),
+                            "Cannot listen on port " +
+                                std::to_string(config.port));
+  }
+  mPort = ntohs(address.sin_port);
+
+  mEpoll = ::epoll_create1(EPOLL_CLOEXEC);
+  mWakeup = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (mEpoll < 0 || mWakeup < 0) {
+    const int error = errno;
+    for (const int fd : {mListener, mEpoll, mWakeup}) {
+      if (fd >= 0) {
+        ::close(fd);
+      }
+    }
+    throw std::system_error(error, std::generic_category(),
+                            "Cannot create the coordinator loop");
+  }
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.u64 = LISTENER_TAG;
+  ::epoll_ctl(mEpoll, EPOLL_CTL_ADD, mListener, &event);
+  event.data.u64 = WAKEUP_TAG;
+  ::epoll_ctl(mEpoll, EPOLL_CTL_ADD, mWakeup, &event);
+#else
+  throw std::system_error(std::make_error_code(std::errc::not_supported),
+                          "Cluster coordinator needs epoll");
+#endif
+}
+
+Cluster::Coordinator::~Coordinator() {
+  stop();
+#ifdef HFM_CLUSTER_COORDINATOR_EPOLL
+  for (const std::unique_ptr<Peer> &node : mNodes) {
+    close(*node);
+  }
+  ::close(mWakeup);
+  ::close(mEpoll);
+  ::close(mListener);
+#endif
+}
+
+void Cluster::Coordinator::start() {
+  if (mRunning.exchange(true)) {
+    return;
+  }
+  mThread = std::thread([this] { run(); });
+}
+
+void Cluster::Coordinator::stop() {
+  if (!mRunning.exchange(false)) {
+    return;
+  }
+#ifdef HFM_CLUSTER_COORDINATOR_EPOLL
+  const uint64_t one = 1;
+  [[maybe_unused]] const ssize_t written =
+      ::write(mWakeup, &one, sizeof(one));
+#endif
+  mThread.join();
+}
+
+uint32_t Cluster::Coordinator::setJob(const Stratum::Notify &notify,
+                                      std::span<const uint8_t> extranonce1,
+                                      size_t extranonce2Size,
+                                      uint32_t versionMask) {
+  Job job;
+  job.notify = notify;
+  job.extranonce1.assign(extranonce1.begin(), extranonce1.end());
+  job.extranonce2Size = extranonce2Size;
+  job.versionMask = versionMask;
+
+  std::lock_guard<std::mutex> lock(mMutex);
+  job.id = mNextJob;
+  auto state = std::make_unique<JobState>(job.id, job);
+  ++mNextJob;
+  encode(state->frame, job);
+  mPrevious = std::move(mJob);
+  mJob = std::move(state);
+
+  for (const std::unique_ptr<Peer> &node : mNodes) {
+    if (node->fd < 0 || !node->greeted) {
+      continue;
+    }
+    node->previous = std::move(node->granted);
+    node->granted.clear();
+    node->leases.clear();
+    send(*node, mJob->frame);
+    grant(*node);
+  }
+  std::erase_if(mNodes, [](const std::unique_ptr<Peer> &node) {
+    return node->fd < 0;
+  });
+  return job.id;
+}
+
+std::vector<Cluster::NodeInfo> Cluster::Coordinator::getNodes() const {
+  std::lock_guard<std::mutex> lock(mMutex);
+  std::vector<NodeInfo> nodes;
+  for (const std::unique_ptr<Peer> &node : mNodes) {
+    if (node->fd < 0 || !node->greeted) {
+      continue;
+    }
+    NodeInfo &info = nodes.emplace_back();
+    info.id = node->id;
+    info.name = node->name;
+    info.hashrate = node->hashrate;
+    info.searched = node->searched;
+    info.solutions = node->solutions;
+    info.rejected = node->rejected;
+    info.leases = node->granted;
+  }
+  return nodes;
+}
+
+void Cluster::Coordinator::run() {
+  using namespace Coordinator_internal;
+
+#ifdef HFM_CLUSTER_COORDINATOR_EPOLL
+  epoll_event events[MAX_EVENTS];
+  std::vector<Pending> pending;
+  while (mRunning.load(std::memory_order_relaxed)) {
+    const int count = ::epoll_wait(mEpoll, events, MAX_EVENTS, -1);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      for (int i = 0; i < count; ++i) {
+        const uint64_t tag = events[i].data.u64;
+        if (tag == LISTENER_TAG) {
+          accept();
+          continue;
+        }
+        if (tag == WAKEUP_TAG) {
+          uint64_t value = 0;
+          [[maybe_unused]] const ssize_t n =
+              ::read(mWakeup, &value, sizeof(value));
+          continue;
+        }
+        const auto found =
+            std::find_if(mNodes.begin(), mNodes.end(),
+                         [tag](const std::unique_ptr<Peer> &node) {
+                           return node->id == tag;
+                         });
+        if (found == mNodes.end() || (*found)->fd < 0) {
+          continue;
+        }
+        Peer &node = **found;
+        if ((events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0 &&
+            !receive(node, pending)) {
+          close(node);
+          continue;
+        }
+        if ((events[i].events & EPOLLOUT) != 0 && !flush(node)) {
+          close(node);
+        }
+      }
+      std::erase_if(mNodes, [](const std::unique_ptr<Peer> &node) {
+        return node->fd < 0;
+      });
+    }
+
+    // The handler may call back into the coordinator
+    for (const Pending &solution : pending) {
+      if (!mSolutionHandler) {
+        break;
+      }
+      Submission submission;
+      submission.node = solution.node;
+      submission.jobId = solution.jobId;
+      submission.extranonce2 = std::span<const uint8_t>(
+          solution.extranonce2, solution.extranonce2Size);
+      submission.time = solution.time;
+      submission.nonce = solution.nonce;
+      submission.versionBits = solution.versionBits;
+      mSolutionHandler(submission);
+    }
+    pending.clear();
+  }
+#endif
+}
+
+void Cluster::Coordinator::accept() {
+#ifdef HFM_CLUSTER_COORDINATOR_EPOLL
+  for (;;) {
+    const int fd = ::accept4(mListener, nullptr, nullptr,
+                             SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return;
+    }
+    const int on = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+    auto node = std::make_unique<Peer>();
+    node->fd = fd;
+    node->id = mNextNode++;
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = node->id;
+    if (::epoll_ctl(mEpoll, EPOLL_CTL_ADD, fd, &event) != 0) {
+      ::close(fd);
+      continue;
+    }
+    mNodes.push_back(std::move(node));
+  }
+#endif
+}
+
+bool Cluster::Coordinator::receive(Peer &node, std::vector<Pending> &pending) {
+  using namespace Coordinator_internal;
+
+#ifdef HFM_CLUSTER_COORDINATOR_EPOLL
+  for (;;) {
+    const size_t used = node.received.size();
+    node.received.resize(used + RECEIVE_SIZE);
+    const ssize_t n =
+        ::recv(node.fd, node.received.data() + used, RECEIVE_SIZE, 0);
+    node.received.resize(used + static_cast<size_t>(std::max<ssize_t>(n, 0)));
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+    if (n == 0) {
+      return false;
+    }
+
+    size_t offset = 0;
+    MessageType type{};
+    std::span<const uint8_t> payload;
+    for (;;) {
+      const FrameStatus status =
+          readFrame(node.received, offset, type, payload);
+      if (status == FrameStatus::Malformed) {
+        return false;
+      }
+      if (status == FrameStatus::Incomplete) {
+        break;
+      }
+      if (!process(node, type, payload, pending) || node.fd < 0) {
+        return false;
+      }
+    }
+    node.received.erase(node.received.begin(),
+                        node.received.begin() +
+                            static_cast<ptrdiff_t>(offset));
+  }
+#else
+  (void)node;
+  (void)pending;
+  return false;
+#endif
+}
+
+bool Cluster::Coordinator::process(Peer &node, MessageType type,
+                                   std::span<const uint8_t> payload,
+                                   std::vector<Pending> &pending) {
+  if (!node.greeted) {
+    Hello hello;
+    if (type != MessageType::Hello || !decode(payload, hello) ||
+        hello.version != PROTOCOL_VERSION) {
+      return false;
+    }
+    node.greeted = true;
+    node.name = std::move(hello.name);
+    node.hashrate = hello.hashrate;
+    std::vector<uint8_t> frame;
+    encode(frame, Welcome{node.id});
+    send(node, frame);
+    if (mJob) {
+      send(node, mJob->frame);
+      grant(node);
+    }
+    return true;
+  }
+
+  if (type == MessageType::Progress) {
+    Progress progress;
+    if (!decode(payload, progress)) {
+      return false;
+    }
+    if (progress.hashrate != 0) {
+      node.hashrate = progress.hashrate;
+    }
+    if (!mJob || progress.job != mJob->id) {
+      return true;
+    }
+    // Everything before the position is searched
+    const auto lease =
+        std::find_if(node.leases.begin(), node.leases.end(),
+                     [&](const WorkRange &range) {
+                       return progress.position >= range.begin &&
+                              progress.position <= range.end;
+                     });
+    if (lease != node.leases.end()) {
+      for (auto done = node.leases.begin(); done != lease; ++done) {
+        node.searched += done->size();
+      }
+      node.searched += progress.position - lease->begin;
+      lease->begin = progress.position;
+      node.leases.erase(node.leases.begin(), lease);
+      if (node.leases.front().size() == 0) {
+        node.leases.pop_front();
+      }
+    }
+    grant(node);
+    return true;
+  }
+
+  if (type == MessageType::Solution) {
+    Solution solution;
+    if (!decode(payload, solution)) {
+      return false;
+    }
+    const JobState *job = nullptr;
+    const std::vector<WorkRange> *leases = nullptr;
+    if (mJob && solution.job == mJob->id) {
+      job = mJob.get();
+      leases = &node.granted;
+    } else if (mPrevious && solution.job == mPrevious->id) {
+      job = mPrevious.get();
+      leases = &node.previous;
+    }
+    if (job == nullptr ||
+        std::none_of(leases->begin(), leases->end(),
+                     [&](const WorkRange &range) {
+                       return range.contains(solution.index);
+                     })) {
+      ++node.rejected;
+      return true;
+    }
+    ++node.solutions;
+    Pending &resolved = pending.emplace_back();
+    resolved.node = node.id;
+    resolved.jobId = job->upstreamId;
+    resolved.extranonce2Size = job->extranonce2Size;
+    job->space.at(solution.index, resolved.extranonce2, resolved.versionBits);
+    resolved.time = solution.time;
+    resolved.nonce = solution.nonce;
+    return true;
+  }
+
+  // Only nodes speak first, and only once
+  return false;
+}
+
+void Cluster::Coordinator::grant(Peer &node) {
+  if (!mJob || node.fd < 0) {
+    return;
+  }
+  // Indices worth leaseTime at the node's rate; each is 2^32 hashes
+  const double seconds =
+      std::chrono::duration<double>(mConfig.leaseTime).count();
+  const double indices =
+      static_cast<double>(node.hashrate) * seconds / 4294967296.0;
+  const uint64_t size =
+      indices < 1 ? 1
+      : indices >= static_cast<double>(mJob->space.size())
+          ? mJob->space.size()
+          : static_cast<uint64_t>(indices);
+
+  uint64_t outstanding = 0;
+  for (const WorkRange &range : node.leases) {
+    outstanding += range.size();
+  }
+  std::vector<uint8_t> frames;
+  while (outstanding < size - size / 2) {
+    // Ranges of nodes gone first, then fresh space
+    WorkRange range;
+    if (!mJob->recycled.empty()) {
+      WorkRange &spare = mJob->recycled.back();
+      range = {spare.begin, spare.begin + std::min(spare.size(), size)};
+      spare.begin = range.end;
+      if (spare.size() == 0) {
+        mJob->recycled.pop_back();
+      }
+    } else if (mJob->cursor < mJob->space.size()) {
+      range = {mJob->cursor,
+               mJob->cursor +
+                   std::min(mJob->space.size() - mJob->cursor, size)};
+      mJob->cursor = range.end;
+    } else {
+      break; // the space is exhausted until the next job
+    }
+    node.leases.push_back(range);
+    node.granted.push_back(range);
+    outstanding += range.size();
+    encode(frames, Lease{mJob->id, range});
+  }
+  if (!frames.empty()) {
+    send(node, frames);
+  }
+}
+
+void Cluster::Coordinator::send(Peer &node, std::span<const uint8_t> frame) {
+  if (node.fd < 0) {
+    return;
+  }
+  const bool idle = node.sending.size() == node.sent;
+  node.sending.insert(node.sending.end(), frame.begin(), frame.end());
+  if (idle && !flush(node)) {
+    close(node);
+  }
+}
+
+bool Cluster::Coordinator::flush(Peer &node) {
+#ifdef HFM_CLUSTER_COORDINATOR_EPOLL
+  while (node.sent < node.sending.size()) {
+    const ssize_t n =
+        ::send(node.fd, node.sending.data() + node.sent,
+               node.sending.size() - node.sent, MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        return false;
+      }
+      break;
+    }
+    node.sent += static_cast<size_t>(n);
+  }
+  const bool writing = node.sent < node.sending.size();
+  if (!writing) {
+    node.sending.clear();
+    node.sent = 0;
+  }
+  if (writing != node.writing) {
+    epoll_event event{};
+    event.events = writing ? EPOLLIN | EPOLLOUT : EPOLLIN;
+    event.data.u64 = node.id;
+    ::epoll_ctl(mEpoll, EPOLL_CTL_MOD, node.fd, &event);
+    node.writing = writing;
+  }
+  return true;
+#else
+  (void)node;
+  return false;
+#endif
+}
+
+void Cluster::Coordinator::close(Peer &node) {
+#ifdef HFM_CLUSTER_COORDINATOR_EPOLL
+  if (node.fd < 0) {
+    return;
+  }
+  // What the node did not get to goes to the others
+  if (mJob) {
+    mJob->recycled.insert(mJob->recycled.end(), node.leases.begin(),
+                          node.leases.end());
+  }
+  node.leases.clear();
+  ::epoll_ctl(mEpoll, EPOLL_CTL_DEL, node.fd, nullptr);
+  ::close(node.fd);
+  node.fd = -1;
+#else
+  (void)node;
+#endif
+}
@@ -0,0 +1,133 @@
+#include "cluster/node.h"
+
+// system includes
+#include <stdexcept>
+#include <string_view>
+
+namespace Cluster {
+namespace Node_internal {
+
+// Largest frame: the type byte, a 9-byte CompactSize and the payload
+static constexpr size_t MAX_FRAME_SIZE = 1 + 9 + MAX_PAYLOAD_SIZE;
+
+// Frames are bytes; the connection sends chars
+static std::string_view asChars(const std::vector<uint8_t> &frame) {
+  return std::string_view(reinterpret_cast<const char *>(frame.data()),
+                          frame.size());
+}
+
+} // namespace Node_internal
+} // namespace Cluster
+
+Cluster::Node::Node(const NodeConfig &config)
+    : mConfig(config), mJobHandler(), mLeaseHandler(),
+      mConnection("the coordinator", Node_internal::MAX_FRAME_SIZE), mId(0),
+      mJob() {
+  mConnection.setReceiveHandler(
+      [this](std::span<const uint8_t> pending, size_t) {
+        return receive(pending);
+      });
+}
+
+Cluster::Node::~Node() = default;
+
+void Cluster::Node::connect() {
+  using namespace Node_internal;
+
+  mConnection.connect(mConfig.host, mConfig.port, mConfig.timeout);
+  mId = 0;
+  Hello hello;
+  hello.hashrate = mConfig.hashrate;
+  hello.name = mConfig.name;
+  std::vector<uint8_t> frame;
+  encode(frame, hello);
+  if (!mConnection.send(asChars(frame))) {
+    throw std::runtime_error("Coordinator closed the connection");
+  }
+
+  const auto deadline = std::chrono::steady_clock::now() + mConfig.timeout;
+  while (mId == 0) {
+    const auto remaining =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+    if (remaining.count() <= 0) {
+      mConnection.close();
+      throw std::runtime_error("Coordinator handshake timed out");
+    }
+    if (!poll(remaining)) {
+      throw std::runtime_error("Coordinator closed the connection");
+    }
+  }
+}
+
+void Cluster::Node::reportProgress(uint32_t job, uint64_t position,
+                                   uint64_t hashrate) {
+  std::vector<uint8_t> frame;
+  encode(frame, Progress{job, position, hashrate});
+  post(frame);
+}
+
+void Cluster::Node::submit(uint32_t job, uint64_t index, uint32_t time,
+                           uint32_t nonce) {
+  std::vector<uint8_t> frame;
+  encode(frame, Solution{job, index, time, nonce});
+  post(frame);
+}
+
+void Cluster::Node::post(const std::vector<uint8_t> &frame) {
+  using namespace Node_internal;
+
+  mConnection.post(
+      [&](std::string &outbox) { outbox.append(asChars(frame)); });
+}
+
+size_t Cluster::Node::receive(std::span<const uint8_t> pending) {
+  size_t offset = 0;
+  MessageType type{};
+  std::span<const uint8_t> payload;
+  for (;;) {
+    const FrameStatus status = readFrame(pending, offset, type, payload);
+    if (status == FrameStatus::Incomplete) {
+      return offset;
+    }
+    if (status == FrameStatus::Malformed || !process(type, payload)) {
+      mConnection.close();
+      return offset;
+    }
+  }
+}
+
+bool Cluster::Node::process(MessageType type,
+                            std::span<const uint8_t> payload) {
+  switch (type) {
+  case MessageType::Welcome: {
+    Welcome welcome;
+    if (!decode(payload, welcome)) {
+      return false;
+    }
+    mId = welcome.node;
+    return true;
+  }
+  case MessageType::Job:
+    if (!decode(payload, mJob)) {
+      return false;
+    }
+    if (mJobHandler) {
+      mJobHandler(mJob);
+    }
+    return true;
+  case MessageType::Lease: {
+    Lease lease;
+    if (!decode(payload, lease)) {
+      return false;
+    }
+    if (mLeaseHandler) {
+      mLeaseHandler(lease);
+    }
+    return true;
+  }
+  default:
+    // Nothing else flows towards nodes
+    return false;
+  }
+}
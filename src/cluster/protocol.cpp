@@ -0,0 +1,345 @@
+#include "cluster/protocol.h"
+
+// system includes
+#include <bit>
+#include <cstring>
+#include <stdexcept>
+
+// project includes
+#include "util/compactSize.h"
+#include "util/endian.h"
+
+namespace Cluster {
+namespace Protocol_internal {
+
+// Payload builder; frames are small and rare next to hashing
+class Writer {
+public:
+  inline void put8(uint8_t value) { mBytes.push_back(value); }
+  inline void put32(uint32_t value) {
+    uint8_t bytes[4];
+    util::WriteLE32(bytes, value);
+    put(bytes);
+  }
+  inline void put64(uint64_t value) {
+    uint8_t bytes[8];
+    util::WriteLE64(bytes, value);
+    put(bytes);
+  }
+  inline void putCompact(uint64_t value) {
+    uint8_t bytes[util::MAX_COMPACT_SIZE_LENGTH];
+    put(std::span<const uint8_t>(bytes, util::WriteCompactSize(bytes, value)));
+  }
+  inline void put(std::span<const uint8_t> bytes) {
+    mBytes.insert(mBytes.end(), bytes.begin(), bytes.end());
+  }
+  // Length-prefixed
+  inline void putBytes(std::span<const uint8_t> bytes) {
+    putCompact(bytes.size());
+    put(bytes);
+  }
+
+  // Append the frame header and the payload to out
+  void finish(std::vector<uint8_t> &out, MessageType type) const {
+    uint8_t header[1 + util::MAX_COMPACT_SIZE_LENGTH];
+    header[0] = static_cast<uint8_t>(type);
+    const size_t length = 1 + util::WriteCompactSize(header + 1, mBytes.size());
+    out.insert(out.end(), header, header + length);
+    out.insert(out.end(), mBytes.begin(), mBytes.end());
+  }
+
+private:
+  std::vector<uint8_t> mBytes;
+};
+
+// Payload parser; a failed read leaves it failed
+class Reader {
+public:
+  explicit Reader(std::span<const uint8_t> data)
+      : mData(data), mOffset(0), mOk(true) {}
+
+  inline bool get8(uint8_t &value) {
+    if (!need(1)) {
+      return false;
+    }
+    value = mData[mOffset++];
+    return true;
+  }
+  inline bool get32(uint32_t &value) {
+    if (!need(4)) {
+      return false;
+    }
+    value = util::ReadLE32(mData.data() + mOffset);
+    mOffset += 4;
+    return true;
+  }
+  inline bool get64(uint64_t &value) {
+    if (!need(8)) {
+      return false;
+    }
+    value = util::ReadLE64(mData.data() + mOffset);
+    mOffset += 8;
+    return true;
+  }
+  inline bool getCompact(uint64_t &value) {
+    mOk = mOk && util::ReadCompactSize(mData, mOffset, value);
+    return mOk;
+  }
+  inline bool get(uint8_t *out, size_t size) {
+    if (!need(size)) {
+      return false;
+    }
+    std::memcpy(out, mData.data() + mOffset, size);
+    mOffset += size;
+    return true;
+  }
+  // A length-prefixed view into the payload
+  inline bool getBytes(std::span<const uint8_t> &bytes) {
+    uint64_t size = 0;
+    if (!getCompact(size) || !need(size)) {
+      return false;
+    }
+    bytes = mData.subspan(mOffset, size);
+    mOffset += size;
+    return true;
+  }
+
+  // Whether everything was read, and nothing more
+  inline bool done() const { return mOk && mOffset == mData.size(); }
+
+private:
+  inline bool need(uint64_t size) {
+    mOk = mOk && mData.size() - mOffset >= size;
+    return mOk;
+  }
+
+  std::span<const uint8_t> mData;
+  size_t mOffset;
+  bool mOk;
+};
+
+static std::span<const uint8_t> asBytes(std::string_view text) {
+  return std::span<const uint8_t>(
+      reinterpret_cast<const uint8_t *>(text.data()), text.size());
+}
+
+} // namespace Protocol_internal
+} // namespace Cluster
+
+Cluster::WorkSpace::WorkSpace(size_t extranonce2Size, uint32_t versionMask)
+    : mExtranonce2Size(extranonce2Size), mVersionMask(versionMask),
+      mVersionBits(static_cast<unsigned>(std::popcount(versionMask))),
+      mBits(0) {
+  if (extranonce2Size > 8 || 8 * extranonce2Size + mVersionBits >= 64) {
+    throw std::invalid_argument(
+        "Work space must have fewer than 2^64 indices");
+  }
+  mBits = static_cast<unsigned>(8 * extranonce2Size) + mVersionBits;
+}
+
+void Cluster::WorkSpace::at(uint64_t index, uint8_t *extranonce2,
+                            uint32_t &versionBits) const {
+  // Scatter the low index bits into the mask, lowest bit first
+  versionBits = 0;
+  uint64_t bits = index;
+  for (uint32_t mask = mVersionMask; mask != 0; mask &= mask - 1) {
+    if ((bits & 1) != 0) {
+      versionBits |= mask & (~mask + 1);
+    }
+    bits >>= 1;
+  }
+  for (size_t i = 0; i < mExtranonce2Size; ++i) {
+    extranonce2[mExtranonce2Size - 1 - i] = static_cast<uint8_t>(bits);
+    bits >>= 8;
+  }
+}
+
+void Cluster::encode(std::vector<uint8_t> &out, const Hello &message) {
+  using namespace Protocol_internal;
+
+  Writer writer;
+  writer.put32(message.version);
+  writer.putCompact(message.hashrate);
+  writer.putBytes(asBytes(message.name));
+  writer.finish(out, MessageType::Hello);
+}
+
+void Cluster::encode(std::vector<uint8_t> &out, const Welcome &message) {
+  using namespace Protocol_internal;
+
+  Writer writer;
+  writer.put32(message.node);
+  writer.finish(out, MessageType::Welcome);
+}
+
+void Cluster::encode(std::vector<uint8_t> &out, const Job &message) {
+  using namespace Protocol_internal;
+
+  const Stratum::Notify &notify = message.notify;
+  Writer writer;
+  writer.put32(message.id);
+  writer.putBytes(asBytes(notify.jobId));
+  writer.put(notify.prevHash);
+  writer.putBytes(notify.coinbase1);
+  writer.putBytes(notify.coinbase2);
+  writer.putCompact(notify.merkleBranch.size());
+  for (const Hash &hash : notify.merkleBranch) {
+    writer.put(hash);
+  }
+  writer.put32(notify.version);
+  writer.put32(notify.bits);
+  writer.put32(notify.time);
+  writer.put8(notify.clean ? 1 : 0);
+  writer.putBytes(message.extranonce1);
+  writer.put8(static_cast<uint8_t>(message.extranonce2Size));
+  writer.put32(message.versionMask);
+  writer.finish(out, MessageType::Job);
+}
+
+void Cluster::encode(std::vector<uint8_t> &out, const Lease &message) {
+  using namespace Protocol_internal;
+
+  Writer writer;
+  writer.put32(message.job);
+  writer.put64(message.range.begin);
+  writer.put64(message.range.end);
+  writer.finish(out, MessageType::Lease);
+}
+
+void Cluster::encode(std::vector<uint8_t> &out, const Progress &message) {
+  using namespace Protocol_internal;
+
+  Writer writer;
+  writer.put32(message.job);
+  writer.put64(message.position);
+  writer.putCompact(message.hashrate);
+  writer.finish(out, MessageType::Progress);
+}
+
+void Cluster::encode(std::vector<uint8_t> &out, const Solution &message) {
+  using namespace Protocol_internal;
+
+  Writer writer;
+  writer.put32(message.job);
+  writer.put64(message.index);
+  writer.put32(message.time);
+  writer.put32(message.nonce);
+  writer.finish(out, MessageType::Solution);
+}
+
+bool Cluster::decode(std::span<const uint8_t> payload, Hello &message) {
+  using namespace Protocol_internal;
+
+  Reader reader(payload);
+  std::span<const uint8_t> name;
+  if (!reader.get32(message.version) ||
+      !reader.getCompact(message.hashrate) || !reader.getBytes(name)) {
+    return false;
+  }
+  message.name.assign(name.begin(), name.end());
+  return reader.done();
+}
+
+bool Cluster::decode(std::span<const uint8_t> payload, Welcome &message) {
+  using namespace Protocol_internal;
+
+  Reader reader(payload);
+  return reader.get32(message.node) && reader.done();
+}
+
+bool Cluster::decode(std::span<const uint8_t> payload, Job &message) {
+  using namespace Protocol_internal;
+
+  Stratum::Notify &notify = message.notify;
+  Reader reader(payload);
+  std::span<const uint8_t> bytes;
+  if (!reader.get32(message.id) || !reader.getBytes(bytes)) {
+    return false;
+  }
+  notify.jobId.assign(bytes.begin(), bytes.end());
+  if (!reader.get(notify.prevHash.data(), notify.prevHash.size()) ||
+      !reader.getBytes(bytes)) {
+    return false;
+  }
+  notify.coinbase1.assign(bytes.begin(), bytes.end());
+  uint64_t branch_size = 0;
+  if (!reader.getBytes(bytes) || !reader.getCompact(branch_size) ||
+      branch_size > payload.size() / sizeof(Hash)) {
+    return false;
+  }
+  notify.coinbase2.assign(bytes.begin(), bytes.end());
+  notify.merkleBranch.resize(branch_size);
+  for (Hash &hash : notify.merkleBranch) {
+    if (!reader.get(hash.data(), hash.size())) {
+      return false;
+    }
+  }
+  uint8_t clean = 0;
+  uint8_t extranonce2_size = 0;
+  if (!reader.get32(notify.version) || !reader.get32(notify.bits) ||
+      !reader.get32(notify.time) || !reader.get8(clean) || clean > 1 ||
+      !reader.getBytes(bytes) || !reader.get8(extranonce2_size) ||
+      !reader.get32(message.versionMask)) {
+    return false;
+  }
+  notify.clean = clean != 0;
+  message.extranonce1.assign(bytes.begin(), bytes.end());
+  message.extranonce2Size = extranonce2_size;
+  return reader.done();
+}
+
+bool Cluster::decode(std::span<const uint8_t> payload, Lease &message) {
+  using namespace Protocol_internal;
+
+  Reader reader(payload);
+  return reader.get32(message.job) && reader.get64(message.range.begin) &&
+         reader.get64(message.range.end) && reader.done() &&
+         message.range.begin < message.range.end;
+}
+
+bool Cluster::decode(std::span<const uint8_t> payload, Progress &message) {
+  using namespace Protocol_internal;
+
+  Reader reader(payload);
+  return reader.get32(message.job) && reader.get64(message.position) &&
+         reader.getCompact(message.hashrate) && reader.done();
+}
+
+bool Cluster::decode(std::span<const uint8_t> payload, Solution &message) {
+  using namespace Protocol_internal;
+
+  Reader reader(payload);
+  return reader.get32(message.job) && reader.get64(message.index) &&
+         reader.get32(message.time) && reader.get32(message.nonce) &&
+         reader.done();
+}
+
+Cluster::FrameStatus Cluster::readFrame(std::span<const uint8_t> data,
+                                        size_t &offset, MessageType &type,
+                                        std::span<const uint8_t> &payload) {
+  if (data.size() - offset < 2) {
+    return FrameStatus::Incomplete;
+  }
+  size_t position = offset + 1;
+  uint64_t size = 0;
+  if (!util::ReadCompactSize(data, position, size)) {
+    // A short read, unless the length is complete but non-canonical
+    const uint8_t first = data[offset + 1];
+    const size_t width = first < 0xfd    ? 1
+                         : first == 0xfd ? 3
+                         : first == 0xfe ? 5
+                                         : 9;
+    return data.size() - offset - 1 < width ? FrameStatus::Incomplete
+                                            : FrameStatus::Malformed;
+  }
+  if (size > MAX_PAYLOAD_SIZE) {
+    return FrameStatus::Malformed;
+  }
+  if (data.size() - position < size) {
+    return FrameStatus::Incomplete;
+  }
+  type = static_cast<MessageType>(data[offset]);
+  payload = data.subspan(position, size);
+  offset = position + size;
+  return FrameStatus::Complete;
+}
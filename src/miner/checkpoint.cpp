@@ -0,0 +1,163 @@
+#include "miner/checkpoint.h"
+
+// system includes
+#include <cerrno>
+#include <cstring>
+#include <system_error>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#define HFM_CHECKPOINT_MMAP 1
+#endif
+
+Miner::Checkpoint::Checkpoint(const std::string &path, unsigned int workers,
+                              std::chrono::milliseconds syncInterval)
+    : mWorkers(workers),
+      mSize(sizeof(FileHeader) + sizeof(Record) * SLOTS_PER_WORKER * workers),
+      mFd(-1), mMapping(nullptr), mSyncInterval(syncInterval), mSyncs(0),
+      mStopping(false) {
+#ifdef HFM_CHECKPOINT_MMAP
+  mFd = ::open(path.c_str(), O_RDWR | O_CREAT, 0644);
+  if (mFd < 0) {
+    throw std::system_error(errno, std::generic_category(),
+                            "Cannot open checkpoint " + path);
+  }
+
+  struct stat info;
+  if (::fstat(mFd, &info) != 0 ||
+      (static_cast<size_t>(info.st_size) != mSize &&
+       ::ftruncate(mFd, static_cast<off_t>(mSize)) != 0)) {
+    const int error = errno;
+    ::close(mFd);
+    throw std::system_error(error, std::generic_category(),
+                            "Cannot size checkpoint " + path);
+  }
+
+  mMapping = ::mmap(nullptr, mSize, PROT_READ | PROT_WRITE, MAP_SHARED, mFd, 0);
+  if (mMapping == MAP_FAILED) {
+    const int error = errno;
+    ::close(mFd);
+    throw std::system_error(error, std::generic_category(),
+                            "Cannot map checkpoint " + path);
+  }
+
+  // Records written for another layout or worker count are meaningless
+  FileHeader *header = static_cast<FileHeader *>(mMapping);
+  if (header->magic != MAGIC || header->format != FORMAT ||
+      header->workers != workers) {
+    std::memset(mMapping, 0, mSize);
+    header->magic = MAGIC;
+    header->format = FORMAT;
+    header->workers = workers;
+    ::msync(mMapping, mSize, MS_SYNC);
+  }
+#else
+  (void)path;
+  throw std::system_error(std::make_error_code(std::errc::not_supported),
+                          "Memory-mapped checkpoints are not supported");
+#endif
+
+  mFlusher = std::thread(&Checkpoint::run, this);
+}
+
+Miner::Checkpoint::~Checkpoint() {
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    mStopping = true;
+  }
+  mWake.notify_one();
+  if (mFlusher.joinable()) {
+    mFlusher.join();
+  }
+#ifdef HFM_CHECKPOINT_MMAP
+  sync();
+  ::munmap(mMapping, mSize);
+  ::close(mFd);
+#endif
+}
+
+uint64_t Miner::Checkpoint::checksum(const Record &record) {
+  // FNV-1a over the fields, independent of struct padding
+  uint64_t hash = 0xcbf29ce484222325;
+  const auto mix = [&hash](uint64_t value) {
+    for (int i = 0; i < 8; ++i) {
+      hash ^= (value >> (8 * i)) & 0xff;
+      hash *= 0x100000001b3;
+    }
+  };
+  mix(record.sequence);
+  mix(record.jobId);
+  mix(record.extranonce);
+  mix(record.nextNonce);
+  mix((uint64_t{record.version} << 32) | record.timestamp);
+  return hash;
+}
+
+Miner::Checkpoint::Record *Miner::Checkpoint::slot(unsigned int worker,
+                                                    unsigned int index) const {
+  Record *records = reinterpret_cast<Record *>(static_cast<char *>(mMapping) +
+                                               sizeof(FileHeader));
+  return &records[worker * SLOTS_PER_WORKER + index];
+}
+
+bool Miner::Checkpoint::load(unsigned int worker, Progress &progress) const {
+  if (worker >= mWorkers) {
+    return false;
+  }
+  const Record *newest = nullptr;
+  for (unsigned int i = 0; i < SLOTS_PER_WORKER; ++i) {
+    const Record *record = slot(worker, i);
+    if (record->sequence != 0 && record->checksum == checksum(*record) &&
+        (newest == nullptr || record->sequence > newest->sequence)) {
+      newest = record;
+    }
+  }
+  if (newest == nullptr) {
+    return false;
+  }
+  progress.jobId = newest->jobId;
+  progress.extranonce = newest->extranonce;
+  progress.version = newest->version;
+  progress.timestamp = newest->timestamp;
+  progress.nextNonce = newest->nextNonce;
+  return true;
+}
+
+void Miner::Checkpoint::store(unsigned int worker, const Progress &progress) {
+  // Overwrite the older slot so the newer one survives a torn write
+  Record *first = slot(worker, 0);
+  Record *second = slot(worker, 1);
+  const bool first_newer = first->sequence >= second->sequence;
+  Record *target = first_newer ? second : first;
+  const uint64_t sequence =
+      (first_newer ? first->sequence : second->sequence) + 1;
+
+  Record record{};
+  record.sequence = sequence;
+  record.jobId = progress.jobId;
+  record.extranonce = progress.extranonce;
+  record.nextNonce = progress.nextNonce;
+  record.version = progress.version;
+  record.timestamp = progress.timestamp;
+  record.checksum = checksum(record);
+  *target = record;
+}
+
+void Miner::Checkpoint::sync() {
+#ifdef HFM_CHECKPOINT_MMAP
+  ::msync(mMapping, mSize, MS_SYNC);
+#endif
+  mSyncs.fetch_add(1, std::memory_order_relaxed);
+}
+
+void Miner::Checkpoint::run() {
+  std::unique_lock<std::mutex> lock(mMutex);
+  while (!mWake.wait_for(lock, mSyncInterval, [this] { return mStopping; })) {
+    lock.unlock();
+    sync();
+    lock.lock();
+  }
+}
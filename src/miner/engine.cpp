@@ -0,0 +1,290 @@
+#include "miner/engine.h"
+
+// system includes
+#include <algorithm>
+
+Miner::Engine::Engine(const EngineConfig &config, ShareCallback onShare)
+    : mConfig(config), mOnShare(std::move(onShare)), mWorkers(), mThreads(),
+      mStarted(0), mCheckpoint(), mSlots(), mCurrent(nullptr),
+      mProducerMutex(), mEpoch(0), mStopping(false), mSwitchAcks(0),
+      mSwitchedEpoch(0), mLastSwitchLatency(0), mMaxSwitchLatency(0) {
+  const Topology topology = Topology::detect();
+  if (mConfig.threads == 0) {
+    mConfig.threads = topology.getDefaultThreadCount();
+  }
+  mConfig.checkInterval = std::max<uint32_t>(1, mConfig.checkInterval);
+  const std::vector<CpuInfo> cpus = topology.placement(mConfig.threads);
+  if (!mConfig.checkpointPath.empty()) {
+    mCheckpoint = std::make_unique<Checkpoint>(
+        mConfig.checkpointPath, mConfig.threads, mConfig.checkpointInterval);
+  }
+
+  // Size the worker table before starting any thread so each one sees the
+  // final worker count when it partitions the nonce space. The workers
+  // fill in their own entries once pinned.
+  mWorkers.resize(mConfig.threads);
+  for (unsigned int i = 0; i < mConfig.threads; ++i) {
+    mThreads.emplace_back(&Engine::run, this, i, cpus[i]);
+  }
+  for (unsigned int started = mStarted.load(std::memory_order_acquire);
+       started < mConfig.threads;
+       started = mStarted.load(std::memory_order_acquire)) {
+    mStarted.wait(started, std::memory_order_acquire);
+  }
+}
+
+Miner::Engine::~Engine() { stop(); }
+
+uint64_t Miner::Engine::setJob(const Job &job) {
+  return publish([&job](Job &slot) { slot = job; });
+}
+
+uint64_t Miner::Engine::publish(const JobBuilder &build) {
+  uint64_t epoch;
+  {
+    std::lock_guard<std::mutex> lock(mProducerMutex);
+    JobSnapshot &slot = acquireFreeSlot();
+    build(slot.job);
+    // Precompute the midstate once here instead of in every worker
+    slot.job.header.updateMidstate();
+
+    epoch = mEpoch.load(std::memory_order_relaxed) + 1;
+    slot.epoch = epoch;
+    slot.published = std::chrono::steady_clock::now();
+    mCurrent.store(&slot, std::memory_order_seq_cst);
+    mEpoch.store(epoch, std::memory_order_release);
+  }
+  // Wake idle workers; busy workers notice the new epoch on their next check
+  mEpoch.notify_all();
+  return epoch;
+}
+
+Miner::Engine::JobSnapshot &Miner::Engine::acquireFreeSlot() {
+  while (true) {
+    const JobSnapshot *current = mCurrent.load(std::memory_order_seq_cst);
+    for (auto &slot : mSlots) {
+      if (&slot == current) {
+        continue;
+      }
+      const bool protected_slot = std::any_of(
+          mWorkers.begin(), mWorkers.end(), [&slot](const auto &worker) {
+            return worker->hazard.load(std::memory_order_seq_cst) == &slot;
+          });
+      if (!protected_slot) {
+        return slot;
+      }
+    }
+    // Only reachable when workers are mid-copy from both older slots; their
+    // copies are short, so wait on the producer side
+    std::this_thread::yield();
+  }
+}
+
+bool Miner::Engine::copyCurrentJob(
+    Worker &worker, Job &job, uint64_t &epoch,
+    std::chrono::steady_clock::time_point &published) {
+  // Announce the snapshot before reading it, then confirm it is still
+  // current so the producer cannot have picked it for rebuilding
+  const JobSnapshot *snapshot = mCurrent.load(std::memory_order_seq_cst);
+  while (true) {
+    if (snapshot == nullptr) {
+      return false;
+    }
+    worker.hazard.store(snapshot, std::memory_order_seq_cst);
+    const JobSnapshot *confirmed = mCurrent.load(std::memory_order_seq_cst);
+    if (confirmed == snapshot) {
+      break;
+    }
+    snapshot = confirmed;
+  }
+
+  job = snapshot->job;
+  epoch = snapshot->epoch;
+  published = snapshot->published;
+  worker.hazard.store(nullptr, std::memory_order_release);
+  return true;
+}
+
+void Miner::Engine::stop() {
+  if (mStopping.exchange(true)) {
+    return;
+  }
+  mEpoch.fetch_add(1, std::memory_order_acq_rel);
+  mEpoch.notify_all();
+  for (std::thread &thread : mThreads) {
+    if (thread.joinable()) {
+      thread.join();
+    }
+  }
+}
+
+uint64_t Miner::Engine::getHashCount() const {
+  uint64_t total = 0;
+  for (const auto &worker : mWorkers) {
+    total += worker->hashes.load(std::memory_order_relaxed);
+  }
+  return total;
+}
+
+std::vector<Miner::CpuInfo> Miner::Engine::getWorkerCpus() const {
+  std::vector<CpuInfo> cpus;
+  for (const auto &worker : mWorkers) {
+    cpus.push_back(worker->cpu);
+  }
+  return cpus;
+}
+
+void Miner::Engine::acknowledgeEpoch(
+    uint64_t epoch, std::chrono::steady_clock::time_point published) {
+  const uint64_t workers = mWorkers.size();
+  uint64_t current = mSwitchAcks.load(std::memory_order_relaxed);
+  uint64_t next;
+  do {
+    const uint64_t acked_epoch = current >> 16;
+    if (acked_epoch > epoch) {
+      return; // A newer job is already being switched to
+    }
+    next = (acked_epoch == epoch ? current : epoch << 16) + 1;
+  } while (!mSwitchAcks.compare_exchange_weak(current, next,
+                                              std::memory_order_acq_rel,
+                                              std::memory_order_relaxed));
+
+  if ((next & 0xFFFF) != workers) {
+    return;
+  }
+
+  // Last worker to switch records the latency
+  const int64_t latency =
+      std::chrono::duration_cast<std::chrono::nanoseconds>(
+          std::chrono::steady_clock::now() - published)
+          .count();
+  mLastSwitchLatency.store(latency, std::memory_order_relaxed);
+  int64_t worst = mMaxSwitchLatency.load(std::memory_order_relaxed);
+  while (latency > worst &&
+         !mMaxSwitchLatency.compare_exchange_weak(worst, latency,
+                                                  std::memory_order_relaxed)) {
+  }
+  mSwitchedEpoch.store(epoch, std::memory_order_release);
+}
+
+void Miner::Engine::run(unsigned int index, CpuInfo cpu) {
+  // Pin before allocating the worker state or any per-thread buffer so
+  // first-touch places the pages on this CPU's NUMA node
+  if (mConfig.pinThreads) {
+    Topology::pinCurrentThread(cpu.id);
+  }
+  auto state = std::make_unique<Worker>();
+  state->index = index;
+  state->cpu = cpu;
+  Worker &worker = *state;
+  mWorkers[index] = std::move(state);
+  mStarted.fetch_add(1, std::memory_order_release);
+  mStarted.notify_all();
+
+  // Each worker owns a disjoint slice of the nonce space
+  const uint64_t nonce_space = uint64_t{1} << 32;
+  const uint64_t range_begin = nonce_space * worker.index / mWorkers.size();
+  const uint64_t range_end = nonce_space * (worker.index + 1) / mWorkers.size();
+
+  std::vector<Block::ScanHit> hits(64);
+  uint64_t epoch = 0;
+
+  while (true) {
+    // Sleep until a job newer than the one just finished is published
+    mEpoch.wait(epoch, std::memory_order_acquire);
+    if (mStopping.load(std::memory_order_acquire)) {
+      return;
+    }
+
+    Job job;
+    std::chrono::steady_clock::time_point published;
+    if (!copyCurrentJob(worker, job, epoch, published)) {
+      epoch = mEpoch.load(std::memory_order_acquire);
+      continue;
+    }
+    acknowledgeEpoch(epoch, published);
+    if (job.targets.empty()) {
+      continue;
+    }
+
+    Block::BlockHeader &header = job.header;
+    const uint32_t base_version = header.getVersion();
+    const uint32_t base_timestamp = header.getTimestamp();
+    const uint32_t mask = job.rolling.versionMask;
+    const uint32_t drift =
+        std::min(job.rolling.maxNtimeDrift, Block::MAX_FUTURE_BLOCK_TIME);
+    uint32_t rolled = base_version & mask;
+    uint32_t ntime_offset = 0;
+    uint64_t first_nonce = range_begin;
+
+    // Resume where a previous run of the same job stopped
+    Progress saved;
+    if (mCheckpoint && mCheckpoint->load(worker.index, saved) &&
+        saved.jobId == job.id && saved.extranonce == job.extranonce &&
+        saved.nextNonce >= range_begin && saved.nextNonce <= range_end &&
+        (saved.version & ~mask) == (base_version & ~mask) &&
+        saved.timestamp - base_timestamp <= drift) {
+      rolled = saved.version & mask;
+      ntime_offset = saved.timestamp - base_timestamp;
+      first_nonce = saved.nextNonce;
+      header.setVersion(saved.version);
+      header.setTimestamp(saved.timestamp);
+    }
+
+    bool stale = false;
+    while (!stale) {
+      for (uint64_t nonce = first_nonce; nonce < range_end;) {
+        const uint64_t count =
+            std::min<uint64_t>(mConfig.checkInterval, range_end - nonce);
+        const Block::ScanResult result = header.scanNonces(
+            static_cast<uint32_t>(nonce), count, job.targets, hits);
+        nonce += result.scanned;
+        worker.hashes.fetch_add(result.scanned, std::memory_order_relaxed);
+
+        for (size_t i = 0; i < result.hits; ++i) {
+          Share share;
+          share.jobId = job.id;
+          share.epoch = epoch;
+          share.nonce = hits[i].nonce;
+          share.version = header.getVersion();
+          share.timestamp = header.getTimestamp();
+          share.targetIndex = hits[i].targetIndex;
+          share.hash = hits[i].hash;
+          mOnShare(share);
+        }
+
+        // Advance the checkpoint only once the interval's shares are
+        // reported, so a crash never resumes past an unreported share.
+        // Memory writes only; the checkpoint thread batches the msync.
+        if (mCheckpoint) {
+          mCheckpoint->store(worker.index,
+                             {job.id, job.extranonce, header.getVersion(),
+                              header.getTimestamp(), nonce});
+        }
+
+        // Lock-free staleness check once per interval
+        if (mEpoch.load(std::memory_order_relaxed) != epoch) {
+          stale = true;
+          break;
+        }
+      }
+      if (stale) {
+        break;
+      }
+      first_nonce = range_begin;
+
+      // Nonce range exhausted: roll ntime first, then the version bits
+      if (ntime_offset < drift) {
+        ++ntime_offset;
+      } else {
+        ntime_offset = 0;
+        rolled = Block::nextRolledVersion(rolled, mask);
+        if (rolled == (base_version & mask)) {
+          break; // Every rolled combination searched, wait for a new job
+        }
+        header.setVersion((base_version & ~mask) | rolled);
+      }
+      header.setTimestamp(base_timestamp + ntime_offset);
+    }
+  }
+}
@@ -0,0 +1,75 @@
+#include "miner/jobPipeline.h"
+
+// system includes
+#include <utility>
+
+Miner::JobPipeline::JobPipeline(Engine &engine)
+    : mEngine(engine), mBusy(false), mStopping(false), mPublished(0),
+      mDropped(0), mLastBuildTime(0) {
+  mThread = std::thread(&JobPipeline::run, this);
+}
+
+Miner::JobPipeline::~JobPipeline() { stop(); }
+
+void Miner::JobPipeline::submit(Engine::JobBuilder build) {
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mPending) {
+      mDropped.fetch_add(1, std::memory_order_relaxed);
+    }
+    mPending = std::move(build);
+  }
+  mWake.notify_one();
+}
+
+void Miner::JobPipeline::flush() {
+  std::unique_lock<std::mutex> lock(mMutex);
+  mIdle.wait(lock, [this] { return mStopping || (!mPending && !mBusy); });
+}
+
+void Miner::JobPipeline::stop() {
+  {
+    std::lock_guard<std::mutex> lock(mMutex);
+    if (mStopping) {
+      return;
+    }
+    mStopping = true;
+    mPending = nullptr;
+  }
+  mWake.notify_one();
+  mIdle.notify_all();
+  if (mThread.joinable()) {
+    mThread.join();
+  }
+}
+
+void Miner::JobPipeline::run() {
+  while (true) {
+    Engine::JobBuilder build;
+    {
+      std::unique_lock<std::mutex> lock(mMutex);
+      mWake.wait(lock, [this] { return mStopping || mPending; });
+      if (mStopping) {
+        return;
+      }
+      build = std::move(mPending);
+      mPending = nullptr;
+      mBusy = true;
+    }
+
+    // Build into a free engine slot while the workers keep hashing
+    const auto start = std::chrono::steady_clock::now();
+    mEngine.publish(build);
+    mLastBuildTime.store(std::chrono::duration_cast<std::chrono::nanoseconds>(
+                             std::chrono::steady_clock::now() - start)
+                             .count(),
+                         std::memory_order_relaxed);
+    mPublished.fetch_add(1, std::memory_order_relaxed);
+
+    {
+      std::lock_guard<std::mutex> lock(mMutex);
+      mBusy = false;
+    }
+    mIdle.notify_all();
+  }
+}
@@ -0,0 +1,120 @@
+#ifndef __CHECKPOINT_H__
+#define __CHECKPOINT_H__
+
+// system includes
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace Miner {
+
+/// \brief Search progress of one worker on one job.
+struct Progress {
+  uint64_t jobId = 0;
+  uint64_t extranonce = 0;
+  uint32_t version = 0;   // header version including rolled bits
+  uint32_t timestamp = 0; // header ntime including the rolled offset
+  uint64_t nextNonce = 0; // first nonce not yet scanned
+};
+
+/// \brief Crash-safe, memory-mapped record of per-worker search progress.
+/// \note Each worker owns two 64-byte record slots in a shared file mapping.
+/// store() only writes to memory, never making a syscall, alternating
+/// between the slots with a sequence number and checksum, so a torn write
+/// leaves the previous record intact. A background thread msyncs the mapping
+/// every sync interval, batching all stores into one flush. After a restart
+/// load() returns the newest intact record of a worker.
+///
+/// The file is reset when its layout or worker count does not match, since
+/// the nonce ranges of the workers would differ.
+class Checkpoint {
+public:
+  /// \brief Map the checkpoint file, creating or resetting it as needed.
+  /// \param path File to map.
+  /// \param workers Number of worker records.
+  /// \param syncInterval Time between two background msyncs.
+  /// \throws std::system_error if the file cannot be opened or mapped, or
+  /// memory mapping is not supported on this platform.
+  Checkpoint(const std::string &path, unsigned int workers,
+             std::chrono::milliseconds syncInterval);
+
+  /// \brief Destructor. Flushes, unmaps and closes the file.
+  ~Checkpoint();
+
+  Checkpoint(const Checkpoint &) = delete;
+  Checkpoint &operator=(const Checkpoint &) = delete;
+
+  /// \brief Read the newest intact record of a worker.
+  /// \param worker Worker index.
+  /// \param progress Receives the record.
+  /// \return false if the worker has no intact record.
+  bool load(unsigned int worker, Progress &progress) const;
+
+  /// \brief Record a worker's progress. Memory writes only.
+  /// \param worker Worker index; only that worker may store to it.
+  /// \param progress Progress to record.
+  void store(unsigned int worker, const Progress &progress);
+
+  /// \brief Flush the mapping to disk now.
+  void sync();
+
+  /// \brief Number of flushes performed so far.
+  inline uint64_t getSyncCount() const {
+    return mSyncs.load(std::memory_order_relaxed);
+  }
+
+  /// \brief Number of worker records in the file.
+  inline unsigned int getWorkerCount() const { return mWorkers; }
+
+private:
+  /// \brief File header, padded to a cache line.
+  struct alignas(64) FileHeader {
+    uint64_t magic;
+    uint32_t format;
+    uint32_t workers;
+  };
+
+  /// \brief One record slot, one cache line.
+  struct alignas(64) Record {
+    uint64_t sequence; // 0 marks an empty slot
+    uint64_t jobId;
+    uint64_t extranonce;
+    uint64_t nextNonce;
+    uint32_t version;
+    uint32_t timestamp;
+    uint64_t checksum;
+  };
+
+  static constexpr uint64_t MAGIC = 0x54504b434d464848; // "HHFMCKPT"
+  static constexpr uint32_t FORMAT = 1;
+  static constexpr unsigned int SLOTS_PER_WORKER = 2;
+
+  /// \brief Checksum over every record field except the checksum itself.
+  static uint64_t checksum(const Record &record);
+
+  /// \brief Get a record slot of a worker.
+  Record *slot(unsigned int worker, unsigned int index) const;
+
+  /// \brief Background flusher body.
+  void run();
+
+  unsigned int mWorkers;
+  size_t mSize;
+  int mFd;
+  void *mMapping;
+
+  std::chrono::milliseconds mSyncInterval;
+  std::atomic<uint64_t> mSyncs;
+  std::mutex mMutex;
+  std::condition_variable mWake;
+  bool mStopping;
+  std::thread mFlusher;
+};
+
+} // namespace Miner
+#endif // __CHECKPOINT_H__
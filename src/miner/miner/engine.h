@@ -0,0 +1,232 @@
+#ifndef __ENGINE_H__
+#define __ENGINE_H__
+
+// system includes
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+// project includes
+#include "block/blockHeader.h"
+#include "block/search.h"
+#include "miner/checkpoint.h"
+#include "miner/topology.h"
+#include "types/types.h"
+#include "types/uint256.h"
+
+namespace Miner {
+
+/// \brief A unit of work handed to the engine.
+struct Job {
+  /// \brief Caller-assigned job identifier, reported back with each share.
+  uint64_t id = 0;
+
+  /// \brief Extranonce the coinbase was built with. Together with the id it
+  /// identifies the work when resuming from a checkpoint.
+  uint64_t extranonce = 0;
+
+  /// \brief Header template; the engine owns the nonce and rolled fields.
+  Block::BlockHeader header;
+
+  /// \brief Targets ordered easiest first (share, network, ...).
+  std::vector<uint256> targets;
+
+  /// \brief Version/ntime rolling allowed once a worker's nonce range is
+  /// exhausted. The nonce window fields are ignored; the engine partitions
+  /// the nonce space between workers.
+  Block::RollingPolicy rolling;
+};
+
+/// \brief A hash that met at least one job target.
+struct Share {
+  uint64_t jobId = 0;
+  uint64_t epoch = 0;
+  uint32_t nonce = 0;
+  uint32_t version = 0;
+  uint32_t timestamp = 0;
+  uint8_t targetIndex = 0;
+  Hash hash{};
+};
+
+/// \brief Engine tuning knobs.
+struct EngineConfig {
+  /// \brief Number of worker threads (0 selects one per allowed CPU, capped
+  /// by the cgroup CPU quota; see Topology::getDefaultThreadCount()).
+  unsigned int threads = 0;
+
+  /// \brief Pin each worker to its own CPU, physical cores before SMT
+  /// siblings (see Topology::placement()).
+  bool pinThreads = true;
+
+  /// \brief Hashes between two checks of the job epoch. Bounds the time a
+  /// worker keeps hashing a stale job.
+  uint32_t checkInterval = 1024;
+
+  /// \brief File recording each worker's progress (empty disables it). When
+  /// a job with the same id and extranonce is set after a restart, workers
+  /// resume from the recorded nonce and rolled version/ntime.
+  std::string checkpointPath;
+
+  /// \brief Time between two flushes of the checkpoint file.
+  std::chrono::milliseconds checkpointInterval{1000};
+};
+
+/// \brief Multi-threaded nonce search driven by a job epoch.
+/// \note Publishing a job bumps an atomic generation counter. Workers load
+/// it (no lock) every checkInterval hashes and switch to the new job as soon
+/// as it changes, so work on a stale job is bounded by one interval. The
+/// time from publication until every worker has picked the job up is
+/// measured and exposed as the job-switch latency.
+///
+/// Jobs live in a triple buffer. The current job is published through an
+/// atomic snapshot pointer (RCU style): a new job is built in a slot no
+/// worker can see and made current with a single pointer store. Workers
+/// protect the snapshot they copy from with a per-worker hazard pointer, so
+/// a slot is never rebuilt while a worker reads it and workers never take a
+/// lock.
+class Engine {
+public:
+  /// \brief Called from worker threads for every share; must be thread-safe.
+  using ShareCallback = std::function<void(const Share &)>;
+
+  /// \brief Fills a job in place inside a free slot.
+  using JobBuilder = std::function<void(Job &)>;
+
+  /// \brief Construct an engine. Workers start idle until the first job.
+  /// \param config Thread count and epoch check interval.
+  /// \param onShare Callback receiving every share found.
+  Engine(const EngineConfig &config, ShareCallback onShare);
+
+  /// \brief Destructor. Stops and joins all workers.
+  ~Engine();
+
+  Engine(const Engine &) = delete;
+  Engine &operator=(const Engine &) = delete;
+
+  /// \brief Publish a new job, abandoning the current one.
+  /// \param job Work to distribute between the workers.
+  /// \return The epoch assigned to the job.
+  uint64_t setJob(const Job &job);
+
+  /// \brief Build a job directly in a free slot and publish it.
+  /// \param build Callback filling the job; runs on the calling thread while
+  /// workers keep hashing the current job.
+  /// \return The epoch assigned to the job.
+  /// \note Producers are serialized with each other, never with workers.
+  uint64_t publish(const JobBuilder &build);
+
+  /// \brief Stop all workers. Safe to call more than once.
+  void stop();
+
+  /// \brief Get the epoch of the most recently published job.
+  inline uint64_t getEpoch() const {
+    return mEpoch.load(std::memory_order_acquire);
+  }
+
+  /// \brief Get the number of worker threads.
+  inline unsigned int getThreadCount() const {
+    return static_cast<unsigned int>(mWorkers.size());
+  }
+
+  /// \brief Total number of hashes computed by all workers.
+  uint64_t getHashCount() const;
+
+  /// \brief Progress checkpoint, or nullptr if disabled.
+  inline Checkpoint *getCheckpoint() const { return mCheckpoint.get(); }
+
+  /// \brief CPU assigned to each worker, in worker order.
+  std::vector<CpuInfo> getWorkerCpus() const;
+
+  /// \brief Time from the latest completed job switch until every worker was
+  /// hashing the new job.
+  inline std::chrono::nanoseconds getLastSwitchLatency() const {
+    return std::chrono::nanoseconds(
+        mLastSwitchLatency.load(std::memory_order_relaxed));
+  }
+
+  /// \brief Worst job-switch latency observed so far.
+  inline std::chrono::nanoseconds getMaxSwitchLatency() const {
+    return std::chrono::nanoseconds(
+        mMaxSwitchLatency.load(std::memory_order_relaxed));
+  }
+
+  /// \brief Epoch of the latest job every worker has switched to.
+  inline uint64_t getSwitchedEpoch() const {
+    return mSwitchedEpoch.load(std::memory_order_acquire);
+  }
+
+private:
+  /// \brief An immutable published job.
+  struct JobSnapshot {
+    Job job;
+    uint64_t epoch = 0;
+    std::chrono::steady_clock::time_point published;
+  };
+
+  /// \brief Per-thread search state.
+  /// \note Cache-line aligned so counters written by one worker never share
+  /// a line with another worker's. Fields written on the hot path come first
+  /// and the read-mostly fields start on the next line. Each worker
+  /// allocates its own state after pinning, so the pages are local to its
+  /// NUMA node.
+  struct alignas(64) Worker {
+    std::atomic<uint64_t> hashes{0};
+    std::atomic<const JobSnapshot *> hazard{nullptr};
+
+    alignas(64) unsigned int index = 0;
+    CpuInfo cpu;
+  };
+
+  /// \brief Find a slot that is neither current nor protected by a worker.
+  JobSnapshot &acquireFreeSlot();
+
+  /// \brief Copy the current job out of its snapshot.
+  /// \return false if no job has been published yet.
+  bool copyCurrentJob(Worker &worker, Job &job, uint64_t &epoch,
+                      std::chrono::steady_clock::time_point &published);
+
+  /// \brief Worker thread body.
+  /// \param index Worker index, the slot it publishes its state in.
+  /// \param cpu CPU to pin the thread to.
+  void run(unsigned int index, CpuInfo cpu);
+
+  /// \brief Record that a worker is now hashing the job of the given epoch.
+  /// \param epoch Epoch the worker switched to.
+  /// \param published When setJob() published that epoch.
+  void acknowledgeEpoch(uint64_t epoch,
+                        std::chrono::steady_clock::time_point published);
+
+  EngineConfig mConfig;
+  ShareCallback mOnShare;
+  std::vector<std::unique_ptr<Worker>> mWorkers;
+  std::vector<std::thread> mThreads;
+  std::atomic<unsigned int> mStarted; // workers that published their state
+  std::unique_ptr<Checkpoint> mCheckpoint;
+
+  // Triple-buffered jobs; workers copy from the current snapshot when they
+  // observe a new epoch
+  static constexpr size_t JOB_SLOTS = 3;
+  std::array<JobSnapshot, JOB_SLOTS> mSlots;
+  std::atomic<JobSnapshot *> mCurrent;
+  std::mutex mProducerMutex;
+
+  // Polled by every worker; kept apart from the counters written on a switch
+  alignas(64) std::atomic<uint64_t> mEpoch;
+  std::atomic<bool> mStopping;
+
+  // Job-switch latency tracking: (epoch << 16) | workers switched
+  alignas(64) std::atomic<uint64_t> mSwitchAcks;
+  std::atomic<uint64_t> mSwitchedEpoch;
+  std::atomic<int64_t> mLastSwitchLatency;
+  std::atomic<int64_t> mMaxSwitchLatency;
+};
+
+} // namespace Miner
+#endif // __ENGINE_H__
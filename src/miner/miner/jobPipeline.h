@@ -0,0 +1,84 @@
+#ifndef __JOB_PIPELINE_H__
+#define __JOB_PIPELINE_H__
+
+// system includes
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstdint>
+#include <mutex>
+#include <thread>
+
+// project includes
+#include "miner/engine.h"
+
+namespace Miner {
+
+/// \brief Prepares jobs on a producer thread while the engine mines.
+/// \note Template parsing, coinbase and Merkle root construction, header
+/// serialization and midstate precomputation all run inside the submitted
+/// builder on the producer thread, writing straight into a free engine slot.
+/// The finished job is then published with a pointer swap. Submissions are
+/// coalesced: if several arrive while one is being built, only the newest is
+/// built next and the older ones are dropped as stale.
+class JobPipeline {
+public:
+  /// \brief Start the producer thread.
+  /// \param engine Engine receiving the prepared jobs.
+  explicit JobPipeline(Engine &engine);
+
+  /// \brief Destructor. Stops the producer thread.
+  ~JobPipeline();
+
+  JobPipeline(const JobPipeline &) = delete;
+  JobPipeline &operator=(const JobPipeline &) = delete;
+
+  /// \brief Queue a job to be built and published. Returns immediately.
+  /// \param build Callback filling the job in place on the producer thread.
+  void submit(Engine::JobBuilder build);
+
+  /// \brief Block until every submitted job has been built or dropped.
+  void flush();
+
+  /// \brief Stop the producer thread. Pending submissions are discarded.
+  void stop();
+
+  /// \brief Number of jobs built and published.
+  inline uint64_t getPublishedCount() const {
+    return mPublished.load(std::memory_order_relaxed);
+  }
+
+  /// \brief Number of submissions superseded before they were built.
+  inline uint64_t getDroppedCount() const {
+    return mDropped.load(std::memory_order_relaxed);
+  }
+
+  /// \brief Time the producer spent building and publishing the last job.
+  inline std::chrono::nanoseconds getLastBuildTime() const {
+    return std::chrono::nanoseconds(
+        mLastBuildTime.load(std::memory_order_relaxed));
+  }
+
+private:
+  /// \brief Producer thread body.
+  void run();
+
+  Engine &mEngine;
+
+  // Latest submission, guarded by mMutex (producer side only)
+  std::mutex mMutex;
+  std::condition_variable mWake;
+  std::condition_variable mIdle;
+  Engine::JobBuilder mPending;
+  bool mBusy;
+  bool mStopping;
+
+  std::atomic<uint64_t> mPublished;
+  std::atomic<uint64_t> mDropped;
+  std::atomic<int64_t> mLastBuildTime;
+
+  std::thread mThread;
+};
+
+} // namespace Miner
+#endif // __JOB_PIPELINE_H__
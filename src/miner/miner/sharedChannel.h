@@ -0,0 +1,212 @@
+#ifndef __SHARED_CHANNEL_H__
+#define __SHARED_CHANNEL_H__
+
+// system includes
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <string>
+
+// project includes
+#include "block/packedHeader.h"
+#include "miner/engine.h"
+#include "sha256/sha256.h"
+#include "types/uint256.h"
+
+namespace Miner {
+
+/// \brief A job as read from a SharedChannel.
+struct SharedJob {
+  uint64_t id = 0;
+  uint64_t extranonce = 0;
+
+  /// \brief Header template; workers own the nonce and rolled fields.
+  Block::PackedHeader header;
+
+  /// \brief SHA-256 state after the first 64 header bytes, computed once by
+  /// the publisher.
+  std::array<uint32_t, 8> midstate{};
+
+  /// \brief Share target.
+  uint256 target;
+
+  /// \brief Get a SHA-256 context that resumes after the first 64 header
+  /// bytes; append the last 16 and finalize.
+  SHA256::SHA256::Context getMidstate() const;
+};
+
+/// \brief Ring sizes and waiting behaviour of a SharedChannel.
+struct SharedChannelConfig {
+  /// \brief Job slots, a power of two. A reader more than this many jobs
+  /// behind skips to the newest one.
+  size_t jobSlots = 16;
+
+  /// \brief Result slots, a power of two. pushResult() fails when the
+  /// reader is this many results behind.
+  size_t resultSlots = 4096;
+
+  /// \brief Polls of a ring before a waiter sleeps on its futex. Only the
+  /// owner's sizes count; the spin count is per process. Ignored on a
+  /// single CPU, where spinning only delays the writer.
+  uint32_t spinCount = 4096;
+};
+
+/// \brief Shared-memory job and result rings between the process that
+/// acquires work and the processes that hash it.
+/// \note The owner publishes jobs into a single-producer, multi-consumer
+/// ring. Every job slot is a seqlock: the slot sequence is odd while the
+/// 80-byte header template, its midstate and target are rewritten, and
+/// readers retry when it changed under them. Each reader keeps its own
+/// cursor, so jobs are never consumed away from other readers.
+///
+/// Workers push shares into a multi-producer, single-consumer ring of
+/// sequence-numbered slots: a producer claims a slot by advancing the tail
+/// with a compare-and-swap and hands it over by bumping the slot sequence.
+///
+/// Neither ring takes a lock or makes a syscall while both sides are busy.
+/// A waiter spins for spinCount polls, then registers as a waiter and
+/// sleeps on a futex word in the segment; a writer makes the wake syscall
+/// only when a waiter is registered. Each instance also counts its waits in
+/// a slot stamped with its pid and the process start time, so when a wake
+/// finds nobody asleep the owner takes back the waits of processes that
+/// died asleep, even if their pid was reused, instead of making wake
+/// syscalls for them forever. A producer that dies between claiming and
+/// filling a result slot stalls the result ring; the job ring is
+/// unaffected by readers dying.
+///
+/// An instance must not be used across fork(): the child would count its
+/// waits in the parent's slot. Open a new instance in the child instead.
+/// Linux only.
+class SharedChannel {
+public:
+  /// \brief Which end of the channel a process holds.
+  enum class Role {
+    /// \brief Creates or resets the segment, publishes jobs and reads
+    /// results. Closes the channel and removes the segment name when
+    /// destroyed.
+    Owner,
+
+    /// \brief Attaches to an existing segment, reads jobs and pushes
+    /// results.
+    Peer,
+  };
+
+  /// \brief Map a shared-memory segment.
+  /// \param name POSIX shared memory name, e.g. "/hfm-jobs".
+  /// \param role Owner creates the segment, peers attach to it.
+  /// \param config Ring sizes (owner only) and spin count.
+  /// \throws std::invalid_argument if a ring size is not a power of two.
+  /// \throws std::system_error if the segment cannot be opened or mapped,
+  /// or off Linux with std::errc::not_supported.
+  /// \throws std::runtime_error if a peer finds no valid segment.
+  SharedChannel(const std::string &name, Role role,
+                const SharedChannelConfig &config = {});
+
+  /// \brief Destructor. Unmaps the segment.
+  ~SharedChannel();
+
+  SharedChannel(const SharedChannel &) = delete;
+  SharedChannel &operator=(const SharedChannel &) = delete;
+
+  /// \brief Publish a job, computing its midstate. Owner only.
+  /// \param id Job identifier, reported back with each share.
+  /// \param extranonce Extranonce the coinbase was built with.
+  /// \param header Header template.
+  /// \param target Share target.
+  /// \return The job's position in the ring.
+  uint64_t publishJob(uint64_t id, uint64_t extranonce,
+                      const Block::PackedHeader &header,
+                      const uint256 &target);
+
+  /// \brief Read the job at a cursor without waiting.
+  /// \param cursor Position of the next job to read; advanced past the job
+  /// read. Start at 0, or at getJobCount() - 1 to begin with the newest.
+  /// \param job Receives the job.
+  /// \return false if no job has been published at the cursor yet.
+  bool readJob(uint64_t &cursor, SharedJob &job) const;
+
+  /// \brief Read the job at a cursor, waiting for it to be published.
+  /// \param timeout Longest wait; negative waits until a job arrives or
+  /// the channel closes.
+  /// \return false on timeout or once the channel is closed.
+  bool waitJob(uint64_t &cursor, SharedJob &job,
+               std::chrono::microseconds timeout);
+
+  /// \brief Number of jobs published so far.
+  uint64_t getJobCount() const;
+
+  /// \brief Push a share. Thread- and process-safe.
+  /// \return false if the result ring is full.
+  bool pushResult(const Share &share);
+
+  /// \brief Take the oldest share without waiting. Owner only.
+  /// \return false if the result ring is empty.
+  bool popResult(Share &share);
+
+  /// \brief Take the oldest share, waiting for one. Owner only.
+  /// \param timeout Longest wait; negative waits until a share arrives or
+  /// the channel closes.
+  /// \return false on timeout or once the channel is closed and drained.
+  bool waitResult(Share &share, std::chrono::microseconds timeout);
+
+  /// \brief Mark the channel closed and wake every waiter.
+  void close();
+
+  /// \brief Whether close() was called by any process.
+  bool isClosed() const;
+
+  /// \brief Number of futex wake syscalls this process made.
+  inline uint64_t getWakeCount() const {
+    return mWakes.load(std::memory_order_relaxed);
+  }
+
+private:
+  struct Segment;
+  struct JobSlot;
+  struct ResultSlot;
+  struct WaiterSlot;
+
+  /// \brief Make the wake syscall on a futex word if anyone sleeps on it.
+  void signal(std::atomic<uint32_t> &word,
+              const std::atomic<uint32_t> &waiters);
+
+  /// \brief Spin, then sleep on a futex word until poll() succeeds, the
+  /// channel closes or the timeout expires. Waits are counted in waiters
+  /// and in this instance's share of it, if it has a slot.
+  template <typename Poll>
+  bool wait(std::atomic<uint32_t> &word, std::atomic<uint32_t> &waiters,
+            std::atomic<uint32_t> *ownWaiters,
+            std::chrono::microseconds timeout, Poll poll);
+
+  /// \brief Claim a waiter slot and stamp it with this process, taking
+  /// over one of a dead process if all are taken. Instances beyond the
+  /// slots go without one.
+  void claimWaiterSlot();
+
+  /// \brief Take back the waits counted in a slot and free it.
+  /// \param holder Pid the slot must still hold.
+  /// \return false if someone else changed the slot first.
+  bool reclaimWaiterSlot(WaiterSlot &slot, uint32_t holder);
+
+  /// \brief Take back the waits of processes that died. Owner only.
+  void reapWaiters();
+
+  JobSlot *jobSlot(uint64_t position) const;
+  ResultSlot *resultSlot(uint64_t position) const;
+
+  std::string mName;
+  Role mRole;
+  uint32_t mSpinCount;
+  size_t mSize;
+  void *mMapping;
+  Segment *mSegment;
+  WaiterSlot *mWaiter;
+  size_t mJobMask;
+  size_t mResultMask;
+  std::atomic<uint64_t> mWakes;
+};
+
+} // namespace Miner
+#endif // __SHARED_CHANNEL_H__
@@ -0,0 +1,69 @@
+#ifndef __TOPOLOGY_H__
+#define __TOPOLOGY_H__
+
+// system includes
+#include <optional>
+#include <string>
+#include <vector>
+
+namespace Miner {
+
+/// \brief One logical CPU the process may run on.
+struct CpuInfo {
+  unsigned int id = 0;
+  int package = 0; // physical socket
+  int core = 0;    // physical core within the package
+  int node = 0;    // NUMA node
+};
+
+/// \brief CPU topology and limits visible to this process.
+/// \note Built from sysfs (packages, cores, NUMA nodes), the cgroup cpuset
+/// and CPU quota (v2 and v1 layouts; the v2 quota of the process's own
+/// cgroup, from /proc/self/cgroup, and its ancestors), and the scheduler
+/// affinity mask.
+/// Missing files degrade gracefully: on non-Linux systems the topology is a
+/// flat list of std::thread::hardware_concurrency() CPUs without a quota.
+class Topology {
+public:
+  /// \brief Read the topology of the running system.
+  /// \param root Prefix prepended to every sysfs, cgroup and proc path.
+  /// Tests point it at a fake tree; an empty root also applies the
+  /// scheduler affinity mask.
+  /// \return The detected topology.
+  static Topology detect(const std::string &root = "");
+
+  /// \brief Parse a kernel CPU list such as "0-3,8,10-11".
+  /// \param list CPU list string.
+  /// \return Sorted CPU ids; empty if the list is malformed.
+  static std::vector<unsigned int> parseCpuList(const std::string &list);
+
+  /// \brief Pin the calling thread to one logical CPU.
+  /// \param cpu Logical CPU id.
+  /// \return true if the affinity was applied.
+  static bool pinCurrentThread(unsigned int cpu);
+
+  /// \brief Logical CPUs the process is allowed to use.
+  inline const std::vector<CpuInfo> &getCpus() const { return mCpus; }
+
+  /// \brief CPU bandwidth quota in CPUs (e.g. 2.5), if one is set.
+  inline std::optional<double> getCpuQuota() const { return mQuota; }
+
+  /// \brief Default worker count: one per allowed CPU, capped by the quota.
+  /// \note The quota is rounded down (minimum 1) so a throttled container is
+  /// not oversubscribed.
+  unsigned int getDefaultThreadCount() const;
+
+  /// \brief Choose CPUs for a number of workers.
+  /// \param threads Number of workers.
+  /// \return One CPU per worker. Distinct physical cores are used first
+  /// (grouped by NUMA node and package) and SMT siblings only after every
+  /// core has a worker. Wraps around if threads exceeds the CPU count.
+  std::vector<CpuInfo> placement(unsigned int threads) const;
+
+private:
+  std::vector<CpuInfo> mCpus;
+  std::optional<double> mQuota;
+};
+
+} // namespace Miner
+#endif // __TOPOLOGY_H__
@@ -0,0 +1,623 @@
+#include "miner/sharedChannel.h"
+
+// system includes
+#include <algorithm>
+#include <cerrno>
+#include <charconv>
+#include <climits>
+#include <ctime>
+#include <new>
+#include <signal.h>
+#include <stdexcept>
+#include <string_view>
+#include <system_error>
+#include <thread>
+
+// project includes
+#include "util/endian.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <linux/futex.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <sys/syscall.h>
+#include <unistd.h>
+#define HFM_SHARED_CHANNEL_FUTEX 1
+#endif
+
+namespace Miner {
+
+/// \brief Waits registered through one SharedChannel instance, so the owner
+/// can take them back when the process that made them dies.
+struct SharedChannel::WaiterSlot {
+  std::atomic<uint32_t> pid; // 0 while free
+  std::atomic<uint64_t> started; // holder's start time, set before the pid
+  std::atomic<uint32_t> jobWaiters;
+  std::atomic<uint32_t> resultWaiters;
+};
+
+/// \brief Segment header; each line is written by one side.
+struct SharedChannel::Segment {
+  static constexpr size_t WAITER_SLOTS = 256;
+
+  // Set by the owner before the magic is published
+  alignas(64) std::atomic<uint64_t> magic;
+  uint32_t format;
+  uint32_t jobSlots;
+  uint32_t resultSlots;
+  std::atomic<uint32_t> closed;
+
+  // Job publisher
+  alignas(64) std::atomic<uint64_t> jobHead;
+  std::atomic<uint32_t> jobSignal;
+
+  // Job readers
+  alignas(64) std::atomic<uint32_t> jobWaiters;
+
+  // Result producers
+  alignas(64) std::atomic<uint64_t> resultTail;
+
+  // Result reader
+  alignas(64) std::atomic<uint64_t> resultHead;
+  std::atomic<uint32_t> resultSignal;
+  std::atomic<uint32_t> resultWaiters;
+
+  // Per-instance shares of the waiter counts
+  alignas(64) WaiterSlot waiters[WAITER_SLOTS];
+};
+
+namespace SharedChannel_internal {
+
+static constexpr uint64_t MAGIC = 0x4e4e414843464848; // "HHFCHANN"
+static constexpr uint32_t FORMAT = 3;
+
+// Marks a waiter slot being stamped or whose counts are being taken back
+static constexpr uint32_t RECLAIMING = UINT32_MAX;
+
+// Job payload in 64-bit words: id, extranonce, header, midstate, target
+static constexpr size_t HEADER_WORD = 2;
+static constexpr size_t MIDSTATE_WORD = HEADER_WORD + 10;
+static constexpr size_t TARGET_WORD = MIDSTATE_WORD + 4;
+static constexpr size_t JOB_WORDS = TARGET_WORD + 4;
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free &&
+                  std::atomic<uint32_t>::is_always_lock_free,
+              "Shared-memory atomics must be lock-free");
+static_assert(sizeof(std::atomic<uint32_t>) == sizeof(uint32_t),
+              "Futex words must be plain 32-bit integers");
+
+static bool isPowerOfTwo(size_t value) {
+  return value != 0 && (value & (value - 1)) == 0 && value <= UINT32_MAX;
+}
+
+static inline void relax() {
+#if defined(__x86_64__) || defined(__i386__)
+  __builtin_ia32_pause();
+#elif defined(__aarch64__)
+  asm volatile("yield");
+#endif
+}
+
+#ifdef HFM_SHARED_CHANNEL_FUTEX
+// Not FUTEX_PRIVATE_FLAG: the words are shared between processes
+static void futexWait(std::atomic<uint32_t> &word, uint32_t value,
+                      const timespec *timeout) {
+  ::syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word), FUTEX_WAIT,
+            value, timeout, nullptr, 0);
+}
+
+// Returns the number of waiters woken
+static long futexWake(std::atomic<uint32_t> &word) {
+  return ::syscall(SYS_futex, reinterpret_cast<uint32_t *>(&word),
+                   FUTEX_WAKE, INT_MAX, nullptr, nullptr, 0);
+}
+
+// Start time of a process in clock ticks since boot (field 22 of
+// /proc/<pid>/stat), or 0 if it cannot be read
+static uint64_t processStartTime(uint32_t pid) {
+  const std::string path = "/proc/" + std::to_string(pid) + "/stat";
+  const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+  if (fd < 0) {
+    return 0;
+  }
+  char buffer[1024];
+  const ssize_t n = ::read(fd, buffer, sizeof(buffer));
+  ::close(fd);
+  if (n <= 0) {
+    return 0;
+  }
+  // The command name (field 2) may hold spaces and parentheses: count the
+  // fields from the last ')'
+  const std::string_view stat(buffer, static_cast<size_t>(n));
+  size_t pos = stat.rfind(')');
+  for (int field = 3; field <= 22 && pos != std::string_view::npos;
+       ++field) {
+    pos = stat.find(' ', pos + 1);
+  }
+  uint64_t started = 0;
+  if (pos == std::string_view::npos ||
+      std::from_chars(stat.data() + pos + 1, stat.data() + stat.size(),
+                      started)
+              .ec != std::errc()) {
+    return 0;
+  }
+  return started;
+}
+
+// Whether the process that stamped a waiter slot still runs. Its pid may
+// have been reused since, so the start time must match as well; EPERM
+// means the process exists but belongs to someone else.
+static bool isAlive(uint32_t pid, uint64_t started) {
+  if (::kill(static_cast<pid_t>(pid), 0) != 0 && errno == ESRCH) {
+    return false;
+  }
+  const uint64_t current = processStartTime(pid);
+  return started == 0 || current == 0 || current == started;
+}
+#endif
+
+} // namespace SharedChannel_internal
+
+struct alignas(64) SharedChannel::JobSlot {
+  // 2p + 1 while job p is written, 2p + 2 once it is complete
+  std::atomic<uint64_t> sequence;
+  std::atomic<uint64_t> words[SharedChannel_internal::JOB_WORDS];
+};
+
+struct alignas(64) SharedChannel::ResultSlot {
+  // p when free for result p, p + 1 once it holds result p
+  std::atomic<uint64_t> sequence;
+  Share share;
+};
+
+} // namespace Miner
+
+SHA256::SHA256::Context Miner::SharedJob::getMidstate() const {
+  SHA256::SHA256::Context context{};
+  std::copy(midstate.begin(), midstate.end(), context.state);
+  context.n_bits = Block::PackedHeader::FIRST_BLOCK_SIZE * 8;
+  context.buffer_counter = 0;
+  return context;
+}
+
+Miner::SharedChannel::SharedChannel(const std::string &name, Role role,
+                                    const SharedChannelConfig &config)
+    : mName(name), mRole(role),
+      mSpinCount(std::thread::hardware_concurrency() > 1 ? config.spinCount
+                                                         : 0),
+      mSize(0), mMapping(nullptr), mSegment(nullptr), mWaiter(nullptr),
+      mJobMask(0), mResultMask(0), mWakes(0) {
+  using namespace SharedChannel_internal;
+
+#ifdef HFM_SHARED_CHANNEL_FUTEX
+  size_t job_slots = config.jobSlots;
+  size_t result_slots = config.resultSlots;
+  int fd = -1;
+  if (role == Role::Owner) {
+    if (!isPowerOfTwo(job_slots) || !isPowerOfTwo(result_slots)) {
+      throw std::invalid_argument("Ring sizes must be powers of two");
+    }
+    // A segment left by a crashed owner is replaced, never reused
+    ::shm_unlink(name.c_str());
+    fd = ::shm_open(name.c_str(), O_RDWR | O_CREAT | O_EXCL | O_CLOEXEC, 0600);
+    mSize = sizeof(Segment) + sizeof(JobSlot) * job_slots +
+            sizeof(ResultSlot) * result_slots;
+    if (fd >= 0 && ::ftruncate(fd, static_cast<off_t>(mSize)) != 0) {
+      const int error = errno;
+      ::close(fd);
+      ::shm_unlink(name.c_str());
+      throw std::system_error(error, std::generic_category(),
+                              "Cannot size shared memory " + name);
+    }
+  } else {
+    fd = ::shm_open(name.c_str(), O_RDWR | O_CLOEXEC, 0);
+    struct stat info;
+    if (fd >= 0 && ::fstat(fd, &info) != 0) {
+      const int error = errno;
+      ::close(fd);
+      throw std::system_error(error, std::generic_category(),
+                              "Cannot inspect shared memory " + name);
+    }
+    mSize = fd >= 0 ? static_cast<size_t>(info.st_size) : 0;
+    if (fd >= 0 && mSize < sizeof(Segment)) {
+      ::close(fd);
+      throw std::runtime_error("Shared memory " + name + " is not a channel");
+    }
+  }
+  if (fd < 0) {
+    throw std::system_error(errno, std::generic_category(),
+                            "Cannot open shared memory " + name);
+  }
+
+  mMapping = ::mmap(nullptr, mSize, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+  const int error = errno;
+  // The mapping keeps the segment alive
+  ::close(fd);
+  if (mMapping == MAP_FAILED) {
+    if (role == Role::Owner) {
+      ::shm_unlink(name.c_str());
+    }
+    throw std::system_error(error, std::generic_category(),
+                            "Cannot map shared memory " + name);
+  }
+  mSegment = static_cast<Segment *>(mMapping);
+
+  if (role == Role::Owner) {
+    // ftruncate zeroed the memory; construct the atomics over it
+    mJobMask = job_slots - 1;
+    mResultMask = result_slots - 1;
+    new (mSegment) Segment();
+    mSegment->format = FORMAT;
+    mSegment->jobSlots = static_cast<uint32_t>(job_slots);
+    mSegment->resultSlots = static_cast<uint32_t>(result_slots);
+    for (size_t i = 0; i < job_slots; ++i) {
+      new (jobSlot(i)) JobSlot();
+    }
+    for (size_t i = 0; i < result_slots; ++i) {
+      ResultSlot *slot = new (resultSlot(i)) ResultSlot();
+      slot->sequence.store(i, std::memory_order_relaxed);
+    }
+    mSegment->magic.store(MAGIC, std::memory_order_release);
+  } else {
+    // The sizes are only valid once the magic is
+    const bool published =
+        mSegment->magic.load(std::memory_order_acquire) == MAGIC;
+    job_slots = published ? mSegment->jobSlots : 0;
+    result_slots = published ? mSegment->resultSlots : 0;
+    if (!published || mSegment->format != FORMAT ||
+        !isPowerOfTwo(job_slots) ||
+        !isPowerOfTwo(result_slots) ||
+        mSize != sizeof(Segment) + sizeof(JobSlot) * job_slots +
+                     sizeof(ResultSlot) * result_slots) {
+      ::munmap(mMapping, mSize);
+      throw std::runtime_error("Shared memory " + name + " is not a channel");
+    }
+    mJobMask = job_slots - 1;
+    mResultMask = result_slots - 1;
+  }
+  claimWaiterSlot();
+#else
+  (void)config;
+  throw std::system_error(std::make_error_code(std::errc::not_supported),
+                          "Shared channels need futexes");
+#endif
+}
+
+Miner::SharedChannel::~SharedChannel() {
+#ifdef HFM_SHARED_CHANNEL_FUTEX
+  if (mRole == Role::Owner) {
+    // Peers blocked on the owner must not wait forever
+    close();
+    ::shm_unlink(mName.c_str());
+  }
+  if (mWaiter != nullptr) {
+    mWaiter->started.store(0, std::memory_order_relaxed);
+    mWaiter->pid.store(0, std::memory_order_release);
+  }
+  ::munmap(mMapping, mSize);
+#endif
+}
+
+uint64_t Miner::SharedChannel::publishJob(uint64_t id, uint64_t extranonce,
+                                          const Block::PackedHeader &header,
+                                          const uint256 &target) {
+  using namespace SharedChannel_internal;
+
+  uint64_t words[JOB_WORDS];
+  words[0] = id;
+  words[1] = extranonce;
+  for (size_t i = 0; i < 10; ++i) {
+    words[HEADER_WORD + i] = util::ReadLE64(header.data() + 8 * i);
+  }
+  SHA256::SHA256::Context context;
+  SHA256::SHA256::init(context);
+  SHA256::SHA256::append(context, header.data(),
+                         Block::PackedHeader::FIRST_BLOCK_SIZE);
+  for (size_t i = 0; i < 4; ++i) {
+    words[MIDSTATE_WORD + i] = context.state[2 * i] |
+                               uint64_t{context.state[2 * i + 1]} << 32;
+  }
+  for (int i = 0; i < uint256::WIDTH; ++i) {
+    words[TARGET_WORD + static_cast<size_t>(i)] = target.GetLimb(i);
+  }
+
+  // The fence keeps the payload stores after the odd sequence
+  const uint64_t position =
+      mSegment->jobHead.load(std::memory_order_relaxed);
+  JobSlot *slot = jobSlot(position);
+  slot->sequence.store(2 * position + 1, std::memory_order_relaxed);
+  std::atomic_thread_fence(std::memory_order_release);
+  for (size_t i = 0; i < JOB_WORDS; ++i) {
+    slot->words[i].store(words[i], std::memory_order_relaxed);
+  }
+  slot->sequence.store(2 * position + 2, std::memory_order_release);
+  mSegment->jobHead.store(position + 1, std::memory_order_release);
+
+  signal(mSegment->jobSignal, mSegment->jobWaiters);
+  return position;
+}
+
+bool Miner::SharedChannel::readJob(uint64_t &cursor, SharedJob &job) const {
+  using namespace SharedChannel_internal;
+
+  uint64_t words[JOB_WORDS];
+  uint64_t position = 0;
+  for (;;) {
+    const uint64_t head = mSegment->jobHead.load(std::memory_order_acquire);
+    if (cursor >= head) {
+      return false;
+    }
+    // A lapped reader skips to the newest job
+    position = head - cursor > mJobMask + 1 ? head - 1 : cursor;
+    const JobSlot *slot = jobSlot(position);
+    const uint64_t complete = 2 * position + 2;
+    if (slot->sequence.load(std::memory_order_acquire) != complete) {
+      continue; // Rewritten since the head was read
+    }
+    for (size_t i = 0; i < JOB_WORDS; ++i) {
+      words[i] = slot->words[i].load(std::memory_order_relaxed);
+    }
+    // The fence keeps the payload loads before the sequence check
+    std::atomic_thread_fence(std::memory_order_acquire);
+    if (slot->sequence.load(std::memory_order_relaxed) == complete) {
+      break;
+    }
+  }
+
+  job.id = words[0];
+  job.extranonce = words[1];
+  uint8_t bytes[Block::PackedHeader::SIZE];
+  for (size_t i = 0; i < 10; ++i) {
+    util::WriteLE64(bytes + 8 * i, words[HEADER_WORD + i]);
+  }
+  job.header = Block::PackedHeader(bytes);
+  for (size_t i = 0; i < 4; ++i) {
+    job.midstate[2 * i] = static_cast<uint32_t>(words[MIDSTATE_WORD + i]);
+    job.midstate[2 * i + 1] =
+        static_cast<uint32_t>(words[MIDSTATE_WORD + i] >> 32);
+  }
+  for (int i = 0; i < uint256::WIDTH; ++i) {
+    job.target.SetLimb(i, words[TARGET_WORD + static_cast<size_t>(i)]);
+  }
+  cursor = position + 1;
+  return true;
+}
+
+bool Miner::SharedChannel::waitJob(uint64_t &cursor, SharedJob &job,
+                                   std::chrono::microseconds timeout) {
+  return wait(mSegment->jobSignal, mSegment->jobWaiters,
+              mWaiter != nullptr ? &mWaiter->jobWaiters : nullptr, timeout,
+              [&] { return readJob(cursor, job); });
+}
+
+uint64_t Miner::SharedChannel::getJobCount() const {
+  return mSegment->jobHead.load(std::memory_order_acquire);
+}
+
+bool Miner::SharedChannel::pushResult(const Share &share) {
+  uint64_t position = mSegment->resultTail.load(std::memory_order_relaxed);
+  for (;;) {
+    ResultSlot *slot = resultSlot(position);
+    const uint64_t sequence = slot->sequence.load(std::memory_order_acquire);
+    const int64_t difference = static_cast<int64_t>(sequence - position);
+    if (difference < 0) {
+      return false; // Still holds the result one lap back
+    }
+    if (difference > 0) {
+      // Another producer claimed it
+      position = mSegment->resultTail.load(std::memory_order_relaxed);
+      continue;
+    }
+    if (mSegment->resultTail.compare_exchange_weak(
+            position, position + 1, std::memory_order_relaxed)) {
+      slot->share = share;
+      slot->sequence.store(position + 1, std::memory_order_release);
+      break;
+    }
+  }
+  signal(mSegment->resultSignal, mSegment->resultWaiters);
+  return true;
+}
+
+bool Miner::SharedChannel::popResult(Share &share) {
+  const uint64_t position =
+      mSegment->resultHead.load(std::memory_order_relaxed);
+  ResultSlot *slot = resultSlot(position);
+  if (slot->sequence.load(std::memory_order_acquire) != position + 1) {
+    return false;
+  }
+  share = slot->share;
+  slot->sequence.store(position + mResultMask + 1, std::memory_order_release);
+  mSegment->resultHead.store(position + 1, std::memory_order_relaxed);
+  return true;
+}
+
+bool Miner::SharedChannel::waitResult(Share &share,
+                                      std::chrono::microseconds timeout) {
+  return wait(mSegment->resultSignal, mSegment->resultWaiters,
+              mWaiter != nullptr ? &mWaiter->resultWaiters : nullptr,
+              timeout, [&] { return popResult(share); });
+}
+
+void Miner::SharedChannel::close() {
+  mSegment->closed.store(1, std::memory_order_seq_cst);
+  signal(mSegment->jobSignal, mSegment->jobWaiters);
+  signal(mSegment->resultSignal, mSegment->resultWaiters);
+}
+
+bool Miner::SharedChannel::isClosed() const {
+  return mSegment->closed.load(std::memory_order_seq_cst) != 0;
+}
+
+void Miner::SharedChannel::signal(std::atomic<uint32_t> &word,
+                                  const std::atomic<uint32_t> &waiters) {
+  using namespace SharedChannel_internal;
+
+  // Pairs with the waiter registering before it reads the word: either the
+  // waiter sees the new value and does not sleep, or the waiter is seen here
+  word.fetch_add(1, std::memory_order_seq_cst);
+  if (waiters.load(std::memory_order_seq_cst) == 0) {
+    return;
+  }
+#ifdef HFM_SHARED_CHANNEL_FUTEX
+  const long woken = futexWake(word);
+  mWakes.fetch_add(1, std::memory_order_relaxed);
+  // Nobody was asleep: a registered waiter may have died
+  if (woken == 0 && mRole == Role::Owner) {
+    reapWaiters();
+  }
+#endif
+}
+
+void Miner::SharedChannel::claimWaiterSlot() {
+  using namespace SharedChannel_internal;
+
+#ifdef HFM_SHARED_CHANNEL_FUTEX
+  const uint32_t pid = static_cast<uint32_t>(::getpid());
+  const uint64_t started = processStartTime(pid);
+  // Stamp the slot before publishing the pid, so whoever reads the pid
+  // sees the start time that goes with it
+  const auto claim = [&](WaiterSlot &slot) {
+    uint32_t free = 0;
+    if (!slot.pid.compare_exchange_strong(free, RECLAIMING,
+                                          std::memory_order_acq_rel)) {
+      return false;
+    }
+    slot.started.store(started, std::memory_order_relaxed);
+    slot.pid.store(pid, std::memory_order_release);
+    mWaiter = &slot;
+    return true;
+  };
+  for (WaiterSlot &slot : mSegment->waiters) {
+    if (claim(slot)) {
+      return;
+    }
+  }
+  // All taken: take over one left behind by a process that died
+  for (WaiterSlot &slot : mSegment->waiters) {
+    const uint32_t holder = slot.pid.load(std::memory_order_acquire);
+    if (holder != 0 && holder != RECLAIMING &&
+        !isAlive(holder, slot.started.load(std::memory_order_relaxed)) &&
+        reclaimWaiterSlot(slot, holder) && claim(slot)) {
+      return;
+    }
+  }
+  // Without a slot this instance's waits are only in the shared counts
+#endif
+}
+
+bool Miner::SharedChannel::reclaimWaiterSlot(WaiterSlot &slot,
+                                             uint32_t holder) {
+  using namespace SharedChannel_internal;
+
+  // The counts are taken back before the slot can be claimed again
+  if (!slot.pid.compare_exchange_strong(holder, RECLAIMING,
+                                        std::memory_order_acq_rel)) {
+    return false;
+  }
+  mSegment->jobWaiters.fetch_sub(
+      slot.jobWaiters.exchange(0, std::memory_order_relaxed),
+      std::memory_order_seq_cst);
+  mSegment->resultWaiters.fetch_sub(
+      slot.resultWaiters.exchange(0, std::memory_order_relaxed),
+      std::memory_order_seq_cst);
+  slot.started.store(0, std::memory_order_relaxed);
+  slot.pid.store(0, std::memory_order_release);
+  return true;
+}
+
+void Miner::SharedChannel::reapWaiters() {
+  using namespace SharedChannel_internal;
+
+#ifdef HFM_SHARED_CHANNEL_FUTEX
+  // Only slots holding waits cost wake syscalls; the rest are reclaimed by
+  // the next peer that finds no free slot
+  for (WaiterSlot &slot : mSegment->waiters) {
+    const uint32_t holder = slot.pid.load(std::memory_order_acquire);
+    if (holder == 0 || holder == RECLAIMING ||
+        (slot.jobWaiters.load(std::memory_order_relaxed) == 0 &&
+         slot.resultWaiters.load(std::memory_order_relaxed) == 0)) {
+      continue;
+    }
+    if (!isAlive(holder, slot.started.load(std::memory_order_relaxed))) {
+      reclaimWaiterSlot(slot, holder);
+    }
+  }
+#endif
+}
+
+template <typename Poll>
+bool Miner::SharedChannel::wait(std::atomic<uint32_t> &word,
+                                std::atomic<uint32_t> &waiters,
+                                std::atomic<uint32_t> *ownWaiters,
+                                std::chrono::microseconds timeout,
+                                Poll poll) {
+  using namespace SharedChannel_internal;
+
+  for (uint32_t i = 0; i < mSpinCount; ++i) {
+    if (poll()) {
+      return true;
+    }
+    relax();
+  }
+
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  for (;;) {
+    // Shared count first and taken back last: a process killed in between
+    // leaves a count too high, never too low
+    waiters.fetch_add(1, std::memory_order_seq_cst);
+    if (ownWaiters != nullptr) {
+      ownWaiters->fetch_add(1, std::memory_order_relaxed);
+    }
+    const uint32_t value = word.load(std::memory_order_seq_cst);
+    bool ready = poll();
+    bool expired = false;
+    if (!ready && !isClosed()) {
+      timespec remaining{};
+      const timespec *limit = nullptr;
+      if (timeout.count() >= 0) {
+        const auto left = std::chrono::duration_cast<std::chrono::nanoseconds>(
+            deadline - std::chrono::steady_clock::now());
+        expired = left.count() <= 0;
+        remaining.tv_sec = static_cast<time_t>(left.count() / 1000000000);
+        remaining.tv_nsec = static_cast<long>(left.count() % 1000000000);
+        limit = &remaining;
+      }
+#ifdef HFM_SHARED_CHANNEL_FUTEX
+      if (!expired) {
+        futexWait(word, value, limit);
+      }
+#else
+      (void)value;
+      (void)limit;
+#endif
+    }
+    if (ownWaiters != nullptr) {
+      ownWaiters->fetch_sub(1, std::memory_order_relaxed);
+    }
+    waiters.fetch_sub(1, std::memory_order_seq_cst);
+    if (ready) {
+      return true;
+    }
+    // A wake, a timeout or a signal; look once more before giving up
+    if (expired || isClosed()) {
+      return poll();
+    }
+  }
+}
+
+Miner::SharedChannel::JobSlot *
+Miner::SharedChannel::jobSlot(uint64_t position) const {
+  JobSlot *slots = reinterpret_cast<JobSlot *>(
+      static_cast<char *>(mMapping) + sizeof(Segment));
+  return &slots[position & mJobMask];
+}
+
+Miner::SharedChannel::ResultSlot *
+Miner::SharedChannel::resultSlot(uint64_t position) const {
+  ResultSlot *slots = reinterpret_cast<ResultSlot *>(
+      static_cast<char *>(mMapping) + sizeof(Segment) +
+      sizeof(JobSlot) * (mJobMask + 1));
+  return &slots[position & mResultMask];
+}
@@ -0,0 +1,280 @@
+#include "miner/topology.h"
+
+// system includes
+#include <algorithm>
+#include <cmath>
+#include <filesystem>
+#include <fstream>
+#include <map>
+#include <set>
+#include <sstream>
+#include <thread>
+#include <tuple>
+
+#ifdef __linux__
+#include <pthread.h>
+#include <sched.h>
+#endif
+
+namespace Miner {
+
+namespace Topology_internal {
+
+// Read the first line of a file; empty if it does not exist
+static std::string readLine(const std::string &path) {
+  std::ifstream file(path);
+  std::string line;
+  if (file) {
+    std::getline(file, line);
+  }
+  return line;
+}
+
+// Read an integer from a sysfs file, with a fallback
+static int readInt(const std::string &path, int fallback) {
+  const std::string line = readLine(path);
+  try {
+    return line.empty() ? fallback : std::stoi(line);
+  } catch (const std::exception &) {
+    return fallback;
+  }
+}
+
+// CPUs allowed by the cgroup cpuset, or every online CPU
+static std::vector<unsigned int> allowedCpus(const std::string &root) {
+  for (const char *path : {"/sys/fs/cgroup/cpuset.cpus.effective",
+                           "/sys/fs/cgroup/cpuset/cpuset.effective_cpus",
+                           "/sys/fs/cgroup/cpuset/cpuset.cpus",
+                           "/sys/devices/system/cpu/online"}) {
+    std::vector<unsigned int> cpus =
+        Topology::parseCpuList(readLine(root + path));
+    if (!cpus.empty()) {
+      return cpus;
+    }
+  }
+  return {};
+}
+
+// This process's cgroup v2 path (the "0::" line of /proc/self/cgroup), or
+// empty if it has none
+static std::string ownCgroup(const std::string &root) {
+  std::ifstream file(root + "/proc/self/cgroup");
+  std::string line;
+  while (std::getline(file, line)) {
+    if (line.rfind("0::", 0) == 0) {
+      return line.substr(3);
+    }
+  }
+  return {};
+}
+
+// Parse a cgroup v2 cpu.max line: "<quota> <period>", or "max <period>"
+static std::optional<double> parseCpuMax(const std::string &max) {
+  std::istringstream fields(max);
+  std::string quota;
+  double period = 0;
+  fields >> quota >> period;
+  if (quota != "max" && period > 0) {
+    try {
+      return std::stod(quota) / period;
+    } catch (const std::exception &) {
+      return std::nullopt;
+    }
+  }
+  return std::nullopt;
+}
+
+// CPU quota from cgroup v2 (cpu.max) or v1 (cfs quota/period)
+static std::optional<double> cpuQuota(const std::string &root) {
+  // The process's own cgroup and each of its ancestors may set cpu.max;
+  // the smallest applies. The root file is read last.
+  std::string cgroup = ownCgroup(root);
+  bool found = false;
+  std::optional<double> smallest;
+  for (;;) {
+    const std::string max =
+        readLine(root + "/sys/fs/cgroup" + cgroup + "/cpu.max");
+    if (!max.empty()) {
+      found = true;
+      const std::optional<double> limit = parseCpuMax(max);
+      if (limit && (!smallest || *limit < *smallest)) {
+        smallest = limit;
+      }
+    }
+    const size_t parent = cgroup.rfind('/');
+    if (parent == std::string::npos || cgroup == "/") {
+      break;
+    }
+    cgroup.erase(parent);
+  }
+  if (found) {
+    return smallest;
+  }
+
+  const int quota = readInt(root + "/sys/fs/cgroup/cpu/cpu.cfs_quota_us", -1);
+  const int period =
+      readInt(root + "/sys/fs/cgroup/cpu/cpu.cfs_period_us", 100000);
+  if (quota > 0 && period > 0) {
+    return static_cast<double>(quota) / period;
+  }
+  return std::nullopt;
+}
+
+// Map every CPU to its NUMA node
+static std::map<unsigned int, int> numaNodes(const std::string &root) {
+  std::map<unsigned int, int> nodes;
+  const std::filesystem::path base = root + "/sys/devices/system/node";
+  std::error_code error;
+  for (const auto &entry :
+       std::filesystem::directory_iterator(base, error)) {
+    const std::string name = entry.path().filename().string();
+    if (name.rfind("node", 0) != 0 || name.size() == 4 ||
+        !std::all_of(name.begin() + 4, name.end(), ::isdigit)) {
+      continue;
+    }
+    const int node = std::stoi(name.substr(4));
+    for (unsigned int cpu :
+         Topology::parseCpuList(readLine(entry.path().string() + "/cpulist"))) {
+      nodes[cpu] = node;
+    }
+  }
+  return nodes;
+}
+
+} // namespace Topology_internal
+
+std::vector<unsigned int> Topology::parseCpuList(const std::string &list) {
+  std::set<unsigned int> cpus;
+  std::istringstream ranges(list);
+  std::string range;
+  while (std::getline(ranges, range, ',')) {
+    if (range.empty()) {
+      continue;
+    }
+    try {
+      const size_t dash = range.find('-');
+      const unsigned long first = std::stoul(range.substr(0, dash));
+      const unsigned long last = dash == std::string::npos
+                                     ? first
+                                     : std::stoul(range.substr(dash + 1));
+      if (last < first) {
+        return {};
+      }
+      for (unsigned long cpu = first; cpu <= last; ++cpu) {
+        cpus.insert(static_cast<unsigned int>(cpu));
+      }
+    } catch (const std::exception &) {
+      return {};
+    }
+  }
+  return {cpus.begin(), cpus.end()};
+}
+
+Topology Topology::detect(const std::string &root) {
+  using namespace Topology_internal;
+
+  Topology topology;
+  std::vector<unsigned int> allowed = allowedCpus(root);
+
+#ifdef __linux__
+  // The scheduler mask reflects taskset/cpuset restrictions on this process
+  if (root.empty()) {
+    cpu_set_t mask;
+    CPU_ZERO(&mask);
+    if (sched_getaffinity(0, sizeof(mask), &mask) == 0) {
+      std::vector<unsigned int> affinity;
+      for (unsigned int cpu = 0; cpu < CPU_SETSIZE; ++cpu) {
+        if (CPU_ISSET(cpu, &mask)) {
+          affinity.push_back(cpu);
+        }
+      }
+      if (allowed.empty()) {
+        allowed = affinity;
+      } else {
+        std::vector<unsigned int> both;
+        std::set_intersection(allowed.begin(), allowed.end(),
+                              affinity.begin(), affinity.end(),
+                              std::back_inserter(both));
+        allowed = both.empty() ? affinity : both;
+      }
+    }
+  }
+#endif
+
+  if (allowed.empty()) {
+    const unsigned int count =
+        std::max(1u, std::thread::hardware_concurrency());
+    for (unsigned int cpu = 0; cpu < count; ++cpu) {
+      allowed.push_back(cpu);
+    }
+  }
+
+  const std::map<unsigned int, int> nodes = numaNodes(root);
+  for (unsigned int id : allowed) {
+    const std::string base =
+        root + "/sys/devices/system/cpu/cpu" + std::to_string(id) + "/topology";
+    CpuInfo cpu;
+    cpu.id = id;
+    cpu.package = readInt(base + "/physical_package_id", 0);
+    cpu.core = readInt(base + "/core_id", static_cast<int>(id));
+    const auto node = nodes.find(id);
+    cpu.node = node == nodes.end() ? 0 : node->second;
+    topology.mCpus.push_back(cpu);
+  }
+  topology.mQuota = cpuQuota(root);
+  return topology;
+}
+
+unsigned int Topology::getDefaultThreadCount() const {
+  unsigned int threads = static_cast<unsigned int>(mCpus.size());
+  if (mQuota) {
+    const double quota = std::max(1.0, std::floor(*mQuota));
+    threads = std::min(threads, static_cast<unsigned int>(quota));
+  }
+  return std::max(1u, threads);
+}
+
+std::vector<CpuInfo> Topology::placement(unsigned int threads) const {
+  // Order CPUs by node, package and core; the first CPU seen for a physical
+  // core goes in the first pass, its SMT siblings in later passes
+  std::vector<CpuInfo> sorted = mCpus;
+  std::stable_sort(sorted.begin(), sorted.end(),
+                   [](const CpuInfo &a, const CpuInfo &b) {
+                     return std::tie(a.node, a.package, a.core, a.id) <
+                            std::tie(b.node, b.package, b.core, b.id);
+                   });
+
+  std::map<std::tuple<int, int, int>, unsigned int> siblings_seen;
+  std::vector<std::pair<unsigned int, CpuInfo>> ranked;
+  for (const CpuInfo &cpu : sorted) {
+    const unsigned int rank =
+        siblings_seen[std::make_tuple(cpu.node, cpu.package, cpu.core)]++;
+    ranked.emplace_back(rank, cpu);
+  }
+  std::stable_sort(
+      ranked.begin(), ranked.end(),
+      [](const auto &a, const auto &b) { return a.first < b.first; });
+
+  std::vector<CpuInfo> chosen;
+  for (unsigned int i = 0; i < threads && !ranked.empty(); ++i) {
+    chosen.push_back(ranked[i % ranked.size()].second);
+  }
+  return chosen;
+}
+
+bool Topology::pinCurrentThread(unsigned int cpu) {
+#ifdef __linux__
+  if (cpu >= CPU_SETSIZE) {
+    return false;
+  }
+  cpu_set_t mask;
+  CPU_ZERO(&mask);
+  CPU_SET(cpu, &mask);
+  return pthread_setaffinity_np(pthread_self(), sizeof(mask), &mask) == 0;
+#else
+  (void)cpu;
+  return false;
+#endif
+}
+
+} // namespace Miner
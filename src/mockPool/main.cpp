@@ -0,0 +1,48 @@
+// system includes
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <exception>
+#include <fstream>
+
+// project includes
+#include "stratum/mockPool.h"
+
+// HF-MockPool <script> [port] [--loop]
+//
+// Serves a Stratum script (see Stratum::MockPool) on 127.0.0.1, once or,
+// with --loop, again for every miner that connects.
+int main(int argc, char **argv) {
+  if (argc < 2) {
+    std::fprintf(stderr, "usage: %s <script> [port] [--loop]\n", argv[0]);
+    return 2;
+  }
+  bool loop = false;
+  unsigned long port = 0;
+  for (int i = 2; i < argc; ++i) {
+    if (std::strcmp(argv[i], "--loop") == 0) {
+      loop = true;
+    } else {
+      port = std::strtoul(argv[i], nullptr, 10);
+    }
+  }
+
+  try {
+    Stratum::MockPool pool(static_cast<uint16_t>(port));
+    std::printf("listening on 127.0.0.1:%u\n", pool.getPort());
+    std::fflush(stdout);
+    do {
+      std::ifstream script(argv[1]);
+      if (!script) {
+        std::fprintf(stderr, "cannot open %s\n", argv[1]);
+        return 1;
+      }
+      pool.runScript(script);
+      pool.close();
+    } while (loop);
+  } catch (const std::exception &e) {
+    std::fprintf(stderr, "%s\n", e.what());
+    return 1;
+  }
+  return 0;
+}
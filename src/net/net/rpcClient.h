@@ -0,0 +1,64 @@
+#ifndef __RPC_CLIENT_H__
+#define __RPC_CLIENT_H__
+
+// system includes
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// project includes
+#include "block/blockTemplate.h"
+
+namespace Net {
+
+/// \brief Connection settings of a node's JSON-RPC interface.
+struct RpcConfig {
+  std::string host = "127.0.0.1";
+  uint16_t port = 8332;
+  std::string user;
+  std::string password;
+
+  /// \brief Limit on connecting and on each send or receive.
+  std::chrono::milliseconds timeout{30000};
+};
+
+/// \brief Minimal JSON-RPC client over HTTP/1.1.
+/// \note Each call opens one connection with "Connection: close" and reads
+/// the response until the node closes it, which is how bitcoind serves RPC.
+/// The request and response buffers are kept between calls, so a client that
+/// keeps fetching templates of similar size does not allocate.
+class RpcClient {
+public:
+  /// \brief Construct a client.
+  /// \param config Node address and credentials.
+  explicit RpcClient(const RpcConfig &config);
+
+  /// \brief Call a method.
+  /// \param method Method name.
+  /// \param params JSON array of parameters.
+  /// \return The response body; valid until the next call.
+  /// \throws std::system_error on a socket error or timeout.
+  /// \throws std::runtime_error on an HTTP error other than the status 500
+  /// that carries a JSON-RPC error, or a malformed response.
+  std::string_view call(std::string_view method,
+                        std::string_view params = "[]");
+
+  /// \brief Fetch a segwit block template.
+  /// \param parser Parser that receives the response.
+  /// \return The template; valid until the parser's next parse.
+  /// \throws std::system_error, std::runtime_error as call() and
+  /// BlockTemplateParser::parse().
+  const Block::BlockTemplate &
+  getBlockTemplate(Block::BlockTemplateParser &parser);
+
+private:
+  RpcConfig mConfig;
+  std::string mAuthorization;
+  std::string mRequest;
+  std::string mResponse;
+  uint64_t mNextId;
+};
+
+} // namespace Net
+#endif // __RPC_CLIENT_H__
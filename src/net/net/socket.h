@@ -0,0 +1,28 @@
+#ifndef __NET_SOCKET_H__
+#define __NET_SOCKET_H__
+
+// system includes
+#include <chrono>
+#include <cstdint>
+#include <string>
+
+namespace Net {
+
+/// \brief Open a TCP connection.
+/// \note Every address the host resolves to is tried in turn. The socket is
+/// blocking and close-on-exec, with send and receive timeouts set to the
+/// timeout; on Linux the send timeout also bounds connect(). Timeouts do
+/// not apply once a caller makes the socket non-blocking.
+/// \param host Host name or address.
+/// \param port TCP port.
+/// \param timeout Bound on each connect attempt and on each send or
+/// receive.
+/// \return The connected socket, owned by the caller.
+/// \throws std::runtime_error if the host cannot be resolved.
+/// \throws std::system_error if no address accepts the connection, or with
+/// std::errc::not_supported on platforms without BSD sockets.
+int connectTo(const std::string &host, uint16_t port,
+              std::chrono::milliseconds timeout);
+
+} // namespace Net
+#endif // __NET_SOCKET_H__
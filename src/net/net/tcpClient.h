@@ -0,0 +1,138 @@
+#ifndef __TCP_CLIENT_H__
+#define __TCP_CLIENT_H__
+
+// system includes
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Net {
+
+/// \brief Non-blocking TCP client connection driven by one thread, the
+/// transport under the Stratum client and the cluster node.
+/// \note One thread drives the connection with poll() or run(): a
+/// non-blocking socket and an eventfd for wakeups under one epoll instance.
+/// Received bytes stay in one buffer, and the receive handler takes the
+/// complete messages from its front in place; what it leaves is kept for
+/// the next read. send() writes at once and keeps what the socket does not
+/// take until it drains. Other threads append to a mutex-guarded outbox
+/// with post(), which wakes the loop to send it, and may call stop().
+/// Linux only.
+class TcpClient {
+public:
+  /// \brief Called on the loop thread with the received bytes not yet
+  /// consumed.
+  /// \note pending is valid during the call only. Its first seen bytes were
+  /// offered before, so a parser need not search them for a delimiter
+  /// again. The handler may close() the connection.
+  /// \return Number of bytes consumed from the front of pending.
+  using ReceiveHandler =
+      std::function<size_t(std::span<const uint8_t> pending, size_t seen)>;
+
+  /// \brief Construct an unconnected client.
+  /// \param peer The other end, for error messages, e.g. "the pool".
+  /// \param maxPending Largest number of unconsumed bytes held, which
+  /// bounds the size of one message.
+  /// \throws std::system_error if the epoll instance or the eventfd cannot
+  /// be created, or with std::errc::not_supported off Linux.
+  TcpClient(std::string peer, size_t maxPending);
+
+  /// \brief Close the connection.
+  ~TcpClient();
+
+  TcpClient(const TcpClient &) = delete;
+  TcpClient &operator=(const TcpClient &) = delete;
+
+  /// \brief Set the receive handler; call before connect().
+  inline void setReceiveHandler(ReceiveHandler handler) {
+    mReceiveHandler = std::move(handler);
+  }
+
+  /// \brief Connect, replacing any open connection and dropping its
+  /// buffered bytes.
+  /// \param host Host name or address.
+  /// \param port TCP port.
+  /// \param timeout Bound on connecting.
+  /// \throws std::runtime_error, std::system_error as connectTo(), or
+  /// std::system_error if the socket cannot be watched.
+  void connect(const std::string &host, uint16_t port,
+               std::chrono::milliseconds timeout);
+
+  /// \brief Process socket events.
+  /// \param timeout Longest wait for an event; negative waits until one
+  /// arrives.
+  /// \return false once the connection is closed.
+  /// \throws std::system_error on socket errors.
+  /// \throws std::runtime_error if a message outgrows maxPending.
+  bool poll(std::chrono::milliseconds timeout);
+
+  /// \brief Process socket events until stop() or until the connection
+  /// closes.
+  /// \throws std::system_error, std::runtime_error as poll().
+  void run();
+
+  /// \brief Make run() return. Thread-safe.
+  void stop();
+
+  /// \brief Send bytes from the loop thread.
+  /// \return false if the peer is gone; the connection is then closed.
+  /// \throws std::system_error on socket errors.
+  bool send(std::string_view bytes);
+
+  /// \brief Queue bytes from any thread and wake the loop to send them.
+  /// Thread-safe.
+  /// \param fill Callable taking the outbox, a std::string&, to append to;
+  /// called with the outbox locked.
+  template <typename Fill> void post(Fill &&fill) {
+    {
+      std::lock_guard<std::mutex> lock(mOutboxMutex);
+      fill(mOutbox);
+    }
+    wake();
+  }
+
+  /// \brief Close the connection; the buffers are kept for reuse.
+  void close();
+
+  /// \brief Whether the connection is open.
+  inline bool isConnected() const { return mSocket >= 0; }
+
+private:
+  bool flush();
+  bool receive();
+  void setWriteInterest(bool enabled);
+  void wake();
+
+  std::string mPeer;
+  size_t mMaxPending;
+  ReceiveHandler mReceiveHandler;
+
+  // The epoll instance and the eventfd live as long as the client, the
+  // socket as long as a connection
+  int mSocket;
+  int mEpoll;
+  int mWakeup;
+  std::atomic<bool> mStop;
+
+  // Receive buffer: messages are handled where they land
+  std::vector<uint8_t> mReceived;
+  size_t mReceivedBegin;
+  size_t mReceivedEnd;
+
+  // Bytes waiting for the socket, and bytes posted by other threads
+  std::string mSendBuffer;
+  size_t mSendOffset;
+  bool mWriteInterest; // EPOLLOUT registered
+  std::mutex mOutboxMutex;
+  std::string mOutbox;
+};
+
+} // namespace Net
+#endif // __TCP_CLIENT_H__
@@ -0,0 +1,224 @@
+#include "net/rpcClient.h"
+
+// system includes
+#include <cerrno>
+#include <charconv>
+#include <stdexcept>
+#include <system_error>
+
+// project includes
+#include "net/socket.h"
+#include "util/transcode.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <sys/socket.h>
+#include <unistd.h>
+#define HFM_NET_RPC_SOCKETS 1
+#endif
+
+namespace Net {
+namespace RpcClient_internal {
+
+// First read; grown by doubling for multi-megabyte templates
+static constexpr size_t INITIAL_RESPONSE_SIZE = 64 * 1024;
+
+// Request body: PREFIX id METHOD method PARAMS params }
+static constexpr std::string_view BODY_PREFIX =
+    "{\"jsonrpc\": \"1.0\", \"id\": ";
+static constexpr std::string_view BODY_METHOD = ", \"method\": \"";
+static constexpr std::string_view BODY_PARAMS = "\", \"params\": ";
+
+static bool equalsIgnoreCase(std::string_view a, std::string_view b) {
+  if (a.size() != b.size()) {
+    return false;
+  }
+  for (size_t i = 0; i < a.size(); ++i) {
+    const char x = (a[i] >= 'A' && a[i] <= 'Z') ? a[i] - 'A' + 'a' : a[i];
+    const char y = (b[i] >= 'A' && b[i] <= 'Z') ? b[i] - 'A' + 'a' : b[i];
+    if (x != y) {
+      return false;
+    }
+  }
+  return true;
+}
+
+// Value of a header in the header block, without leading spaces
+static std::string_view findHeader(std::string_view headers,
+                                   std::string_view name) {
+  size_t line = headers.find("\r\n");
+  while (line != std::string_view::npos && line + 2 < headers.size()) {
+    const size_t begin = line + 2;
+    const size_t end = headers.find("\r\n", begin);
+    const std::string_view field = headers.substr(
+        begin, end == std::string_view::npos ? end : end - begin);
+    const size_t colon = field.find(':');
+    if (colon != std::string_view::npos &&
+        equalsIgnoreCase(field.substr(0, colon), name)) {
+      std::string_view value = field.substr(colon + 1);
+      while (!value.empty() &&
+             (value.front() == ' ' || value.front() == '\t')) {
+        value.remove_prefix(1);
+      }
+      return value;
+    }
+    line = end;
+  }
+  return {};
+}
+
+#ifdef HFM_NET_RPC_SOCKETS
+// Closes the socket when the call leaves
+struct SocketGuard {
+  int fd;
+  ~SocketGuard() {
+    if (fd >= 0) {
+      ::close(fd);
+    }
+  }
+};
+#endif
+
+} // namespace RpcClient_internal
+} // namespace Net
+
+Net::RpcClient::RpcClient(const RpcConfig &config)
+    : mConfig(config), mAuthorization(), mRequest(), mResponse(),
+      mNextId(0) {
+  const std::string credentials = config.user + ":" + config.password;
+  mAuthorization = util::EncodeBase64(std::span<const uint8_t>(
+      reinterpret_cast<const uint8_t *>(credentials.data()),
+      credentials.size()));
+}
+
+std::string_view Net::RpcClient::call(std::string_view method,
+                                      std::string_view params) {
+  using namespace RpcClient_internal;
+
+#ifdef HFM_NET_RPC_SOCKETS
+  const std::string id = std::to_string(++mNextId);
+  const size_t body_size = BODY_PREFIX.size() + id.size() +
+                           BODY_METHOD.size() + method.size() +
+                           BODY_PARAMS.size() + params.size() + 1;
+
+  mRequest.clear();
+  mRequest.append("POST / HTTP/1.1\r\nHost: ")
+      .append(mConfig.host)
+      .append(":")
+      .append(std::to_string(mConfig.port))
+      .append("\r\nAuthorization: Basic ")
+      .append(mAuthorization)
+      .append("\r\nContent-Type: application/json\r\nContent-Length: ")
+      .append(std::to_string(body_size))
+      .append("\r\nConnection: close\r\n\r\n");
+  mRequest.append(BODY_PREFIX)
+      .append(id)
+      .append(BODY_METHOD)
+      .append(method)
+      .append(BODY_PARAMS)
+      .append(params)
+      .append("}");
+
+  SocketGuard socket{connectTo(mConfig.host, mConfig.port, mConfig.timeout)};
+  for (size_t sent = 0; sent < mRequest.size();) {
+    const ssize_t n = ::send(socket.fd, mRequest.data() + sent,
+                             mRequest.size() - sent, MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw std::system_error(errno, std::generic_category(),
+                              "Cannot send RPC request");
+    }
+    sent += static_cast<size_t>(n);
+  }
+
+  // Read until the node closes the connection or Content-Length is reached
+  if (mResponse.size() < INITIAL_RESPONSE_SIZE) {
+    mResponse.resize(INITIAL_RESPONSE_SIZE);
+  }
+  size_t received = 0;
+  size_t header_end = std::string::npos;
+  size_t content_length = std::string::npos;
+  for (;;) {
+    if (received == mResponse.size()) {
+      mResponse.resize(2 * mResponse.size());
+    }
+    const ssize_t n = ::recv(socket.fd, mResponse.data() + received,
+                             mResponse.size() - received, 0);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw std::system_error(errno, std::generic_category(),
+                              "Cannot receive RPC response");
+    }
+    if (n == 0) {
+      break;
+    }
+    const size_t previous = received;
+    received += static_cast<size_t>(n);
+
+    if (header_end == std::string::npos) {
+      const std::string_view data(mResponse.data(), received);
+      const size_t end = data.find("\r\n\r\n", previous < 3 ? 0 : previous - 3);
+      if (end == std::string_view::npos) {
+        continue;
+      }
+      header_end = end + 4;
+      const std::string_view length =
+          findHeader(data.substr(0, end + 2), "Content-Length");
+      if (!length.empty()) {
+        size_t value = 0;
+        const auto result = std::from_chars(
+            length.data(), length.data() + length.size(), value);
+        if (result.ec != std::errc()) {
+          throw std::runtime_error("Malformed RPC response length");
+        }
+        content_length = value;
+      }
+    }
+    if (content_length != std::string::npos &&
+        received - header_end >= content_length) {
+      break;
+    }
+  }
+
+  const std::string_view response(mResponse.data(), received);
+  if (header_end == std::string::npos || response.substr(0, 5) != "HTTP/" ||
+      response.size() < 12 || response[8] != ' ') {
+    throw std::runtime_error("Malformed RPC response");
+  }
+  const std::string_view headers = response.substr(0, header_end - 2);
+  if (equalsIgnoreCase(findHeader(headers, "Transfer-Encoding"), "chunked")) {
+    throw std::runtime_error("Chunked RPC responses are not supported");
+  }
+  std::string_view body = response.substr(header_end);
+  if (content_length != std::string::npos) {
+    if (body.size() < content_length) {
+      throw std::runtime_error("Truncated RPC response");
+    }
+    body = body.substr(0, content_length);
+  }
+
+  // bitcoind reports JSON-RPC errors with status 500 and a JSON body
+  const std::string_view status = response.substr(9, 3);
+  if (status == "200" || (status == "500" && !body.empty())) {
+    return body;
+  }
+  if (status == "401") {
+    throw std::runtime_error("RPC authentication failed");
+  }
+  throw std::runtime_error("RPC request failed with HTTP status " +
+                           std::string(status));
+#else
+  (void)method;
+  (void)params;
+  throw std::system_error(std::make_error_code(std::errc::not_supported),
+                          "RPC sockets are not supported");
+#endif
+}
+
+const Block::BlockTemplate &
+Net::RpcClient::getBlockTemplate(Block::BlockTemplateParser &parser) {
+  return parser.parse(call("getblocktemplate", R"([{"rules": ["segwit"]}])"));
+}
@@ -0,0 +1,67 @@
+#include "net/socket.h"
+
+// system includes
+#include <cerrno>
+#include <stdexcept>
+#include <system_error>
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <netdb.h>
+#include <sys/socket.h>
+#include <sys/time.h>
+#include <unistd.h>
+#define HFM_NET_SOCKETS 1
+#endif
+
+int Net::connectTo(const std::string &host, uint16_t port,
+                   std::chrono::milliseconds timeout) {
+#ifdef HFM_NET_SOCKETS
+  addrinfo hints{};
+  hints.ai_family = AF_UNSPEC;
+  hints.ai_socktype = SOCK_STREAM;
+  addrinfo *addresses = nullptr;
+  const std::string service = std::to_string(port);
+  const int status =
+      ::getaddrinfo(host.c_str(), service.c_str(), &hints, &addresses);
+  if (status != 0) {
+    throw std::runtime_error("Cannot resolve " + host + ": " +
+                             ::gai_strerror(status));
+  }
+
+  timeval limit{};
+  limit.tv_sec = static_cast<time_t>(timeout.count() / 1000);
+  limit.tv_usec = static_cast<suseconds_t>((timeout.count() % 1000) * 1000);
+
+  int error = 0;
+  for (addrinfo *address = addresses; address != nullptr;
+       address = address->ai_next) {
+    int type = address->ai_socktype;
+#ifdef SOCK_CLOEXEC
+    type |= SOCK_CLOEXEC;
+#endif
+    const int fd = ::socket(address->ai_family, type, address->ai_protocol);
+    if (fd < 0) {
+      error = errno;
+      continue;
+    }
+    // On Linux the send timeout also bounds connect()
+    ::setsockopt(fd, SOL_SOCKET, SO_RCVTIMEO, &limit, sizeof(limit));
+    ::setsockopt(fd, SOL_SOCKET, SO_SNDTIMEO, &limit, sizeof(limit));
+    if (::connect(fd, address->ai_addr, address->ai_addrlen) == 0) {
+      ::freeaddrinfo(addresses);
+      return fd;
+    }
+    error = errno;
+    ::close(fd);
+  }
+  ::freeaddrinfo(addresses);
+  throw std::system_error(error, std::generic_category(),
+                          "Cannot connect to " + host + ":" + service);
+#else
+  (void)host;
+  (void)port;
+  (void)timeout;
+  throw std::system_error(std::make_error_code(std::errc::not_supported),
+                          "Sockets are not supported");
+#endif
+}
@@ -0,0 +1,306 @@
+#include "net/tcpClient.h"
+
+// system includes
+#include <algorithm>
+#include <cerrno>
+#include <climits>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+// project includes
+#include "net/socket.h"
+
+#if defined(__linux__)
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#define HFM_NET_TCP_CLIENT_EPOLL 1
+#endif
+
+namespace Net {
+namespace TcpClient_internal {
+
+// First receive buffer; grown for long messages up to maxPending
+static constexpr size_t RECEIVE_SIZE = 16 * 1024;
+
+} // namespace TcpClient_internal
+} // namespace Net
+
+Net::TcpClient::TcpClient(std::string peer, size_t maxPending)
+    : mPeer(std::move(peer)), mMaxPending(maxPending), mReceiveHandler(),
+      mSocket(-1), mEpoll(-1), mWakeup(-1), mStop(false), mReceived(),
+      mReceivedBegin(0), mReceivedEnd(0), mSendBuffer(), mSendOffset(0),
+      mWriteInterest(false), mOutboxMutex(), mOutbox() {
+#ifdef HFM_NET_TCP_CLIENT_EPOLL
+  mEpoll = ::epoll_create1(EPOLL_CLOEXEC);
+  if (mEpoll < 0) {
+    throw std::system_error(errno, std::generic_category(),
+                            "Cannot create epoll instance");
+  }
+  mWakeup = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+  if (mWakeup < 0) {
+    const int error = errno;
+    ::close(mEpoll);
+    throw std::system_error(error, std::generic_category(),
+                            "Cannot create eventfd");
+  }
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.fd = mWakeup;
+  ::epoll_ctl(mEpoll, EPOLL_CTL_ADD, mWakeup, &event);
+#else
+  throw std::system_error(std::make_error_code(std::errc::not_supported),
+                          "TCP client needs epoll");
+#endif
+}
+
+Net::TcpClient::~TcpClient() {
+#ifdef HFM_NET_TCP_CLIENT_EPOLL
+  close();
+  ::close(mWakeup);
+  ::close(mEpoll);
+#endif
+}
+
+void Net::TcpClient::connect(const std::string &host, uint16_t port,
+                             std::chrono::milliseconds timeout) {
+  using namespace TcpClient_internal;
+
+#ifdef HFM_NET_TCP_CLIENT_EPOLL
+  close();
+  const int fd = connectTo(host, port, timeout);
+  // Messages are single small writes: send them at once
+  const int on = 1;
+  ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+  ::fcntl(fd, F_SETFL, ::fcntl(fd, F_GETFL) | O_NONBLOCK);
+  mSocket = fd;
+  epoll_event event{};
+  event.events = EPOLLIN;
+  event.data.fd = mSocket;
+  if (::epoll_ctl(mEpoll, EPOLL_CTL_ADD, mSocket, &event) != 0) {
+    const int error = errno;
+    close();
+    throw std::system_error(error, std::generic_category(),
+                            "Cannot watch the socket of " + mPeer);
+  }
+
+  mStop = false;
+  if (mReceived.size() < std::min(RECEIVE_SIZE, mMaxPending)) {
+    mReceived.resize(std::min(RECEIVE_SIZE, mMaxPending));
+  }
+  mReceivedBegin = 0;
+  mReceivedEnd = 0;
+  mSendBuffer.clear();
+  mSendOffset = 0;
+#else
+  (void)host;
+  (void)port;
+  (void)timeout;
+  throw std::system_error(std::make_error_code(std::errc::not_supported),
+                          "TCP client needs epoll");
+#endif
+}
+
+bool Net::TcpClient::poll(std::chrono::milliseconds timeout) {
+#ifdef HFM_NET_TCP_CLIENT_EPOLL
+  if (mSocket < 0) {
+    return false;
+  }
+  const int wait = timeout.count() < 0         ? -1
+                   : timeout.count() > INT_MAX ? INT_MAX
+                                               : static_cast<int>(
+                                                     timeout.count());
+  epoll_event events[2];
+  const int count = ::epoll_wait(mEpoll, events, 2, wait);
+  if (count < 0) {
+    if (errno == EINTR) {
+      return true;
+    }
+    throw std::system_error(errno, std::generic_category(),
+                            "Cannot wait for the socket of " + mPeer);
+  }
+
+  for (int i = 0; i < count && mSocket >= 0; ++i) {
+    if (events[i].data.fd == mWakeup) {
+      uint64_t value = 0;
+      if (::read(mWakeup, &value, sizeof(value)) < 0 && errno != EAGAIN) {
+        throw std::system_error(errno, std::generic_category(),
+                                "Cannot read eventfd");
+      }
+      {
+        std::lock_guard<std::mutex> lock(mOutboxMutex);
+        mSendBuffer.append(mOutbox);
+        mOutbox.clear();
+      }
+      if (!flush()) {
+        close();
+      }
+      continue;
+    }
+    if ((events[i].events & (EPOLLIN | EPOLLHUP | EPOLLERR)) != 0 &&
+        !receive()) {
+      close();
+      continue;
+    }
+    if ((events[i].events & EPOLLOUT) != 0 && !flush()) {
+      close();
+    }
+  }
+  return mSocket >= 0;
+#else
+  (void)timeout;
+  throw std::system_error(std::make_error_code(std::errc::not_supported),
+                          "TCP client needs epoll");
+#endif
+}
+
+void Net::TcpClient::run() {
+  while (!mStop && poll(std::chrono::milliseconds(-1))) {
+  }
+  // Each stop() ends one run()
+  mStop = false;
+}
+
+void Net::TcpClient::stop() {
+  mStop = true;
+  wake();
+}
+
+bool Net::TcpClient::send(std::string_view bytes) {
+  mSendBuffer.append(bytes);
+  if (!flush()) {
+    close();
+    return false;
+  }
+  return true;
+}
+
+void Net::TcpClient::close() {
+#ifdef HFM_NET_TCP_CLIENT_EPOLL
+  if (mSocket >= 0) {
+    ::epoll_ctl(mEpoll, EPOLL_CTL_DEL, mSocket, nullptr);
+    ::close(mSocket);
+    mSocket = -1;
+  }
+  mWriteInterest = false;
+#endif
+}
+
+bool Net::TcpClient::flush() {
+#ifdef HFM_NET_TCP_CLIENT_EPOLL
+  while (mSendOffset < mSendBuffer.size()) {
+    const ssize_t n =
+        ::send(mSocket, mSendBuffer.data() + mSendOffset,
+               mSendBuffer.size() - mSendOffset, MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        // Resume once the socket drains
+        setWriteInterest(true);
+        return true;
+      }
+      if (errno == EPIPE || errno == ECONNRESET) {
+        return false;
+      }
+      throw std::system_error(errno, std::generic_category(),
+                              "Cannot send to " + mPeer);
+    }
+    mSendOffset += static_cast<size_t>(n);
+  }
+  mSendBuffer.clear();
+  mSendOffset = 0;
+  setWriteInterest(false);
+  return true;
+#else
+  return false;
+#endif
+}
+
+bool Net::TcpClient::receive() {
+#ifdef HFM_NET_TCP_CLIENT_EPOLL
+  for (;;) {
+    if (mReceivedEnd == mReceived.size()) {
+      if (mReceivedBegin > 0) {
+        std::memmove(mReceived.data(), mReceived.data() + mReceivedBegin,
+                     mReceivedEnd - mReceivedBegin);
+        mReceivedEnd -= mReceivedBegin;
+        mReceivedBegin = 0;
+      } else if (mReceived.size() < mMaxPending) {
+        mReceived.resize(std::min(2 * mReceived.size(), mMaxPending));
+      } else {
+        throw std::runtime_error("Message from " + mPeer + " too long");
+      }
+    }
+
+    const ssize_t n = ::recv(mSocket, mReceived.data() + mReceivedEnd,
+                             mReceived.size() - mReceivedEnd, 0);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno == EAGAIN || errno == EWOULDBLOCK) {
+        return true;
+      }
+      if (errno == ECONNRESET) {
+        return false;
+      }
+      throw std::system_error(errno, std::generic_category(),
+                              "Cannot receive from " + mPeer);
+    }
+    if (n == 0) {
+      return false;
+    }
+
+    // Hand over every complete message before reading on
+    const size_t seen = mReceivedEnd - mReceivedBegin;
+    mReceivedEnd += static_cast<size_t>(n);
+    if (mReceiveHandler) {
+      mReceivedBegin += mReceiveHandler(
+          std::span<const uint8_t>(mReceived.data() + mReceivedBegin,
+                                   mReceivedEnd - mReceivedBegin),
+          seen);
+    } else {
+      mReceivedBegin = mReceivedEnd;
+    }
+    if (mSocket < 0) {
+      return false;
+    }
+    if (mReceivedBegin == mReceivedEnd) {
+      mReceivedBegin = 0;
+      mReceivedEnd = 0;
+    }
+  }
+#else
+  return false;
+#endif
+}
+
+void Net::TcpClient::setWriteInterest(bool enabled) {
+#ifdef HFM_NET_TCP_CLIENT_EPOLL
+  if (enabled == mWriteInterest || mSocket < 0) {
+    return;
+  }
+  epoll_event event{};
+  event.events = enabled ? EPOLLIN | EPOLLOUT : EPOLLIN;
+  event.data.fd = mSocket;
+  ::epoll_ctl(mEpoll, EPOLL_CTL_MOD, mSocket, &event);
+  mWriteInterest = enabled;
+#else
+  (void)enabled;
+#endif
+}
+
+void Net::TcpClient::wake() {
+#ifdef HFM_NET_TCP_CLIENT_EPOLL
+  const uint64_t one = 1;
+  [[maybe_unused]] const ssize_t written =
+      ::write(mWakeup, &one, sizeof(one));
+#endif
+}
@@ -1,6 +1,8 @@
 #include "sha256/sha256.h"
 
 // system includes
+#include <algorithm>
+#include <cstring>
 #include <iomanip>
 #include <sstream>
 #include <stdexcept>
@@ -42,6 +44,195 @@ static inline void update_w(uint32_t *w, int i, const uint8_t *buffer) {
   }
 }
 
+// Round constants
+static constexpr uint32_t K[64] = {
+    0x428a2f98, 0x71374491, 0xb5c0fbcf, 0xe9b5dba5, 0x3956c25b, 0x59f111f1,
+    0x923f82a4, 0xab1c5ed5, 0xd807aa98, 0x12835b01, 0x243185be, 0x550c7dc3,
+    0x72be5d74, 0x80deb1fe, 0x9bdc06a7, 0xc19bf174, 0xe49b69c1, 0xefbe4786,
+    0x0fc19dc6, 0x240ca1cc, 0x2de92c6f, 0x4a7484aa, 0x5cb0a9dc, 0x76f988da,
+    0x983e5152, 0xa831c66d, 0xb00327c8, 0xbf597fc7, 0xc6e00bf3, 0xd5a79147,
+    0x06ca6351, 0x14292967, 0x27b70a85, 0x2e1b2138, 0x4d2c6dfc, 0x53380d13,
+    0x650a7354, 0x766a0abb, 0x81c2c92e, 0x92722c85, 0xa2bfe8a1, 0xa81a664b,
+    0xc24b8b70, 0xc76c51a3, 0xd192e819, 0xd6990624, 0xf40e3585, 0x106aa070,
+    0x19a4c116, 0x1e376c08, 0x2748774c, 0x34b0bcb5, 0x391c0cb3, 0x4ed8aa4a,
+    0x5b9cca4f, 0x682e6ff3, 0x748f82ee, 0x78a5636f, 0x84c87814, 0x8cc70208,
+    0x90befffa, 0xa4506ceb, 0xbef9a3f7, 0xc67178f2,
+};
+
+static constexpr uint32_t IV[8] = {0x6a09e667, 0xbb67ae85, 0x3c6ef372,
+                                   0xa54ff53a, 0x510e527f, 0x9b05688c,
+                                   0x1f83d9ab, 0x5be0cd19};
+
+static constexpr size_t LANES = SHA256::LANES;
+
+// Lane-interleaved words: v[i][lane]
+using LaneWords = uint32_t[LANES];
+
+static inline uint32_t load_be32(const uint8_t *p) {
+  return ((uint32_t)p[0] << 24) | ((uint32_t)p[1] << 16) |
+         ((uint32_t)p[2] << 8) | ((uint32_t)p[3]);
+}
+
+// One compression of LANES independent blocks. Every statement is a loop
+// over the lanes with no cross-lane dependency, which vectorizes.
+static void compress_lanes(LaneWords *state, const LaneWords *block) {
+  LaneWords w[64];
+  for (int i = 0; i < 16; i++) {
+    for (size_t l = 0; l < LANES; l++) {
+      w[i][l] = block[i][l];
+    }
+  }
+  for (int i = 16; i < 64; i++) {
+    for (size_t l = 0; l < LANES; l++) {
+      const uint32_t a = w[i - 15][l];
+      const uint32_t b = w[i - 2][l];
+      const uint32_t s0 = rotr(a, 7) ^ rotr(a, 18) ^ (a >> 3);
+      const uint32_t s1 = rotr(b, 17) ^ rotr(b, 19) ^ (b >> 10);
+      w[i][l] = w[i - 16][l] + s0 + w[i - 7][l] + s1;
+    }
+  }
+
+  LaneWords v[8];
+  for (int i = 0; i < 8; i++) {
+    for (size_t l = 0; l < LANES; l++) {
+      v[i][l] = state[i][l];
+    }
+  }
+  for (int i = 0; i < 64; i++) {
+    for (size_t l = 0; l < LANES; l++) {
+      const uint32_t a = v[0][l], b = v[1][l], c = v[2][l], d = v[3][l];
+      const uint32_t e = v[4][l], f = v[5][l], g = v[6][l], h = v[7][l];
+      const uint32_t t1 = h + step1(e, f, g) + K[i] + w[i][l];
+      const uint32_t t2 = step2(a, b, c);
+      v[7][l] = g;
+      v[6][l] = f;
+      v[5][l] = e;
+      v[4][l] = d + t1;
+      v[3][l] = c;
+      v[2][l] = b;
+      v[1][l] = a;
+      v[0][l] = t1 + t2;
+    }
+  }
+  for (int i = 0; i < 8; i++) {
+    for (size_t l = 0; l < LANES; l++) {
+      state[i][l] += v[i][l];
+    }
+  }
+}
+
+// Second hash over each lane's 32-byte first digest; writes the results
+static void second_hash_lanes(LaneWords *state, uint8_t *const *dst) {
+  LaneWords block[16];
+  for (int i = 0; i < 16; i++) {
+    for (size_t l = 0; l < LANES; l++) {
+      block[i][l] = i < 8     ? state[i][l]
+                    : i == 8  ? 0x80000000
+                    : i == 15 ? 256
+                              : 0;
+    }
+  }
+  for (int i = 0; i < 8; i++) {
+    for (size_t l = 0; l < LANES; l++) {
+      state[i][l] = IV[i];
+    }
+  }
+  compress_lanes(state, block);
+
+  for (size_t l = 0; l < LANES; l++) {
+    for (int i = 0; i < 8; i++) {
+      const uint32_t word = state[i][l];
+      uint8_t *out = dst[l] + i * 4;
+      out[0] = (uint8_t)(word >> 24);
+      out[1] = (uint8_t)(word >> 16);
+      out[2] = (uint8_t)(word >> 8);
+      out[3] = (uint8_t)word;
+    }
+  }
+}
+
+// Double SHA-256 of LANES 80-byte messages
+static void double_80_lanes(const uint8_t *src, uint8_t *dst) {
+  LaneWords state[8];
+  LaneWords block[16];
+
+  // First hash, block 1: bytes 0..63
+  for (int i = 0; i < 8; i++) {
+    for (size_t l = 0; l < LANES; l++) {
+      state[i][l] = IV[i];
+    }
+  }
+  for (int i = 0; i < 16; i++) {
+    for (size_t l = 0; l < LANES; l++) {
+      block[i][l] = load_be32(src + l * 80 + i * 4);
+    }
+  }
+  compress_lanes(state, block);
+
+  // First hash, block 2: bytes 64..79, padding and the 640-bit length
+  for (int i = 0; i < 4; i++) {
+    for (size_t l = 0; l < LANES; l++) {
+      block[i][l] = load_be32(src + l * 80 + 64 + i * 4);
+    }
+  }
+  for (int i = 4; i < 16; i++) {
+    for (size_t l = 0; l < LANES; l++) {
+      block[i][l] = i == 4 ? 0x80000000 : i == 15 ? 640 : 0;
+    }
+  }
+  compress_lanes(state, block);
+
+  uint8_t *out[LANES];
+  for (size_t l = 0; l < LANES; l++) {
+    out[l] = dst + l * 32;
+  }
+  second_hash_lanes(state, out);
+}
+
+// Padded block b of a message that pads to `blocks` blocks
+static void padded_block(const uint8_t *msg, size_t len, size_t blocks,
+                         size_t b, uint8_t *out) {
+  const size_t begin = b * 64;
+  const size_t n = len > begin ? std::min<size_t>(64, len - begin) : 0;
+  if (n > 0) {
+    std::memcpy(out, msg + begin, n);
+  }
+  std::memset(out + n, 0, 64 - n);
+  if (len >= begin && len < begin + 64) {
+    out[len - begin] = 0x80;
+  }
+  if (b + 1 == blocks) {
+    const uint64_t n_bits = (uint64_t)len * 8;
+    for (int i = 0; i < 8; i++) {
+      out[56 + i] = (uint8_t)(n_bits >> (56 - 8 * i));
+    }
+  }
+}
+
+// Double SHA-256 of LANES messages that all pad to `blocks` blocks
+static void double_lanes(const uint8_t *const *src, const size_t *len,
+                         size_t blocks, uint8_t *const *dst) {
+  LaneWords state[8];
+  LaneWords block[16];
+
+  for (int i = 0; i < 8; i++) {
+    for (size_t l = 0; l < LANES; l++) {
+      state[i][l] = IV[i];
+    }
+  }
+  for (size_t b = 0; b < blocks; b++) {
+    for (size_t l = 0; l < LANES; l++) {
+      uint8_t bytes[64];
+      padded_block(src[l], len[l], blocks, b, bytes);
+      for (int i = 0; i < 16; i++) {
+        block[i][l] = load_be32(bytes + i * 4);
+      }
+    }
+    compress_lanes(state, block);
+  }
+  second_hash_lanes(state, dst);
+}
+
 } // namespace SHA256_internal
 
 void SHA256::sha256_block(SHA256::Context *ctx) {
@@ -130,10 +321,20 @@ void SHA256::sha256_append_byte(Context *ctx, uint8_t byte) {
 
 void SHA256::append(Context &ctx, const void *src, size_t n_bytes) {
   const uint8_t *bytes = (const uint8_t *)src;
-  size_t i;
-
-  for (i = 0; i < n_bytes; i++) {
-    sha256_append_byte(&ctx, bytes[i]);
+  ctx.n_bits += (uint64_t)n_bytes * 8;
+
+  // Fill the buffer a run at a time rather than byte by byte
+  while (n_bytes > 0) {
+    const size_t room = 64 - ctx.buffer_counter;
+    const size_t n = n_bytes < room ? n_bytes : room;
+    std::memcpy(ctx.buffer + ctx.buffer_counter, bytes, n);
+    ctx.buffer_counter += (uint8_t)n;
+    bytes += n;
+    n_bytes -= n;
+    if (ctx.buffer_counter == 64) {
+      ctx.buffer_counter = 0;
+      sha256_block(&ctx);
+    }
   }
 }
 
@@ -193,6 +394,81 @@ void SHA256::bytes(const void *src, size_t n_bytes, void *dst_bytes32) {
   finalize_bytes(ctx, dst_bytes32);
 }
 
+void SHA256::double_bytes_80(const void *src, size_t n_messages,
+                             void *dst_bytes32) {
+  const uint8_t *in = (const uint8_t *)src;
+  uint8_t *out = (uint8_t *)dst_bytes32;
+
+  size_t i = 0;
+  for (; i + LANES <= n_messages; i += LANES) {
+    SHA256_internal::double_80_lanes(in + i * 80, out + i * 32);
+  }
+
+  // A partial batch costs as much as a full one, which is about LANES / 2
+  // one-shot hashes; shorter tails, single headers included, are hashed one
+  // by one and longer ones are padded into one more batch
+  const size_t rest = n_messages - i;
+  if (rest >= LANES / 2) {
+    uint8_t tail_in[LANES * 80] = {};
+    uint8_t tail_out[LANES * 32];
+    std::memcpy(tail_in, in + i * 80, rest * 80);
+    SHA256_internal::double_80_lanes(tail_in, tail_out);
+    std::memcpy(out + i * 32, tail_out, rest * 32);
+    return;
+  }
+  for (; i < n_messages; ++i) {
+    uint8_t first[SHA256_BYTES_SIZE];
+    bytes(in + i * 80, 80, first);
+    bytes(first, sizeof(first), out + i * 32);
+  }
+}
+
+void SHA256::double_bytes_many(const void *const *src, const size_t *n_bytes,
+                               size_t n_messages, void *const *dst_bytes32) {
+  // Messages are grouped by padded block count; a group is hashed as soon as
+  // it fills all lanes
+  struct Group {
+    const uint8_t *src[LANES];
+    size_t len[LANES];
+    uint8_t *dst[LANES];
+    size_t count = 0;
+  };
+  Group groups[BATCH_MAX_BLOCKS];
+
+  for (size_t m = 0; m < n_messages; m++) {
+    const size_t blocks = (n_bytes[m] + 8) / 64 + 1;
+    if (blocks > BATCH_MAX_BLOCKS) {
+      uint8_t first[SHA256_BYTES_SIZE];
+      bytes(src[m], n_bytes[m], first);
+      bytes(first, sizeof(first), dst_bytes32[m]);
+      continue;
+    }
+    Group &group = groups[blocks - 1];
+    group.src[group.count] = (const uint8_t *)src[m];
+    group.len[group.count] = n_bytes[m];
+    group.dst[group.count] = (uint8_t *)dst_bytes32[m];
+    if (++group.count == LANES) {
+      SHA256_internal::double_lanes(group.src, group.len, blocks, group.dst);
+      group.count = 0;
+    }
+  }
+
+  // Fill the unused lanes of partial groups with a copy of the first message
+  uint8_t discard[SHA256_BYTES_SIZE];
+  for (size_t g = 0; g < BATCH_MAX_BLOCKS; g++) {
+    Group &group = groups[g];
+    if (group.count == 0) {
+      continue;
+    }
+    for (size_t l = group.count; l < LANES; l++) {
+      group.src[l] = group.src[0];
+      group.len[l] = group.len[0];
+      group.dst[l] = discard;
+    }
+    SHA256_internal::double_lanes(group.src, group.len, g + 1, group.dst);
+  }
+}
+
 Hash SHA256::hashStringToArray(const std::string &hex_string) {
   // A full SHA-256 hex string is 64 characters long (32 bytes * 2 hex
   // chars/byte).
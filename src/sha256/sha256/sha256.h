@@ -44,6 +44,40 @@ public:
   /// Must be at least SHA256_BYTES_SIZE bytes.
   static void bytes(const void *src, size_t n_bytes, void *dst_bytes32);
 
+  // Batch methods
+
+  /// \brief Number of messages the batch kernel hashes side by side.
+  static constexpr size_t LANES = 8;
+
+  /// \brief Compute the double SHA-256 of many 80-byte messages (block
+  /// headers) and return them as raw bytes.
+  /// \param src Pointer to n_messages contiguous 80-byte messages.
+  /// \param n_messages Number of messages.
+  /// \param dst_bytes32 Destination buffer receiving n_messages contiguous
+  /// 32-byte digests.
+  /// \note Messages are hashed LANES at a time with lane-interleaved state
+  /// so the compiler can keep one lane per SIMD element. A tail of fewer
+  /// than LANES / 2 messages, or a single header, is hashed one by one.
+  static void double_bytes_80(const void *src, size_t n_messages,
+                              void *dst_bytes32);
+
+  /// \brief Longest message, in padded 64-byte blocks, that
+  /// double_bytes_many() hashes in the batch kernel.
+  static constexpr size_t BATCH_MAX_BLOCKS = 8;
+
+  /// \brief Compute the double SHA-256 of many short messages of any length
+  /// and return them as raw bytes.
+  /// \param src Array of n_messages pointers to the messages.
+  /// \param n_bytes Array of n_messages message lengths.
+  /// \param n_messages Number of messages.
+  /// \param dst_bytes32 Array of n_messages pointers, each receiving a
+  /// 32-byte digest.
+  /// \note Messages that pad to the same number of blocks are hashed LANES
+  /// at a time; messages longer than BATCH_MAX_BLOCKS blocks are hashed one
+  /// by one.
+  static void double_bytes_many(const void *const *src, const size_t *n_bytes,
+                                size_t n_messages, void *const *dst_bytes32);
+
   // Streaming context methods
 
   /// \brief Initialize a streaming SHA-256 context.
@@ -115,6 +149,11 @@ inline void sha256_bytes(const void *src, size_t n_bytes, void *dst_bytes32) {
   SHA256::bytes(src, n_bytes, dst_bytes32);
 }
 
+inline void sha256d_80_bytes(const void *src, size_t n_messages,
+                             void *dst_bytes32) {
+  SHA256::double_bytes_80(src, n_messages, dst_bytes32);
+}
+
 inline Hash hashStringToArray(const std::string &hex_string) {
   return SHA256::hashStringToArray(hex_string);
 }
@@ -0,0 +1,343 @@
+#include "stratum/client.h"
+
+// system includes
+#include <cstring>
+#include <stdexcept>
+
+// project includes
+#include "util/jsonReader.h"
+#include "util/transcode.h"
+
+namespace Stratum {
+namespace Client_internal {
+
+using util::JsonReader;
+using util::JsonToken;
+
+// Request ids of the handshake; submissions count up from FIRST_SUBMIT_ID
+static constexpr uint64_t CONFIGURE_ID = 1;
+static constexpr uint64_t SUBSCRIBE_ID = 2;
+static constexpr uint64_t AUTHORIZE_ID = 3;
+static constexpr uint64_t FIRST_SUBMIT_ID = 4;
+
+// Longest line accepted from the pool
+static constexpr size_t MAX_LINE_SIZE = 1024 * 1024;
+
+// Whether a JSON value is absent or null
+static bool isNull(std::string_view value) {
+  if (value.empty()) {
+    return true;
+  }
+  JsonReader reader(value);
+  const JsonToken token = reader.next();
+  return token == JsonToken::End || token == JsonToken::Null;
+}
+
+static bool isTrue(std::string_view value) {
+  JsonReader reader(value);
+  return reader.next() == JsonToken::True;
+}
+
+} // namespace Client_internal
+} // namespace Stratum
+
+Stratum::Client::Client(const ClientConfig &config)
+    : mConfig(config), mJobHandler(), mResultHandler(),
+      mConnection("the pool", Client_internal::MAX_LINE_SIZE),
+      mNextId(Client_internal::FIRST_SUBMIT_ID), mSubscribed(false),
+      mAuthorized(false), mRejection(), mExtranonce1(), mExtranonce2Size(0),
+      mDifficulty(1), mVersionMask(0), mNotify(), mJob() {
+  mConnection.setReceiveHandler(
+      [this](std::span<const uint8_t> pending, size_t seen) {
+        return receive(pending, seen);
+      });
+}
+
+Stratum::Client::~Client() = default;
+
+void Stratum::Client::connect() {
+  using namespace Client_internal;
+
+  mConnection.connect(mConfig.host, mConfig.port, mConfig.timeout);
+  mSubscribed = false;
+  mAuthorized = false;
+  mRejection.clear();
+  mExtranonce1.clear();
+  mExtranonce2Size = 0;
+  mDifficulty = 1;
+  mVersionMask = 0;
+
+  // Pipeline the whole handshake
+  std::string line;
+  if (mConfig.versionRollingMask != 0) {
+    line.append("{\"id\":1,\"method\":\"mining.configure\",\"params\":[[")
+        .append("\"version-rolling\"],{\"version-rolling.mask\":");
+    appendHex32(line, mConfig.versionRollingMask);
+    line.append(",\"version-rolling.min-bit-count\":2}]}\n");
+  }
+  line.append("{\"id\":2,\"method\":\"mining.subscribe\",\"params\":[");
+  util::AppendJsonString(line, mConfig.userAgent);
+  line.append("]}\n{\"id\":3,\"method\":\"mining.authorize\",\"params\":[");
+  util::AppendJsonString(line, mConfig.user);
+  line.push_back(',');
+  util::AppendJsonString(line, mConfig.password);
+  line.append("]}\n");
+  mConnection.send(line);
+
+  const auto deadline = std::chrono::steady_clock::now() + mConfig.timeout;
+  while (!mSubscribed || !mAuthorized) {
+    if (!mRejection.empty()) {
+      mConnection.close();
+      throw std::runtime_error("Stratum pool refused " + mRejection);
+    }
+    const auto remaining =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+    if (remaining.count() <= 0) {
+      mConnection.close();
+      throw std::runtime_error("Stratum handshake timed out");
+    }
+    if (!poll(remaining)) {
+      throw std::runtime_error("Stratum pool closed the connection");
+    }
+  }
+}
+
+uint64_t Stratum::Client::submit(std::string_view jobId,
+                                 std::span<const uint8_t> extranonce2,
+                                 uint32_t time, uint32_t nonce,
+                                 uint32_t versionBits) {
+  using namespace Client_internal;
+
+  uint64_t id = 0;
+  mConnection.post([&](std::string &outbox) {
+    id = mNextId++;
+    outbox.append("{\"id\":")
+        .append(std::to_string(id))
+        .append(",\"method\":\"mining.submit\",\"params\":[");
+    util::AppendJsonString(outbox, mConfig.user);
+    outbox.push_back(',');
+    util::AppendJsonString(outbox, jobId);
+    outbox.append(",\"");
+    util::AppendHex(outbox, extranonce2);
+    outbox.append("\",");
+    appendHex32(outbox, time);
+    outbox.push_back(',');
+    appendHex32(outbox, nonce);
+    if (versionBits != 0) {
+      outbox.push_back(',');
+      appendHex32(outbox, versionBits);
+    }
+    outbox.append("]}\n");
+  });
+  return id;
+}
+
+size_t Stratum::Client::receive(std::span<const uint8_t> pending,
+                                size_t seen) {
+  // Handle every complete line; the bytes already seen hold no newline
+  const char *data = reinterpret_cast<const char *>(pending.data());
+  size_t begin = 0;
+  for (size_t scan = seen;; scan = begin) {
+    const char *newline = static_cast<const char *>(
+        std::memchr(data + scan, '\n', pending.size() - scan));
+    if (newline == nullptr) {
+      break;
+    }
+    const size_t end = static_cast<size_t>(newline - data);
+    std::string_view line(data + begin, end - begin);
+    if (!line.empty() && line.back() == '\r') {
+      line.remove_suffix(1);
+    }
+    begin = end + 1;
+    processLine(line);
+  }
+  return begin;
+}
+
+void Stratum::Client::processLine(std::string_view line) {
+  using namespace Client_internal;
+
+  // Members may come in any order: note where the values are, then act
+  JsonReader reader(line);
+  if (reader.next() != JsonToken::BeginObject) {
+    return;
+  }
+  bool has_id = false;
+  uint64_t id = 0;
+  std::string_view method;
+  std::string_view params;
+  std::string_view result;
+  std::string_view error;
+  for (JsonToken token = reader.next(); token != JsonToken::EndObject;
+       token = reader.next()) {
+    if (token != JsonToken::Key) {
+      return; // malformed; pools are not always strict, so skip the line
+    }
+    const std::string_view key = reader.getValue();
+    if (key == "id") {
+      const JsonToken value = reader.next();
+      has_id = value == JsonToken::Number && reader.getUint(id);
+      if (value == JsonToken::BeginObject || value == JsonToken::BeginArray ||
+          value == JsonToken::Error) {
+        return;
+      }
+    } else if (key == "method") {
+      if (reader.next() != JsonToken::String) {
+        return;
+      }
+      method = reader.getValue();
+    } else {
+      const size_t begin = reader.getOffset();
+      if (!reader.skipValue()) {
+        return;
+      }
+      const std::string_view value =
+          line.substr(begin, reader.getOffset() - begin);
+      if (key == "params") {
+        params = value;
+      } else if (key == "result") {
+        result = value;
+      } else if (key == "error") {
+        error = value;
+      }
+    }
+  }
+
+  if (!method.empty()) {
+    processNotification(method, params);
+  } else if (has_id) {
+    processResponse(id, result, error);
+  }
+}
+
+void Stratum::Client::processResponse(uint64_t id, std::string_view result,
+                                      std::string_view error) {
+  using namespace Client_internal;
+
+  const bool failed = !isNull(error);
+  switch (id) {
+  case CONFIGURE_ID: {
+    // {"version-rolling": true, "version-rolling.mask": "1fffe000"}
+    if (failed) {
+      return;
+    }
+    JsonReader reader(result);
+    if (reader.next() != JsonToken::BeginObject) {
+      return;
+    }
+    bool enabled = false;
+    uint32_t mask = 0;
+    for (JsonToken token = reader.next(); token == JsonToken::Key;
+         token = reader.next()) {
+      const std::string_view key = reader.getValue();
+      if (key == "version-rolling") {
+        enabled = reader.next() == JsonToken::True;
+      } else if (key == "version-rolling.mask") {
+        if (reader.next() != JsonToken::String ||
+            !decodeHex32(reader.getValue(), mask)) {
+          return;
+        }
+      } else if (!reader.skipValue()) {
+        return;
+      }
+    }
+    mVersionMask = enabled ? mask & mConfig.versionRollingMask : 0;
+    return;
+  }
+  case SUBSCRIBE_ID:
+    if (failed || !parseSubscribeResult(result)) {
+      mRejection = "the subscription: " + std::string(error);
+    } else {
+      mSubscribed = true;
+    }
+    return;
+  case AUTHORIZE_ID:
+    if (failed || !isTrue(result)) {
+      mRejection = "worker " + mConfig.user + ": " + std::string(error);
+    } else {
+      mAuthorized = true;
+    }
+    return;
+  default:
+    if (id >= FIRST_SUBMIT_ID && mResultHandler) {
+      SubmitResult submitted;
+      submitted.id = id;
+      submitted.accepted = !failed && isTrue(result);
+      submitted.error = error;
+      mResultHandler(submitted);
+    }
+    return;
+  }
+}
+
+void Stratum::Client::processNotification(std::string_view method,
+                                          std::string_view params) {
+  using namespace Client_internal;
+
+  if (method == "mining.notify") {
+    // Jobs before the subscription have no extranonce to go with
+    if (!mSubscribed || !parseNotify(params, mNotify)) {
+      return;
+    }
+    mJob.set(mNotify.coinbase1, mExtranonce1, mExtranonce2Size,
+             mNotify.coinbase2, mNotify.merkleBranch, mNotify.getHeader());
+    if (mJobHandler) {
+      mJobHandler(mNotify, mJob);
+    }
+    return;
+  }
+
+  JsonReader reader(params);
+  if (reader.next() != JsonToken::BeginArray) {
+    return;
+  }
+  if (method == "mining.set_difficulty") {
+    double difficulty = 0;
+    if (reader.next() == JsonToken::Number && reader.getDouble(difficulty) &&
+        difficulty > 0) {
+      mDifficulty = difficulty;
+    }
+  } else if (method == "mining.set_version_mask") {
+    uint32_t mask = 0;
+    if (reader.next() == JsonToken::String &&
+        decodeHex32(reader.getValue(), mask)) {
+      mVersionMask = mask;
+    }
+  } else if (method == "mining.set_extranonce") {
+    // Applies from the next job
+    std::vector<uint8_t> extranonce1;
+    uint64_t size = 0;
+    if (reader.next() != JsonToken::String) {
+      return;
+    }
+    extranonce1.resize(reader.getValue().size() / 2);
+    if (util::DecodeHex(reader.getValue(), extranonce1.data()) &&
+        reader.next() == JsonToken::Number && reader.getUint(size) &&
+        size <= 32) {
+      mExtranonce1 = std::move(extranonce1);
+      mExtranonce2Size = static_cast<size_t>(size);
+    }
+  }
+}
+
+bool Stratum::Client::parseSubscribeResult(std::string_view result) {
+  using namespace Client_internal;
+
+  // [[subscriptions...], "extranonce1", extranonce2_size]
+  JsonReader reader(result);
+  uint64_t size = 0;
+  if (reader.next() != JsonToken::BeginArray || !reader.skipValue() ||
+      reader.next() != JsonToken::String) {
+    return false;
+  }
+  const std::string_view extranonce1 = reader.getValue();
+  mExtranonce1.resize(extranonce1.size() / 2);
+  if (!util::DecodeHex(extranonce1, mExtranonce1.data()) ||
+      reader.next() != JsonToken::Number || !reader.getUint(size) ||
+      size > 32) {
+    return false;
+  }
+  mExtranonce2Size = static_cast<size_t>(size);
+  return true;
+}
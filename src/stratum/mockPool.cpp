@@ -0,0 +1,256 @@
+#include "stratum/mockPool.h"
+
+// system includes
+#include <cerrno>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+// project includes
+#include "util/jsonReader.h"
+
+#if defined(__unix__) || defined(__APPLE__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <poll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#define HFM_STRATUM_MOCK_SOCKETS 1
+#endif
+
+namespace Stratum {
+namespace MockPool_internal {
+
+using util::JsonReader;
+using util::JsonToken;
+
+// Pick the id, method and params out of a request line
+static bool parseRequest(std::string_view line, MockPool::Request &request) {
+  JsonReader reader(line);
+  if (reader.next() != JsonToken::BeginObject) {
+    return false;
+  }
+  for (JsonToken token = reader.next(); token == JsonToken::Key;
+       token = reader.next()) {
+    const std::string_view key = reader.getValue();
+    const size_t begin = reader.getOffset();
+    if (key == "method") {
+      if (reader.next() != JsonToken::String) {
+        return false;
+      }
+      request.method.assign(reader.getValue());
+      continue;
+    }
+    if (!reader.skipValue()) {
+      return false;
+    }
+    std::string_view value = line.substr(begin, reader.getOffset() - begin);
+    while (!value.empty() && value.front() == ' ') {
+      value.remove_prefix(1);
+    }
+    if (key == "id") {
+      request.id.assign(value);
+    } else if (key == "params") {
+      request.params.assign(value);
+    }
+  }
+  return true;
+}
+
+} // namespace MockPool_internal
+} // namespace Stratum
+
+Stratum::MockPool::MockPool(uint16_t port)
+    : mListener(-1), mSocket(-1), mPort(0), mReceived(), mLast() {
+#ifdef HFM_STRATUM_MOCK_SOCKETS
+  mListener = ::socket(AF_INET, SOCK_STREAM, 0);
+  if (mListener < 0) {
+    throw std::system_error(errno, std::generic_category(),
+                            "Cannot create the mock pool socket");
+  }
+  const int on = 1;
+  ::setsockopt(mListener, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+  address.sin_port = htons(port);
+  socklen_t length = sizeof(address);
+  if (::bind(mListener, reinterpret_cast<sockaddr *>(&address), length) !=
+          0 ||
+      ::listen(mListener, 16) != 0 ||
+      ::getsockname(mListener, reinterpret_cast<sockaddr *>(&address),
+                    &length) != 0) {
+    const int error = errno;
+    ::close(mListener);
+    throw std::system_error(error, std::generic_category(),
+                            "Cannot listen on port " + std::to_string(port));
+  }
+  mPort = ntohs(address.sin_port);
+#else
+  (void)port;
+  throw std::system_error(std::make_error_code(std::errc::not_supported),
+                          "Mock pool needs POSIX sockets");
+#endif
+}
+
+Stratum::MockPool::~MockPool() {
+#ifdef HFM_STRATUM_MOCK_SOCKETS
+  close();
+  ::close(mListener);
+#endif
+}
+
+void Stratum::MockPool::accept(std::chrono::milliseconds timeout) {
+#ifdef HFM_STRATUM_MOCK_SOCKETS
+  close();
+  pollfd listener{mListener, POLLIN, 0};
+  if (::poll(&listener, 1, static_cast<int>(timeout.count())) <= 0) {
+    throw std::runtime_error("No miner connected to the mock pool");
+  }
+  mSocket = ::accept(mListener, nullptr, nullptr);
+  if (mSocket < 0) {
+    throw std::system_error(errno, std::generic_category(),
+                            "Cannot accept a miner");
+  }
+  const int on = 1;
+  ::setsockopt(mSocket, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+#else
+  (void)timeout;
+#endif
+}
+
+Stratum::MockPool::Request
+Stratum::MockPool::expect(std::string_view method,
+                          std::chrono::milliseconds timeout) {
+  using namespace MockPool_internal;
+
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  std::string line;
+  for (;;) {
+    const auto remaining =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+    if (remaining.count() <= 0 || !readLine(line, remaining)) {
+      throw std::runtime_error("Mock pool expected " + std::string(method));
+    }
+    Request request;
+    if (parseRequest(line, request) && request.method == method) {
+      mLast = request;
+      return request;
+    }
+  }
+}
+
+void Stratum::MockPool::reply(const Request &request, std::string_view result,
+                              std::string_view error) {
+  std::string line;
+  line.append("{\"id\":")
+      .append(request.id.empty() ? "null" : request.id)
+      .append(",\"result\":")
+      .append(result)
+      .append(",\"error\":")
+      .append(error)
+      .append("}");
+  send(line);
+}
+
+void Stratum::MockPool::send(std::string_view line) {
+#ifdef HFM_STRATUM_MOCK_SOCKETS
+  std::string data(line);
+  data.push_back('\n');
+  for (size_t sent = 0; sent < data.size();) {
+    const ssize_t n = ::send(mSocket, data.data() + sent, data.size() - sent,
+                             MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      throw std::system_error(errno, std::generic_category(),
+                              "Mock pool cannot send");
+    }
+    sent += static_cast<size_t>(n);
+  }
+#else
+  (void)line;
+#endif
+}
+
+void Stratum::MockPool::close() {
+#ifdef HFM_STRATUM_MOCK_SOCKETS
+  if (mSocket >= 0) {
+    ::close(mSocket);
+    mSocket = -1;
+  }
+  mReceived.clear();
+#endif
+}
+
+void Stratum::MockPool::runScript(std::istream &script) {
+  std::string line;
+  while (std::getline(script, line)) {
+    if (!line.empty() && line.back() == '\r') {
+      line.pop_back();
+    }
+    const size_t start = line.find_first_not_of(" \t");
+    if (start == std::string::npos || line[start] == '#') {
+      continue;
+    }
+    const size_t space = line.find(' ', start);
+    const std::string command = line.substr(start, space - start);
+    const std::string argument =
+        space == std::string::npos ? std::string() : line.substr(space + 1);
+
+    if (command == "accept") {
+      accept();
+    } else if (command == "expect") {
+      expect(argument);
+    } else if (command == "reply") {
+      reply(mLast, argument);
+    } else if (command == "error") {
+      reply(mLast, "null", argument);
+    } else if (command == "send") {
+      send(argument);
+    } else if (command == "sleep") {
+      std::this_thread::sleep_for(
+          std::chrono::milliseconds(std::stoi(argument)));
+    } else if (command == "close") {
+      close();
+    } else {
+      throw std::invalid_argument("Unknown mock pool command: " + command);
+    }
+  }
+}
+
+bool Stratum::MockPool::readLine(std::string &line,
+                                 std::chrono::milliseconds timeout) {
+#ifdef HFM_STRATUM_MOCK_SOCKETS
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  for (;;) {
+    const size_t newline = mReceived.find('\n');
+    if (newline != std::string::npos) {
+      line.assign(mReceived, 0, newline);
+      mReceived.erase(0, newline + 1);
+      return true;
+    }
+    const auto remaining =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+    pollfd socket{mSocket, POLLIN, 0};
+    if (mSocket < 0 || remaining.count() <= 0 ||
+        ::poll(&socket, 1, static_cast<int>(remaining.count())) <= 0) {
+      return false;
+    }
+    char buffer[4096];
+    const ssize_t n = ::recv(mSocket, buffer, sizeof(buffer), 0);
+    if (n <= 0) {
+      return false;
+    }
+    mReceived.append(buffer, static_cast<size_t>(n));
+  }
+#else
+  (void)line;
+  (void)timeout;
+  return false;
+#endif
+}
@@ -0,0 +1,173 @@
+#include "stratum/notify.h"
+
+// system includes
+#include <algorithm>
+
+// project includes
+#include "util/endian.h"
+#include "util/jsonReader.h"
+#include "util/transcode.h"
+
+namespace Stratum {
+namespace Notify_internal {
+
+using util::JsonReader;
+using util::JsonToken;
+
+// Decode a hex string value into a buffer sized to fit
+static bool readHexBytes(JsonReader &reader, std::vector<uint8_t> &out) {
+  if (reader.next() != JsonToken::String) {
+    return false;
+  }
+  const std::string_view hex = reader.getValue();
+  out.resize(hex.size() / 2);
+  return util::DecodeHex(hex, out.data());
+}
+
+static bool readHash(JsonReader &reader, Hash &hash) {
+  if (reader.next() != JsonToken::String ||
+      reader.getValue().size() != 2 * hash.size()) {
+    return false;
+  }
+  return util::DecodeHex(reader.getValue(), hash.data());
+}
+
+static bool readHex32(JsonReader &reader, uint32_t &value) {
+  return reader.next() == JsonToken::String &&
+         decodeHex32(reader.getValue(), value);
+}
+
+} // namespace Notify_internal
+} // namespace Stratum
+
+Block::PackedHeader Stratum::Notify::getHeader() const {
+  Block::PackedHeader header;
+  header.setVersion(version);
+  header.setPrevBlockHash(prevHash);
+  header.setTimestamp(time);
+  header.setBits(bits);
+  return header;
+}
+
+bool Stratum::parseNotify(std::string_view params, Notify &notify) {
+  using namespace Notify_internal;
+
+  JsonReader reader(params);
+  if (reader.next() != JsonToken::BeginArray) {
+    return false;
+  }
+
+  const JsonToken id = reader.next();
+  if (id != JsonToken::String && id != JsonToken::Number) {
+    return false;
+  }
+  if (reader.hasEscapes()) {
+    if (!reader.getString(notify.jobId)) {
+      return false;
+    }
+  } else {
+    notify.jobId.assign(reader.getValue());
+  }
+
+  // Each 4-byte word of the previous block hash is sent byte-reversed
+  if (!readHash(reader, notify.prevHash)) {
+    return false;
+  }
+  for (size_t i = 0; i < notify.prevHash.size(); i += 4) {
+    std::reverse(notify.prevHash.begin() + i, notify.prevHash.begin() + i + 4);
+  }
+
+  if (!readHexBytes(reader, notify.coinbase1) ||
+      !readHexBytes(reader, notify.coinbase2) ||
+      reader.next() != JsonToken::BeginArray) {
+    return false;
+  }
+  size_t branch_size = 0;
+  for (JsonToken token = reader.next(); token != JsonToken::EndArray;
+       token = reader.next()) {
+    if (token != JsonToken::String || reader.getValue().size() != 64) {
+      return false;
+    }
+    if (branch_size == notify.merkleBranch.size()) {
+      notify.merkleBranch.emplace_back();
+    }
+    if (!util::DecodeHex(reader.getValue(),
+                         notify.merkleBranch[branch_size].data())) {
+      return false;
+    }
+    ++branch_size;
+  }
+  notify.merkleBranch.resize(branch_size);
+
+  if (!readHex32(reader, notify.version) || !readHex32(reader, notify.bits) ||
+      !readHex32(reader, notify.time)) {
+    return false;
+  }
+  const JsonToken clean = reader.next();
+  if (clean != JsonToken::True && clean != JsonToken::False) {
+    return false;
+  }
+  notify.clean = clean == JsonToken::True;
+
+  // Some pools append fields; ignore them
+  while (reader.getDepth() > 0) {
+    const JsonToken token = reader.next();
+    if (token == JsonToken::Error || token == JsonToken::End) {
+      return false;
+    }
+  }
+  return reader.next() == JsonToken::End;
+}
+
+void Stratum::formatNotify(const Notify &notify, std::string &out) {
+  using namespace Notify_internal;
+
+  out.assign("{\"id\":null,\"method\":\"mining.notify\",\"params\":[");
+  util::AppendJsonString(out, notify.jobId);
+  out.append(",\"");
+  Hash prev_hash = notify.prevHash;
+  for (size_t i = 0; i < prev_hash.size(); i += 4) {
+    std::reverse(prev_hash.begin() + i, prev_hash.begin() + i + 4);
+  }
+  util::AppendHex(out, prev_hash);
+  out.append("\",\"");
+  util::AppendHex(out, notify.coinbase1);
+  out.append("\",\"");
+  util::AppendHex(out, notify.coinbase2);
+  out.append("\",[");
+  for (size_t i = 0; i < notify.merkleBranch.size(); ++i) {
+    out.append(i == 0 ? "\"" : ",\"");
+    util::AppendHex(out, notify.merkleBranch[i]);
+    out.push_back('"');
+  }
+  out.append("],");
+  appendHex32(out, notify.version);
+  out.push_back(',');
+  appendHex32(out, notify.bits);
+  out.push_back(',');
+  appendHex32(out, notify.time);
+  out.append(notify.clean ? ",true]}\n" : ",false]}\n");
+}
+
+bool Stratum::decodeHex32(std::string_view hex, uint32_t &value) {
+  uint8_t bytes[4];
+  if (hex.size() != 2 * sizeof(bytes) || !util::DecodeHex(hex, bytes)) {
+    return false;
+  }
+  value = util::ReadBE32(bytes);
+  return true;
+}
+
+void Stratum::encodeHex32(uint32_t value, char *out) {
+  uint8_t bytes[4];
+  util::WriteBE32(bytes, value);
+  util::EncodeHex(bytes, out);
+}
+
+void Stratum::appendHex32(std::string &out, uint32_t value) {
+  char hex[8];
+  encodeHex32(value, hex);
+  out.push_back('"');
+  out.append(hex, sizeof(hex));
+  out.push_back('"');
+}
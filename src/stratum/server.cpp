@@ -0,0 +1,842 @@
+#include "stratum/server.h"
+
+// system includes
+#include <algorithm>
+#include <array>
+#include <cerrno>
+#include <charconv>
+#include <deque>
+#include <stdexcept>
+#include <system_error>
+#include <thread>
+
+// project includes
+#include "util/jsonReader.h"
+#include "util/transcode.h"
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <netinet/in.h>
+#include <netinet/tcp.h>
+#include <sys/epoll.h>
+#include <sys/eventfd.h>
+#include <sys/socket.h>
+#include <sys/uio.h>
+#include <unistd.h>
+#define HFM_STRATUM_SERVER_EPOLL 1
+#endif
+
+namespace Stratum {
+namespace Server_internal {
+
+using util::JsonReader;
+using util::JsonToken;
+
+// Broadcast completion times kept for getBroadcastStats()
+static constexpr size_t STATS_SIZE = 1024;
+
+// epoll tags; a connection's tag is its slot plus FIRST_CONNECTION_TAG
+static constexpr uint64_t LISTENER_TAG = 0;
+static constexpr uint64_t WAKEUP_TAG = 1;
+static constexpr uint64_t FIRST_CONNECTION_TAG = 2;
+
+static constexpr int MAX_EVENTS = 256;
+static constexpr size_t MAX_IOVECS = 64;
+
+// Miner requests are short; a longer line is not a miner
+static constexpr size_t RECEIVE_SIZE = 16 * 1024;
+static constexpr size_t MAX_LINE_SIZE = 16 * 1024;
+
+// A string parameter, unescaped into scratch only when needed
+static bool readString(JsonReader &reader, std::string &scratch,
+                       std::string_view &value) {
+  if (reader.next() != JsonToken::String) {
+    return false;
+  }
+  if (!reader.hasEscapes()) {
+    value = reader.getValue();
+    return true;
+  }
+  if (!reader.getString(scratch)) {
+    return false;
+  }
+  value = scratch;
+  return true;
+}
+
+static bool readHex32(JsonReader &reader, uint32_t &value) {
+  return reader.next() == JsonToken::String &&
+         decodeHex32(reader.getValue(), value);
+}
+
+} // namespace Server_internal
+} // namespace Stratum
+
+/// \brief A line shared by every connection it is queued on.
+struct Stratum::Server::Message {
+  std::string line;
+  bool job = false; // a mining.notify
+  bool clean = false;
+  std::chrono::steady_clock::time_point start;
+
+  // Tracked deliveries left, plus one per loop still queuing it
+  std::atomic<size_t> pending{0};
+};
+
+struct Stratum::Server::Connection {
+  struct Chunk {
+    std::shared_ptr<Message> message;
+    size_t offset = 0;
+    bool tracked = false; // counts towards the broadcast's completion
+  };
+
+  int fd = -1;
+  uint32_t slot = 0;
+  uint64_t id = 0;
+  std::array<uint8_t, 8> extranonce1{};
+  bool subscribed = false;
+  bool authorized = false;
+  bool reading = true; // EPOLLIN registered
+  bool writing = false; // EPOLLOUT registered
+  uint32_t versionMask = 0;
+  std::string worker;
+  std::string partial; // start of a line split across reads
+
+  std::deque<Chunk> queue;
+  size_t queued = 0; // unsent bytes
+};
+
+struct Stratum::Server::Loop {
+  ~Loop() {
+#ifdef HFM_STRATUM_SERVER_EPOLL
+    for (const std::unique_ptr<Connection> &connection : connections) {
+      if (connection) {
+        ::close(connection->fd);
+      }
+    }
+    for (const int fd : {listener, epoll, wakeup}) {
+      if (fd >= 0) {
+        ::close(fd);
+      }
+    }
+#endif
+  }
+
+  size_t index = 0;
+  int listener = -1;
+  int epoll = -1;
+  int wakeup = -1;
+  std::thread thread;
+
+  // Connections by slot; closed ones are freed after the event batch, so
+  // events already returned never see a reused slot
+  std::vector<std::unique_ptr<Connection>> connections;
+  std::vector<uint32_t> freeSlots;
+  std::vector<std::unique_ptr<Connection>> closed;
+  std::atomic<size_t> open{0};
+  std::atomic<size_t> paused{0}; // open connections not being read
+  uint64_t accepted = 0;
+
+  // Broadcasts posted by other threads
+  std::mutex mailboxMutex;
+  std::vector<std::shared_ptr<Message>> mailbox;
+  std::vector<std::shared_ptr<Message>> delivering;
+
+  // The latest job, for miners authorized after its broadcast
+  std::shared_ptr<Message> job;
+
+  std::vector<char> buffer;
+  std::string line;
+  std::string scratch;
+};
+
+Stratum::Server::Server(const ServerConfig &config)
+    : mConfig(config), mSubmitHandler(), mPort(0), mLoops(), mRunning(false),
+      mSlowDisconnects(0), mPausedWakeups(0), mDifficulty(), mStatsMutex(),
+      mCompletions(Server_internal::STATS_SIZE), mCompleted(0) {
+  using namespace Server_internal;
+
+  if (config.extranonce1Size == 0 || config.extranonce1Size > 8 ||
+      config.extranonce2Size == 0 || config.extranonce2Size > 8) {
+    throw std::invalid_argument("Extranonce parts must be 1 to 8 bytes");
+  }
+  char difficulty[32];
+  char *end =
+      std::to_chars(difficulty, difficulty + sizeof(difficulty),
+                    config.difficulty)
+          .ptr;
+  mDifficulty = std::make_shared<Message>();
+  mDifficulty->line
+      .append("{\"id\":null,\"method\":\"mining.set_difficulty\",")
+      .append("\"params\":[")
+      .append(difficulty, end)
+      .append("]}\n");
+
+#ifdef HFM_STRATUM_SERVER_EPOLL
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  if (::inet_pton(AF_INET, config.host.c_str(), &address.sin_addr) != 1) {
+    throw std::invalid_argument("Not an IPv4 address: " + config.host);
+  }
+  const size_t threads =
+      config.threads != 0
+          ? config.threads
+          : std::max<size_t>(1, std::thread::hardware_concurrency());
+
+  // One listener per loop on the same port; the first may pick it
+  mPort = config.port;
+  for (size_t i = 0; i < threads; ++i) {
+    auto loop = std::make_unique<Loop>();
+    loop->index = i;
+    loop->buffer.resize(RECEIVE_SIZE);
+    loop->listener = ::socket(AF_INET, SOCK_STREAM | SOCK_NONBLOCK |
+                                           SOCK_CLOEXEC,
+                              0);
+    if (loop->listener < 0) {
+      throw std::system_error(errno, std::generic_category(),
+                              "Cannot create the pool socket");
+    }
+    const int on = 1;
+    ::setsockopt(loop->listener, SOL_SOCKET, SO_REUSEADDR, &on, sizeof(on));
+    ::setsockopt(loop->listener, SOL_SOCKET, SO_REUSEPORT, &on, sizeof(on));
+    address.sin_port = htons(mPort);
+    socklen_t length = sizeof(address);
+    if (::bind(loop->listener, reinterpret_cast<sockaddr *>(&address),
+               length) != 0 ||
+        ::listen(loop->listener, SOMAXCONN) != 0 ||
+        ::getsockname(loop->listener, reinterpret_cast<sockaddr *>(&address),
+                      &length) != 0) {
+      throw std::system_error(errno, std::generic_category(),
+                              "Cannot listen on port " +
+                                  std::to_string(mPort));
+    }
+    mPort = ntohs(address.sin_port);
+
+    loop->epoll = ::epoll_create1(EPOLL_CLOEXEC);
+    if (loop->epoll < 0) {
+      throw std::system_error(errno, std::generic_category(),
+                              "Cannot create epoll instance");
+    }
+    loop->wakeup = ::eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC);
+    if (loop->wakeup < 0) {
+      throw std::system_error(errno, std::generic_category(),
+                              "Cannot create eventfd");
+    }
+    epoll_event event{};
+    event.events = EPOLLIN;
+    event.data.u64 = LISTENER_TAG;
+    ::epoll_ctl(loop->epoll, EPOLL_CTL_ADD, loop->listener, &event);
+    event.data.u64 = WAKEUP_TAG;
+    ::epoll_ctl(loop->epoll, EPOLL_CTL_ADD, loop->wakeup, &event);
+    mLoops.push_back(std::move(loop));
+  }
+#else
+  throw std::system_error(std::make_error_code(std::errc::not_supported),
+                          "Stratum server needs epoll");
+#endif
+}
+
+Stratum::Server::~Server() { stop(); }
+
+void Stratum::Server::start() {
+  if (mRunning.exchange(true)) {
+    return;
+  }
+  for (const std::unique_ptr<Loop> &loop : mLoops) {
+    loop->thread = std::thread([this, &loop] { run(*loop); });
+  }
+}
+
+void Stratum::Server::stop() {
+  if (!mRunning.exchange(false)) {
+    return;
+  }
+  for (const std::unique_ptr<Loop> &loop : mLoops) {
+#ifdef HFM_STRATUM_SERVER_EPOLL
+    const uint64_t one = 1;
+    [[maybe_unused]] const ssize_t written =
+        ::write(loop->wakeup, &one, sizeof(one));
+#endif
+    loop->thread.join();
+  }
+}
+
+void Stratum::Server::broadcast(const Notify &notify) {
+  auto message = std::make_shared<Message>();
+  formatNotify(notify, message->line);
+  message->job = true;
+  message->clean = notify.clean;
+  message->pending.store(mLoops.size(), std::memory_order_relaxed);
+  message->start = std::chrono::steady_clock::now();
+  for (const std::unique_ptr<Loop> &loop : mLoops) {
+    {
+      std::lock_guard<std::mutex> lock(loop->mailboxMutex);
+      loop->mailbox.push_back(message);
+    }
+#ifdef HFM_STRATUM_SERVER_EPOLL
+    const uint64_t one = 1;
+    [[maybe_unused]] const ssize_t written =
+        ::write(loop->wakeup, &one, sizeof(one));
+#endif
+  }
+}
+
+size_t Stratum::Server::getConnectionCount() const {
+  size_t count = 0;
+  for (const std::unique_ptr<Loop> &loop : mLoops) {
+    count += loop->open.load(std::memory_order_relaxed);
+  }
+  return count;
+}
+
+size_t Stratum::Server::getPausedCount() const {
+  size_t count = 0;
+  for (const std::unique_ptr<Loop> &loop : mLoops) {
+    count += loop->paused.load(std::memory_order_relaxed);
+  }
+  return count;
+}
+
+Stratum::BroadcastStats Stratum::Server::getBroadcastStats() const {
+  std::vector<std::chrono::nanoseconds> times;
+  BroadcastStats stats;
+  {
+    std::lock_guard<std::mutex> lock(mStatsMutex);
+    stats.broadcasts = mCompleted;
+    times.assign(mCompletions.begin(),
+                 mCompletions.begin() +
+                     static_cast<ptrdiff_t>(
+                         std::min<uint64_t>(mCompleted, mCompletions.size())));
+  }
+  if (times.empty()) {
+    return stats;
+  }
+  std::sort(times.begin(), times.end());
+  stats.p50 = times[(times.size() - 1) / 2];
+  stats.p99 = times[(times.size() - 1) * 99 / 100];
+  stats.max = times.back();
+  return stats;
+}
+
+void Stratum::Server::run(Loop &loop) {
+  using namespace Server_internal;
+
+#ifdef HFM_STRATUM_SERVER_EPOLL
+  epoll_event events[MAX_EVENTS];
+  while (mRunning.load(std::memory_order_relaxed)) {
+    const int count = ::epoll_wait(loop.epoll, events, MAX_EVENTS, -1);
+    if (count < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      break;
+    }
+    for (int i = 0; i < count; ++i) {
+      const uint64_t tag = events[i].data.u64;
+      if (tag == LISTENER_TAG) {
+        accept(loop);
+        continue;
+      }
+      if (tag == WAKEUP_TAG) {
+        uint64_t value = 0;
+        [[maybe_unused]] const ssize_t n =
+            ::read(loop.wakeup, &value, sizeof(value));
+        deliver(loop);
+        continue;
+      }
+      Connection *connection =
+          loop.connections[tag - FIRST_CONNECTION_TAG].get();
+      if (connection == nullptr) {
+        continue;
+      }
+      if ((events[i].events & (EPOLLHUP | EPOLLERR)) != 0) {
+        close(loop, *connection);
+        continue;
+      }
+      if ((events[i].events & (EPOLLIN | EPOLLRDHUP)) != 0) {
+        if (!connection->reading) {
+          mPausedWakeups.fetch_add(1, std::memory_order_relaxed);
+        }
+        receive(loop, *connection);
+      }
+      if (connection->fd >= 0 && (events[i].events & EPOLLOUT) != 0) {
+        if (!flush(*connection)) {
+          close(loop, *connection);
+        } else {
+          updateInterest(loop, *connection);
+        }
+      }
+    }
+    for (const std::unique_ptr<Connection> &connection : loop.closed) {
+      loop.freeSlots.push_back(connection->slot);
+    }
+    loop.closed.clear();
+  }
+#else
+  (void)loop;
+#endif
+}
+
+void Stratum::Server::accept(Loop &loop) {
+  using namespace Server_internal;
+
+#ifdef HFM_STRATUM_SERVER_EPOLL
+  for (;;) {
+    const int fd = ::accept4(loop.listener, nullptr, nullptr,
+                             SOCK_NONBLOCK | SOCK_CLOEXEC);
+    if (fd < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return;
+    }
+    // Jobs are single small writes: send them at once
+    const int on = 1;
+    ::setsockopt(fd, IPPROTO_TCP, TCP_NODELAY, &on, sizeof(on));
+
+    uint32_t slot = 0;
+    if (loop.freeSlots.empty()) {
+      slot = static_cast<uint32_t>(loop.connections.size());
+      loop.connections.emplace_back();
+    } else {
+      slot = loop.freeSlots.back();
+      loop.freeSlots.pop_back();
+    }
+    auto connection = std::make_unique<Connection>();
+    connection->fd = fd;
+    connection->slot = slot;
+    // Interleaving the loops' counters keeps ids, and so extranonce1s,
+    // unique across loops
+    connection->id = loop.accepted++ * mLoops.size() + loop.index;
+    for (size_t i = 0; i < mConfig.extranonce1Size; ++i) {
+      connection->extranonce1[mConfig.extranonce1Size - 1 - i] =
+          static_cast<uint8_t>(connection->id >> (8 * i));
+    }
+
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLRDHUP;
+    event.data.u64 = slot + FIRST_CONNECTION_TAG;
+    if (::epoll_ctl(loop.epoll, EPOLL_CTL_ADD, fd, &event) != 0) {
+      ::close(fd);
+      loop.freeSlots.push_back(slot);
+      continue;
+    }
+    loop.connections[slot] = std::move(connection);
+    loop.open.fetch_add(1, std::memory_order_relaxed);
+  }
+#else
+  (void)loop;
+#endif
+}
+
+void Stratum::Server::deliver(Loop &loop) {
+  {
+    std::lock_guard<std::mutex> lock(loop.mailboxMutex);
+    std::swap(loop.mailbox, loop.delivering);
+  }
+  for (const std::shared_ptr<Message> &message : loop.delivering) {
+    loop.job = message;
+    for (size_t slot = 0; slot < loop.connections.size(); ++slot) {
+      Connection *connection = loop.connections[slot].get();
+      if (connection != nullptr && connection->subscribed &&
+          connection->authorized) {
+        enqueue(loop, *connection, message, true);
+      }
+    }
+    // Release this loop's hold on the completion count
+    complete(*message);
+  }
+  loop.delivering.clear();
+}
+
+void Stratum::Server::receive(Loop &loop, Connection &connection) {
+  using namespace Server_internal;
+
+#ifdef HFM_STRATUM_SERVER_EPOLL
+  while (connection.fd >= 0 && connection.reading) {
+    const ssize_t n =
+        ::recv(connection.fd, loop.buffer.data(), loop.buffer.size(), 0);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        close(loop, connection);
+      }
+      return;
+    }
+    if (n == 0) {
+      close(loop, connection);
+      return;
+    }
+
+    // Lines are handled where they landed unless split across reads
+    std::string_view data(loop.buffer.data(), static_cast<size_t>(n));
+    while (connection.fd >= 0 && !data.empty()) {
+      const size_t newline = data.find('\n');
+      if (newline == std::string_view::npos) {
+        if (connection.partial.size() + data.size() > MAX_LINE_SIZE) {
+          close(loop, connection);
+          return;
+        }
+        connection.partial.append(data);
+        break;
+      }
+      std::string_view line = data.substr(0, newline);
+      data.remove_prefix(newline + 1);
+      if (!connection.partial.empty()) {
+        loop.line.assign(connection.partial).append(line);
+        connection.partial.clear();
+        line = loop.line;
+      }
+      if (!line.empty() && line.back() == '\r') {
+        line.remove_suffix(1);
+      }
+      processLine(loop, connection, line);
+    }
+  }
+#else
+  (void)loop;
+  (void)connection;
+#endif
+}
+
+void Stratum::Server::processLine(Loop &loop, Connection &connection,
+                                  std::string_view line) {
+  using namespace Server_internal;
+
+  // Note where the id, method and params are; members may come in any order
+  JsonReader reader(line);
+  if (reader.next() != JsonToken::BeginObject) {
+    return;
+  }
+  std::string_view id = "null";
+  std::string_view method;
+  std::string_view params;
+  for (JsonToken token = reader.next(); token == JsonToken::Key;
+       token = reader.next()) {
+    const std::string_view key = reader.getValue();
+    if (key == "method") {
+      if (reader.next() != JsonToken::String) {
+        return;
+      }
+      method = reader.getValue();
+      continue;
+    }
+    const size_t begin = reader.getOffset();
+    if (!reader.skipValue()) {
+      return;
+    }
+    std::string_view value = line.substr(begin, reader.getOffset() - begin);
+    while (!value.empty() && value.front() == ' ') {
+      value.remove_prefix(1);
+    }
+    if (key == "id") {
+      id = value;
+    } else if (key == "params") {
+      params = value;
+    }
+  }
+
+  JsonReader arguments(params);
+  const bool has_array = arguments.next() == JsonToken::BeginArray;
+  if (method == "mining.submit") {
+    // [worker, job, extranonce2, ntime, nonce, version bits?]
+    if (!connection.authorized) {
+      reply(loop, connection, id, "null", "[24,\"Unauthorized worker\",null]");
+      return;
+    }
+    Submission submission;
+    std::string_view worker;
+    uint8_t extranonce2[8];
+    bool valid = has_array && readString(arguments, loop.scratch, worker) &&
+                 readString(arguments, loop.scratch, submission.jobId) &&
+                 arguments.next() == JsonToken::String &&
+                 arguments.getValue().size() ==
+                     2 * mConfig.extranonce2Size &&
+                 util::DecodeHex(arguments.getValue(), extranonce2) &&
+                 readHex32(arguments, submission.time) &&
+                 readHex32(arguments, submission.nonce);
+    if (valid) {
+      const JsonToken token = arguments.next();
+      if (token == JsonToken::String) {
+        valid = decodeHex32(arguments.getValue(), submission.versionBits) &&
+                (submission.versionBits & ~connection.versionMask) == 0;
+      }
+    }
+    if (!valid) {
+      reply(loop, connection, id, "null", "[20,\"Malformed share\",null]");
+      return;
+    }
+    submission.connection = connection.id;
+    submission.extranonce1 = std::span<const uint8_t>(connection.extranonce1)
+                                 .first(mConfig.extranonce1Size);
+    submission.worker = connection.worker;
+    submission.extranonce2 =
+        std::span<const uint8_t>(extranonce2, mConfig.extranonce2Size);
+    if (!mSubmitHandler || mSubmitHandler(submission)) {
+      reply(loop, connection, id, "true");
+    } else {
+      reply(loop, connection, id, "null", "[23,\"Share rejected\",null]");
+    }
+  } else if (method == "mining.subscribe") {
+    // [[subscriptions...], "extranonce1", extranonce2_size]
+    std::string &result = loop.scratch;
+    char hex[16];
+    const std::span<const uint8_t> extranonce1 =
+        std::span<const uint8_t>(connection.extranonce1)
+            .first(mConfig.extranonce1Size);
+    util::EncodeHex(extranonce1, hex);
+    const std::string_view subscription(hex, 2 * extranonce1.size());
+    result.assign("[[[\"mining.set_difficulty\",\"")
+        .append(subscription)
+        .append("\"],[\"mining.notify\",\"")
+        .append(subscription)
+        .append("\"]],\"")
+        .append(subscription)
+        .append("\",")
+        .append(std::to_string(mConfig.extranonce2Size))
+        .append("]");
+    reply(loop, connection, id, result);
+    const bool ready = connection.authorized && !connection.subscribed;
+    connection.subscribed = true;
+    if (ready) {
+      sendJob(loop, connection);
+    }
+  } else if (method == "mining.authorize") {
+    std::string_view worker;
+    if (!has_array || !readString(arguments, loop.scratch, worker)) {
+      reply(loop, connection, id, "null", "[20,\"Malformed request\",null]");
+      return;
+    }
+    connection.worker.assign(worker);
+    reply(loop, connection, id, "true");
+    const bool ready = connection.subscribed && !connection.authorized;
+    connection.authorized = true;
+    if (ready) {
+      sendJob(loop, connection);
+    }
+  } else if (method == "mining.configure") {
+    // [["version-rolling", ...], {"version-rolling.mask": "1fffe000"}]
+    bool rolling = false;
+    uint32_t mask = mConfig.versionRollingMask;
+    if (has_array && arguments.next() == JsonToken::BeginArray) {
+      for (JsonToken token = arguments.next();
+           token == JsonToken::String; token = arguments.next()) {
+        rolling = rolling || arguments.getValue() == "version-rolling";
+      }
+      if (arguments.next() == JsonToken::BeginObject) {
+        for (JsonToken token = arguments.next(); token == JsonToken::Key;
+             token = arguments.next()) {
+          uint32_t requested = 0;
+          if (arguments.getValue() == "version-rolling.mask") {
+            if (readHex32(arguments, requested)) {
+              mask &= requested;
+            }
+          } else if (!arguments.skipValue()) {
+            break;
+          }
+        }
+      }
+    }
+    std::string &result = loop.scratch;
+    if (rolling && mConfig.versionRollingMask != 0) {
+      connection.versionMask = mask;
+      result.assign("{\"version-rolling\":true,\"version-rolling.mask\":");
+      appendHex32(result, mask);
+      result.push_back('}');
+    } else {
+      result.assign("{\"version-rolling\":false}");
+    }
+    reply(loop, connection, id, result);
+  } else if (method == "mining.extranonce.subscribe") {
+    reply(loop, connection, id, "true");
+  } else if (!method.empty() && id != "null") {
+    reply(loop, connection, id, "null", "[20,\"Unknown method\",null]");
+  }
+}
+
+void Stratum::Server::reply(Loop &loop, Connection &connection,
+                            std::string_view id, std::string_view result,
+                            std::string_view error) {
+  auto message = std::make_shared<Message>();
+  message->line.append("{\"id\":")
+      .append(id)
+      .append(",\"result\":")
+      .append(result)
+      .append(",\"error\":")
+      .append(error)
+      .append("}\n");
+  enqueue(loop, connection, std::move(message), false);
+}
+
+void Stratum::Server::enqueue(Loop &loop, Connection &connection,
+                              std::shared_ptr<Message> message,
+                              bool tracked) {
+  if (connection.fd < 0) {
+    return;
+  }
+  // A clean job makes the jobs still waiting whole worthless
+  if (message->job && message->clean) {
+    for (auto chunk = connection.queue.begin();
+         chunk != connection.queue.end();) {
+      if (!chunk->message->job || chunk->offset != 0) {
+        ++chunk;
+        continue;
+      }
+      connection.queued -= chunk->message->line.size();
+      if (chunk->tracked) {
+        complete(*chunk->message);
+      }
+      chunk = connection.queue.erase(chunk);
+    }
+  }
+  if (tracked) {
+    message->pending.fetch_add(1, std::memory_order_relaxed);
+  }
+  const bool idle = connection.queue.empty();
+  connection.queued += message->line.size();
+  connection.queue.push_back({std::move(message), 0, tracked});
+
+  // A connection waiting for EPOLLOUT is flushed when it comes
+  if (idle && !flush(connection)) {
+    close(loop, connection);
+    return;
+  }
+  if (connection.queued > mConfig.maxQueuedBytes) {
+    mSlowDisconnects.fetch_add(1, std::memory_order_relaxed);
+    close(loop, connection);
+    return;
+  }
+  updateInterest(loop, connection);
+}
+
+bool Stratum::Server::flush(Connection &connection) {
+  using namespace Server_internal;
+
+#ifdef HFM_STRATUM_SERVER_EPOLL
+  while (!connection.queue.empty()) {
+    // Gather the queued lines straight from the shared buffers
+    iovec iov[MAX_IOVECS];
+    size_t count = 0;
+    for (const Connection::Chunk &chunk : connection.queue) {
+      if (count == MAX_IOVECS) {
+        break;
+      }
+      iov[count].iov_base = chunk.message->line.data() + chunk.offset;
+      iov[count].iov_len = chunk.message->line.size() - chunk.offset;
+      ++count;
+    }
+    // sendmsg is writev with MSG_NOSIGNAL
+    msghdr header{};
+    header.msg_iov = iov;
+    header.msg_iovlen = count;
+    const ssize_t n = ::sendmsg(connection.fd, &header, MSG_NOSIGNAL);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      return errno == EAGAIN || errno == EWOULDBLOCK;
+    }
+
+    size_t sent = static_cast<size_t>(n);
+    connection.queued -= sent;
+    while (sent > 0) {
+      Connection::Chunk &chunk = connection.queue.front();
+      const size_t rest = chunk.message->line.size() - chunk.offset;
+      if (sent < rest) {
+        chunk.offset += sent;
+        break;
+      }
+      sent -= rest;
+      if (chunk.tracked) {
+        complete(*chunk.message);
+      }
+      connection.queue.pop_front();
+    }
+  }
+  return true;
+#else
+  (void)connection;
+  return false;
+#endif
+}
+
+void Stratum::Server::updateInterest(Loop &loop, Connection &connection) {
+  using namespace Server_internal;
+
+#ifdef HFM_STRATUM_SERVER_EPOLL
+  const bool writing = !connection.queue.empty();
+  const bool reading = connection.queued <= mConfig.maxQueuedBytes / 2;
+  if (writing == connection.writing && reading == connection.reading) {
+    return;
+  }
+  // A paused connection does not watch for the peer half-closing either:
+  // the level-triggered event would fire on every wait while receive()
+  // declines to read. It is seen once reading resumes.
+  epoll_event event{};
+  event.events = (reading ? EPOLLIN | EPOLLRDHUP : 0u) |
+                 (writing ? EPOLLOUT : 0u);
+  event.data.u64 = connection.slot + FIRST_CONNECTION_TAG;
+  ::epoll_ctl(loop.epoll, EPOLL_CTL_MOD, connection.fd, &event);
+  if (reading != connection.reading) {
+    if (reading) {
+      loop.paused.fetch_sub(1, std::memory_order_relaxed);
+    } else {
+      loop.paused.fetch_add(1, std::memory_order_relaxed);
+    }
+  }
+  connection.writing = writing;
+  connection.reading = reading;
+#else
+  (void)loop;
+  (void)connection;
+#endif
+}
+
+void Stratum::Server::close(Loop &loop, Connection &connection) {
+#ifdef HFM_STRATUM_SERVER_EPOLL
+  if (connection.fd < 0) {
+    return;
+  }
+  for (const Connection::Chunk &chunk : connection.queue) {
+    if (chunk.tracked) {
+      complete(*chunk.message);
+    }
+  }
+  connection.queue.clear();
+  connection.queued = 0;
+  ::epoll_ctl(loop.epoll, EPOLL_CTL_DEL, connection.fd, nullptr);
+  ::close(connection.fd);
+  connection.fd = -1;
+  loop.open.fetch_sub(1, std::memory_order_relaxed);
+  if (!connection.reading) {
+    loop.paused.fetch_sub(1, std::memory_order_relaxed);
+  }
+  // Freed after the event batch; the caller may still hold it
+  loop.closed.push_back(std::move(loop.connections[connection.slot]));
+#else
+  (void)loop;
+  (void)connection;
+#endif
+}
+
+void Stratum::Server::sendJob(Loop &loop, Connection &connection) {
+  enqueue(loop, connection, mDifficulty, false);
+  if (loop.job) {
+    enqueue(loop, connection, loop.job, false);
+  }
+}
+
+void Stratum::Server::complete(Message &message) {
+  using namespace Server_internal;
+
+  if (message.pending.fetch_sub(1, std::memory_order_acq_rel) != 1) {
+    return;
+  }
+  const auto elapsed = std::chrono::duration_cast<std::chrono::nanoseconds>(
+      std::chrono::steady_clock::now() - message.start);
+  std::lock_guard<std::mutex> lock(mStatsMutex);
+  mCompletions[mCompleted % STATS_SIZE] = elapsed;
+  ++mCompleted;
+}
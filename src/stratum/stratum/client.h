@@ -0,0 +1,178 @@
+#ifndef __STRATUM_CLIENT_H__
+#define __STRATUM_CLIENT_H__
+
+// system includes
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// project includes
+#include "block/miningJob.h"
+#include "net/tcpClient.h"
+#include "stratum/notify.h"
+
+namespace Stratum {
+
+/// \brief Pool connection settings.
+struct ClientConfig {
+  std::string host = "127.0.0.1";
+  uint16_t port = 3333;
+
+  /// \brief Worker name and password for mining.authorize.
+  std::string user;
+  std::string password = "x";
+
+  /// \brief Sent with mining.subscribe.
+  std::string userAgent = "HF-Miner/1.0";
+
+  /// \brief Header version bits to ask to roll with mining.configure
+  /// (BIP310); 0 skips the request.
+  uint32_t versionRollingMask = 0x1fffe000;
+
+  /// \brief Bound on connecting and on the subscribe/authorize handshake.
+  std::chrono::milliseconds timeout{10000};
+};
+
+/// \brief The pool's answer to a mining.submit.
+struct SubmitResult {
+  /// \brief Request id returned by Client::submit().
+  uint64_t id = 0;
+  bool accepted = false;
+
+  /// \brief The pool's error, as JSON, when not accepted.
+  std::string_view error;
+};
+
+/// \brief Stratum v1 mining client.
+/// \note One thread drives the connection with poll() or run(), on a
+/// Net::TcpClient. Incoming lines are parsed in place in its receive
+/// buffer; a mining.notify is decoded into a reused Notify and Block::MiningJob and
+/// handed to the job handler before the next line is read, so new work
+/// reaches the hashing threads without an allocation or a queue hop. Other
+/// threads may call submit() and stop(): submissions are formatted into a
+/// mutex-guarded outbox and the loop is woken to send them. Handlers and
+/// the getters belong to the loop thread. Linux only.
+class Client {
+public:
+  /// \brief Called for every job.
+  /// \note The job is built with the current extranonce1, and both
+  /// arguments are only valid during the call.
+  using JobHandler =
+      std::function<void(const Notify &notify, const Block::MiningJob &job)>;
+
+  /// \brief Called for every answered submission.
+  using ResultHandler = std::function<void(const SubmitResult &result)>;
+
+  /// \brief Construct an unconnected client.
+  /// \param config Pool and worker settings.
+  /// \throws std::system_error as Net::TcpClient().
+  explicit Client(const ClientConfig &config);
+
+  /// \brief Close the connection.
+  ~Client();
+
+  Client(const Client &) = delete;
+  Client &operator=(const Client &) = delete;
+
+  /// \brief Set the job handler; call before connect().
+  inline void setJobHandler(JobHandler handler) {
+    mJobHandler = std::move(handler);
+  }
+
+  /// \brief Set the submission result handler; call before connect().
+  inline void setResultHandler(ResultHandler handler) {
+    mResultHandler = std::move(handler);
+  }
+
+  /// \brief Connect, then configure version rolling, subscribe and
+  /// authorize.
+  /// \note Returns once authorized. Jobs sent during the handshake already
+  /// reach the job handler.
+  /// \throws std::system_error on socket errors.
+  /// \throws std::runtime_error if the pool rejects the subscription or the
+  /// worker, closes the connection, or does not answer within the timeout.
+  void connect();
+
+  /// \brief Process socket events.
+  /// \param timeout Longest wait for an event; negative waits until one
+  /// arrives.
+  /// \return false once the connection is closed.
+  /// \throws std::system_error on socket errors.
+  inline bool poll(std::chrono::milliseconds timeout) {
+    return mConnection.poll(timeout);
+  }
+
+  /// \brief Process socket events until stop() or until the connection
+  /// closes.
+  /// \throws std::system_error on socket errors.
+  inline void run() { mConnection.run(); }
+
+  /// \brief Make run() return. Thread-safe.
+  inline void stop() { mConnection.stop(); }
+
+  /// \brief Submit a share. Thread-safe.
+  /// \param jobId Job the share belongs to.
+  /// \param extranonce2 The rolled extranonce part.
+  /// \param time Header timestamp.
+  /// \param nonce Header nonce.
+  /// \param versionBits Rolled version bits (header version XOR job
+  /// version); sent unless zero.
+  /// \return Request id, repeated in the SubmitResult.
+  uint64_t submit(std::string_view jobId,
+                  std::span<const uint8_t> extranonce2, uint32_t time,
+                  uint32_t nonce, uint32_t versionBits = 0);
+
+  /// \brief Whether the connection is open.
+  inline bool isConnected() const { return mConnection.isConnected(); }
+
+  /// \brief Get the extranonce part fixed by the pool.
+  inline std::span<const uint8_t> getExtranonce1() const {
+    return mExtranonce1;
+  }
+
+  /// \brief Get the size of the extranonce part the miner rolls.
+  inline size_t getExtranonce2Size() const { return mExtranonce2Size; }
+
+  /// \brief Get the share difficulty (1 until the pool sets one).
+  inline double getDifficulty() const { return mDifficulty; }
+
+  /// \brief Get the version bits the pool lets the miner roll (0 without
+  /// version rolling).
+  inline uint32_t getVersionMask() const { return mVersionMask; }
+
+private:
+  size_t receive(std::span<const uint8_t> pending, size_t seen);
+  void processLine(std::string_view line);
+  void processResponse(uint64_t id, std::string_view result,
+                       std::string_view error);
+  void processNotification(std::string_view method, std::string_view params);
+  bool parseSubscribeResult(std::string_view result);
+
+  ClientConfig mConfig;
+  JobHandler mJobHandler;
+  ResultHandler mResultHandler;
+
+  Net::TcpClient mConnection;
+  uint64_t mNextId; // guarded by the connection's outbox lock
+  bool mSubscribed;
+  bool mAuthorized;
+  std::string mRejection; // what the pool refused, if anything
+
+  // Session state from the pool
+  std::vector<uint8_t> mExtranonce1;
+  size_t mExtranonce2Size;
+  double mDifficulty;
+  uint32_t mVersionMask;
+
+  // Current job, reused for every notification
+  Notify mNotify;
+  Block::MiningJob mJob;
+};
+
+} // namespace Stratum
+#endif // __STRATUM_CLIENT_H__
@@ -0,0 +1,96 @@
+#ifndef __MOCK_POOL_H__
+#define __MOCK_POOL_H__
+
+// system includes
+#include <chrono>
+#include <cstdint>
+#include <istream>
+#include <string>
+#include <string_view>
+
+namespace Stratum {
+
+/// \brief Scriptable Stratum pool on the loopback interface, for tests and
+/// benchmarks.
+/// \note Serves one miner at a time over blocking sockets. A test drives it
+/// call by call from its own thread; the HF-MockPool binary feeds it a
+/// script, one command per line:
+///
+///     accept                    wait for a miner to connect
+///     expect <method>           read requests until one calls <method>
+///     reply <json>              answer the last expected request
+///     error <json>              answer it with an error
+///     send <json>               send a line as is
+///     sleep <milliseconds>
+///     close                     drop the connection
+///
+/// Blank lines and lines starting with # are skipped.
+class MockPool {
+public:
+  /// \brief A request read from the miner.
+  struct Request {
+    std::string id;     // JSON text of the id
+    std::string method;
+    std::string params; // JSON text of the params
+  };
+
+  /// \brief Listen on 127.0.0.1.
+  /// \param port Port to listen on; 0 picks a free one.
+  /// \throws std::system_error if the port cannot be bound, or with
+  /// std::errc::not_supported without POSIX sockets.
+  explicit MockPool(uint16_t port = 0);
+
+  /// \brief Close the listener and the connection.
+  ~MockPool();
+
+  MockPool(const MockPool &) = delete;
+  MockPool &operator=(const MockPool &) = delete;
+
+  /// \brief Get the port listened on.
+  inline uint16_t getPort() const { return mPort; }
+
+  /// \brief Wait for a miner, dropping the previous one.
+  /// \param timeout Longest wait.
+  /// \throws std::runtime_error if nobody connects in time.
+  void accept(std::chrono::milliseconds timeout = std::chrono::seconds(10));
+
+  /// \brief Read requests until one calls a method; others are discarded.
+  /// \param method The method, e.g. "mining.subscribe".
+  /// \param timeout Longest wait.
+  /// \return The request.
+  /// \throws std::runtime_error on a timeout or a closed connection.
+  Request expect(std::string_view method,
+                 std::chrono::milliseconds timeout = std::chrono::seconds(10));
+
+  /// \brief Answer a request.
+  /// \param request The request.
+  /// \param result JSON result.
+  /// \param error JSON error.
+  void reply(const Request &request, std::string_view result,
+             std::string_view error = "null");
+
+  /// \brief Send a line; the newline is added.
+  /// \param line JSON text.
+  /// \throws std::system_error if the miner is gone.
+  void send(std::string_view line);
+
+  /// \brief Drop the connection.
+  void close();
+
+  /// \brief Run a script (see the class note).
+  /// \param script The commands.
+  /// \throws std::invalid_argument on an unknown command.
+  void runScript(std::istream &script);
+
+private:
+  bool readLine(std::string &line, std::chrono::milliseconds timeout);
+
+  int mListener;
+  int mSocket;
+  uint16_t mPort;
+  std::string mReceived;
+  Request mLast; // answered by the script's reply and error
+};
+
+} // namespace Stratum
+#endif // __MOCK_POOL_H__
@@ -0,0 +1,79 @@
+#ifndef __NOTIFY_H__
+#define __NOTIFY_H__
+
+// system includes
+#include <cstdint>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// project includes
+#include "block/packedHeader.h"
+#include "types/types.h"
+
+namespace Stratum {
+
+/// \brief The parameters of a mining.notify message.
+/// \note Fields are decoded from their Stratum hex forms: the previous block
+/// hash arrives as eight 4-byte words each written byte-reversed, and the
+/// version, bits and time as big-endian hex. All are stored in header byte
+/// order. Parsing into a Notify that held a job before reuses its buffers,
+/// so steady-state parsing does not allocate.
+struct Notify {
+  std::string jobId;
+
+  /// \brief Previous block hash (raw little-endian bytes).
+  Hash prevHash{};
+
+  /// \brief Coinbase serialization before and after the extranonce.
+  std::vector<uint8_t> coinbase1;
+  std::vector<uint8_t> coinbase2;
+
+  /// \brief Hashes the coinbase txid is paired with, from the leaves up.
+  std::vector<Hash> merkleBranch;
+
+  uint32_t version = 0;
+  uint32_t bits = 0;
+  uint32_t time = 0;
+
+  /// \brief Whether work on earlier jobs should be abandoned.
+  bool clean = false;
+
+  /// \brief Header with the version, previous block hash, time and bits.
+  Block::PackedHeader getHeader() const;
+};
+
+/// \brief Parse the params array of a mining.notify message.
+/// \param params The array, e.g. ["job", "prevhash", "coinb1", "coinb2",
+/// [branch...], "version", "nbits", "ntime", clean].
+/// \param notify Receives the fields; unchanged members are undefined if
+/// the array is malformed.
+/// \return false if the array is malformed.
+bool parseNotify(std::string_view params, Notify &notify);
+
+/// \brief Format a complete mining.notify line, the inverse of
+/// parseNotify().
+/// \param notify The job.
+/// \param out Receives the JSON line, newline included; its previous
+/// contents are replaced.
+void formatNotify(const Notify &notify, std::string &out);
+
+/// \brief Decode a 32-bit field written as 8 big-endian hex digits
+/// (version, nbits, ntime, version mask).
+/// \param hex The digits.
+/// \param value Receives the value.
+/// \return false unless hex is 8 hex digits.
+bool decodeHex32(std::string_view hex, uint32_t &value);
+
+/// \brief Encode a 32-bit field as 8 big-endian hex digits.
+/// \param value The value.
+/// \param out Destination of 8 characters; not terminated.
+void encodeHex32(uint32_t value, char *out);
+
+/// \brief Append a 32-bit field as a JSON string of 8 big-endian hex digits.
+/// \param out String to append to.
+/// \param value The value.
+void appendHex32(std::string &out, uint32_t value);
+
+} // namespace Stratum
+#endif // __NOTIFY_H__
@@ -0,0 +1,194 @@
+#ifndef __STRATUM_SERVER_H__
+#define __STRATUM_SERVER_H__
+
+// system includes
+#include <atomic>
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+// project includes
+#include "stratum/notify.h"
+
+namespace Stratum {
+
+/// \brief Pool front-end settings.
+struct ServerConfig {
+  /// \brief IPv4 address and port to listen on; port 0 picks a free one.
+  std::string host = "0.0.0.0";
+  uint16_t port = 3333;
+
+  /// \brief Event loops; 0 runs one per core.
+  size_t threads = 0;
+
+  /// \brief Sizes of the extranonce part assigned to each connection and
+  /// of the part miners roll.
+  size_t extranonce1Size = 4;
+  size_t extranonce2Size = 4;
+
+  /// \brief Share difficulty sent to every miner once authorized.
+  double difficulty = 1;
+
+  /// \brief Version bits miners may roll (BIP310); 0 refuses version
+  /// rolling.
+  uint32_t versionRollingMask = 0x1fffe000;
+
+  /// \brief Unsent bytes a connection may hold. Past half of it its
+  /// requests are no longer read; past all of it it is dropped.
+  size_t maxQueuedBytes = 256 * 1024;
+};
+
+/// \brief A mining.submit, decoded; views are valid during the handler.
+struct Submission {
+  /// \brief Connection id, unique for the server's lifetime.
+  uint64_t connection = 0;
+
+  /// \brief The connection's extranonce1 and authorized worker name.
+  std::span<const uint8_t> extranonce1;
+  std::string_view worker;
+
+  std::string_view jobId;
+  std::span<const uint8_t> extranonce2;
+  uint32_t time = 0;
+  uint32_t nonce = 0;
+
+  /// \brief Rolled version bits; 0 if none were sent.
+  uint32_t versionBits = 0;
+};
+
+/// \brief Time from broadcast() until the job was handed to the kernel for
+/// every connection, over the recent broadcasts.
+struct BroadcastStats {
+  uint64_t broadcasts = 0; // completed, all time
+  std::chrono::nanoseconds p50{0};
+  std::chrono::nanoseconds p99{0};
+  std::chrono::nanoseconds max{0};
+};
+
+/// \brief Stratum v1 pool front-end: accepts miners, runs their handshake,
+/// hands each its own extranonce1, forwards shares and broadcasts jobs.
+/// \note Connections are sharded across event loops, one thread each, with
+/// an SO_REUSEPORT listener per loop so the kernel spreads new connections
+/// and no connection ever moves between threads. broadcast() formats a
+/// job once into a reference-counted buffer and posts it to every loop;
+/// each loop queues a reference on its connections and writes it with
+/// writev(), so the bytes are never copied per connection.
+///
+/// Slow readers are handled in three steps: a clean job replaces the
+/// queued jobs a connection has not started receiving, a connection
+/// holding more than half of maxQueuedBytes stops being read, and one
+/// holding more than all of it is dropped. Linux only.
+class Server {
+public:
+  /// \brief Called on a loop thread for every well-formed share from an
+  /// authorized worker; returns whether the share is accepted. Must be
+  /// thread-safe when there are several loops.
+  using SubmitHandler = std::function<bool(const Submission &submission)>;
+
+  /// \brief Create the listeners; the loops start with start().
+  /// \param config Settings.
+  /// \throws std::invalid_argument on extranonce sizes outside 1..8 or an
+  /// unparsable host.
+  /// \throws std::system_error if the port cannot be bound, or with
+  /// std::errc::not_supported off Linux.
+  explicit Server(const ServerConfig &config);
+
+  /// \brief Stop the loops and close every connection.
+  ~Server();
+
+  Server(const Server &) = delete;
+  Server &operator=(const Server &) = delete;
+
+  /// \brief Set the share handler; call before start(). Without one every
+  /// well-formed share is accepted.
+  inline void setSubmitHandler(SubmitHandler handler) {
+    mSubmitHandler = std::move(handler);
+  }
+
+  /// \brief Start the event loops.
+  void start();
+
+  /// \brief Stop the event loops and wait for them.
+  void stop();
+
+  /// \brief Broadcast a job to every authorized miner; miners authorized
+  /// later get it too. Thread-safe.
+  /// \param notify The job.
+  void broadcast(const Notify &notify);
+
+  /// \brief Get the port listened on.
+  inline uint16_t getPort() const { return mPort; }
+
+  /// \brief Get the number of event loops.
+  inline size_t getLoopCount() const { return mLoops.size(); }
+
+  /// \brief Get the number of open connections. Thread-safe.
+  size_t getConnectionCount() const;
+
+  /// \brief Get the number of open connections whose requests are not
+  /// read because too much is queued for them. Thread-safe.
+  size_t getPausedCount() const;
+
+  /// \brief Get the number of connections dropped for not reading.
+  /// Thread-safe.
+  inline uint64_t getSlowDisconnects() const {
+    return mSlowDisconnects.load(std::memory_order_relaxed);
+  }
+
+  /// \brief Get the number of read events reported for paused connections.
+  /// \note Paused connections are not watched for reading, so this stays 0
+  /// but for an event reported as its connection was paused. Thread-safe.
+  inline uint64_t getPausedWakeups() const {
+    return mPausedWakeups.load(std::memory_order_relaxed);
+  }
+
+  /// \brief Get broadcast completion times. Thread-safe.
+  BroadcastStats getBroadcastStats() const;
+
+private:
+  struct Message;
+  struct Connection;
+  struct Loop;
+
+  void run(Loop &loop);
+  void accept(Loop &loop);
+  void deliver(Loop &loop);
+  void receive(Loop &loop, Connection &connection);
+  void processLine(Loop &loop, Connection &connection,
+                   std::string_view line);
+  void reply(Loop &loop, Connection &connection, std::string_view id,
+             std::string_view result, std::string_view error = "null");
+  void enqueue(Loop &loop, Connection &connection,
+               std::shared_ptr<Message> message, bool tracked);
+  bool flush(Connection &connection);
+  void updateInterest(Loop &loop, Connection &connection);
+  void close(Loop &loop, Connection &connection);
+  void sendJob(Loop &loop, Connection &connection);
+  void complete(Message &message);
+
+  ServerConfig mConfig;
+  SubmitHandler mSubmitHandler;
+  uint16_t mPort;
+  std::vector<std::unique_ptr<Loop>> mLoops;
+  std::atomic<bool> mRunning;
+  std::atomic<uint64_t> mSlowDisconnects;
+  std::atomic<uint64_t> mPausedWakeups;
+
+  // mining.set_difficulty, sent to miners once authorized
+  std::shared_ptr<Message> mDifficulty;
+
+  // Completion times of the last STATS_SIZE broadcasts, as a ring
+  mutable std::mutex mStatsMutex;
+  std::vector<std::chrono::nanoseconds> mCompletions;
+  uint64_t mCompleted; // guarded by mStatsMutex
+};
+
+} // namespace Stratum
+#endif // __STRATUM_SERVER_H__
@@ -0,0 +1,95 @@
+#ifndef __SWARM_H__
+#define __SWARM_H__
+
+// system includes
+#include <chrono>
+#include <cstddef>
+#include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
+#include <vector>
+
+namespace Stratum {
+
+/// \brief Thousands of synthetic miners on one thread, for load tests of a
+/// pool front-end on the loopback interface.
+/// \note Each miner subscribes and authorizes, then reads everything the
+/// pool sends and notes when each mining.notify arrives. A miner can be
+/// paused to play a client that stops reading, and half-closed to play one
+/// that stops sending. Each miner takes a file descriptor, so large swarms
+/// need a raised RLIMIT_NOFILE. Linux only.
+class Swarm {
+public:
+  using TimePoint = std::chrono::steady_clock::time_point;
+
+  /// \brief Connect the miners and complete their handshakes.
+  /// \param host IPv4 address of the pool.
+  /// \param port Port of the pool.
+  /// \param miners Number of miners.
+  /// \param timeout Bound on the whole handshake.
+  /// \throws std::system_error on socket errors, or with
+  /// std::errc::not_supported off Linux.
+  /// \throws std::runtime_error if a miner is refused or the handshake
+  /// does not finish in time.
+  Swarm(const std::string &host, uint16_t port, size_t miners,
+        std::chrono::milliseconds timeout = std::chrono::seconds(30));
+
+  /// \brief Disconnect every miner.
+  ~Swarm();
+
+  Swarm(const Swarm &) = delete;
+  Swarm &operator=(const Swarm &) = delete;
+
+  /// \brief Get the number of miners.
+  inline size_t size() const { return mMiners.size(); }
+
+  /// \brief Get the extranonce1 the pool gave a miner.
+  std::span<const uint8_t> getExtranonce1(size_t miner) const;
+
+  /// \brief Stop or resume reading for a miner.
+  void setReading(size_t miner, bool reading);
+
+  /// \brief Shut down the sending side of a miner's connection, as a client
+  /// that half-closes; it keeps reading if it was.
+  void halfClose(size_t miner);
+
+  /// \brief Wait until every reading miner has received a job.
+  /// \param jobId The job's id.
+  /// \param timeout Longest wait.
+  /// \return Arrival time per miner; TimePoint() for miners that are
+  /// paused, disconnected, or still without the job at the timeout.
+  std::vector<TimePoint> waitForJob(std::string_view jobId,
+                                    std::chrono::milliseconds timeout);
+
+  /// \brief Get the number of miners the pool disconnected.
+  size_t getClosedCount() const;
+
+private:
+  struct Miner {
+    int fd = -1;
+    bool reading = true;
+    bool subscribed = false;
+    bool authorized = false;
+    std::vector<uint8_t> extranonce1;
+    std::string received;
+    std::string jobId; // latest job
+    TimePoint jobTime;
+  };
+
+  void wait(int timeout);
+  void receive(Miner &miner);
+  void processLine(Miner &miner, std::string_view line, TimePoint now);
+  void close(Miner &miner);
+
+  /// \brief Disconnect every miner and close the epoll instance; called by
+  /// the destructor and before the constructor throws.
+  void closeAll();
+
+  std::vector<Miner> mMiners;
+  int mEpoll;
+  std::vector<char> mBuffer;
+};
+
+} // namespace Stratum
+#endif // __SWARM_H__
@@ -0,0 +1,327 @@
+#include "stratum/swarm.h"
+
+// system includes
+#include <cerrno>
+#include <cstring>
+#include <stdexcept>
+#include <system_error>
+
+// project includes
+#include "util/jsonReader.h"
+#include "util/transcode.h"
+
+#if defined(__linux__)
+#include <arpa/inet.h>
+#include <fcntl.h>
+#include <netinet/in.h>
+#include <sys/epoll.h>
+#include <sys/socket.h>
+#include <unistd.h>
+#define HFM_STRATUM_SWARM_EPOLL 1
+#endif
+
+namespace Stratum {
+namespace Swarm_internal {
+
+using util::JsonReader;
+using util::JsonToken;
+
+static constexpr size_t RECEIVE_SIZE = 64 * 1024;
+
+static const char HANDSHAKE[] =
+    "{\"id\":1,\"method\":\"mining.subscribe\",\"params\":[\"swarm\"]}\n"
+    "{\"id\":2,\"method\":\"mining.authorize\",\"params\":[\"swarm\",\"x\"]}"
+    "\n";
+
+} // namespace Swarm_internal
+} // namespace Stratum
+
+Stratum::Swarm::Swarm(const std::string &host, uint16_t port, size_t miners,
+                      std::chrono::milliseconds timeout)
+    : mMiners(miners), mEpoll(-1), mBuffer(Swarm_internal::RECEIVE_SIZE) {
+  using namespace Swarm_internal;
+
+#ifdef HFM_STRATUM_SWARM_EPOLL
+  sockaddr_in address{};
+  address.sin_family = AF_INET;
+  address.sin_port = htons(port);
+  if (::inet_pton(AF_INET, host.c_str(), &address.sin_addr) != 1) {
+    throw std::invalid_argument("Not an IPv4 address: " + host);
+  }
+  mEpoll = ::epoll_create1(EPOLL_CLOEXEC);
+  if (mEpoll < 0) {
+    throw std::system_error(errno, std::generic_category(),
+                            "Cannot create epoll instance");
+  }
+
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  for (size_t i = 0; i < miners; ++i) {
+    Miner &miner = mMiners[i];
+    miner.fd = ::socket(AF_INET, SOCK_STREAM | SOCK_CLOEXEC, 0);
+    if (miner.fd < 0 ||
+        ::connect(miner.fd, reinterpret_cast<const sockaddr *>(&address),
+                  sizeof(address)) != 0) {
+      const int error = errno;
+      closeAll();
+      throw std::system_error(error, std::generic_category(),
+                              "Swarm cannot connect miner " +
+                                  std::to_string(i));
+    }
+    [[maybe_unused]] const ssize_t sent =
+        ::send(miner.fd, HANDSHAKE, sizeof(HANDSHAKE) - 1, MSG_NOSIGNAL);
+    ::fcntl(miner.fd, F_SETFL, ::fcntl(miner.fd, F_GETFL) | O_NONBLOCK);
+    epoll_event event{};
+    event.events = EPOLLIN | EPOLLRDHUP;
+    event.data.u64 = i;
+    ::epoll_ctl(mEpoll, EPOLL_CTL_ADD, miner.fd, &event);
+  }
+
+  // Wait for every subscription and authorization
+  for (size_t i = 0; i < miners;) {
+    if (mMiners[i].fd < 0) {
+      closeAll();
+      throw std::runtime_error("Pool refused swarm miner " +
+                               std::to_string(i));
+    }
+    if (mMiners[i].subscribed && mMiners[i].authorized) {
+      ++i;
+      continue;
+    }
+    const auto remaining =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+    if (remaining.count() <= 0) {
+      closeAll();
+      throw std::runtime_error("Swarm handshake timed out");
+    }
+    wait(static_cast<int>(remaining.count()));
+  }
+#else
+  (void)host;
+  (void)port;
+  (void)timeout;
+  throw std::system_error(std::make_error_code(std::errc::not_supported),
+                          "Swarm needs epoll");
+#endif
+}
+
+Stratum::Swarm::~Swarm() { closeAll(); }
+
+std::span<const uint8_t> Stratum::Swarm::getExtranonce1(size_t miner) const {
+  return mMiners.at(miner).extranonce1;
+}
+
+void Stratum::Swarm::setReading(size_t miner, bool reading) {
+  Miner &target = mMiners.at(miner);
+  target.reading = reading;
+#ifdef HFM_STRATUM_SWARM_EPOLL
+  if (target.fd >= 0) {
+    // A paused miner still hears about the pool hanging up
+    epoll_event event{};
+    event.events = reading ? EPOLLIN | EPOLLRDHUP : EPOLLRDHUP;
+    event.data.u64 = miner;
+    ::epoll_ctl(mEpoll, EPOLL_CTL_MOD, target.fd, &event);
+  }
+#endif
+}
+
+void Stratum::Swarm::halfClose(size_t miner) {
+  const Miner &target = mMiners.at(miner);
+#ifdef HFM_STRATUM_SWARM_EPOLL
+  if (target.fd >= 0) {
+    ::shutdown(target.fd, SHUT_WR);
+  }
+#else
+  (void)target;
+#endif
+}
+
+std::vector<Stratum::Swarm::TimePoint>
+Stratum::Swarm::waitForJob(std::string_view jobId,
+                           std::chrono::milliseconds timeout) {
+  const auto deadline = std::chrono::steady_clock::now() + timeout;
+  for (size_t i = 0; i < mMiners.size();) {
+    const Miner &miner = mMiners[i];
+    if (miner.fd < 0 || !miner.reading || miner.jobId == jobId) {
+      ++i;
+      continue;
+    }
+    const auto remaining =
+        std::chrono::duration_cast<std::chrono::milliseconds>(
+            deadline - std::chrono::steady_clock::now());
+    if (remaining.count() <= 0) {
+      break;
+    }
+    wait(static_cast<int>(remaining.count()));
+  }
+
+  std::vector<TimePoint> arrivals(mMiners.size());
+  for (size_t i = 0; i < mMiners.size(); ++i) {
+    if (mMiners[i].reading && mMiners[i].jobId == jobId) {
+      arrivals[i] = mMiners[i].jobTime;
+    }
+  }
+  return arrivals;
+}
+
+size_t Stratum::Swarm::getClosedCount() const {
+  size_t closed = 0;
+  for (const Miner &miner : mMiners) {
+    closed += miner.fd < 0;
+  }
+  return closed;
+}
+
+void Stratum::Swarm::wait(int timeout) {
+#ifdef HFM_STRATUM_SWARM_EPOLL
+  epoll_event events[256];
+  const int count = ::epoll_wait(mEpoll, events, 256, timeout);
+  if (count < 0 && errno != EINTR) {
+    throw std::system_error(errno, std::generic_category(),
+                            "Swarm cannot wait for the pool");
+  }
+  for (int i = 0; i < count; ++i) {
+    Miner &miner = mMiners[events[i].data.u64];
+    if (miner.reading) {
+      receive(miner);
+    } else if ((events[i].events & (EPOLLRDHUP | EPOLLHUP)) != 0) {
+      close(miner);
+    }
+  }
+#else
+  (void)timeout;
+#endif
+}
+
+void Stratum::Swarm::receive(Miner &miner) {
+#ifdef HFM_STRATUM_SWARM_EPOLL
+  while (miner.fd >= 0) {
+    const ssize_t n = ::recv(miner.fd, mBuffer.data(), mBuffer.size(), 0);
+    if (n < 0) {
+      if (errno == EINTR) {
+        continue;
+      }
+      if (errno != EAGAIN && errno != EWOULDBLOCK) {
+        close(miner);
+      }
+      return;
+    }
+    if (n == 0) {
+      close(miner);
+      return;
+    }
+    const TimePoint now = std::chrono::steady_clock::now();
+    miner.received.append(mBuffer.data(), static_cast<size_t>(n));
+    size_t begin = 0;
+    for (size_t newline = miner.received.find('\n');
+         newline != std::string::npos;
+         newline = miner.received.find('\n', begin)) {
+      processLine(miner,
+                  std::string_view(miner.received)
+                      .substr(begin, newline - begin),
+                  now);
+      begin = newline + 1;
+    }
+    miner.received.erase(0, begin);
+  }
+#else
+  (void)miner;
+#endif
+}
+
+void Stratum::Swarm::processLine(Miner &miner, std::string_view line,
+                                 TimePoint now) {
+  using namespace Swarm_internal;
+
+  JsonReader reader(line);
+  if (reader.next() != JsonToken::BeginObject) {
+    return;
+  }
+  uint64_t id = 0;
+  std::string_view method;
+  std::string_view result;
+  std::string_view params;
+  for (JsonToken token = reader.next(); token == JsonToken::Key;
+       token = reader.next()) {
+    const std::string_view key = reader.getValue();
+    if (key == "id") {
+      if (reader.next() == JsonToken::Number) {
+        reader.getUint(id);
+      }
+      continue;
+    }
+    if (key == "method") {
+      if (reader.next() != JsonToken::String) {
+        return;
+      }
+      method = reader.getValue();
+      continue;
+    }
+    const size_t begin = reader.getOffset();
+    if (!reader.skipValue()) {
+      return;
+    }
+    const std::string_view value =
+        line.substr(begin, reader.getOffset() - begin);
+    if (key == "result") {
+      result = value;
+    } else if (key == "params") {
+      params = value;
+    }
+  }
+
+  if (method == "mining.notify") {
+    JsonReader job(params);
+    if (job.next() == JsonToken::BeginArray &&
+        job.next() == JsonToken::String) {
+      miner.jobId.assign(job.getValue());
+      miner.jobTime = now;
+    }
+    return;
+  }
+  if (!method.empty()) {
+    return;
+  }
+  JsonReader answer(result);
+  if (id == 1) {
+    // [[subscriptions...], "extranonce1", extranonce2_size]
+    if (answer.next() == JsonToken::BeginArray && answer.skipValue() &&
+        answer.next() == JsonToken::String) {
+      miner.extranonce1.resize(answer.getValue().size() / 2);
+      miner.subscribed =
+          util::DecodeHex(answer.getValue(), miner.extranonce1.data());
+    }
+    if (!miner.subscribed) {
+      close(miner);
+    }
+  } else if (id == 2) {
+    miner.authorized = answer.next() == JsonToken::True;
+    if (!miner.authorized) {
+      close(miner);
+    }
+  }
+}
+
+void Stratum::Swarm::close(Miner &miner) {
+#ifdef HFM_STRATUM_SWARM_EPOLL
+  if (miner.fd >= 0) {
+    ::epoll_ctl(mEpoll, EPOLL_CTL_DEL, miner.fd, nullptr);
+    ::close(miner.fd);
+    miner.fd = -1;
+  }
+#else
+  (void)miner;
+#endif
+}
+
+void Stratum::Swarm::closeAll() {
+#ifdef HFM_STRATUM_SWARM_EPOLL
+  for (Miner &miner : mMiners) {
+    close(miner);
+  }
+  if (mEpoll >= 0) {
+    ::close(mEpoll);
+    mEpoll = -1;
+  }
+#endif
+}
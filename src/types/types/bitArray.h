@@ -69,8 +69,12 @@ public:
   constexpr const unsigned char *begin() const { return mdata.data(); }
   constexpr const unsigned char *end() const { return mdata.data() + mBytes; }
   static constexpr unsigned int size() { return mBytes; }
+
+  /// \brief Read the 64-bit little-endian word at a given word position.
+  /// \param pos Word index (0 is the first 8 bytes).
+  /// \return Native representation of the stored word.
   constexpr uint64_t GetUint64(int pos) const {
-    return ReadLE64(mdata.data() + pos * 8);
+    return util::ReadLE64(mdata.data() + pos * 8);
   }
 };
 
@@ -0,0 +1,356 @@
+#ifndef __UINT256_H__
+#define __UINT256_H__
+
+// system includes
+#include <array>
+#include <bit>
+#include <compare>
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+
+// project includes
+#include "types/bitArray.h"
+#include "types/types.h"
+#include "util/endian.h"
+
+/// \brief 256-bit unsigned integer built on BitArray<256>.
+/// \note Bytes are stored little-endian (byte 31 is the most significant),
+/// which is the order Bitcoin uses when it interprets a raw double SHA-256
+/// digest as a number. A Hash can therefore be compared against a uint256
+/// target without any reordering. Arithmetic works on four 64-bit limbs,
+/// least significant limb first.
+class uint256 : public BitArray<256> {
+public:
+  /// \brief Number of 64-bit limbs in the value.
+  static constexpr int WIDTH = 4;
+
+  /// \brief Limb representation, least significant limb first.
+  using Limbs = std::array<uint64_t, WIDTH>;
+
+  /// \brief Default constructor initializes the value to zero.
+  constexpr uint256() = default;
+
+  /// \brief Construct from a 64-bit integer.
+  /// \param value Value stored in the least significant limb.
+  constexpr uint256(uint64_t value) { SetLimb(0, value); }
+
+  /// \brief Construct from a raw 32-byte hash (little-endian number).
+  /// \param hash Hash bytes, e.g. the output of a double SHA-256.
+  constexpr explicit uint256(const Hash &hash)
+      : BitArray<256>(std::span<const unsigned char>(hash)) {}
+
+  /// \brief Construct from a 64-character big-endian hexadecimal string.
+  /// \param hex_str Most significant digit first, lowercase only.
+  consteval explicit uint256(std::string_view hex_str)
+      : BitArray<256>(hex_str) {}
+
+  // Limb access
+
+  /// \brief Get a 64-bit limb.
+  /// \param index Limb index, 0 is the least significant.
+  constexpr uint64_t GetLimb(int index) const { return GetUint64(index); }
+
+  /// \brief Set a 64-bit limb.
+  /// \param index Limb index, 0 is the least significant.
+  /// \param value New limb value.
+  constexpr void SetLimb(int index, uint64_t value) {
+    util::WriteLE64(mdata.data() + index * 8, value);
+  }
+
+  /// \brief Load all four limbs.
+  constexpr Limbs GetLimbs() const {
+    return {GetLimb(0), GetLimb(1), GetLimb(2), GetLimb(3)};
+  }
+
+  /// \brief Store all four limbs.
+  constexpr void SetLimbs(const Limbs &limbs) {
+    for (int i = 0; i < WIDTH; ++i) {
+      SetLimb(i, limbs[i]);
+    }
+  }
+
+  /// \brief Get the least significant 64 bits.
+  constexpr uint64_t GetLow64() const { return GetLimb(0); }
+
+  /// \brief Number of significant bits (position of the highest set bit + 1).
+  /// \return 0 for a zero value, otherwise 1..256.
+  constexpr unsigned int Bits() const {
+    for (int i = WIDTH - 1; i >= 0; --i) {
+      const uint64_t limb = GetLimb(i);
+      if (limb != 0) {
+        return 64 * i + (64 - std::countl_zero(limb));
+      }
+    }
+    return 0;
+  }
+
+  /// \brief Copy the value out as raw hash bytes.
+  constexpr Hash ToHash() const {
+    Hash hash{};
+    std::copy(begin(), end(), hash.begin());
+    return hash;
+  }
+
+  /// \brief Format the value as 64 big-endian hexadecimal characters.
+  std::string GetHex() const;
+
+  // Comparison
+
+  /// \brief Numeric comparison, most significant limb first.
+  /// \return zero if equal, negative if this < other, positive otherwise.
+  constexpr int CompareTo(const uint256 &other) const {
+    for (int i = WIDTH - 1; i >= 0; --i) {
+      const uint64_t a = GetLimb(i);
+      const uint64_t b = other.GetLimb(i);
+      if (a != b) {
+        return a < b ? -1 : 1;
+      }
+    }
+    return 0;
+  }
+
+  friend constexpr bool operator==(const uint256 &a, const uint256 &b) {
+    return a.CompareTo(b) == 0;
+  }
+
+  friend constexpr std::strong_ordering operator<=>(const uint256 &a,
+                                                    const uint256 &b) {
+    return a.CompareTo(b) <=> 0;
+  }
+
+  // Arithmetic
+
+  constexpr uint256 operator~() const {
+    uint256 ret;
+    for (int i = 0; i < WIDTH; ++i) {
+      ret.SetLimb(i, ~GetLimb(i));
+    }
+    return ret;
+  }
+
+  constexpr uint256 operator-() const {
+    uint256 ret = ~*this;
+    ++ret;
+    return ret;
+  }
+
+  constexpr uint256 &operator+=(const uint256 &other) {
+    uint64_t carry = 0;
+    for (int i = 0; i < WIDTH; ++i) {
+      const uint64_t a = GetLimb(i);
+      const uint64_t sum = a + other.GetLimb(i);
+      const uint64_t total = sum + carry;
+      carry = (sum < a) | (total < sum);
+      SetLimb(i, total);
+    }
+    return *this;
+  }
+
+  constexpr uint256 &operator-=(const uint256 &other) {
+    return *this += -other;
+  }
+
+  constexpr uint256 &operator++() {
+    for (int i = 0; i < WIDTH; ++i) {
+      const uint64_t limb = GetLimb(i) + 1;
+      SetLimb(i, limb);
+      if (limb != 0) {
+        break;
+      }
+    }
+    return *this;
+  }
+
+  constexpr uint256 &operator<<=(unsigned int shift) {
+    const Limbs a = GetLimbs();
+    Limbs r{};
+    const unsigned int k = shift / 64;
+    const unsigned int s = shift % 64;
+    for (unsigned int i = 0; i + k < WIDTH; ++i) {
+      r[i + k] |= a[i] << s;
+      if (s != 0 && i + k + 1 < WIDTH) {
+        r[i + k + 1] |= a[i] >> (64 - s);
+      }
+    }
+    SetLimbs(r);
+    return *this;
+  }
+
+  constexpr uint256 &operator>>=(unsigned int shift) {
+    const Limbs a = GetLimbs();
+    Limbs r{};
+    const unsigned int k = shift / 64;
+    const unsigned int s = shift % 64;
+    for (unsigned int i = k; i < WIDTH; ++i) {
+      r[i - k] |= a[i] >> s;
+      if (s != 0 && i > k) {
+        r[i - k - 1] |= a[i] << (64 - s);
+      }
+    }
+    SetLimbs(r);
+    return *this;
+  }
+
+  /// \brief Multiply by a small integer (result is truncated to 256 bits).
+  constexpr uint256 &operator*=(uint32_t factor) {
+    uint64_t carry = 0;
+    for (int i = 0; i < WIDTH; ++i) {
+      const uint64_t limb = GetLimb(i);
+      const uint64_t lo = (limb & 0xFFFFFFFF) * factor + carry;
+      const uint64_t hi = (limb >> 32) * factor + (lo >> 32);
+      SetLimb(i, (lo & 0xFFFFFFFF) | (hi << 32));
+      carry = hi >> 32;
+    }
+    return *this;
+  }
+
+  /// \brief Divide by a small integer, discarding the remainder.
+  /// \throws std::domain_error on division by zero.
+  constexpr uint256 &operator/=(uint32_t divisor) {
+    if (divisor == 0) {
+      throw std::domain_error("uint256 division by zero");
+    }
+    uint64_t remainder = 0;
+    for (int i = WIDTH - 1; i >= 0; --i) {
+      const uint64_t limb = GetLimb(i);
+      const uint64_t hi = (remainder << 32) | (limb >> 32);
+      remainder = hi % divisor;
+      const uint64_t lo = (remainder << 32) | (limb & 0xFFFFFFFF);
+      remainder = lo % divisor;
+      SetLimb(i, ((hi / divisor) << 32) | (lo / divisor));
+    }
+    return *this;
+  }
+
+  /// \brief Full 256-bit division (binary long division).
+  /// \note Needed to invert a target into work: ~target / (target + 1) + 1.
+  /// \throws std::domain_error on division by zero.
+  constexpr uint256 &operator/=(const uint256 &divisor) {
+    const unsigned int num_bits = Bits();
+    const unsigned int div_bits = divisor.Bits();
+    if (div_bits == 0) {
+      throw std::domain_error("uint256 division by zero");
+    }
+    uint256 num = *this;
+    uint256 div = divisor;
+    Limbs quotient{};
+    if (div_bits <= num_bits) {
+      int shift = static_cast<int>(num_bits - div_bits);
+      div <<= shift;
+      while (shift >= 0) {
+        if (num >= div) {
+          num -= div;
+          quotient[shift / 64] |= uint64_t{1} << (shift % 64);
+        }
+        div >>= 1;
+        --shift;
+      }
+    }
+    SetLimbs(quotient);
+    return *this;
+  }
+
+  friend constexpr uint256 operator+(uint256 a, const uint256 &b) {
+    return a += b;
+  }
+  friend constexpr uint256 operator-(uint256 a, const uint256 &b) {
+    return a -= b;
+  }
+  friend constexpr uint256 operator*(uint256 a, uint32_t b) { return a *= b; }
+  friend constexpr uint256 operator/(uint256 a, uint32_t b) { return a /= b; }
+  friend constexpr uint256 operator/(uint256 a, const uint256 &b) {
+    return a /= b;
+  }
+  friend constexpr uint256 operator<<(uint256 a, unsigned int shift) {
+    return a <<= shift;
+  }
+  friend constexpr uint256 operator>>(uint256 a, unsigned int shift) {
+    return a >>= shift;
+  }
+
+  // Compact ("nBits") encoding
+
+  /// \brief Decode a compact difficulty encoding into this value.
+  /// \param compact 32-bit compact value: 8-bit exponent, sign bit and a
+  /// 23-bit mantissa, value = mantissa * 256^(exponent - 3).
+  /// \param negative Optional output, set when the sign bit is set on a
+  /// non-zero mantissa.
+  /// \param overflow Optional output, set when the value does not fit in 256
+  /// bits.
+  /// \return Reference to this value.
+  /// \note Follows Bitcoin's arith_uint256::SetCompact exactly.
+  constexpr uint256 &SetCompact(uint32_t compact, bool *negative = nullptr,
+                                bool *overflow = nullptr) {
+    const unsigned int size = compact >> 24;
+    uint32_t word = compact & 0x007FFFFF;
+    if (size <= 3) {
+      word >>= 8 * (3 - size);
+      *this = word;
+    } else {
+      *this = word;
+      *this <<= 8 * (size - 3);
+    }
+    if (negative) {
+      *negative = word != 0 && (compact & 0x00800000) != 0;
+    }
+    if (overflow) {
+      *overflow = word != 0 && ((size > 34) || (word > 0xFF && size > 33) ||
+                                (word > 0xFFFF && size > 32));
+    }
+    return *this;
+  }
+
+  /// \brief Encode this value in compact form.
+  /// \param negative Set the sign bit (only if the mantissa is non-zero).
+  /// \return 32-bit compact encoding.
+  constexpr uint32_t GetCompact(bool negative = false) const {
+    unsigned int size = (Bits() + 7) / 8;
+    uint32_t compact = 0;
+    if (size <= 3) {
+      compact = static_cast<uint32_t>(GetLow64() << 8 * (3 - size));
+    } else {
+      compact = static_cast<uint32_t>((*this >> 8 * (size - 3)).GetLow64());
+    }
+    // The 0x00800000 bit denotes the sign, so if it is already set divide
+    // the mantissa by 256 and increase the exponent.
+    if (compact & 0x00800000) {
+      compact >>= 8;
+      size++;
+    }
+    compact |= size << 24;
+    if (negative && (compact & 0x007FFFFF) != 0) {
+      compact |= 0x00800000;
+    }
+    return compact;
+  }
+};
+
+/// \brief Proof-of-work check: hash <= target.
+/// \param hash Pointer to a 32-byte digest in raw (little-endian) order.
+/// \param target Decoded target.
+/// \return true if the hash meets the target.
+/// \note Compares four native 64-bit words, most significant first, so a
+/// typical miss is decided by the first comparison.
+constexpr bool MeetsTarget(const uint8_t *hash, const uint256 &target) {
+  for (int i = uint256::WIDTH - 1; i >= 0; --i) {
+    const uint64_t word = util::ReadLE64(hash + i * 8);
+    const uint64_t limit = target.GetLimb(i);
+    if (word != limit) {
+      return word < limit;
+    }
+  }
+  return true;
+}
+
+/// \brief Proof-of-work check: hash <= target.
+/// \param hash 32-byte digest in raw (little-endian) order.
+/// \param target Decoded target.
+/// \return true if the hash meets the target.
+constexpr bool MeetsTarget(const Hash &hash, const uint256 &target) {
+  return MeetsTarget(hash.data(), target);
+}
+
+#endif // __UINT256_H__
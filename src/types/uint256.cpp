@@ -0,0 +1,12 @@
+#include "types/uint256.h"
+
+std::string uint256::GetHex() const {
+  static constexpr char hexmap[] = "0123456789abcdef";
+  std::string hex(size() * 2, '0');
+  for (unsigned int i = 0; i < size(); ++i) {
+    const uint8_t byte = mdata[size() - 1 - i];
+    hex[2 * i] = hexmap[byte >> 4];
+    hex[2 * i + 1] = hexmap[byte & 0x0F];
+  }
+  return hex;
+}
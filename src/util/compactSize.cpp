@@ -0,0 +1 @@
+#include "util/compactSize.h"
@@ -0,0 +1,67 @@
+#include "util/concurrentHashSet.h"
+
+// system includes
+#include <algorithm>
+#include <bit>
+
+util::ConcurrentHashSet::ConcurrentHashSet(size_t capacity)
+    : mSlots(), mMask(0), mShift(0), mLimit(0), mSize(0), mHasMaxKey(false) {
+  const size_t slots = std::bit_ceil(std::max<size_t>(capacity / 3 * 4 + 4, 8));
+  mSlots = std::make_unique<std::atomic<uint64_t>[]>(slots);
+  mMask = slots - 1;
+  mShift = static_cast<unsigned int>(64 - std::countr_zero(slots));
+  mLimit = slots / 4 * 3;
+  clear();
+}
+
+util::ConcurrentHashSet::Insert util::ConcurrentHashSet::insert(uint64_t key) {
+  if (key == ~uint64_t{0}) {
+    // Has no key + 1 encoding
+    return mHasMaxKey.exchange(true, std::memory_order_acq_rel)
+               ? Insert::Present
+               : Insert::Inserted;
+  }
+  const uint64_t stored = key + 1;
+  for (size_t slot = slotOf(key);; slot = (slot + 1) & mMask) {
+    uint64_t current = mSlots[slot].load(std::memory_order_acquire);
+    if (current == EMPTY) {
+      // Claim the slot only while there is room
+      if (mSize.load(std::memory_order_relaxed) >= mLimit) {
+        return Insert::Full;
+      }
+      if (mSlots[slot].compare_exchange_strong(current, stored,
+                                               std::memory_order_acq_rel)) {
+        mSize.fetch_add(1, std::memory_order_relaxed);
+        return Insert::Inserted;
+      }
+      // Lost the race: current is now the winner's key
+    }
+    if (current == stored) {
+      return Insert::Present;
+    }
+  }
+}
+
+bool util::ConcurrentHashSet::contains(uint64_t key) const {
+  if (key == ~uint64_t{0}) {
+    return mHasMaxKey.load(std::memory_order_acquire);
+  }
+  const uint64_t stored = key + 1;
+  for (size_t slot = slotOf(key);; slot = (slot + 1) & mMask) {
+    const uint64_t current = mSlots[slot].load(std::memory_order_acquire);
+    if (current == stored) {
+      return true;
+    }
+    if (current == EMPTY) {
+      return false;
+    }
+  }
+}
+
+void util::ConcurrentHashSet::clear() {
+  for (size_t slot = 0; slot <= mMask; ++slot) {
+    mSlots[slot].store(EMPTY, std::memory_order_relaxed);
+  }
+  mSize.store(0, std::memory_order_relaxed);
+  mHasMaxKey.store(false, std::memory_order_relaxed);
+}
@@ -0,0 +1,394 @@
+#include "util/jsonReader.h"
+
+// system includes
+#include <charconv>
+#include <cstring>
+
+namespace util {
+namespace JsonReader_internal {
+
+static inline bool isDigit(char c) { return c >= '0' && c <= '9'; }
+
+// Whether any byte of the word is below n (n <= 128)
+static inline uint64_t hasLess(uint64_t word, uint8_t n) {
+  return (word - 0x0101010101010101ULL * n) & ~word & 0x8080808080808080ULL;
+}
+
+// Whether any of eight string bytes needs a closer look: a quote, a
+// backslash or a control character
+static inline bool isSpecial(const char *bytes) {
+  uint64_t word;
+  std::memcpy(&word, bytes, sizeof(word));
+  return hasLess(word ^ 0x2222222222222222ULL, 1) |
+         hasLess(word ^ 0x5c5c5c5c5c5c5c5cULL, 1) | hasLess(word, 0x20);
+}
+
+static int hexValue(char c) {
+  if (c >= '0' && c <= '9') {
+    return c - '0';
+  }
+  if (c >= 'a' && c <= 'f') {
+    return c - 'a' + 10;
+  }
+  if (c >= 'A' && c <= 'F') {
+    return c - 'A' + 10;
+  }
+  return -1;
+}
+
+// Read the four hex digits of a \u escape
+static bool readCodeUnit(std::string_view text, size_t pos, uint32_t &unit) {
+  if (text.size() - pos < 4) {
+    return false;
+  }
+  unit = 0;
+  for (size_t i = 0; i < 4; ++i) {
+    const int digit = hexValue(text[pos + i]);
+    if (digit < 0) {
+      return false;
+    }
+    unit = (unit << 4) | static_cast<uint32_t>(digit);
+  }
+  return true;
+}
+
+static void appendUtf8(std::string &out, uint32_t code) {
+  if (code < 0x80) {
+    out.push_back(static_cast<char>(code));
+  } else if (code < 0x800) {
+    out.push_back(static_cast<char>(0xc0 | (code >> 6)));
+    out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+  } else if (code < 0x10000) {
+    out.push_back(static_cast<char>(0xe0 | (code >> 12)));
+    out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+    out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+  } else {
+    out.push_back(static_cast<char>(0xf0 | (code >> 18)));
+    out.push_back(static_cast<char>(0x80 | ((code >> 12) & 0x3f)));
+    out.push_back(static_cast<char>(0x80 | ((code >> 6) & 0x3f)));
+    out.push_back(static_cast<char>(0x80 | (code & 0x3f)));
+  }
+}
+
+} // namespace JsonReader_internal
+} // namespace util
+
+util::JsonReader::JsonReader(std::string_view text)
+    : mText(text), mPos(0), mValue(), mEscaped(false), mFailed(false),
+      mExpect(Expect::Value), mDepth(0), mStack(0) {}
+
+util::JsonToken util::JsonReader::fail() {
+  mFailed = true;
+  return JsonToken::Error;
+}
+
+void util::JsonReader::skipWhitespace() {
+  while (mPos < mText.size()) {
+    const char c = mText[mPos];
+    if (c != ' ' && c != '\n' && c != '\r' && c != '\t') {
+      break;
+    }
+    ++mPos;
+  }
+}
+
+util::JsonToken util::JsonReader::next() {
+  if (mFailed) {
+    return JsonToken::Error;
+  }
+  mValue = {};
+  mEscaped = false;
+  skipWhitespace();
+
+  switch (mExpect) {
+  case Expect::Done:
+    return mPos == mText.size() ? JsonToken::End : fail();
+
+  case Expect::CommaOrEnd:
+    if (mPos < mText.size()) {
+      const char c = mText[mPos];
+      if (c == (inObject() ? '}' : ']')) {
+        ++mPos;
+        return close(inObject());
+      }
+      if (c == ',') {
+        ++mPos;
+        skipWhitespace();
+        if (inObject()) {
+          return readString(JsonToken::Key);
+        }
+        return readValue();
+      }
+    }
+    return fail();
+
+  case Expect::KeyOrEnd:
+    if (mPos < mText.size() && mText[mPos] == '}') {
+      ++mPos;
+      return close(true);
+    }
+    return readString(JsonToken::Key);
+
+  case Expect::Key:
+    return readString(JsonToken::Key);
+
+  case Expect::ValueOrEnd:
+    if (mPos < mText.size() && mText[mPos] == ']') {
+      ++mPos;
+      return close(false);
+    }
+    return readValue();
+
+  case Expect::Value:
+    return readValue();
+  }
+  return fail();
+}
+
+util::JsonToken util::JsonReader::open(bool object) {
+  if (mDepth == MAX_DEPTH) {
+    return fail();
+  }
+  ++mPos;
+  if (object) {
+    mStack |= uint64_t{1} << mDepth;
+  } else {
+    mStack &= ~(uint64_t{1} << mDepth);
+  }
+  ++mDepth;
+  mExpect = object ? Expect::KeyOrEnd : Expect::ValueOrEnd;
+  return object ? JsonToken::BeginObject : JsonToken::BeginArray;
+}
+
+util::JsonToken util::JsonReader::close(bool object) {
+  --mDepth;
+  mExpect = afterValue();
+  return object ? JsonToken::EndObject : JsonToken::EndArray;
+}
+
+util::JsonToken util::JsonReader::readValue() {
+  if (mPos >= mText.size()) {
+    return fail();
+  }
+  const char c = mText[mPos];
+  switch (c) {
+  case '{':
+    return open(true);
+  case '[':
+    return open(false);
+  case '"':
+    return readString(JsonToken::String);
+  case 't':
+    return readLiteral("true", JsonToken::True);
+  case 'f':
+    return readLiteral("false", JsonToken::False);
+  case 'n':
+    return readLiteral("null", JsonToken::Null);
+  default:
+    if (c == '-' || JsonReader_internal::isDigit(c)) {
+      return readNumber();
+    }
+    return fail();
+  }
+}
+
+util::JsonToken util::JsonReader::readString(JsonToken token) {
+  if (mPos >= mText.size() || mText[mPos] != '"') {
+    return fail();
+  }
+  const size_t begin = ++mPos;
+  // Plain characters are the common case, even in megabytes of hex, so they
+  // are skipped eight at a time
+  while (mPos < mText.size()) {
+    while (mText.size() - mPos >= 8 &&
+           !JsonReader_internal::isSpecial(mText.data() + mPos)) {
+      mPos += 8;
+    }
+    if (mPos >= mText.size()) {
+      break;
+    }
+    const unsigned char c = static_cast<unsigned char>(mText[mPos]);
+    if (c == '"') {
+      break;
+    }
+    if (c < 0x20) {
+      return fail();
+    }
+    if (c == '\\') {
+      mEscaped = true;
+      ++mPos; // the escaped character is checked by getString()
+    }
+    ++mPos;
+  }
+  if (mPos >= mText.size()) {
+    return fail();
+  }
+  mValue = mText.substr(begin, mPos - begin);
+  ++mPos;
+
+  if (token == JsonToken::Key) {
+    skipWhitespace();
+    if (mPos >= mText.size() || mText[mPos] != ':') {
+      return fail();
+    }
+    ++mPos;
+    mExpect = Expect::Value;
+  } else {
+    mExpect = afterValue();
+  }
+  return token;
+}
+
+util::JsonToken util::JsonReader::readNumber() {
+  using JsonReader_internal::isDigit;
+
+  const size_t begin = mPos;
+  if (mText[mPos] == '-') {
+    ++mPos;
+  }
+  // No leading zeros
+  if (mPos < mText.size() && mText[mPos] == '0') {
+    ++mPos;
+  } else if (mPos < mText.size() && isDigit(mText[mPos])) {
+    while (mPos < mText.size() && isDigit(mText[mPos])) {
+      ++mPos;
+    }
+  } else {
+    return fail();
+  }
+  if (mPos < mText.size() && mText[mPos] == '.') {
+    ++mPos;
+    if (mPos >= mText.size() || !isDigit(mText[mPos])) {
+      return fail();
+    }
+    while (mPos < mText.size() && isDigit(mText[mPos])) {
+      ++mPos;
+    }
+  }
+  if (mPos < mText.size() && (mText[mPos] == 'e' || mText[mPos] == 'E')) {
+    ++mPos;
+    if (mPos < mText.size() && (mText[mPos] == '+' || mText[mPos] == '-')) {
+      ++mPos;
+    }
+    if (mPos >= mText.size() || !isDigit(mText[mPos])) {
+      return fail();
+    }
+    while (mPos < mText.size() && isDigit(mText[mPos])) {
+      ++mPos;
+    }
+  }
+  mValue = mText.substr(begin, mPos - begin);
+  mExpect = afterValue();
+  return JsonToken::Number;
+}
+
+util::JsonToken util::JsonReader::readLiteral(std::string_view literal,
+                                              JsonToken token) {
+  if (mText.substr(mPos, literal.size()) != literal) {
+    return fail();
+  }
+  mPos += literal.size();
+  mExpect = afterValue();
+  return token;
+}
+
+bool util::JsonReader::skipValue() {
+  const JsonToken token = next();
+  if (token != JsonToken::BeginObject && token != JsonToken::BeginArray) {
+    return token != JsonToken::Error && token != JsonToken::End &&
+           token != JsonToken::EndObject && token != JsonToken::EndArray &&
+           token != JsonToken::Key;
+  }
+  const size_t depth = mDepth - 1;
+  while (mDepth > depth) {
+    if (next() == JsonToken::Error) {
+      return false;
+    }
+  }
+  return true;
+}
+
+bool util::JsonReader::getString(std::string &out) const {
+  using namespace JsonReader_internal;
+
+  out.clear();
+  if (!mEscaped) {
+    out.assign(mValue);
+    return true;
+  }
+  for (size_t i = 0; i < mValue.size(); ++i) {
+    const char c = mValue[i];
+    if (c != '\\') {
+      out.push_back(c);
+      continue;
+    }
+    if (++i >= mValue.size()) {
+      return false;
+    }
+    switch (mValue[i]) {
+    case '"':
+    case '\\':
+    case '/':
+      out.push_back(mValue[i]);
+      break;
+    case 'b':
+      out.push_back('\b');
+      break;
+    case 'f':
+      out.push_back('\f');
+      break;
+    case 'n':
+      out.push_back('\n');
+      break;
+    case 'r':
+      out.push_back('\r');
+      break;
+    case 't':
+      out.push_back('\t');
+      break;
+    case 'u': {
+      uint32_t code = 0;
+      if (!readCodeUnit(mValue, i + 1, code)) {
+        return false;
+      }
+      i += 4;
+      // A high surrogate must be followed by an escaped low surrogate
+      if (code >= 0xd800 && code < 0xdc00) {
+        uint32_t low = 0;
+        if (mValue.size() - i < 7 || mValue[i + 1] != '\\' ||
+            mValue[i + 2] != 'u' || !readCodeUnit(mValue, i + 3, low) ||
+            low < 0xdc00 || low >= 0xe000) {
+          return false;
+        }
+        code = 0x10000 + ((code - 0xd800) << 10) + (low - 0xdc00);
+        i += 6;
+      } else if (code >= 0xdc00 && code < 0xe000) {
+        return false;
+      }
+      appendUtf8(out, code);
+      break;
+    }
+    default:
+      return false;
+    }
+  }
+  return true;
+}
+
+bool util::JsonReader::getInt(int64_t &value) const {
+  const char *end = mValue.data() + mValue.size();
+  const auto result = std::from_chars(mValue.data(), end, value);
+  return result.ec == std::errc() && result.ptr == end;
+}
+
+bool util::JsonReader::getUint(uint64_t &value) const {
+  const char *end = mValue.data() + mValue.size();
+  const auto result = std::from_chars(mValue.data(), end, value);
+  return result.ec == std::errc() && result.ptr == end;
+}
+
+bool util::JsonReader::getDouble(double &value) const {
+  const char *end = mValue.data() + mValue.size();
+  const auto result = std::from_chars(mValue.data(), end, value);
+  return result.ec == std::errc() && result.ptr == end;
+}
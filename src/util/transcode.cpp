@@ -1 +1,110 @@
-#include "util/transcode.h"
\ No newline at end of file
+#include "util/transcode.h"
+
+// system includes
+#include <array>
+
+namespace util {
+namespace Transcode_internal {
+
+static constexpr uint8_t INVALID = 0xff;
+
+// Hex digit values, INVALID for anything else
+static constexpr std::array<uint8_t, 256> HEX_TABLE = []() {
+  std::array<uint8_t, 256> table{};
+  table.fill(INVALID);
+  for (int c = 0; c < 10; ++c) {
+    table['0' + c] = static_cast<uint8_t>(c);
+  }
+  for (int c = 0; c < 6; ++c) {
+    table['a' + c] = static_cast<uint8_t>(10 + c);
+    table['A' + c] = static_cast<uint8_t>(10 + c);
+  }
+  return table;
+}();
+
+static constexpr char HEX_DIGITS[] = "0123456789abcdef";
+
+static constexpr char BASE64_ALPHABET[] =
+    "ABCDEFGHIJKLMNOPQRSTUVWXYZabcdefghijklmnopqrstuvwxyz0123456789+/";
+
+} // namespace Transcode_internal
+} // namespace util
+
+bool util::DecodeHex(std::string_view hex, uint8_t *out) {
+  using namespace Transcode_internal;
+
+  if (hex.size() % 2 != 0) {
+    return false;
+  }
+  // Accumulate the digits and test for an invalid one once per run
+  uint8_t invalid = 0;
+  for (size_t i = 0; i < hex.size(); i += 2) {
+    const uint8_t high = HEX_TABLE[static_cast<uint8_t>(hex[i])];
+    const uint8_t low = HEX_TABLE[static_cast<uint8_t>(hex[i + 1])];
+    invalid |= (high | low) & 0xf0;
+    out[i / 2] = static_cast<uint8_t>((high << 4) | (low & 0x0f));
+  }
+  return invalid == 0;
+}
+
+void util::EncodeHex(std::span<const uint8_t> data, char *out) {
+  using namespace Transcode_internal;
+
+  for (const uint8_t byte : data) {
+    *out++ = HEX_DIGITS[byte >> 4];
+    *out++ = HEX_DIGITS[byte & 0x0f];
+  }
+}
+
+void util::AppendHex(std::string &out, std::span<const uint8_t> data) {
+  const size_t offset = out.size();
+  out.resize(offset + 2 * data.size());
+  EncodeHex(data, out.data() + offset);
+}
+
+void util::AppendJsonString(std::string &out, std::string_view text) {
+  using namespace Transcode_internal;
+
+  out.push_back('"');
+  for (const char c : text) {
+    if (c == '"' || c == '\\') {
+      out.push_back('\\');
+      out.push_back(c);
+    } else if (static_cast<unsigned char>(c) < 0x20) {
+      out.append("\\u00");
+      out.push_back(HEX_DIGITS[c >> 4]);
+      out.push_back(HEX_DIGITS[c & 0x0f]);
+    } else {
+      out.push_back(c);
+    }
+  }
+  out.push_back('"');
+}
+
+std::string util::EncodeBase64(std::span<const uint8_t> data) {
+  using namespace Transcode_internal;
+
+  std::string text;
+  text.reserve((data.size() + 2) / 3 * 4);
+  size_t i = 0;
+  for (; i + 3 <= data.size(); i += 3) {
+    const uint32_t group = (static_cast<uint32_t>(data[i]) << 16) |
+                           (static_cast<uint32_t>(data[i + 1]) << 8) |
+                           data[i + 2];
+    text.push_back(BASE64_ALPHABET[(group >> 18) & 0x3f]);
+    text.push_back(BASE64_ALPHABET[(group >> 12) & 0x3f]);
+    text.push_back(BASE64_ALPHABET[(group >> 6) & 0x3f]);
+    text.push_back(BASE64_ALPHABET[group & 0x3f]);
+  }
+  const size_t rest = data.size() - i;
+  if (rest > 0) {
+    const uint32_t group =
+        (static_cast<uint32_t>(data[i]) << 16) |
+        (rest == 2 ? static_cast<uint32_t>(data[i + 1]) << 8 : 0);
+    text.push_back(BASE64_ALPHABET[(group >> 18) & 0x3f]);
+    text.push_back(BASE64_ALPHABET[(group >> 12) & 0x3f]);
+    text.push_back(rest == 2 ? BASE64_ALPHABET[(group >> 6) & 0x3f] : '=');
+    text.push_back('=');
+  }
+  return text;
+}
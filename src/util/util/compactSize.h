@@ -0,0 +1,86 @@
+#ifndef __COMPACT_SIZE_H__
+#define __COMPACT_SIZE_H__
+
+// system includes
+#include <cstddef>
+#include <cstdint>
+#include <span>
+
+// project includes
+#include "util/endian.h"
+
+namespace util {
+
+/// \brief Largest CompactSize encoding in bytes.
+static constexpr size_t MAX_COMPACT_SIZE_LENGTH = 9;
+
+/// \brief  Number of bytes the CompactSize encoding of a value takes.
+/// \param value Value to encode.
+/// \return 1, 3, 5 or 9.
+constexpr size_t CompactSizeLength(uint64_t value) {
+  return value < 0xfd ? 1 : value <= 0xffff ? 3 : value <= 0xffffffff ? 5 : 9;
+}
+
+/// \brief  Read a Bitcoin CompactSize (varint) length prefix.
+/// \param data Buffer to read from.
+/// \param offset Read position; advanced past the value on success.
+/// \param value Receives the decoded value.
+/// \return false if the buffer ends inside the value or the value is not in
+/// its shortest encoding (which consensus rejects).
+constexpr bool ReadCompactSize(std::span<const uint8_t> data, size_t &offset,
+                               uint64_t &value) {
+  if (offset >= data.size()) {
+    return false;
+  }
+  const uint8_t first = data[offset];
+  if (first < 0xfd) {
+    value = first;
+    offset += 1;
+    return true;
+  }
+  const size_t width = first == 0xfd ? 2 : first == 0xfe ? 4 : 8;
+  if (data.size() - offset - 1 < width) {
+    return false;
+  }
+  const uint8_t *p = data.data() + offset + 1;
+  uint64_t decoded = 0;
+  if (width == 2) {
+    decoded = static_cast<uint64_t>(p[0]) | (static_cast<uint64_t>(p[1]) << 8);
+  } else if (width == 4) {
+    decoded = ReadLE32(p);
+  } else {
+    decoded = ReadLE64(p);
+  }
+  if (CompactSizeLength(decoded) != width + 1) {
+    return false;
+  }
+  value = decoded;
+  offset += width + 1;
+  return true;
+}
+
+/// \brief  Write a value as a Bitcoin CompactSize (varint).
+/// \param ptr Pointer to at least CompactSizeLength(value) writable bytes.
+/// \param value Value to encode.
+/// \return Number of bytes written.
+constexpr size_t WriteCompactSize(uint8_t *ptr, uint64_t value) {
+  const size_t length = CompactSizeLength(value);
+  if (length == 1) {
+    ptr[0] = static_cast<uint8_t>(value);
+  } else if (length == 3) {
+    ptr[0] = 0xfd;
+    ptr[1] = static_cast<uint8_t>(value);
+    ptr[2] = static_cast<uint8_t>(value >> 8);
+  } else if (length == 5) {
+    ptr[0] = 0xfe;
+    WriteLE32(ptr + 1, static_cast<uint32_t>(value));
+  } else {
+    ptr[0] = 0xff;
+    WriteLE64(ptr + 1, value);
+  }
+  return length;
+}
+
+} // namespace util
+
+#endif // __COMPACT_SIZE_H__
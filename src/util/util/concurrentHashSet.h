@@ -0,0 +1,71 @@
+#ifndef __CONCURRENT_HASH_SET_H__
+#define __CONCURRENT_HASH_SET_H__
+
+// system includes
+#include <atomic>
+#include <cstddef>
+#include <cstdint>
+#include <memory>
+
+namespace util {
+
+/// \brief Fixed-capacity set of 64-bit keys that many threads insert into
+/// without locks.
+/// \note Open addressing with linear probing over an array of atomic slots:
+/// an insert claims an empty slot with a single compare-and-swap, so when
+/// two threads insert the same key at once exactly one of them sees it as
+/// new. Keys are never removed one by one; clear() empties the whole set
+/// and must not run concurrently with insert() or contains(). The set
+/// reports itself full at three quarters of its slots to keep probe
+/// sequences short.
+class ConcurrentHashSet {
+public:
+  /// \brief Outcome of insert().
+  enum class Insert : uint8_t {
+    Inserted,
+    Present, // the key was already in the set
+    Full,    // the key is not in the set and there is no room for it
+  };
+
+  /// \brief Construct an empty set.
+  /// \param capacity Number of keys to hold; rounded up so that they fill
+  /// at most three quarters of a power-of-two slot count.
+  explicit ConcurrentHashSet(size_t capacity);
+
+  /// \brief Insert a key. Thread-safe.
+  /// \param key Any value, zero included.
+  /// \return Whether the key was added.
+  Insert insert(uint64_t key);
+
+  /// \brief Whether the set holds a key. Thread-safe.
+  bool contains(uint64_t key) const;
+
+  /// \brief Remove every key. Not thread-safe.
+  void clear();
+
+  /// \brief Get the number of keys.
+  inline size_t size() const { return mSize.load(std::memory_order_relaxed); }
+
+  /// \brief Get the number of keys the set can hold.
+  inline size_t getCapacity() const { return mLimit; }
+
+private:
+  // Slots hold key + 1, with the all-ones key kept aside, so 0 means empty
+  static constexpr uint64_t EMPTY = 0;
+
+  inline size_t slotOf(uint64_t key) const {
+    // Fibonacci hashing spreads sequential keys
+    return static_cast<size_t>((key * 0x9e3779b97f4a7c15ULL) >> mShift);
+  }
+
+  std::unique_ptr<std::atomic<uint64_t>[]> mSlots;
+  size_t mMask;
+  unsigned int mShift;
+  size_t mLimit;
+  std::atomic<size_t> mSize;
+  std::atomic<bool> mHasMaxKey;
+};
+
+} // namespace util
+
+#endif // __CONCURRENT_HASH_SET_H__
@@ -4,13 +4,14 @@
 // system includes
 #include <bit>
 #include <cstdint>
+#include <cstring>
 
 namespace util {
 
 /// \brief  Convert a 16-bit integer to big-endian format.
 /// \param value 16-bit integer to convert.
 /// \return Big-endian representation of the input value.
-inline uint16_t toBigEndian(uint16_t value) {
+constexpr uint16_t toBigEndian(uint16_t value) {
   if constexpr (std::endian::native == std::endian::big) {
     return value;
   } else {
@@ -21,7 +22,7 @@ inline uint16_t toBigEndian(uint16_t value) {
 /// \brief  Convert a 16-bit integer to little-endian format.
 /// \param value 16-bit integer to convert.
 /// \return Little-endian representation of the input value.
-inline uint16_t toLittleEndian(uint16_t value) {
+constexpr uint16_t toLittleEndian(uint16_t value) {
   if constexpr (std::endian::native == std::endian::little) {
     return value;
   } else {
@@ -32,7 +33,7 @@ inline uint16_t toLittleEndian(uint16_t value) {
 /// \brief  Convert a 16-bit integer from big-endian format to native format.
 /// \param value 16-bit integer in big-endian format.
 /// \return Native representation of the input value.
-inline uint16_t fromBigEndian(uint16_t value) {
+constexpr uint16_t fromBigEndian(uint16_t value) {
   if constexpr (std::endian::native == std::endian::big) {
     return value;
   } else {
@@ -43,7 +44,7 @@ inline uint16_t fromBigEndian(uint16_t value) {
 /// \brief  Convert a 16-bit integer from little-endian format to native format.
 /// \param value 16-bit integer in little-endian format.
 /// \return Native representation of the input value.
-inline uint16_t fromLittleEndian(uint16_t value) {
+constexpr uint16_t fromLittleEndian(uint16_t value) {
   if constexpr (std::endian::native == std::endian::little) {
     return value;
   } else {
@@ -54,7 +55,7 @@ inline uint16_t fromLittleEndian(uint16_t value) {
 /// \brief  Convert a 32-bit integer to big-endian format.
 /// \param value 32-bit integer to convert.
 /// \return Big-endian representation of the input value.
-inline uint32_t toBigEndian(uint32_t value) {
+constexpr uint32_t toBigEndian(uint32_t value) {
   if constexpr (std::endian::native == std::endian::big) {
     return value;
   } else {
@@ -65,7 +66,7 @@ inline uint32_t toBigEndian(uint32_t value) {
 /// \brief  Convert a 32-bit integer to little-endian format.
 /// \param value 32-bit integer to convert.
 /// \return Little-endian representation of the input value.
-inline uint32_t toLittleEndian(uint32_t value) {
+constexpr uint32_t toLittleEndian(uint32_t value) {
   if constexpr (std::endian::native == std::endian::little) {
     return value;
   } else {
@@ -76,7 +77,7 @@ inline uint32_t toLittleEndian(uint32_t value) {
 /// \brief  Convert a 32-bit integer from big-endian format to native format.
 /// \param value 32-bit integer in big-endian format.
 /// \return Native representation of the input value.
-inline uint32_t fromBigEndian(uint32_t value) {
+constexpr uint32_t fromBigEndian(uint32_t value) {
   if constexpr (std::endian::native == std::endian::big) {
     return value;
   } else {
@@ -87,7 +88,7 @@ inline uint32_t fromBigEndian(uint32_t value) {
 /// \brief  Convert a 32-bit integer from little-endian format to native format.
 /// \param value 32-bit integer in little-endian format.
 /// \return Native representation of the input value.
-inline uint32_t fromLittleEndian(uint32_t value) {
+constexpr uint32_t fromLittleEndian(uint32_t value) {
   if constexpr (std::endian::native == std::endian::little) {
     return value;
   } else {
@@ -98,7 +99,7 @@ inline uint32_t fromLittleEndian(uint32_t value) {
 /// \brief  Convert a 64-bit integer to big-endian format.
 /// \param value 64-bit integer to convert.
 /// \return Big-endian representation of the input value.
-inline uint64_t toBigEndian(uint64_t value) {
+constexpr uint64_t toBigEndian(uint64_t value) {
   if constexpr (std::endian::native == std::endian::big) {
     return value;
   } else {
@@ -109,7 +110,7 @@ inline uint64_t toBigEndian(uint64_t value) {
 /// \brief  Convert a 64-bit integer to little-endian format.
 /// \param value 64-bit integer to convert.
 /// \return Little-endian representation of the input value.
-inline uint64_t toLittleEndian(uint64_t value) {
+constexpr uint64_t toLittleEndian(uint64_t value) {
   if constexpr (std::endian::native == std::endian::little) {
     return value;
   } else {
@@ -120,7 +121,7 @@ inline uint64_t toLittleEndian(uint64_t value) {
 /// \brief  Convert a 64-bit integer from big-endian format to native format.
 /// \param value 64-bit integer in big-endian format.
 /// \return Native representation of the input value.
-inline uint64_t fromBigEndian(uint64_t value) {
+constexpr uint64_t fromBigEndian(uint64_t value) {
   if constexpr (std::endian::native == std::endian::big) {
     return value;
   } else {
@@ -131,7 +132,7 @@ inline uint64_t fromBigEndian(uint64_t value) {
 /// \brief  Convert a 64-bit integer from little-endian format to native format.
 /// \param value 64-bit integer in little-endian format.
 /// \return Native representation of the input value.
-inline uint64_t fromLittleEndian(uint64_t value) {
+constexpr uint64_t fromLittleEndian(uint64_t value) {
   if constexpr (std::endian::native == std::endian::little) {
     return value;
   } else {
@@ -139,6 +140,98 @@ inline uint64_t fromLittleEndian(uint64_t value) {
   }
 }
 
+/// \brief  Read a 32-bit little-endian integer from a byte buffer.
+/// \param ptr Pointer to at least 4 readable bytes.
+/// \return Native representation of the stored value.
+/// \note Usable in constant expressions; at run time this is a single load.
+constexpr uint32_t ReadLE32(const uint8_t *ptr) {
+  if consteval {
+    return static_cast<uint32_t>(ptr[0]) |
+           (static_cast<uint32_t>(ptr[1]) << 8) |
+           (static_cast<uint32_t>(ptr[2]) << 16) |
+           (static_cast<uint32_t>(ptr[3]) << 24);
+  } else {
+    uint32_t value;
+    std::memcpy(&value, ptr, sizeof(value));
+    return fromLittleEndian(value);
+  }
+}
+
+/// \brief  Read a 64-bit little-endian integer from a byte buffer.
+/// \param ptr Pointer to at least 8 readable bytes.
+/// \return Native representation of the stored value.
+/// \note Usable in constant expressions; at run time this is a single load.
+constexpr uint64_t ReadLE64(const uint8_t *ptr) {
+  if consteval {
+    uint64_t value = 0;
+    for (int i = 7; i >= 0; --i) {
+      value = (value << 8) | ptr[i];
+    }
+    return value;
+  } else {
+    uint64_t value;
+    std::memcpy(&value, ptr, sizeof(value));
+    return fromLittleEndian(value);
+  }
+}
+
+/// \brief  Read a 32-bit big-endian integer from a byte buffer.
+/// \param ptr Pointer to at least 4 readable bytes.
+/// \return Native representation of the stored value.
+constexpr uint32_t ReadBE32(const uint8_t *ptr) {
+  if consteval {
+    return (static_cast<uint32_t>(ptr[0]) << 24) |
+           (static_cast<uint32_t>(ptr[1]) << 16) |
+           (static_cast<uint32_t>(ptr[2]) << 8) | static_cast<uint32_t>(ptr[3]);
+  } else {
+    uint32_t value;
+    std::memcpy(&value, ptr, sizeof(value));
+    return fromBigEndian(value);
+  }
+}
+
+/// \brief  Write a 32-bit integer to a byte buffer in little-endian order.
+/// \param ptr Pointer to at least 4 writable bytes.
+/// \param value Native value to store.
+constexpr void WriteLE32(uint8_t *ptr, uint32_t value) {
+  if consteval {
+    for (int i = 0; i < 4; ++i) {
+      ptr[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+  } else {
+    value = toLittleEndian(value);
+    std::memcpy(ptr, &value, sizeof(value));
+  }
+}
+
+/// \brief  Write a 64-bit integer to a byte buffer in little-endian order.
+/// \param ptr Pointer to at least 8 writable bytes.
+/// \param value Native value to store.
+constexpr void WriteLE64(uint8_t *ptr, uint64_t value) {
+  if consteval {
+    for (int i = 0; i < 8; ++i) {
+      ptr[i] = static_cast<uint8_t>(value >> (8 * i));
+    }
+  } else {
+    value = toLittleEndian(value);
+    std::memcpy(ptr, &value, sizeof(value));
+  }
+}
+
+/// \brief  Write a 32-bit integer to a byte buffer in big-endian order.
+/// \param ptr Pointer to at least 4 writable bytes.
+/// \param value Native value to store.
+constexpr void WriteBE32(uint8_t *ptr, uint32_t value) {
+  if consteval {
+    for (int i = 0; i < 4; ++i) {
+      ptr[i] = static_cast<uint8_t>(value >> (8 * (3 - i)));
+    }
+  } else {
+    value = toBigEndian(value);
+    std::memcpy(ptr, &value, sizeof(value));
+  }
+}
+
 } // namespace util
 
 #endif // __ENDIAN_H__
\ No newline at end of file
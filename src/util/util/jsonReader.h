@@ -0,0 +1,123 @@
+#ifndef __JSON_READER_H__
+#define __JSON_READER_H__
+
+// system includes
+#include <cstddef>
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+namespace util {
+
+/// \brief Token kinds produced by JsonReader.
+enum class JsonToken : uint8_t {
+  BeginObject,
+  EndObject,
+  BeginArray,
+  EndArray,
+  Key,    // object member name
+  String, // string value
+  Number,
+  True,
+  False,
+  Null,
+  End,   // the whole document has been read
+  Error, // malformed input; see getOffset()
+};
+
+/// \brief Streaming pull parser for JSON text.
+/// \note Tokens are read one at a time with next() and never copied: keys,
+/// strings and numbers are views into the input, which must outlive the
+/// reader. Strings are returned raw, without their quotes and with escapes
+/// left in place; getString() decodes them into a caller-owned buffer when
+/// needed. The nesting is tracked in a fixed bit stack, so reading does not
+/// allocate. The grammar is checked as tokens are read; any violation
+/// yields JsonToken::Error from then on.
+class JsonReader {
+public:
+  /// \brief Deepest nesting accepted.
+  static constexpr size_t MAX_DEPTH = 64;
+
+  /// \brief Construct a reader.
+  /// \param text JSON document.
+  explicit JsonReader(std::string_view text);
+
+  /// \brief Read the next token.
+  /// \return The token kind; getValue() holds its text for keys, strings and
+  /// numbers.
+  JsonToken next();
+
+  /// \brief Skip the next value, including everything nested in it.
+  /// \return false on malformed input or if no value follows.
+  bool skipValue();
+
+  /// \brief Get the text of the current key, string or number token.
+  inline std::string_view getValue() const { return mValue; }
+
+  /// \brief Whether the current key or string contains escapes.
+  inline bool hasEscapes() const { return mEscaped; }
+
+  /// \brief Decode the current key or string.
+  /// \param out Receives the text with escapes resolved (\\uXXXX as UTF-8).
+  /// \return false on an invalid escape.
+  bool getString(std::string &out) const;
+
+  /// \brief Read the current number token as an integer.
+  /// \param value Receives the value.
+  /// \return false if the number is not an integer or is out of range.
+  bool getInt(int64_t &value) const;
+
+  /// \brief Read the current number token as an unsigned integer.
+  /// \param value Receives the value.
+  /// \return false if the number is not a non-negative integer or is out of
+  /// range.
+  bool getUint(uint64_t &value) const;
+
+  /// \brief Read the current number token as a floating-point value.
+  /// \param value Receives the value.
+  /// \return false if the number is out of range.
+  bool getDouble(double &value) const;
+
+  /// \brief Get the current nesting depth.
+  inline size_t getDepth() const { return mDepth; }
+
+  /// \brief Get the read position (of the error, after JsonToken::Error).
+  inline size_t getOffset() const { return mPos; }
+
+private:
+  /// \brief What the grammar allows next.
+  enum class Expect : uint8_t {
+    Value,      // any value
+    ValueOrEnd, // first array element or ]
+    Key,        // member name after a comma
+    KeyOrEnd,   // first member name or }
+    CommaOrEnd, // , or the closing bracket
+    Done,       // the top-level value is complete
+  };
+
+  JsonToken fail();
+  JsonToken readValue();
+  JsonToken readString(JsonToken token);
+  JsonToken readNumber();
+  JsonToken readLiteral(std::string_view literal, JsonToken token);
+  JsonToken open(bool object);
+  JsonToken close(bool object);
+  void skipWhitespace();
+  inline bool inObject() const { return (mStack >> (mDepth - 1)) & 1; }
+  inline Expect afterValue() const {
+    return mDepth == 0 ? Expect::Done : Expect::CommaOrEnd;
+  }
+
+  std::string_view mText;
+  size_t mPos;
+  std::string_view mValue;
+  bool mEscaped;
+  bool mFailed;
+  Expect mExpect;
+  size_t mDepth;
+  uint64_t mStack; // bit d set: level d + 1 is an object
+};
+
+} // namespace util
+
+#endif // __JSON_READER_H__
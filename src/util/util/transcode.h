@@ -2,7 +2,11 @@
 #define __TRANSCODE_H__
 
 // system includes
+#include <cstddef>
 #include <cstdint>
+#include <span>
+#include <string>
+#include <string_view>
 
 namespace util {
 /// \brief Convert a single hexadecimal character to its integer value at
@@ -19,6 +23,35 @@ consteval uint8_t ConstevalHexDigit(const char c) {
   throw "Only lowercase hex digits are allowed, for consistency";
 }
 
+/// \brief Decode a hexadecimal string into bytes.
+/// \param hex Hex digits, upper or lower case; must have an even length.
+/// \param out Destination of hex.size() / 2 bytes.
+/// \return false if the length is odd or a character is not a hex digit
+/// (out may then be partly written).
+/// \note Table-driven, for multi-megabyte inputs such as block templates.
+bool DecodeHex(std::string_view hex, uint8_t *out);
+
+/// \brief Encode bytes as lowercase hexadecimal.
+/// \param data Bytes to encode.
+/// \param out Destination of 2 * data.size() characters; not terminated.
+void EncodeHex(std::span<const uint8_t> data, char *out);
+
+/// \brief Append bytes as lowercase hexadecimal, without quotes.
+/// \param out String to append to.
+/// \param data Bytes to encode.
+void AppendHex(std::string &out, std::span<const uint8_t> data);
+
+/// \brief Append text as a quoted JSON string, escaping quotes,
+/// backslashes and control characters.
+/// \param out String to append to.
+/// \param text UTF-8 text.
+void AppendJsonString(std::string &out, std::string_view text);
+
+/// \brief Encode bytes as standard base64 with padding.
+/// \param data Bytes to encode.
+/// \return The base64 text.
+std::string EncodeBase64(std::span<const uint8_t> data);
+
 } // namespace util
 
 #endif // __TRANSCODE_H__
\ No newline at end of file
@@ -0,0 +1,264 @@
+// system includes
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <span>
+#include <string>
+#include <vector>
+
+// Google Test includes
+#include <gtest/gtest.h>
+
+// project includes
+#include "block/blockFile.h"
+#include "block/blockIndex.h"
+#include "block/headerView.h"
+#include "block/packedHeader.h"
+#include "types/types.h"
+#include "util/endian.h"
+
+// A throwaway blocks directory under the temp directory
+class BlocksDir {
+public:
+  explicit BlocksDir(const std::string &name)
+      : mPath(std::filesystem::temp_directory_path() / name) {
+    std::filesystem::remove_all(mPath);
+    std::filesystem::create_directories(mPath);
+  }
+  ~BlocksDir() { std::filesystem::remove_all(mPath); }
+
+  std::string path() const { return mPath.string(); }
+  std::string file(const std::string &name) const {
+    return (mPath / name).string();
+  }
+
+  // Serialized block: header plus a body of the given size
+  static std::vector<uint8_t> makeBlock(uint32_t id, size_t body) {
+    Block::PackedHeader header;
+    header.setVersion(0x20000000);
+    header.setTimestamp(1700000000 + id);
+    header.setBits(0x1d00ffff);
+    header.setNonce(id);
+    std::vector<uint8_t> block(header.bytes().begin(), header.bytes().end());
+    for (size_t i = 0; i < body; ++i) {
+      block.push_back(static_cast<uint8_t>(id + i));
+    }
+    return block;
+  }
+
+  // Write framed blocks followed by preallocation padding, XORed with key
+  void writeFile(const std::string &name,
+                 const std::vector<std::vector<uint8_t>> &blocks,
+                 const Block::XorKey &key = {}, size_t padding = 1000) const {
+    std::vector<uint8_t> data;
+    for (const auto &block : blocks) {
+      data.insert(data.end(), Block::MAINNET_MAGIC.begin(),
+                  Block::MAINNET_MAGIC.end());
+      uint8_t size[4];
+      util::WriteLE32(size, static_cast<uint32_t>(block.size()));
+      data.insert(data.end(), size, size + 4);
+      data.insert(data.end(), block.begin(), block.end());
+    }
+    data.resize(data.size() + padding, 0);
+    for (size_t i = 0; i < data.size(); ++i) {
+      data[i] ^= key[i % key.size()];
+    }
+    std::ofstream(file(name), std::ios::binary)
+        .write(reinterpret_cast<const char *>(data.data()),
+               static_cast<std::streamsize>(data.size()));
+  }
+
+  void writeKey(const Block::XorKey &key) const {
+    std::ofstream(file("xor.dat"), std::ios::binary)
+        .write(reinterpret_cast<const char *>(key.data()), key.size());
+  }
+
+private:
+  std::filesystem::path mPath;
+};
+
+static std::vector<std::vector<uint8_t>> makeBlocks(uint32_t first,
+                                                    size_t count) {
+  std::vector<std::vector<uint8_t>> blocks;
+  for (uint32_t i = first; i < first + count; ++i) {
+    blocks.push_back(BlocksDir::makeBlock(i, 100 + (i % 7) * 33));
+  }
+  return blocks;
+}
+
+// Walk a file and compare every record with the blocks written
+static void expectBlocks(const Block::BlockFile &file,
+                         const std::vector<std::vector<uint8_t>> &blocks) {
+  size_t i = 0;
+  std::vector<uint8_t> buffer;
+  const size_t visited =
+      file.forEachBlock([&](const Block::BlockRecord &record) {
+        ASSERT_LT(i, blocks.size());
+        const std::span<const uint8_t> bytes = record.bytes(buffer);
+        EXPECT_TRUE(std::equal(bytes.begin(), bytes.end(), blocks[i].begin(),
+                               blocks[i].end()));
+        EXPECT_EQ(record.header().getNonce(), i);
+        ++i;
+      });
+  EXPECT_EQ(visited, blocks.size());
+}
+
+TEST(BlockFileTEST, WalksPlainFile) {
+  BlocksDir dir("hfm_blocks_plain");
+  const auto blocks = makeBlocks(0, 20);
+  dir.writeFile("blk00000.dat", blocks);
+
+  const Block::BlockFile file(dir.file("blk00000.dat"),
+                              Block::readXorKey(dir.path()));
+  EXPECT_FALSE(file.isObfuscated());
+  expectBlocks(file, blocks);
+
+  // Records point into the mapping: the second starts after the first
+  const auto first = file.readAt(0);
+  ASSERT_TRUE(first.has_value());
+  EXPECT_EQ(first->offset, Block::BlockFile::FRAME_SIZE);
+  const auto second = file.readAt(first->offset + first->size());
+  ASSERT_TRUE(second.has_value());
+  EXPECT_EQ(second->stored.data(), first->stored.data() + first->size() +
+                                       Block::BlockFile::FRAME_SIZE);
+  std::vector<uint8_t> buffer;
+  EXPECT_EQ(second->bytes(buffer).data(), second->stored.data());
+  EXPECT_TRUE(buffer.empty());
+}
+
+TEST(BlockFileTEST, DecodesObfuscatedFile) {
+  BlocksDir dir("hfm_blocks_xor");
+  const Block::XorKey key = {0x12, 0x34, 0x56, 0x78, 0x9a, 0xbc, 0xde, 0xf0};
+  dir.writeKey(key);
+  const auto blocks = makeBlocks(0, 20);
+  dir.writeFile("blk00000.dat", blocks, key);
+  const auto size_before =
+      std::filesystem::file_size(dir.file("blk00000.dat"));
+
+  {
+    const Block::BlockFile file(dir.file("blk00000.dat"),
+                                Block::readXorKey(dir.path()));
+    EXPECT_TRUE(file.isObfuscated());
+    expectBlocks(file, blocks);
+
+    // Only the header is decoded up front; the mapping stays encoded
+    const auto record = file.readAt(0);
+    ASSERT_TRUE(record.has_value());
+    EXPECT_EQ(record->stored[0], blocks[0][0] ^ key[0]);
+    EXPECT_EQ(record->stored[80], blocks[0][80] ^ key[0]);
+    EXPECT_EQ(record->header().getTimestamp(), 1700000000u);
+
+    // Without the key the framing does not parse
+    const Block::BlockFile raw(dir.file("blk00000.dat"));
+    EXPECT_EQ(raw.forEachBlock([](const Block::BlockRecord &) {}), 0);
+  }
+
+  // Decoding never writes to the file
+  EXPECT_EQ(std::filesystem::file_size(dir.file("blk00000.dat")),
+            size_before);
+  const Block::BlockFile again(dir.file("blk00000.dat"), key);
+  expectBlocks(again, blocks);
+}
+
+TEST(BlockFileTEST, StopsAtTruncatedRecord) {
+  BlocksDir dir("hfm_blocks_truncated");
+  const auto blocks = makeBlocks(0, 3);
+  dir.writeFile("blk00000.dat", blocks);
+  // Drop the padding and half of the last block
+  std::filesystem::resize_file(dir.file("blk00000.dat"),
+                               2 * 8 + blocks[0].size() + blocks[1].size() +
+                                   8 + blocks[2].size() / 2);
+
+  // A walk reports where the last complete record ends
+  const Block::BlockFile file(dir.file("blk00000.dat"));
+  uint64_t end = 0;
+  EXPECT_EQ(file.forEachBlock([](const Block::BlockRecord &) {}, end), 2);
+  EXPECT_EQ(end, 2 * 8 + blocks[0].size() + blocks[1].size());
+  EXPECT_FALSE(file.readBlock(file.getSize() - 10, 80).has_value());
+}
+
+TEST(BlockIndexTEST, BuildFindAndReuse) {
+  BlocksDir dir("hfm_blocks_index");
+  const Block::XorKey key = {1, 2, 3, 4, 5, 6, 7, 8};
+  dir.writeKey(key);
+  const auto first = makeBlocks(0, 150);
+  const auto second = makeBlocks(150, 90);
+  dir.writeFile("blk00000.dat", first, key);
+  dir.writeFile("blk00001.dat", second, key);
+  const std::string index_path = dir.file("index.bin");
+
+  {
+    const Block::BlockIndex index =
+        Block::BlockIndex::build(dir.path(), index_path, 2);
+    EXPECT_EQ(index.size(), 240);
+    EXPECT_EQ(index.getScannedFiles(), 2);
+
+    // Every block is found and its location reads back the same bytes
+    const Block::BlockFile file(Block::BlockIndex::blockFilePath(dir.path(), 1),
+                                key);
+    std::vector<uint8_t> buffer;
+    for (size_t i = 0; i < second.size(); ++i) {
+      const Block::BlockHeaderView view(
+          std::span<const uint8_t, 80>(second[i].data(), 80));
+      const auto location = index.find(view.calculateBlockHash());
+      ASSERT_TRUE(location.has_value());
+      EXPECT_EQ(location->file, 1);
+      const auto record = file.readBlock(location->offset, location->size);
+      ASSERT_TRUE(record.has_value());
+      const std::span<const uint8_t> bytes = record->bytes(buffer);
+      EXPECT_TRUE(std::equal(bytes.begin(), bytes.end(), second[i].begin(),
+                             second[i].end()));
+    }
+    EXPECT_FALSE(index.find(Hash{}).has_value());
+  }
+
+  // Nothing changed: the saved index is reused and no blocks are found
+  {
+    const Block::BlockIndex index =
+        Block::BlockIndex::build(dir.path(), index_path, 2);
+    EXPECT_EQ(index.size(), 240);
+    EXPECT_EQ(index.getScannedFiles(), 0);
+  }
+
+  // The last file grew: only it is scanned again
+  auto grown = second;
+  const auto extra = makeBlocks(240, 5);
+  grown.insert(grown.end(), extra.begin(), extra.end());
+  dir.writeFile("blk00001.dat", grown, key);
+  const Block::BlockIndex index =
+      Block::BlockIndex::build(dir.path(), index_path, 2);
+  EXPECT_EQ(index.getScannedFiles(), 1);
+  EXPECT_EQ(index.size(), 245);
+  const Block::BlockHeaderView view(
+      std::span<const uint8_t, 80>(extra[4].data(), 80));
+  ASSERT_TRUE(index.find(view.calculateBlockHash()).has_value());
+  EXPECT_EQ(index.find(view.calculateBlockHash())->file, 1);
+}
+
+// Core writes into preallocated space: the file size does not change
+TEST(BlockIndexTEST, FindsBlocksAppendedToPreallocatedFile) {
+  BlocksDir dir("hfm_blocks_prealloc");
+  const auto blocks = makeBlocks(0, 30);
+  const auto extra = makeBlocks(30, 1);
+  const size_t padding = 4096;
+  dir.writeFile("blk00000.dat", blocks, {}, padding);
+  const auto size = std::filesystem::file_size(dir.file("blk00000.dat"));
+  const std::string index_path = dir.file("index.bin");
+  EXPECT_EQ(Block::BlockIndex::build(dir.path(), index_path, 1).size(), 30);
+
+  auto appended = blocks;
+  appended.push_back(extra[0]);
+  dir.writeFile("blk00000.dat", appended, {},
+                padding - Block::BlockFile::FRAME_SIZE - extra[0].size());
+  ASSERT_EQ(std::filesystem::file_size(dir.file("blk00000.dat")), size);
+
+  const Block::BlockIndex index =
+      Block::BlockIndex::build(dir.path(), index_path, 1);
+  EXPECT_EQ(index.getScannedFiles(), 1);
+  EXPECT_EQ(index.size(), 31);
+  const Block::BlockHeaderView view(
+      std::span<const uint8_t, 80>(extra[0].data(), 80));
+  const auto location = index.find(view.calculateBlockHash());
+  ASSERT_TRUE(location.has_value());
+  EXPECT_EQ(location->offset, size - padding + Block::BlockFile::FRAME_SIZE);
+}
@@ -1,3 +1,7 @@
+// system includes
+#include <thread>
+#include <vector>
+
 // Google Test includes
 #include <gtest/gtest.h>
 
@@ -605,3 +609,274 @@ TEST(BlockHeaderTEST, calculateNonce_LargeMaxAttempts) {
   EXPECT_TRUE(found);
   EXPECT_GE(block.getNonce(), 0);
 }
+
+// Test rolling walks ntime and version once the nonce window is exhausted
+TEST(BlockHeaderTEST, calculateNonce_RollsVersionAndNtime) {
+  Block::BlockHeader block;
+
+  block.setVersion(0x20000000);
+  block.setTimestamp(1000000);
+  // Top byte of the hash must be zero: roughly 1 in 256 hashes qualify
+  block.setBits(0x2000ffff);
+
+  Hash prev_hash, merkle_hash;
+  for (size_t i = 0; i < 32; ++i) {
+    prev_hash[i] = static_cast<unsigned char>(i);
+    merkle_hash[i] = static_cast<unsigned char>(255 - i);
+  }
+  block.setPrevBlockHash(prev_hash);
+  block.setMerkleRoot(merkle_hash);
+
+  Block::RollingPolicy policy;
+  policy.versionMask = Block::BIP320_VERSION_MASK;
+  policy.maxNtimeDrift = 4;
+  policy.nonceCount = 8;
+
+  Block::Solution solution;
+  ASSERT_TRUE(block.calculateNonce(policy, solution, 100000));
+
+  // Only the allowed fields were rolled, within their limits
+  EXPECT_LT(solution.nonce, 8);
+  EXPECT_EQ(solution.version & ~Block::BIP320_VERSION_MASK, 0x20000000);
+  EXPECT_GE(solution.timestamp, 1000000);
+  EXPECT_LE(solution.timestamp, 1000004);
+  // Eight nonces per roll are not enough on their own at this difficulty
+  EXPECT_TRUE(solution.version != 0x20000000 ||
+              solution.timestamp != 1000000);
+
+  // The header holds the solution and reproduces the reported hash
+  EXPECT_EQ(block.getNonce(), solution.nonce);
+  EXPECT_EQ(block.getVersion(), solution.version);
+  EXPECT_EQ(block.getTimestamp(), solution.timestamp);
+  EXPECT_EQ(block.calculateBlockHash(), solution.hash);
+}
+
+// Test an exhausted search restores the rolled fields
+TEST(BlockHeaderTEST, calculateNonce_RollingRestoresOnFailure) {
+  Block::BlockHeader block;
+
+  block.setVersion(0x20000000);
+  block.setTimestamp(1000000);
+  block.setBits(0x1d00ffff); // Bitcoin difficulty, out of reach here
+
+  Block::RollingPolicy policy;
+  policy.versionMask = Block::BIP320_VERSION_MASK;
+  policy.maxNtimeDrift = 2;
+  policy.nonceCount = 4;
+
+  Block::Solution solution;
+  EXPECT_FALSE(block.calculateNonce(policy, solution, 64));
+  EXPECT_EQ(block.getVersion(), 0x20000000);
+  EXPECT_EQ(block.getTimestamp(), 1000000);
+}
+
+// Test the version roll enumerates every combination of the mask bits
+TEST(BlockHeaderTEST, nextRolledVersion_EnumeratesMask) {
+  const uint32_t mask = 0x00000A00;
+  uint32_t rolled = 0;
+  std::vector<uint32_t> seen;
+  do {
+    seen.push_back(rolled);
+    rolled = Block::nextRolledVersion(rolled, mask);
+  } while (rolled != 0);
+
+  EXPECT_EQ(seen, (std::vector<uint32_t>{0x000, 0x200, 0x800, 0xA00}));
+}
+
+// Test hashing from the cached midstate matches hashing all 80 bytes
+TEST(BlockHeaderTEST, midstate_MatchesFullHash) {
+  Block::BlockHeader block;
+
+  block.setVersion(BLOCK_VERSION_4);
+  block.setTimestamp(1234567890);
+  block.setBits(0x1d00ffff);
+  block.setNonce(0xDEADBEEF);
+
+  Hash prev_hash, merkle_hash;
+  for (size_t i = 0; i < 32; ++i) {
+    prev_hash[i] = static_cast<unsigned char>(i);
+    merkle_hash[i] = static_cast<unsigned char>(255 - i);
+  }
+  block.setPrevBlockHash(prev_hash);
+  block.setMerkleRoot(merkle_hash);
+
+  EXPECT_FALSE(block.hasMidstate());
+  Hash full = block.calculateBlockHash();
+
+  block.updateMidstate();
+  EXPECT_TRUE(block.hasMidstate());
+  EXPECT_EQ(block.calculateBlockHash(), full);
+}
+
+// Test only the fields in the first 64 bytes invalidate the midstate
+TEST(BlockHeaderTEST, midstate_Invalidation) {
+  Block::BlockHeader block;
+  block.updateMidstate();
+
+  // Fields in the second SHA-256 block keep the midstate
+  block.setNonce(1);
+  block.setTimestamp(2);
+  block.setBits(0x207FFFFF);
+  EXPECT_TRUE(block.hasMidstate());
+
+  block.setVersion(BLOCK_VERSION_2);
+  EXPECT_FALSE(block.hasMidstate());
+  block.updateMidstate();
+
+  Hash hash;
+  hash.fill(0x11);
+  block.setPrevBlockHash(hash);
+  EXPECT_FALSE(block.hasMidstate());
+  block.updateMidstate();
+
+  block.setMerkleRoot(hash);
+  EXPECT_FALSE(block.hasMidstate());
+
+  // A refreshed midstate reflects the new first-block bytes
+  Block::BlockHeader fresh(block.getPackedHeader());
+  block.updateMidstate();
+  block.setNonce(42);
+  fresh.setNonce(42);
+  EXPECT_EQ(block.calculateBlockHash(), fresh.calculateBlockHash());
+}
+
+// Test the hash is cached after the first call and matches a recomputation
+TEST(BlockHeaderTEST, cachedHash_MatchesRecomputed) {
+  Block::BlockHeader block;
+  block.setVersion(BLOCK_VERSION_4);
+  block.setTimestamp(1234567890);
+  block.setBits(0x1d00ffff);
+  block.setNonce(7);
+
+  EXPECT_FALSE(block.isHashCached());
+  Hash first = block.calculateBlockHash();
+  EXPECT_TRUE(block.isHashCached());
+  EXPECT_EQ(block.calculateBlockHash(), first);
+
+  // A fresh header over the same bytes recomputes the same value
+  Block::BlockHeader recomputed(block.getPackedHeader());
+  EXPECT_FALSE(recomputed.isHashCached());
+  EXPECT_EQ(recomputed.calculateBlockHash(), first);
+}
+
+// Test every setter marks the cached hash dirty
+TEST(BlockHeaderTEST, cachedHash_SettersInvalidate) {
+  Block::BlockHeader block;
+  Hash hash;
+  hash.fill(0x22);
+
+  auto expect_invalidated = [&block](auto &&mutate) {
+    Hash before = block.calculateBlockHash();
+    ASSERT_TRUE(block.isHashCached());
+    mutate();
+    EXPECT_FALSE(block.isHashCached());
+    EXPECT_NE(block.calculateBlockHash(), before);
+  };
+
+  expect_invalidated([&] { block.setVersion(BLOCK_VERSION_2); });
+  expect_invalidated([&] { block.setPrevBlockHash(hash); });
+  expect_invalidated([&] { block.setMerkleRoot(hash); });
+  expect_invalidated([&] { block.setTimestamp(99); });
+  expect_invalidated([&] { block.setBits(0x207FFFFF); });
+  expect_invalidated([&] { block.setNonce(12345); });
+}
+
+// Test copies carry the cached hash and stay independent
+TEST(BlockHeaderTEST, cachedHash_Copy) {
+  Block::BlockHeader block;
+  block.setNonce(1);
+  Hash hash = block.calculateBlockHash();
+
+  Block::BlockHeader copy(block);
+  EXPECT_TRUE(copy.isHashCached());
+  EXPECT_EQ(copy.calculateBlockHash(), hash);
+
+  copy.setNonce(2);
+  EXPECT_TRUE(block.isHashCached());
+  EXPECT_EQ(block.calculateBlockHash(), hash);
+
+  Block::BlockHeader assigned;
+  assigned = copy;
+  EXPECT_EQ(assigned.calculateBlockHash(), copy.calculateBlockHash());
+}
+
+// Test concurrent readers of an unmodified header agree on the hash
+TEST(BlockHeaderTEST, cachedHash_ConcurrentReaders) {
+  Block::BlockHeader block;
+  block.setVersion(BLOCK_VERSION_4);
+  block.setTimestamp(1234567890);
+  block.setNonce(0xABCDEF);
+  const Hash expected = Block::BlockHeader(block.getPackedHeader())
+                            .calculateBlockHash();
+
+  std::vector<Hash> results(8);
+  std::vector<std::thread> readers;
+  for (size_t i = 0; i < results.size(); ++i) {
+    readers.emplace_back([&block, &results, i] {
+      for (int n = 0; n < 100; ++n) {
+        results[i] = block.calculateBlockHash();
+      }
+    });
+  }
+  for (auto &reader : readers) {
+    reader.join();
+  }
+
+  for (const auto &result : results) {
+    EXPECT_EQ(result, expected);
+  }
+  EXPECT_TRUE(block.isHashCached());
+}
+
+// Test a multi-target scan reports every hit with the hardest target met
+TEST(BlockHeaderTEST, scanNonces_ReportsAllHits) {
+  Block::BlockHeader block;
+  block.setVersion(BLOCK_VERSION_4);
+  block.setTimestamp(1000000);
+
+  // Share target: top byte zero. Network target: top two bytes zero.
+  const uint256 targets[] = {uint256().SetCompact(0x2000ffff),
+                             uint256().SetCompact(0x1f00ffff)};
+  std::vector<Block::ScanHit> hits(4096);
+
+  Block::ScanResult result = block.scanNonces(100, 4096, targets, hits);
+  EXPECT_EQ(result.scanned, 4096);
+
+  // Brute-force the same range on an independent header
+  Block::BlockHeader check(block.getPackedHeader());
+  size_t expected_hits = 0;
+  for (uint32_t nonce = 100; nonce < 100 + 4096; ++nonce) {
+    check.setNonce(nonce);
+    Hash hash = check.calculateBlockHash();
+    if (!MeetsTarget(hash, targets[0])) {
+      continue;
+    }
+    ASSERT_LT(expected_hits, result.hits);
+    const Block::ScanHit &hit = hits[expected_hits++];
+    EXPECT_EQ(hit.nonce, nonce);
+    EXPECT_EQ(hit.hash, hash);
+    EXPECT_EQ(hit.targetIndex, MeetsTarget(hash, targets[1]) ? 1 : 0);
+  }
+  EXPECT_EQ(result.hits, expected_hits);
+  EXPECT_GT(result.hits, 0);
+}
+
+// Test the scan stops when the hit buffer is full and can be resumed
+TEST(BlockHeaderTEST, scanNonces_ResumesWhenBufferFull) {
+  Block::BlockHeader block;
+  block.setVersion(BLOCK_VERSION_4);
+
+  // Every hash meets the maximum target
+  const uint256 targets[] = {~uint256()};
+  std::vector<Block::ScanHit> hits(3);
+
+  Block::ScanResult first = block.scanNonces(0, 10, targets, hits);
+  EXPECT_EQ(first.scanned, 3);
+  EXPECT_EQ(first.hits, 3);
+  EXPECT_EQ(hits[2].nonce, 2);
+
+  Block::ScanResult second =
+      block.scanNonces(static_cast<uint32_t>(first.scanned), 7, targets, hits);
+  EXPECT_EQ(second.hits, 3);
+  EXPECT_EQ(hits[0].nonce, 3);
+}
@@ -0,0 +1,124 @@
+// system includes
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+
+// Google Test includes
+#include <gtest/gtest.h>
+
+// project includes
+#include "block/blockTemplate.h"
+#include "block/transaction.h"
+#include "block/witnessCommitment.h"
+#include "sha256/sha256.h"
+#include "types/types.h"
+
+// Recorded templates live next to this file
+static std::string readTemplateFile(const std::string &name) {
+  const std::filesystem::path path =
+      std::filesystem::path(__FILE__).parent_path() / "data" / name;
+  std::ifstream file(path, std::ios::binary);
+  EXPECT_TRUE(file) << path;
+  return std::string((std::istreambuf_iterator<char>(file)),
+                     std::istreambuf_iterator<char>());
+}
+
+// Displayed (big-endian) hex to a raw hash
+static Hash displayedHash(const std::string &hex) {
+  Hash hash = SHA256::hashStringToArray(hex);
+  std::reverse(hash.begin(), hash.end());
+  return hash;
+}
+
+// Test the header fields, transactions and ids of a recorded template
+TEST(BlockTemplateTEST, RecordedTemplate) {
+  const std::string json = readTemplateFile("getblocktemplate_regtest.json");
+  Block::BlockTemplateParser parser;
+  const Block::BlockTemplate &gbt = parser.parse(json);
+
+  EXPECT_EQ(gbt.header.getVersion(), 0x20000000u);
+  EXPECT_EQ(gbt.header.getPrevBlockHash(),
+            displayedHash("3e1b5d2f7a3c1f0e5c2b8e2a9d7f4c1b0a9e8d7c6b5a4938271"
+                          "6054433221100"));
+  EXPECT_EQ(gbt.header.getBits(), 0x207fffffu);
+  EXPECT_EQ(gbt.header.getTimestamp(), 1700000600u);
+  EXPECT_EQ(gbt.header.getNonce(), 0u);
+  EXPECT_EQ(gbt.height, 205u);
+  EXPECT_EQ(gbt.minTime, 1700000001u);
+
+  ASSERT_EQ(gbt.transactions.size(), 3u);
+  EXPECT_EQ(gbt.getTotalFees(), 1410 + 2410 + 3410);
+  EXPECT_EQ(gbt.coinbaseValue, 5000000000 + gbt.getTotalFees());
+  EXPECT_TRUE(gbt.transactions[0].depends.empty());
+  ASSERT_EQ(gbt.transactions[2].depends.size(), 1u);
+  EXPECT_EQ(gbt.transactions[2].depends[0], 1u);
+
+  // The ids in the JSON match the decoded data
+  for (const Block::TemplateTransaction &entry : gbt.transactions) {
+    Block::Transaction tx;
+    size_t offset = 0;
+    ASSERT_TRUE(Block::parseTransaction(entry.data, offset, tx));
+    EXPECT_EQ(offset, entry.data.size());
+    EXPECT_EQ(tx.txid, entry.txid);
+    EXPECT_EQ(tx.wtxid, entry.wtxid);
+    EXPECT_EQ(tx.getWeight(), entry.weight);
+  }
+  EXPECT_NE(gbt.transactions[1].txid, gbt.transactions[0].txid);
+
+  // The node's commitment matches ours
+  std::vector<Hash> wtxids;
+  for (const Block::TemplateTransaction &entry : gbt.transactions) {
+    wtxids.push_back(entry.wtxid);
+  }
+  Block::WitnessCommitment commitment;
+  commitment.update(wtxids);
+  ASSERT_EQ(gbt.defaultWitnessCommitment.size(),
+            Block::WitnessCommitment::SCRIPT_SIZE);
+  EXPECT_TRUE(std::equal(gbt.defaultWitnessCommitment.begin(),
+                         gbt.defaultWitnessCommitment.end(),
+                         commitment.getScript().begin()));
+}
+
+// Test that a JSON-RPC response is unwrapped and that parsing again reuses
+// the arena
+TEST(BlockTemplateTEST, RpcResponseAndReuse) {
+  const std::string result = readTemplateFile("getblocktemplate_regtest.json");
+  const std::string response =
+      "{\"result\": " + result + ", \"error\": null, \"id\": \"hfm\"}";
+
+  Block::BlockTemplateParser parser;
+  const uint8_t *first_data =
+      parser.parse(response).transactions[0].data.data();
+  EXPECT_EQ(parser.parse(response).height, 205u);
+
+  // A smaller document fits in the same arena
+  const Block::BlockTemplate &gbt = parser.parse(result);
+  ASSERT_EQ(gbt.transactions.size(), 3u);
+  EXPECT_EQ(gbt.transactions[0].data.data(), first_data);
+}
+
+// Test error responses, missing fields and malformed input
+TEST(BlockTemplateTEST, Rejects) {
+  Block::BlockTemplateParser parser;
+  try {
+    parser.parse(R"({"result": null, "error": {"code": -10, "message": )"
+                 R"("Bitcoin Core is in initial sync"}, "id": 1})");
+    FAIL() << "expected an RPC error";
+  } catch (const std::runtime_error &error) {
+    EXPECT_NE(std::string(error.what()).find("initial sync"),
+              std::string::npos);
+  }
+
+  EXPECT_THROW(parser.parse(R"({"version": 1, "transactions": []})"),
+               std::runtime_error);
+
+  std::string json = readTemplateFile("getblocktemplate_regtest.json");
+  EXPECT_THROW(parser.parse(json.substr(0, json.size() / 2)),
+               std::runtime_error);
+
+  const size_t data = json.find("\"data\": \"") + 9;
+  json[data + 3] = 'x';
+  EXPECT_THROW(parser.parse(json), std::runtime_error);
+}
@@ -0,0 +1,132 @@
+// system includes
+#include <cstdint>
+#include <vector>
+
+// Google Test includes
+#include <gtest/gtest.h>
+
+// project includes
+#include "block/coinbase.h"
+#include "block/transaction.h"
+#include "block/witnessCommitment.h"
+#include "types/types.h"
+
+static Block::CoinbaseParams makeParams(size_t tagSize) {
+  Block::CoinbaseParams params;
+  params.height = 840000;
+  params.tag.assign(tagSize, 0x2f);
+  params.extranonceSize = 8;
+  params.payouts.push_back({312500000, std::vector<uint8_t>(22, 0x14)});
+  params.payouts.push_back({1000, std::vector<uint8_t>(34, 0x20)});
+  return params;
+}
+
+static std::vector<Hash> makeWtxids(uint8_t seed) {
+  std::vector<Hash> wtxids(3);
+  for (size_t i = 0; i < wtxids.size(); ++i) {
+    wtxids[i].fill(static_cast<uint8_t>(seed + i));
+  }
+  return wtxids;
+}
+
+// Test BIP34 height pushes: opcodes, minimal bytes and the sign byte
+TEST(CoinbaseTEST, EncodeHeight) {
+  using Block::CoinbaseBuilder;
+  EXPECT_EQ(CoinbaseBuilder::encodeHeight(0), (std::vector<uint8_t>{0x00}));
+  EXPECT_EQ(CoinbaseBuilder::encodeHeight(1), (std::vector<uint8_t>{0x51}));
+  EXPECT_EQ(CoinbaseBuilder::encodeHeight(16), (std::vector<uint8_t>{0x60}));
+  EXPECT_EQ(CoinbaseBuilder::encodeHeight(17),
+            (std::vector<uint8_t>{0x01, 0x11}));
+  EXPECT_EQ(CoinbaseBuilder::encodeHeight(128),
+            (std::vector<uint8_t>{0x02, 0x80, 0x00}));
+  EXPECT_EQ(CoinbaseBuilder::encodeHeight(500000),
+            (std::vector<uint8_t>{0x03, 0x20, 0xa1, 0x07}));
+  EXPECT_EQ(CoinbaseBuilder::encodeHeight(8388608),
+            (std::vector<uint8_t>{0x04, 0x00, 0x00, 0x80, 0x00}));
+}
+
+// Test the layout and that midstate txids match a full parse, for prefixes
+// shorter and longer than one SHA-256 block
+TEST(CoinbaseTEST, TxidMatchesParse) {
+  for (size_t tag_size : {size_t{0}, size_t{30}, size_t{80}}) {
+    const Block::CoinbaseBuilder builder(makeParams(tag_size));
+    EXPECT_EQ(builder.getMidstateSize() % 64, 0u);
+    EXPECT_LE(builder.getMidstateSize(), builder.getPrefix().size());
+    EXPECT_FALSE(builder.hasWitnessCommitment());
+
+    for (uint8_t n = 0; n < 4; ++n) {
+      const std::vector<uint8_t> extranonce(8, n);
+      const std::vector<uint8_t> bytes = builder.serialize(extranonce);
+      EXPECT_EQ(bytes.size(), builder.getPrefix().size() + 8 +
+                                  builder.getSuffix().size());
+
+      Block::Transaction tx;
+      size_t offset = 0;
+      ASSERT_TRUE(Block::parseTransaction(bytes, offset, tx));
+      EXPECT_EQ(builder.computeTxid(extranonce), tx.txid);
+
+      ASSERT_EQ(tx.inputs.size(), 1u);
+      const std::vector<uint8_t> height =
+          Block::CoinbaseBuilder::encodeHeight(840000);
+      EXPECT_TRUE(std::equal(height.begin(), height.end(),
+                             tx.inputs[0].scriptSig.begin()));
+      EXPECT_TRUE(std::equal(extranonce.begin(), extranonce.end(),
+                             tx.inputs[0].scriptSig.end() - 8));
+      ASSERT_EQ(tx.outputs.size(), 2u);
+      EXPECT_EQ(tx.outputs[0].value, 312500000);
+      EXPECT_EQ(tx.outputs[1].scriptPubKey.size(), 34u);
+    }
+  }
+}
+
+// Test the witness commitment output, the segwit serialization and swapping
+// in a new commitment
+TEST(CoinbaseTEST, WitnessCommitment) {
+  Block::WitnessCommitment commitment;
+  commitment.update(makeWtxids(1));
+  Block::CoinbaseBuilder builder(makeParams(20), &commitment);
+  EXPECT_TRUE(builder.hasWitnessCommitment());
+
+  const std::vector<uint8_t> extranonce(8, 0xab);
+  const std::vector<uint8_t> full = builder.serialize(extranonce);
+  Block::Transaction tx;
+  size_t offset = 0;
+  ASSERT_TRUE(Block::parseTransaction(full, offset, tx));
+  EXPECT_TRUE(tx.hasWitness());
+  EXPECT_EQ(builder.computeTxid(extranonce), tx.txid);
+  ASSERT_EQ(tx.outputs.size(), 3u);
+  EXPECT_TRUE(std::equal(tx.outputs[2].scriptPubKey.begin(),
+                         tx.outputs[2].scriptPubKey.end(),
+                         commitment.getScript().begin()));
+  EXPECT_EQ(tx.inputs[0].witness.size(), 1u + 1u + 32u);
+  EXPECT_EQ(Block::WitnessCommitment::find(full).has_value(), true);
+
+  // A new transaction set changes only the commitment bytes
+  const Hash before = builder.computeTxid(extranonce);
+  commitment.update(makeWtxids(9));
+  builder.setWitnessCommitment(commitment);
+  const std::vector<uint8_t> legacy = builder.serialize(extranonce, false);
+  offset = 0;
+  ASSERT_TRUE(Block::parseTransaction(legacy, offset, tx));
+  EXPECT_FALSE(tx.hasWitness());
+  EXPECT_EQ(builder.computeTxid(extranonce), tx.txid);
+  EXPECT_NE(builder.computeTxid(extranonce), before);
+  EXPECT_TRUE(std::equal(tx.outputs[2].scriptPubKey.begin(),
+                         tx.outputs[2].scriptPubKey.end(),
+                         commitment.getScript().begin()));
+}
+
+// Test argument checks
+TEST(CoinbaseTEST, RejectsInvalid) {
+  EXPECT_THROW(Block::CoinbaseBuilder(makeParams(100)), std::invalid_argument);
+
+  Block::CoinbaseParams params = makeParams(0);
+  params.payouts[0].value = -1;
+  EXPECT_THROW(Block::CoinbaseBuilder{params}, std::invalid_argument);
+
+  Block::CoinbaseBuilder builder(makeParams(0));
+  EXPECT_THROW(builder.computeTxid(std::vector<uint8_t>(4)),
+               std::invalid_argument);
+  EXPECT_THROW(builder.setWitnessCommitment(Block::WitnessCommitment()),
+               std::invalid_argument);
+}
@@ -0,0 +1,156 @@
+// system includes
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+// Google Test includes
+#include <gtest/gtest.h>
+
+// project includes
+#include "block/difficulty.h"
+#include "block/packedHeader.h"
+#include "types/uint256.h"
+
+// Headers with only the timestamp and bits filled in
+static std::vector<uint8_t> makeHeaders(const std::vector<uint32_t> &times,
+                                        const std::vector<uint32_t> &bits) {
+  std::vector<uint8_t> buffer;
+  for (size_t i = 0; i < times.size(); ++i) {
+    Block::PackedHeader header;
+    header.setTimestamp(times[i]);
+    header.setBits(bits[i]);
+    buffer.insert(buffer.end(), header.bytes().begin(), header.bytes().end());
+  }
+  return buffer;
+}
+
+// Vectors from Bitcoin Core's pow_tests
+TEST(DifficultyTEST, RetargetMainnetVectors) {
+  const Block::ConsensusParams params = Block::ConsensusParams::mainnet();
+  EXPECT_EQ(params.getAdjustmentInterval(), 2016);
+
+  // Regular adjustment
+  EXPECT_EQ(Block::calculateNextWorkRequired(0x1d00ffff, 1261130161,
+                                             1262152739, params),
+            0x1d00d86au);
+  // Capped at the proof-of-work limit
+  EXPECT_EQ(Block::calculateNextWorkRequired(0x1d00ffff, 1231006505,
+                                             1233061996, params),
+            0x1d00ffffu);
+  // Timespan clamped to a quarter
+  EXPECT_EQ(Block::calculateNextWorkRequired(0x1c05a3f4, 1279008237,
+                                             1279297671, params),
+            0x1c0168fdu);
+  // Timespan clamped to four times
+  EXPECT_EQ(Block::calculateNextWorkRequired(0x1c387f6f, 1263163443,
+                                             1269211443, params),
+            0x1d00e1fdu);
+}
+
+TEST(DifficultyTEST, RegtestKeepsBits) {
+  const Block::ConsensusParams params = Block::ConsensusParams::regtest();
+  EXPECT_EQ(Block::calculateNextWorkRequired(0x207fffff, 0, 1, params),
+            0x207fffffu);
+}
+
+TEST(DifficultyTEST, BlockProof) {
+  // Genesis difficulty: chainwork of the genesis block is 0x100010001
+  EXPECT_EQ(Block::getBlockProof(uint256().SetCompact(0x1d00ffff)),
+            uint256(0x100010001));
+  // A target of 2^255 - 1 needs two hashes on average
+  EXPECT_EQ(Block::getBlockProof(~uint256() >> 1), uint256(2));
+  // The maximum target needs one
+  EXPECT_EQ(Block::getBlockProof(~uint256()), uint256(1));
+}
+
+// Test Stratum share targets against the difficulty-1 target
+TEST(DifficultyTEST, ShareTarget) {
+  const uint256 diff1(
+      "00000000ffff0000000000000000000000000000000000000000000000000000");
+  EXPECT_EQ(Block::getShareTarget(1), diff1);
+  EXPECT_EQ(Block::getShareTarget(65536), diff1 >> 16);
+  EXPECT_EQ(Block::getShareTarget(0.5), diff1 << 1);
+  EXPECT_EQ(Block::getShareTarget(3), diff1 / 3);
+  // Regtest pools hand out tiny difficulties
+  EXPECT_EQ(Block::getShareTarget(1.0 / 65536), diff1 << 16);
+  EXPECT_EQ(Block::getShareTarget(1e-30), ~uint256());
+  EXPECT_EQ(Block::getShareTarget(1e80), uint256());
+  EXPECT_THROW(Block::getShareTarget(0), std::invalid_argument);
+}
+
+TEST(DifficultyTEST, TargetCache) {
+  Block::CompactTargetCache cache;
+  const auto &entry = cache.lookup(0x1d00ffff);
+  EXPECT_TRUE(entry.valid);
+  EXPECT_EQ(entry.target, uint256().SetCompact(0x1d00ffff));
+  EXPECT_EQ(entry.work, uint256(0x100010001));
+  EXPECT_EQ(cache.getMisses(), 1);
+
+  cache.lookup(0x1d00ffff);
+  EXPECT_EQ(cache.getHits(), 1);
+
+  // Negative and zero targets carry no work
+  EXPECT_FALSE(cache.lookup(0x04923456).valid);
+  EXPECT_FALSE(cache.lookup(0x00000000).valid);
+  EXPECT_EQ(cache.lookup(0x00000000).work, uint256());
+}
+
+TEST(DifficultyTEST, ChainWorkPrefix) {
+  const std::vector<uint8_t> headers = makeHeaders(
+      {1, 2, 3, 4, 5}, {0x1d00ffff, 0x1d00ffff, 0x1c05a3f4, 0x1c05a3f4,
+                        0x1d00ffff});
+  std::vector<uint256> chain_work(5);
+  Block::CompactTargetCache cache;
+  const uint256 base(1000);
+  Block::computeChainWork(headers, base, chain_work, cache);
+
+  const uint256 easy = Block::getBlockProof(uint256().SetCompact(0x1d00ffff));
+  const uint256 hard = Block::getBlockProof(uint256().SetCompact(0x1c05a3f4));
+  EXPECT_EQ(chain_work[0], base + easy);
+  EXPECT_EQ(chain_work[1], base + easy + easy);
+  EXPECT_EQ(chain_work[3], base + easy + easy + hard + hard);
+  EXPECT_EQ(chain_work[4], chain_work[3] + easy);
+
+  // Work between two headers is a difference of two lookups
+  EXPECT_EQ(chain_work[3] - chain_work[1], hard + hard);
+  // Three decodes for five headers
+  EXPECT_EQ(cache.getMisses() + cache.getHits(), 3);
+}
+
+TEST(DifficultyTEST, FindBadTransition) {
+  // Four-block windows of 40 seconds
+  Block::ConsensusParams params = Block::ConsensusParams::mainnet();
+  params.powTargetTimespan = 40;
+  params.powTargetSpacing = 10;
+  ASSERT_EQ(params.getAdjustmentInterval(), 4);
+
+  // Heights 0..8; the window 0..3 took 80 seconds, so height 4 doubles the
+  // target
+  const uint32_t start = 0x1c05a3f4;
+  const uint32_t doubled =
+      Block::calculateNextWorkRequired(start, 0, 80, params);
+  ASSERT_NE(doubled, start);
+  std::vector<uint32_t> times = {0, 20, 40, 80, 100, 110, 120, 130, 140};
+  std::vector<uint32_t> bits = {start,   start,   start,   start,  doubled,
+                                doubled, doubled, doubled, 0};
+  // Window 4..7 took exactly 40 seconds: unchanged
+  bits[8] = Block::calculateNextWorkRequired(doubled, 100, 130, params);
+  EXPECT_EQ(Block::findBadTransition(makeHeaders(times, bits), 0, params), 9);
+
+  // Bits changing inside a window
+  std::vector<uint32_t> bad = bits;
+  bad[6] = start;
+  EXPECT_EQ(Block::findBadTransition(makeHeaders(times, bad), 0, params), 6);
+
+  // Boundary without the expected retarget
+  bad = bits;
+  for (size_t i = 4; i < 8; ++i) {
+    bad[i] = start;
+  }
+  EXPECT_EQ(Block::findBadTransition(makeHeaders(times, bad), 0, params), 4);
+
+  // Starting mid-window, the first boundary's window is not in the batch
+  std::vector<uint8_t> shifted = makeHeaders(times, bits);
+  shifted.erase(shifted.begin(), shifted.begin() + 2 * 80);
+  EXPECT_EQ(Block::findBadTransition(shifted, 2, params), 7);
+}
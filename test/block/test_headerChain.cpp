@@ -0,0 +1,157 @@
+// system includes
+#include <cstring>
+#include <vector>
+
+// Google Test includes
+#include <gtest/gtest.h>
+
+// project includes
+#include "block/blockHeader.h"
+#include "block/headerChain.h"
+#include "block/packedHeader.h"
+#include "types/types.h"
+
+// Regtest difficulty: about one hash in two meets the target
+static constexpr uint32_t EASY_BITS = 0x207fffff;
+
+// Mine a linked chain of headers into one contiguous buffer
+static std::vector<uint8_t> mineChain(size_t count, Hash &tip) {
+  std::vector<uint8_t> chain;
+  chain.reserve(count * Block::PackedHeader::SIZE);
+  Hash prev{};
+  for (size_t i = 0; i < count; ++i) {
+    Block::BlockHeader header;
+    header.setVersion(0x20000000);
+    header.setPrevBlockHash(prev);
+    Hash merkle{};
+    merkle[0] = static_cast<unsigned char>(i);
+    merkle[1] = static_cast<unsigned char>(i >> 8);
+    header.setMerkleRoot(merkle);
+    header.setTimestamp(1700000000 + static_cast<uint32_t>(i) * 600);
+    header.setBits(EASY_BITS);
+    EXPECT_TRUE(header.calculateNonce(1000));
+    prev = header.calculateBlockHash();
+    const auto bytes = header.getPackedHeader().bytes();
+    chain.insert(chain.end(), bytes.begin(), bytes.end());
+  }
+  tip = prev;
+  return chain;
+}
+
+// Shared fixture: mining a few thousand headers once is enough
+class HeaderChainTEST : public ::testing::Test {
+protected:
+  static void SetUpTestSuite() { sChain = mineChain(3000, sTip); }
+
+  // Copy of the chain with a header field overwritten
+  static std::vector<uint8_t> corrupt(size_t index, size_t offset,
+                                      uint8_t value) {
+    std::vector<uint8_t> chain = sChain;
+    chain[index * Block::PackedHeader::SIZE + offset] = value;
+    return chain;
+  }
+
+  static std::vector<uint8_t> sChain;
+  static Hash sTip;
+};
+
+std::vector<uint8_t> HeaderChainTEST::sChain;
+Hash HeaderChainTEST::sTip;
+
+TEST_F(HeaderChainTEST, ValidChain) {
+  for (unsigned int threads : {1u, 2u, 7u}) {
+    const Block::HeaderChainValidator validator(threads);
+    const Block::ChainValidation result = validator.validate(sChain, Hash{});
+    EXPECT_EQ(result.error, Block::ChainError::None) << threads;
+    EXPECT_EQ(result.firstFailure, 3000) << threads;
+    EXPECT_EQ(result.tipHash, sTip) << threads;
+  }
+}
+
+TEST_F(HeaderChainTEST, EmptyChain) {
+  Hash prev{};
+  prev[0] = 1;
+  const Block::ChainValidation result =
+      Block::HeaderChainValidator(4).validate({}, prev);
+  EXPECT_EQ(result.error, Block::ChainError::None);
+  EXPECT_EQ(result.firstFailure, 0);
+  EXPECT_EQ(result.tipHash, prev);
+}
+
+TEST_F(HeaderChainTEST, WrongStartingPrevHash) {
+  Hash prev{};
+  prev[31] = 1;
+  const Block::ChainValidation result =
+      Block::HeaderChainValidator(4).validate(sChain, prev);
+  EXPECT_EQ(result.error, Block::ChainError::BrokenLinkage);
+  EXPECT_EQ(result.firstFailure, 0);
+}
+
+TEST_F(HeaderChainTEST, BrokenLinkage) {
+  // First header of the second batch, where thread ranges often meet
+  const std::vector<uint8_t> chain =
+      corrupt(1024, Block::PackedHeader::PREV_BLOCK_HASH_OFFSET + 5, 0xAA);
+  for (unsigned int threads : {1u, 3u}) {
+    const Block::ChainValidation result =
+        Block::HeaderChainValidator(threads).validate(chain, Hash{});
+    EXPECT_EQ(result.error, Block::ChainError::BrokenLinkage) << threads;
+    EXPECT_EQ(result.firstFailure, 1024) << threads;
+  }
+}
+
+TEST_F(HeaderChainTEST, HighHash) {
+  // Bump a nonce until the hash misses the target, and relink the
+  // successor so only the proof of work is wrong
+  std::vector<uint8_t> chain = sChain;
+  const size_t index = 1500;
+  uint8_t *raw = chain.data() + index * Block::PackedHeader::SIZE;
+  Block::BlockHeader header(Block::PackedHeader(
+      std::span<const uint8_t, Block::PackedHeader::SIZE>(
+          raw, Block::PackedHeader::SIZE)));
+  uint32_t nonce = header.getNonce();
+  do {
+    header.setNonce(++nonce);
+  } while (MeetsTarget(header.calculateBlockHash(),
+                       uint256().SetCompact(EASY_BITS)));
+  std::memcpy(raw, header.getPackedHeader().data(), Block::PackedHeader::SIZE);
+  const Hash hash = header.calculateBlockHash();
+  std::memcpy(raw + Block::PackedHeader::SIZE +
+                  Block::PackedHeader::PREV_BLOCK_HASH_OFFSET,
+              hash.data(), hash.size());
+
+  const Block::ChainValidation result =
+      Block::HeaderChainValidator(4).validate(chain, Hash{});
+  EXPECT_EQ(result.error, Block::ChainError::HighHash);
+  EXPECT_EQ(result.firstFailure, index);
+}
+
+TEST_F(HeaderChainTEST, InvalidBits) {
+  // Sign bit set in the compact target
+  const std::vector<uint8_t> chain =
+      corrupt(10, Block::PackedHeader::BITS_OFFSET + 2, 0x80);
+  const Block::ChainValidation result =
+      Block::HeaderChainValidator(2).validate(chain, Hash{});
+  EXPECT_EQ(result.firstFailure, 10);
+  EXPECT_EQ(result.error, Block::ChainError::InvalidBits);
+}
+
+TEST_F(HeaderChainTEST, ReportsLowestFailure) {
+  // Failures in several thread ranges: the lowest index wins
+  std::vector<uint8_t> chain = sChain;
+  for (size_t index : {2900, 1200, 2100}) {
+    chain[index * Block::PackedHeader::SIZE +
+          Block::PackedHeader::PREV_BLOCK_HASH_OFFSET] ^= 1;
+  }
+  const Block::ChainValidation result =
+      Block::HeaderChainValidator(4).validate(chain, Hash{});
+  EXPECT_EQ(result.error, Block::ChainError::BrokenLinkage);
+  EXPECT_EQ(result.firstFailure, 1200);
+}
+
+TEST_F(HeaderChainTEST, Truncated) {
+  std::vector<uint8_t> chain(sChain.begin(), sChain.begin() + 10 * 80 + 40);
+  const Block::ChainValidation result =
+      Block::HeaderChainValidator(2).validate(chain, Hash{});
+  EXPECT_EQ(result.error, Block::ChainError::Truncated);
+  EXPECT_EQ(result.firstFailure, 10);
+}
@@ -0,0 +1,169 @@
+// system includes
+#include <cstdint>
+#include <filesystem>
+#include <fstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Google Test includes
+#include <gtest/gtest.h>
+
+// project includes
+#include "block/blockHeader.h"
+#include "block/difficulty.h"
+#include "block/headerStore.h"
+#include "block/headerView.h"
+#include "block/packedHeader.h"
+#include "types/types.h"
+#include "types/uint256.h"
+
+// Store file under the temp directory, removed afterwards
+struct TempStore {
+  explicit TempStore(const std::string &name)
+      : path((std::filesystem::temp_directory_path() / name).string()) {
+    std::filesystem::remove(path);
+  }
+  ~TempStore() { std::filesystem::remove(path); }
+  std::string path;
+};
+
+// Distinct headers; the store does not validate, so no mining is needed
+static std::vector<uint8_t> makeHeaders(size_t first, size_t count) {
+  std::vector<uint8_t> buffer;
+  for (size_t i = first; i < first + count; ++i) {
+    Block::PackedHeader header;
+    header.setVersion(0x20000000 | static_cast<uint32_t>(i & 0xff));
+    Hash merkle{};
+    merkle[0] = static_cast<unsigned char>(i);
+    merkle[1] = static_cast<unsigned char>(i >> 8);
+    header.setMerkleRoot(merkle);
+    header.setTimestamp(1700000000 + static_cast<uint32_t>(i) * 600);
+    header.setBits(i < 500 ? 0x1d00ffff : 0x1c05a3f4);
+    header.setNonce(static_cast<uint32_t>(i * 7919));
+    buffer.insert(buffer.end(), header.bytes().begin(), header.bytes().end());
+  }
+  return buffer;
+}
+
+// Check every column against the records
+static void expectConsistent(const Block::HeaderStore &store,
+                             const std::vector<uint8_t> &expected) {
+  ASSERT_EQ(store.size() * Block::PackedHeader::SIZE, expected.size());
+  EXPECT_TRUE(std::equal(store.getRecords().begin(), store.getRecords().end(),
+                         expected.begin()));
+
+  std::vector<uint256> chain_work(store.size());
+  Block::CompactTargetCache cache;
+  Block::computeChainWork(expected, uint256(), chain_work, cache);
+
+  for (size_t i = 0; i < store.size(); ++i) {
+    const Block::BlockHeaderView view = store.getHeader(i);
+    EXPECT_EQ(store.getBits()[i], view.getBits());
+    EXPECT_EQ(store.getTimestamps()[i], view.getTimestamp());
+    EXPECT_EQ(store.getHashes()[i],
+              view.toBlockHeader().calculateBlockHash());
+    EXPECT_EQ(store.getChainWork(i), chain_work[i]);
+  }
+}
+
+TEST(HeaderStoreTEST, HeaderView) {
+  const std::vector<uint8_t> bytes = makeHeaders(42, 1);
+  const Block::BlockHeaderView view(
+      std::span<const uint8_t, Block::PackedHeader::SIZE>(bytes.data(), 80));
+  EXPECT_EQ(view.data(), bytes.data());
+
+  const Block::BlockHeader header = view.toBlockHeader();
+  EXPECT_EQ(view.getVersion(), header.getVersion());
+  EXPECT_EQ(view.getPrevBlockHash(), header.getPrevBlockHash());
+  EXPECT_EQ(view.getMerkleRoot(), header.getMerkleRoot());
+  EXPECT_EQ(view.getTimestamp(), header.getTimestamp());
+  EXPECT_EQ(view.getBits(), header.getBits());
+  EXPECT_EQ(view.getNonce(), header.getNonce());
+  EXPECT_EQ(view.calculateBlockHash(), header.calculateBlockHash());
+}
+
+TEST(HeaderStoreTEST, AppendAndGrow) {
+  TempStore file("hfm_header_store_grow");
+  Block::HeaderStore store(file.path);
+  EXPECT_EQ(store.size(), 0);
+  EXPECT_EQ(store.capacity(), 64);
+
+  std::vector<uint8_t> all;
+  for (size_t first = 0; first < 1000; first += 37) {
+    const std::vector<uint8_t> chunk = makeHeaders(first, 37);
+    store.append(chunk);
+    all.insert(all.end(), chunk.begin(), chunk.end());
+  }
+  EXPECT_EQ(store.size(), 1036);
+  EXPECT_EQ(store.capacity(), 2048);
+  expectConsistent(store, all);
+
+  // Appending a BlockHeader goes through its packed bytes
+  Block::BlockHeader header = store.getHeader(3).toBlockHeader();
+  header.setNonce(12345);
+  store.append(header);
+  EXPECT_EQ(store.getHeader(1036).getNonce(), 12345);
+}
+
+TEST(HeaderStoreTEST, ReopenWithoutReparse) {
+  TempStore file("hfm_header_store_reopen");
+  const std::vector<uint8_t> headers = makeHeaders(0, 700);
+  {
+    Block::HeaderStore store(file.path);
+    store.append(headers);
+  }
+
+  Block::HeaderStore store(file.path);
+  EXPECT_EQ(store.size(), 700);
+  expectConsistent(store, headers);
+
+  // And keeps growing after reopening
+  const std::vector<uint8_t> more = makeHeaders(700, 100);
+  store.append(more);
+  std::vector<uint8_t> all = headers;
+  all.insert(all.end(), more.begin(), more.end());
+  expectConsistent(store, all);
+}
+
+TEST(HeaderStoreTEST, RebuildsStaleColumns) {
+  TempStore file("hfm_header_store_stale");
+  const std::vector<uint8_t> headers = makeHeaders(0, 100);
+  size_t bits_offset;
+  {
+    Block::HeaderStore store(file.path);
+    store.append(headers);
+    bits_offset = static_cast<size_t>(
+        reinterpret_cast<const uint8_t *>(store.getBits().data()) -
+        store.getRecords().data()) + 64;
+  }
+
+  // Simulate a crash while the columns moved: stale flag and garbage
+  {
+    std::fstream stream(file.path,
+                        std::ios::in | std::ios::out | std::ios::binary);
+    stream.seekp(12); // FileHeader::columnsValid
+    const uint32_t stale = 0;
+    stream.write(reinterpret_cast<const char *>(&stale), sizeof(stale));
+    stream.seekp(static_cast<std::streamoff>(bits_offset));
+    stream.write("garbage!", 8);
+  }
+
+  Block::HeaderStore store(file.path);
+  expectConsistent(store, headers);
+}
+
+TEST(HeaderStoreTEST, RejectsInvalidInput) {
+  TempStore file("hfm_header_store_invalid");
+  {
+    std::ofstream stream(file.path, std::ios::binary);
+    stream << std::string(200, 'x');
+  }
+  EXPECT_THROW(Block::HeaderStore store(file.path), std::runtime_error);
+
+  std::filesystem::remove(file.path);
+  Block::HeaderStore store(file.path);
+  const std::vector<uint8_t> partial(79);
+  EXPECT_THROW(store.append(partial), std::invalid_argument);
+  EXPECT_EQ(store.size(), 0);
+}
@@ -0,0 +1,162 @@
+// system includes
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+// Google Test includes
+#include <gtest/gtest.h>
+
+// project includes
+#include "block/merkle.h"
+#include "sha256/sha256.h"
+#include "types/types.h"
+
+// Reference: one pair at a time, duplicating an odd last hash
+static Hash referenceRoot(std::vector<Hash> level) {
+  if (level.empty()) {
+    return Hash{};
+  }
+  while (level.size() > 1) {
+    if (level.size() % 2 == 1) {
+      level.push_back(level.back());
+    }
+    std::vector<Hash> next;
+    for (size_t i = 0; i < level.size(); i += 2) {
+      uint8_t pair[64];
+      std::copy(level[i].begin(), level[i].end(), pair);
+      std::copy(level[i + 1].begin(), level[i + 1].end(), pair + 32);
+      Hash first;
+      Hash second;
+      SHA256::sha256_bytes(pair, sizeof(pair), first.data());
+      SHA256::sha256_bytes(first.data(), first.size(), second.data());
+      next.push_back(second);
+    }
+    level = next;
+  }
+  return level[0];
+}
+
+static std::vector<Hash> makeLeaves(size_t count) {
+  std::vector<Hash> leaves(count);
+  for (size_t i = 0; i < count; ++i) {
+    for (size_t j = 0; j < leaves[i].size(); ++j) {
+      leaves[i][j] = static_cast<uint8_t>(i * 7 + j);
+    }
+  }
+  return leaves;
+}
+
+// Test the batched root against the pairwise reference for many sizes
+TEST(MerkleTEST, MatchesReference) {
+  for (size_t count = 0; count <= 40; ++count) {
+    const std::vector<Hash> leaves = makeLeaves(count);
+    EXPECT_EQ(Block::computeMerkleRoot(leaves), referenceRoot(leaves))
+        << count << " leaves";
+  }
+  const std::vector<Hash> leaves = makeLeaves(2501);
+  EXPECT_EQ(Block::computeMerkleRoot(leaves), referenceRoot(leaves));
+}
+
+// Test that a single leaf is its own root
+TEST(MerkleTEST, SingleLeaf) {
+  const std::vector<Hash> leaves = makeLeaves(1);
+  EXPECT_EQ(Block::computeMerkleRoot(leaves), leaves[0]);
+}
+
+// Test the incremental tree against full computations through a sequence of
+// edits that crosses several power-of-two sizes
+TEST(MerkleTreeTEST, EditsMatchFullComputation) {
+  std::vector<Hash> leaves = makeLeaves(5);
+  Block::MerkleTree tree(leaves);
+  EXPECT_EQ(tree.getRoot(), Block::computeMerkleRoot(leaves));
+
+  std::mt19937 rng(3);
+  const std::vector<Hash> pool = makeLeaves(300);
+  for (int step = 0; step < 400; ++step) {
+    const Hash &leaf = pool[rng() % pool.size()];
+    const size_t at = leaves.empty() ? 0 : rng() % leaves.size();
+    switch (leaves.empty() ? 2 : rng() % 6) {
+    case 0:
+      leaves[at] = leaf;
+      tree.set(at, leaf);
+      break;
+    case 1: {
+      const size_t other = rng() % leaves.size();
+      std::swap(leaves[at], leaves[other]);
+      tree.swap(at, other);
+      break;
+    }
+    case 2:
+    case 3:
+      leaves.push_back(leaf);
+      tree.push_back(leaf);
+      break;
+    case 4:
+      leaves.pop_back();
+      tree.pop_back();
+      break;
+    case 5:
+      if (rng() % 2 == 0) {
+        leaves.insert(leaves.begin() + at, leaf);
+        tree.insert(at, leaf);
+      } else {
+        leaves.erase(leaves.begin() + at);
+        tree.erase(at);
+      }
+      break;
+    }
+    ASSERT_EQ(tree.size(), leaves.size());
+    ASSERT_EQ(tree.getRoot(), Block::computeMerkleRoot(leaves))
+        << "step " << step << ", " << leaves.size() << " leaves";
+  }
+
+  tree.assign(makeLeaves(0));
+  EXPECT_EQ(tree.getRoot(), Hash{});
+  EXPECT_THROW(tree.pop_back(), std::out_of_range);
+  EXPECT_THROW(tree.set(0, pool[0]), std::out_of_range);
+}
+
+// Test that a few changed leaves cost only their paths
+TEST(MerkleTreeTEST, RehashesOnlyChangedPaths) {
+  std::vector<Hash> leaves = makeLeaves(4000);
+  Block::MerkleTree tree(leaves);
+  tree.getRoot();
+  // 2000 + 1000 + 500 + 250 + 125 + 63 + 32 + 16 + 8 + 4 + 2 + 1
+  EXPECT_EQ(tree.getHashCount(), 4001u);
+
+  const std::vector<Hash> replacements = makeLeaves(4003);
+  for (const size_t index : {17u, 18u, 2999u}) {
+    leaves[index] = replacements[4000 + index % 3];
+    tree.set(index, leaves[index]);
+  }
+  EXPECT_EQ(tree.getRoot(), Block::computeMerkleRoot(leaves));
+  // 12 levels above the leaves: 17 and 18 share all but their parents, and
+  // 2999 shares only the root with them
+  EXPECT_EQ(tree.getHashCount(), (12u + 1u) + 11u);
+
+  tree.getRoot();
+  EXPECT_EQ(tree.getHashCount(), 0u);
+}
+
+// Test that branches lead from their leaf to the root
+TEST(MerkleTreeTEST, Branches) {
+  for (size_t count = 1; count <= 20; ++count) {
+    Block::MerkleTree tree(makeLeaves(count));
+    for (size_t index = 0; index < count; ++index) {
+      Hash node = tree.getLeaf(index);
+      size_t position = index;
+      for (const Hash &sibling : tree.getBranch(index)) {
+        uint8_t pair[64];
+        const bool right = position % 2 == 1;
+        std::copy(sibling.begin(), sibling.end(), pair + (right ? 0 : 32));
+        std::copy(node.begin(), node.end(), pair + (right ? 32 : 0));
+        Hash first;
+        SHA256::sha256_bytes(pair, sizeof(pair), first.data());
+        SHA256::sha256_bytes(first.data(), first.size(), node.data());
+        position /= 2;
+      }
+      EXPECT_EQ(node, tree.getRoot()) << count << " leaves, leaf " << index;
+    }
+  }
+}
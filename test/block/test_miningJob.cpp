@@ -0,0 +1,74 @@
+// system includes
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+// Google Test includes
+#include <gtest/gtest.h>
+
+// project includes
+#include "block/coinbase.h"
+#include "block/merkle.h"
+#include "block/miningJob.h"
+#include "block/packedHeader.h"
+#include "types/types.h"
+
+// Test that the job reproduces the coinbase txid and Merkle root of the full
+// computation, with the midstate boundary falling before, inside and after
+// extranonce1
+TEST(MiningJobTEST, MatchesFullComputation) {
+  std::vector<Hash> leaves(7);
+  for (size_t i = 1; i < leaves.size(); ++i) {
+    leaves[i].fill(static_cast<uint8_t>(i));
+  }
+  Block::PackedHeader header;
+  header.setVersion(0x20000000);
+  header.setTimestamp(1700000000);
+  header.setBits(0x207fffff);
+  header.setNonce(99);
+
+  for (size_t tag = 0; tag < 80; tag += 3) {
+    Block::CoinbaseParams params;
+    params.height = 840000;
+    params.tag.assign(tag, 0x2f);
+    params.extranonceSize = 12; // 4 from the pool, 8 rolled
+    params.payouts.push_back({312500000, std::vector<uint8_t>(22, 0x14)});
+    const Block::CoinbaseBuilder builder(params);
+    const std::vector<uint8_t> extranonce = {1, 2, 3, 4, 5, 6,
+                                             7, 8, 9, 10, 11, 12};
+
+    leaves[0] = builder.computeTxid(extranonce);
+    Block::MerkleTree tree(leaves);
+    const std::vector<Hash> branch = tree.getBranch(0);
+
+    Block::MiningJob job;
+    job.set(builder.getPrefix(),
+            std::span<const uint8_t>(extranonce).first(4), 8,
+            builder.getSuffix(), branch, header);
+    const std::span<const uint8_t> extranonce2 =
+        std::span<const uint8_t>(extranonce).subspan(4);
+    EXPECT_EQ(job.computeCoinbaseTxid(extranonce2), leaves[0]) << tag;
+    EXPECT_EQ(job.computeMerkleRoot(extranonce2), tree.getRoot()) << tag;
+
+    const Block::PackedHeader made = job.makeHeader(extranonce2);
+    EXPECT_EQ(made.getMerkleRoot(), tree.getRoot());
+    EXPECT_EQ(made.getVersion(), 0x20000000u);
+    EXPECT_EQ(made.getBits(), 0x207fffffu);
+    EXPECT_EQ(made.getNonce(), 0u);
+  }
+}
+
+// Test a job without transactions and the extranonce2 size check
+TEST(MiningJobTEST, CoinbaseOnly) {
+  Block::MiningJob job;
+  const std::vector<uint8_t> coinbase1(41, 0x01);
+  const std::vector<uint8_t> coinbase2(60, 0x02);
+  job.set(coinbase1, {}, 4, coinbase2, {}, Block::PackedHeader());
+
+  const std::vector<uint8_t> extranonce2 = {0, 0, 0, 1};
+  EXPECT_EQ(job.computeMerkleRoot(extranonce2),
+            job.computeCoinbaseTxid(extranonce2));
+  EXPECT_TRUE(job.getMerkleBranch().empty());
+  EXPECT_THROW(job.computeMerkleRoot(std::vector<uint8_t>(5)),
+               std::invalid_argument);
+}
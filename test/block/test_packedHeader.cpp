@@ -0,0 +1,114 @@
+// system includes
+#include <algorithm>
+#include <cstdint>
+#include <string>
+
+// Google Test includes
+#include <gtest/gtest.h>
+
+// project includes
+#include "block/blockHeader.h"
+#include "block/packedHeader.h"
+#include "sha256/sha256.h"
+#include "types/types.h"
+
+// Convert a hash in display (big-endian) hex order to raw byte order
+static Hash displayHexToHash(const std::string &hex) {
+  Hash hash = SHA256::hashStringToArray(hex);
+  std::reverse(hash.begin(), hash.end());
+  return hash;
+}
+
+// Build the Bitcoin mainnet genesis block header
+static Block::BlockHeader genesisHeader() {
+  Block::BlockHeader block;
+  block.setVersion(BLOCK_VERSION_1);
+  block.setPrevBlockHash(Hash{});
+  block.setMerkleRoot(displayHexToHash(
+      "4a5e1e4baab89f3a32518a88c31bc87f618f76673e2cc77ab2127b7afdeda33b"));
+  block.setTimestamp(1231006505);
+  block.setBits(0x1d00ffff);
+  block.setNonce(2083236893);
+  return block;
+}
+
+// Test the buffer is cache-line aligned
+TEST(PackedHeaderTEST, Alignment) {
+  Block::PackedHeader header;
+  EXPECT_EQ(reinterpret_cast<uintptr_t>(header.data()) % 64, 0);
+  EXPECT_EQ(alignof(Block::PackedHeader), 64);
+}
+
+// Test setters write through to the wire-format offsets
+TEST(PackedHeaderTEST, SettersWriteThrough) {
+  Block::PackedHeader header;
+  Hash prev_hash, merkle_hash;
+  for (size_t i = 0; i < 32; ++i) {
+    prev_hash[i] = static_cast<unsigned char>(i);
+    merkle_hash[i] = static_cast<unsigned char>(255 - i);
+  }
+
+  header.setVersion(0x20000004);
+  header.setPrevBlockHash(prev_hash);
+  header.setMerkleRoot(merkle_hash);
+  header.setTimestamp(0x01020304);
+  header.setBits(0x1d00ffff);
+  header.setNonce(0xDEADBEEF);
+
+  const uint8_t *bytes = header.data();
+  EXPECT_EQ(bytes[0], 0x04);
+  EXPECT_EQ(bytes[3], 0x20);
+  EXPECT_TRUE(std::equal(prev_hash.begin(), prev_hash.end(), bytes + 4));
+  EXPECT_TRUE(std::equal(merkle_hash.begin(), merkle_hash.end(), bytes + 36));
+  EXPECT_EQ(bytes[68], 0x04);
+  EXPECT_EQ(bytes[71], 0x01);
+  EXPECT_EQ(bytes[72], 0xff);
+  EXPECT_EQ(bytes[75], 0x1d);
+  EXPECT_EQ(bytes[76], 0xEF);
+  EXPECT_EQ(bytes[79], 0xDE);
+
+  EXPECT_EQ(header.getVersion(), 0x20000004);
+  EXPECT_EQ(header.getPrevBlockHash(), prev_hash);
+  EXPECT_EQ(header.getMerkleRoot(), merkle_hash);
+  EXPECT_EQ(header.getTimestamp(), 0x01020304);
+  EXPECT_EQ(header.getBits(), 0x1d00ffff);
+  EXPECT_EQ(header.getNonce(), 0xDEADBEEF);
+}
+
+// Test nonce updates only touch the last 4 bytes
+TEST(PackedHeaderTEST, NonceUpdateInPlace) {
+  Block::PackedHeader header;
+  header.setVersion(BLOCK_VERSION_4);
+  header.setTimestamp(1234567890);
+
+  Block::PackedHeader before = header;
+  header.setNonce(0x12345678);
+
+  EXPECT_TRUE(std::equal(before.data(),
+                         before.data() + Block::PackedHeader::NONCE_OFFSET,
+                         header.data()));
+  EXPECT_EQ(header.getNonce(), 0x12345678);
+}
+
+// Test the BlockHeader packs the genesis block to the known hash
+TEST(PackedHeaderTEST, GenesisBlockHash) {
+  Block::BlockHeader block = genesisHeader();
+
+  EXPECT_EQ(block.calculateBlockHash(),
+            displayHexToHash("000000000019d6689c085ae165831e934ff763ae46a2a6c17"
+                             "2b3f1b60a8ce26f"));
+}
+
+// Test round trip through raw wire bytes
+TEST(PackedHeaderTEST, ConstructFromBytes) {
+  Block::BlockHeader genesis = genesisHeader();
+  Block::PackedHeader copy(genesis.getPackedHeader().bytes());
+  Block::BlockHeader block(copy);
+
+  EXPECT_EQ(block.getVersion(), genesis.getVersion());
+  EXPECT_EQ(block.getMerkleRoot(), genesis.getMerkleRoot());
+  EXPECT_EQ(block.getTimestamp(), genesis.getTimestamp());
+  EXPECT_EQ(block.getBits(), genesis.getBits());
+  EXPECT_EQ(block.getNonce(), genesis.getNonce());
+  EXPECT_EQ(block.calculateBlockHash(), genesis.calculateBlockHash());
+}
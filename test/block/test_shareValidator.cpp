@@ -0,0 +1,327 @@
+// system includes
+#include <atomic>
+#include <chrono>
+#include <cmath>
+#include <cstdint>
+#include <stdexcept>
+#include <thread>
+#include <vector>
+
+// Google Test includes
+#include <gtest/gtest.h>
+
+// project includes
+#include "block/miningJob.h"
+#include "block/packedHeader.h"
+#include "block/shareValidator.h"
+#include "sha256/sha256.h"
+#include "types/types.h"
+#include "types/uint256.h"
+
+namespace {
+
+const std::vector<uint8_t> COINBASE1(83, 0x11);
+const std::vector<uint8_t> COINBASE2(70, 0x22);
+const std::chrono::steady_clock::time_point START{};
+constexpr uint32_t JOB_TIME = 1700000000;
+constexpr uint32_t VERSION_MASK = 0x1fffe000;
+
+std::vector<Hash> makeBranch() {
+  std::vector<Hash> branch(3);
+  for (size_t i = 0; i < branch.size(); ++i) {
+    branch[i].fill(static_cast<uint8_t>(0x30 + i));
+  }
+  return branch;
+}
+
+Block::PackedHeader makeJobHeader(uint32_t bits) {
+  Block::PackedHeader header;
+  header.setVersion(0x20000000);
+  Hash prev;
+  prev.fill(0x44);
+  header.setPrevBlockHash(prev);
+  header.setTimestamp(JOB_TIME);
+  header.setBits(bits);
+  return header;
+}
+
+// Settings under which every share meets the share target
+Block::VarDiffConfig easyDifficulty() {
+  Block::VarDiffConfig config;
+  config.initialDifficulty = 1e-12;
+  config.minDifficulty = 1e-12;
+  config.retargetShares = 1000000;
+  return config;
+}
+
+Block::Share makeShare(Block::Worker &worker, uint32_t job, uint8_t tag,
+                       uint32_t nonce) {
+  Block::Share share;
+  share.worker = &worker;
+  share.job = job;
+  share.extranonce2.fill(tag);
+  share.time = JOB_TIME + 10;
+  share.nonce = nonce;
+  return share;
+}
+
+} // namespace
+
+// Test that batched validation hashes the header MiningJob builds, reusing
+// roots across shares and batches
+TEST(ShareValidatorTEST, MatchesMiningJob) {
+  Block::ShareValidator validator;
+  const std::vector<Hash> branch = makeBranch();
+  const Block::PackedHeader job_header = makeJobHeader(0x1d00ffff);
+  const uint32_t job =
+      validator.addJob(COINBASE1, COINBASE2, branch, job_header, VERSION_MASK);
+
+  const uint8_t extranonce1[3][4] = {{1, 2, 3, 4}, {5, 6, 7, 8}, {9, 9, 9, 9}};
+  std::vector<Block::Worker> workers;
+  for (const auto &bytes : extranonce1) {
+    workers.emplace_back(bytes, easyDifficulty(), START);
+  }
+
+  Block::ShareBatch batch(64);
+  std::vector<Block::Share> shares;
+  for (int round = 0; round < 2; ++round) {
+    for (uint32_t i = 0; i < 30; ++i) {
+      Block::Share share =
+          makeShare(workers[i % 3], job, static_cast<uint8_t>(i / 6), i);
+      share.time += round;
+      share.versionBits = (i & 3) << 13;
+      shares.push_back(share);
+      EXPECT_EQ(batch.push(share), i);
+    }
+    EXPECT_EQ(batch.size(), 30u);
+    EXPECT_FALSE(batch.full());
+    const std::span<const Block::ShareResult> results = batch.flush(validator);
+    ASSERT_EQ(results.size(), 30u);
+    EXPECT_EQ(batch.size(), 0u);
+
+    for (size_t i = 0; i < results.size(); ++i) {
+      const Block::Share &share = shares[round * 30 + i];
+      Block::MiningJob expected;
+      expected.set(COINBASE1, share.worker->getExtranonce1(), 8, COINBASE2,
+                   branch, job_header);
+      Block::PackedHeader header = expected.makeHeader(share.extranonce2);
+      header.setVersion(0x20000000 | share.versionBits);
+      header.setTimestamp(share.time);
+      header.setNonce(share.nonce);
+      Hash first;
+      Hash hash;
+      SHA256::SHA256::bytes(header.data(), Block::PackedHeader::SIZE,
+                            first.data());
+      SHA256::SHA256::bytes(first.data(), first.size(), hash.data());
+
+      EXPECT_EQ(results[i].status, Block::ShareStatus::Accepted) << i;
+      EXPECT_EQ(results[i].hash, hash) << i;
+      EXPECT_EQ(results[i].difficulty, 1e-12);
+    }
+  }
+  EXPECT_EQ(workers[0].getAcceptedShares(), 20u);
+  EXPECT_DOUBLE_EQ(workers[0].getAcceptedWork(), 20e-12);
+}
+
+// Test every rejection
+TEST(ShareValidatorTEST, Rejections) {
+  Block::ShareValidator validator;
+  const std::vector<Hash> branch = makeBranch();
+  const uint32_t job = validator.addJob(
+      COINBASE1, COINBASE2, branch, makeJobHeader(0x1d00ffff), VERSION_MASK);
+  const uint8_t extranonce1[4] = {1, 2, 3, 4};
+  Block::Worker worker(extranonce1, easyDifficulty(), START);
+  Block::VarDiffConfig hard;
+  hard.initialDifficulty = 1e15;
+  Block::Worker hard_worker(extranonce1, hard, START);
+  Block::Worker short_worker(std::span<const uint8_t>(extranonce1).first(3),
+                             easyDifficulty(), START);
+
+  Block::ShareBatch batch;
+  batch.push(makeShare(worker, job, 0, 1));
+  batch.push(makeShare(worker, job, 0, 1));
+  batch.push(makeShare(worker, job + 1, 0, 2));
+  Block::Share early = makeShare(worker, job, 0, 3);
+  early.time = JOB_TIME - 1;
+  batch.push(early);
+  Block::Share late = makeShare(worker, job, 0, 4);
+  late.time = JOB_TIME + 7201;
+  batch.push(late);
+  Block::Share rolled = makeShare(worker, job, 0, 5);
+  rolled.versionBits = 1;
+  batch.push(rolled);
+  batch.push(makeShare(short_worker, job, 0, 6));
+  batch.push(makeShare(hard_worker, job, 0, 7));
+
+  const std::span<const Block::ShareResult> results = batch.flush(validator);
+  using Block::ShareStatus;
+  const std::vector<ShareStatus> expected = {
+      ShareStatus::Accepted,   ShareStatus::Duplicate,
+      ShareStatus::UnknownJob, ShareStatus::BadTime,
+      ShareStatus::BadTime,    ShareStatus::BadVersion,
+      ShareStatus::BadExtranonce, ShareStatus::LowDifficulty};
+  ASSERT_EQ(results.size(), expected.size());
+  for (size_t i = 0; i < expected.size(); ++i) {
+    EXPECT_EQ(results[i].status, expected[i]) << i;
+  }
+  EXPECT_EQ(results[1].difficulty, 0);
+  EXPECT_EQ(results[7].difficulty, 0);
+
+  // Seen shares are remembered across batches until a new block, after
+  // which their job is gone
+  batch.push(makeShare(worker, job, 0, 1));
+  EXPECT_EQ(batch.flush(validator)[0].status, ShareStatus::Duplicate);
+  validator.newBlock();
+  batch.push(makeShare(worker, job, 0, 1));
+  EXPECT_EQ(batch.flush(validator)[0].status, ShareStatus::UnknownJob);
+
+  // Evicted jobs are unknown too
+  Block::ValidatorConfig config;
+  config.maxJobs = 2;
+  Block::ShareValidator small(config);
+  const uint32_t first = small.addJob(COINBASE1, COINBASE2, branch,
+                                      makeJobHeader(0x1d00ffff), 0);
+  small.addJob(COINBASE1, COINBASE2, branch, makeJobHeader(0x1d00ffff), 0);
+  small.addJob(COINBASE1, COINBASE2, branch, makeJobHeader(0x1d00ffff), 0);
+  EXPECT_EQ(small.getNextJobId(), 3u);
+  batch.push(makeShare(worker, first, 0, 1));
+  EXPECT_EQ(batch.flush(small)[0].status, ShareStatus::UnknownJob);
+}
+
+// Test that shares meeting the network target are reported as blocks
+TEST(ShareValidatorTEST, Blocks) {
+  Block::ShareValidator validator;
+  const uint32_t job =
+      validator.addJob(COINBASE1, COINBASE2, makeBranch(),
+                       makeJobHeader(0x207fffff), VERSION_MASK);
+  const uint8_t extranonce1[4] = {1, 2, 3, 4};
+  Block::Worker worker(extranonce1, easyDifficulty(), START);
+  Block::ShareBatch batch;
+  for (uint32_t nonce = 0; nonce < 64; ++nonce) {
+    batch.push(makeShare(worker, job, 0, nonce));
+  }
+  const uint256 network = uint256().SetCompact(0x207fffff);
+  int blocks = 0;
+  for (const Block::ShareResult &result : batch.flush(validator)) {
+    const bool block = uint256(result.hash) <= network;
+    EXPECT_EQ(result.status, block ? Block::ShareStatus::Block
+                                   : Block::ShareStatus::Accepted);
+    blocks += block;
+  }
+  EXPECT_GT(blocks, 0);
+  EXPECT_LT(blocks, 64);
+}
+
+// Test variable difficulty: fast shares raise it, slow ones lower it, and
+// shares for older jobs keep the easier target
+TEST(ShareValidatorTEST, VarDiff) {
+  Block::ShareValidator validator;
+  const std::vector<Hash> branch = makeBranch();
+  const uint32_t old_job = validator.addJob(
+      COINBASE1, COINBASE2, branch, makeJobHeader(0x1d00ffff), VERSION_MASK);
+
+  // The easiest difficulty whose target fits, 0xffff << 240: nearly every
+  // share meets it, and a quarter meet four times it
+  const double easiest = std::ldexp(1.0, -32);
+  Block::VarDiffConfig config;
+  config.initialDifficulty = easiest;
+  config.minDifficulty = easiest;
+  config.retargetShares = 4;
+  const uint8_t extranonce1[4] = {1, 2, 3, 4};
+  Block::Worker worker(extranonce1, config, START);
+  EXPECT_FALSE(worker.takeDifficultyChange());
+
+  // Submit shares until one is credited
+  Block::ShareBatch batch;
+  uint32_t nonce = 0;
+  const auto credit = [&](uint32_t job,
+                          std::chrono::steady_clock::time_point now) {
+    for (;;) {
+      batch.push(makeShare(worker, job, 0, nonce++));
+      const Block::ShareResult result = batch.flush(validator, now)[0];
+      if (result.status == Block::ShareStatus::Accepted) {
+        return result.difficulty;
+      }
+      EXPECT_EQ(result.status, Block::ShareStatus::LowDifficulty);
+    }
+  };
+
+  // Four shares at once quadruple it
+  for (int i = 0; i < 4; ++i) {
+    EXPECT_EQ(credit(old_job, START), easiest);
+  }
+  EXPECT_EQ(worker.getDifficulty(), 4 * easiest);
+  EXPECT_TRUE(worker.takeDifficultyChange());
+  EXPECT_FALSE(worker.takeDifficultyChange());
+
+  const uint32_t new_job = validator.addJob(
+      COINBASE1, COINBASE2, branch, makeJobHeader(0x1d00ffff), VERSION_MASK);
+  EXPECT_EQ(credit(old_job, START), easiest);
+  EXPECT_EQ(credit(new_job, START), 4 * easiest);
+
+  // Three shares in ten minutes are far too slow for 10 s a share; a step
+  // is capped at 4x
+  EXPECT_EQ(credit(new_job, START + std::chrono::minutes(10)), 4 * easiest);
+  EXPECT_EQ(worker.getDifficulty(), easiest);
+  EXPECT_TRUE(worker.takeDifficultyChange());
+
+  // Close to the aimed rate it stays put
+  for (int i = 0; i < 4; ++i) {
+    credit(new_job, START + std::chrono::seconds(640));
+  }
+  EXPECT_EQ(worker.getDifficulty(), easiest);
+  EXPECT_FALSE(worker.takeDifficultyChange());
+
+  // Explicit changes are clamped
+  worker.setDifficulty(1e20, validator.getNextJobId());
+  EXPECT_EQ(worker.getDifficulty(), config.maxDifficulty);
+  EXPECT_TRUE(worker.takeDifficultyChange());
+}
+
+// Test that the same shares submitted from several threads are accepted
+// exactly once
+TEST(ShareValidatorTEST, ConcurrentDuplicates) {
+  Block::ShareValidator validator;
+  const uint32_t job =
+      validator.addJob(COINBASE1, COINBASE2, makeBranch(),
+                       makeJobHeader(0x1d00ffff), VERSION_MASK);
+  constexpr uint32_t SHARES = 4000;
+  std::atomic<uint32_t> accepted{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&] {
+      const uint8_t extranonce1[4] = {1, 2, 3, 4};
+      Block::Worker worker(extranonce1, easyDifficulty(), START);
+      Block::ShareBatch batch;
+      uint32_t mine = 0;
+      for (uint32_t nonce = 0; nonce < SHARES; ++nonce) {
+        batch.push(makeShare(worker, job, static_cast<uint8_t>(nonce / 100),
+                             nonce));
+        if (batch.full() || nonce + 1 == SHARES) {
+          for (const Block::ShareResult &result : batch.flush(validator)) {
+            mine += result.status == Block::ShareStatus::Accepted;
+          }
+        }
+      }
+      accepted += mine;
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(accepted.load(), SHARES);
+}
+
+// Test the argument checks
+TEST(ShareValidatorTEST, InvalidArguments) {
+  Block::ValidatorConfig config;
+  config.extranonce2Size = 9;
+  EXPECT_THROW(Block::ShareValidator{config}, std::invalid_argument);
+  config.extranonce2Size = 8;
+  config.maxJobs = 0;
+  EXPECT_THROW(Block::ShareValidator{config}, std::invalid_argument);
+
+  const std::vector<uint8_t> extranonce1(9);
+  EXPECT_THROW(Block::Worker(extranonce1, Block::VarDiffConfig(), START),
+               std::invalid_argument);
+}
@@ -0,0 +1,233 @@
+// system includes
+#include <algorithm>
+#include <cstdint>
+#include <random>
+#include <stdexcept>
+#include <vector>
+
+// Google Test includes
+#include <gtest/gtest.h>
+
+// project includes
+#include "block/templateBuilder.h"
+#include "types/types.h"
+
+static Block::MempoolEntry makeEntry(uint8_t id, int64_t fee,
+                                     uint32_t weight = 1000,
+                                     uint32_t sigops = 4) {
+  Block::MempoolEntry entry;
+  entry.txid.fill(id);
+  entry.wtxid.fill(static_cast<uint8_t>(id ^ 0xff));
+  entry.fee = fee;
+  entry.weight = weight;
+  entry.sigops = sigops;
+  return entry;
+}
+
+using Indexes = std::vector<uint32_t>;
+
+// Test that a high-fee child pulls in its low-fee parent (CPFP), and that
+// the coinbase value adds the fees to the subsidy
+TEST(TemplateBuilderTEST, ChildPaysForParent) {
+  Block::TemplateBuilder builder;
+  const uint32_t parent = builder.addTransaction(makeEntry(1, 100));
+  const uint32_t medium = builder.addTransaction(makeEntry(2, 3000));
+  const uint32_t child = builder.addTransaction(makeEntry(3, 9000), Indexes{0});
+
+  const Block::SelectedTemplate &selected = builder.build(840000);
+  EXPECT_EQ(selected.indexes, (Indexes{parent, child, medium}));
+  ASSERT_EQ(selected.txids.size(), 3u);
+  EXPECT_EQ(selected.txids[0][0], 1);
+  EXPECT_EQ(selected.txids[1][0], 3);
+  EXPECT_EQ(selected.wtxids[2][0], 2 ^ 0xff);
+  EXPECT_EQ(selected.fees, 12100);
+  EXPECT_EQ(selected.coinbaseValue, 312500000 + 12100);
+  EXPECT_EQ(selected.weight, 4000u + 3000u);
+  EXPECT_EQ(selected.sigops, 400u + 12u);
+
+  const Hash coinbase{};
+  const std::vector<Hash> leaves = selected.getMerkleLeaves(coinbase);
+  ASSERT_EQ(leaves.size(), 4u);
+  EXPECT_EQ(leaves[0], coinbase);
+  EXPECT_EQ(leaves[1], selected.txids[0]);
+}
+
+// Test that selecting a shared parent rescores its other children
+TEST(TemplateBuilderTEST, RescoresDescendants) {
+  Block::TemplateBuilder builder;
+  builder.addTransaction(makeEntry(0, 0));
+  builder.addTransaction(makeEntry(1, 10000), Indexes{0}); // 5000 as package
+  builder.addTransaction(makeEntry(2, 4000), Indexes{0});  // 2000 as package
+  builder.addTransaction(makeEntry(3, 3000));
+
+  // After 0 and 1, transaction 2 pays 4000 on its own and beats 3
+  EXPECT_EQ(builder.build(0).indexes, (Indexes{0, 1, 2, 3}));
+}
+
+// Test the weight and sigop limits
+TEST(TemplateBuilderTEST, Limits) {
+  Block::TemplateLimits limits;
+  limits.maxWeight = 10000;
+  limits.coinbaseWeight = 1000;
+  limits.maxSigops = 100;
+  limits.coinbaseSigops = 10;
+  Block::TemplateBuilder builder(limits);
+  builder.addTransaction(makeEntry(0, 60000, 6000));
+  builder.addTransaction(makeEntry(1, 40000, 4000)); // does not fit any more
+  builder.addTransaction(makeEntry(2, 2000, 2000));
+  builder.addTransaction(makeEntry(3, 1500, 500, 90)); // too many sigops
+  builder.addTransaction(makeEntry(4, 500, 500));
+
+  const Block::SelectedTemplate &selected = builder.build(0);
+  EXPECT_EQ(selected.indexes, (Indexes{0, 2, 4}));
+  EXPECT_LT(selected.weight, limits.maxWeight);
+  EXPECT_EQ(selected.coinbaseValue, 5000000000 + 62500);
+}
+
+// Test that a fee bump reorders the next build
+TEST(TemplateBuilderTEST, FeeBump) {
+  Block::TemplateBuilder builder;
+  builder.addTransaction(makeEntry(0, 1000));
+  builder.addTransaction(makeEntry(1, 500), Indexes{0});
+  builder.addTransaction(makeEntry(2, 2000));
+  EXPECT_EQ(builder.build(0).indexes, (Indexes{2, 0, 1}));
+
+  // The child now pays for both
+  builder.setFee(1, 8000);
+  EXPECT_EQ(builder.build(0).indexes, (Indexes{0, 1, 2}));
+  EXPECT_EQ(builder.build(0).fees, 11000);
+
+  EXPECT_THROW(builder.setFee(3, 0), std::out_of_range);
+}
+
+// Test the ancestor limit and the parents-first requirement
+TEST(TemplateBuilderTEST, AncestorLimit) {
+  Block::TemplateLimits limits;
+  limits.maxAncestors = 3;
+  Block::TemplateBuilder builder(limits);
+  builder.addTransaction(makeEntry(0, 1000));
+  for (uint32_t i = 1; i < 6; ++i) {
+    builder.addTransaction(makeEntry(static_cast<uint8_t>(i), 1000),
+                           Indexes{i - 1});
+  }
+  // Transactions 4 and 5 have more than three ancestors
+  EXPECT_EQ(builder.build(0).indexes, (Indexes{0, 1, 2, 3}));
+
+  EXPECT_THROW(builder.addTransaction(makeEntry(9, 1), Indexes{6}),
+               std::invalid_argument);
+  builder.clear();
+  EXPECT_EQ(builder.size(), 0u);
+  EXPECT_TRUE(builder.build(0).indexes.empty());
+}
+
+// Test a mempool large enough to be heapified in batches. Each child pays
+// less than its parent, so everything comes out by its own fee rate.
+TEST(TemplateBuilderTEST, LargeMempool) {
+  Block::TemplateLimits limits;
+  limits.maxWeight = 0xffffffff;
+  limits.maxSigops = 0xffffffff;
+  Block::TemplateBuilder builder(limits);
+  std::mt19937 rng(11);
+  const uint32_t count = 40000;
+  std::vector<int64_t> fees(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    // Distinct fees, told apart by the index in the low digits
+    if (i % 10 == 9) {
+      fees[i] = fees[i - 1] / count / 2 * count + i;
+      builder.addTransaction(makeEntry(0, fees[i]), Indexes{i - 1});
+    } else {
+      fees[i] = static_cast<int64_t>(rng() % 1000000 + 2) * count + i;
+      builder.addTransaction(makeEntry(0, fees[i]));
+    }
+  }
+
+  Indexes expected(count);
+  for (uint32_t i = 0; i < count; ++i) {
+    expected[i] = i;
+  }
+  std::sort(expected.begin(), expected.end(),
+            [&](uint32_t a, uint32_t b) { return fees[a] > fees[b]; });
+  EXPECT_EQ(builder.build(0).indexes, expected);
+}
+
+// Test the subsidy schedule
+TEST(TemplateBuilderTEST, Subsidy) {
+  EXPECT_EQ(Block::TemplateBuilder::getBlockSubsidy(0), 5000000000);
+  EXPECT_EQ(Block::TemplateBuilder::getBlockSubsidy(209999), 5000000000);
+  EXPECT_EQ(Block::TemplateBuilder::getBlockSubsidy(210000), 2500000000);
+  EXPECT_EQ(Block::TemplateBuilder::getBlockSubsidy(840000), 312500000);
+  EXPECT_EQ(Block::TemplateBuilder::getBlockSubsidy(64 * 210000), 0);
+  EXPECT_EQ(Block::TemplateBuilder::getBlockSubsidy(150, 150), 2500000000);
+}
+
+// Test against a quadratic reference: without limits, each step takes the
+// package with the best fee rate among the unselected transactions
+TEST(TemplateBuilderTEST, MatchesReference) {
+  std::mt19937 rng(7);
+  for (int round = 0; round < 20; ++round) {
+    const size_t count = 60;
+    std::vector<Block::MempoolEntry> entries;
+    std::vector<Indexes> parents(count);
+    Block::TemplateLimits limits;
+    limits.maxAncestors = 1000;
+    Block::TemplateBuilder builder(limits);
+    for (size_t i = 0; i < count; ++i) {
+      // Distinct fee rates, so there are no ties
+      entries.push_back(makeEntry(static_cast<uint8_t>(i),
+                                  static_cast<int64_t>(rng() % 100000) * 64 +
+                                      static_cast<int64_t>(i),
+                                  200 + rng() % 2000));
+      for (uint32_t p = 0; p < i; ++p) {
+        if (rng() % 20 == 0) {
+          parents[i].push_back(p);
+        }
+      }
+      builder.addTransaction(entries[i], parents[i]);
+    }
+
+    std::vector<bool> chosen(count, false);
+    Indexes expected;
+    const auto collect = [&](uint32_t index, std::vector<bool> &package,
+                             const auto &self) -> void {
+      if (chosen[index] || package[index]) {
+        return;
+      }
+      package[index] = true;
+      for (const uint32_t parent : parents[index]) {
+        self(parent, package, self);
+      }
+    };
+    while (expected.size() < count) {
+      double best_rate = -1;
+      std::vector<bool> best_package;
+      for (uint32_t i = 0; i < count; ++i) {
+        if (chosen[i]) {
+          continue;
+        }
+        std::vector<bool> package(count, false);
+        collect(i, package, collect);
+        int64_t fee = 0;
+        uint64_t weight = 0;
+        for (uint32_t j = 0; j < count; ++j) {
+          if (package[j]) {
+            fee += entries[j].fee;
+            weight += entries[j].weight;
+          }
+        }
+        const double rate = static_cast<double>(fee) / weight;
+        if (rate > best_rate) {
+          best_rate = rate;
+          best_package = package;
+        }
+      }
+      for (uint32_t j = 0; j < count; ++j) {
+        if (best_package[j]) {
+          chosen[j] = true;
+          expected.push_back(j);
+        }
+      }
+    }
+
+    EXPECT_EQ(builder.build(0).indexes, expected) << round;
+  }
+}
@@ -0,0 +1,241 @@
+// system includes
+#include <cstdint>
+#include <string>
+#include <vector>
+
+// Google Test includes
+#include <gtest/gtest.h>
+
+// project includes
+#include "block/packedHeader.h"
+#include "block/transaction.h"
+#include "sha256/sha256.h"
+#include "types/types.h"
+#include "util/compactSize.h"
+#include "util/endian.h"
+
+static std::vector<uint8_t> fromHex(const std::string &hex) {
+  std::vector<uint8_t> bytes;
+  for (size_t i = 0; i + 1 < hex.size(); i += 2) {
+    bytes.push_back(
+        static_cast<uint8_t>(std::stoul(hex.substr(i, 2), nullptr, 16)));
+  }
+  return bytes;
+}
+
+static Hash doubleHash(const std::vector<uint8_t> &bytes) {
+  Hash first;
+  Hash second;
+  SHA256::sha256_bytes(bytes.data(), bytes.size(), first.data());
+  SHA256::sha256_bytes(first.data(), first.size(), second.data());
+  return second;
+}
+
+static void putLE32(std::vector<uint8_t> &out, uint32_t value) {
+  uint8_t bytes[4];
+  util::WriteLE32(bytes, value);
+  out.insert(out.end(), bytes, bytes + 4);
+}
+
+static void putCompact(std::vector<uint8_t> &out, uint64_t value) {
+  uint8_t bytes[util::MAX_COMPACT_SIZE_LENGTH];
+  out.insert(out.end(), bytes, bytes + util::WriteCompactSize(bytes, value));
+}
+
+// A synthetic transaction in both serializations
+struct TestTx {
+  std::vector<uint8_t> legacy;
+  std::vector<uint8_t> full;
+};
+
+static TestTx makeTx(uint32_t seed, size_t inputs, size_t scriptSize,
+                     bool segwit) {
+  std::vector<uint8_t> body;
+  putCompact(body, inputs);
+  for (size_t i = 0; i < inputs; ++i) {
+    for (size_t j = 0; j < 36; ++j) {
+      body.push_back(static_cast<uint8_t>(seed + i + j));
+    }
+    putCompact(body, scriptSize);
+    body.insert(body.end(), scriptSize, static_cast<uint8_t>(seed));
+    putLE32(body, 0xfffffffe);
+  }
+  putCompact(body, 2);
+  for (size_t o = 0; o < 2; ++o) {
+    putLE32(body, seed * 1000 + static_cast<uint32_t>(o));
+    putLE32(body, 0);
+    putCompact(body, 22);
+    body.insert(body.end(), 22, static_cast<uint8_t>(o + 1));
+  }
+
+  TestTx tx;
+  putLE32(tx.legacy, 2);
+  tx.legacy.insert(tx.legacy.end(), body.begin(), body.end());
+  putLE32(tx.legacy, seed);
+  if (!segwit) {
+    tx.full = tx.legacy;
+    return tx;
+  }
+
+  putLE32(tx.full, 2);
+  tx.full.push_back(0x00);
+  tx.full.push_back(0x01);
+  tx.full.insert(tx.full.end(), body.begin(), body.end());
+  for (size_t i = 0; i < inputs; ++i) {
+    putCompact(tx.full, 2);
+    putCompact(tx.full, 72);
+    tx.full.insert(tx.full.end(), 72, static_cast<uint8_t>(seed + 3));
+    putCompact(tx.full, 33);
+    tx.full.insert(tx.full.end(), 33, static_cast<uint8_t>(seed + 4));
+  }
+  putLE32(tx.full, seed);
+  return tx;
+}
+
+static const std::string GENESIS_HEADER =
+    "0100000000000000000000000000000000000000000000000000000000000000"
+    "000000003ba3edfd7a7b12b27ac72c3e67768f617fc81bc3888a51323a9fb8aa"
+    "4b1e5e4a29ab5f49ffff001d1dac2b7c";
+
+static const std::string GENESIS_COINBASE =
+    "01000000010000000000000000000000000000000000000000000000000000000000000000"
+    "ffffffff4d04ffff001d0104455468652054696d65732030332f4a616e2f323030392043"
+    "68616e63656c6c6f72206f6e206272696e6b206f66207365636f6e64206261696c6f7574"
+    "20666f722062616e6b73ffffffff0100f2052a01000000434104678afdb0fe5548271967"
+    "f1a67130b7105cd6a828e03909a67962e0ea1f61deb649f6bc3f4cef38c4f35504e51ec1"
+    "12de5c384df7ba0b8d578a4c702b6bf11d5fac00000000";
+
+// Test the genesis coinbase against its well-known txid
+TEST(TransactionTEST, GenesisCoinbase) {
+  const std::vector<uint8_t> bytes = fromHex(GENESIS_COINBASE);
+  Block::Transaction tx;
+  size_t offset = 0;
+  ASSERT_TRUE(Block::parseTransaction(bytes, offset, tx));
+  EXPECT_EQ(offset, bytes.size());
+
+  EXPECT_EQ(tx.version, 1u);
+  EXPECT_EQ(tx.lockTime, 0u);
+  EXPECT_FALSE(tx.hasWitness());
+  ASSERT_EQ(tx.inputs.size(), 1u);
+  EXPECT_EQ(tx.inputs[0].prevout.size(), 36u);
+  EXPECT_EQ(tx.inputs[0].scriptSig.size(), 0x4du);
+  EXPECT_EQ(tx.inputs[0].sequence, 0xffffffffu);
+  ASSERT_EQ(tx.outputs.size(), 1u);
+  EXPECT_EQ(tx.outputs[0].value, 5000000000);
+  EXPECT_EQ(tx.outputs[0].scriptPubKey.size(), 0x43u);
+  EXPECT_EQ(tx.getWeight(), bytes.size() * 4);
+
+  // Stored little-endian: the displayed txid reversed
+  EXPECT_EQ(SHA256::hashArrayToString(tx.txid),
+            "3ba3edfd7a7b12b27ac72c3e67768f617fc81bc3888a51323a9fb8aa4b1e5e4a");
+  EXPECT_EQ(tx.wtxid, tx.txid);
+}
+
+// Test that a segwit transaction's txid skips the marker, flag and witnesses
+TEST(TransactionTEST, SegwitIds) {
+  const TestTx test_tx = makeTx(7, 2, 0, true);
+  Block::Transaction tx;
+  size_t offset = 0;
+  ASSERT_TRUE(Block::parseTransaction(test_tx.full, offset, tx));
+  EXPECT_EQ(offset, test_tx.full.size());
+
+  EXPECT_TRUE(tx.hasWitness());
+  EXPECT_EQ(tx.getBaseSize(), test_tx.legacy.size());
+  EXPECT_EQ(tx.getWeight(),
+            test_tx.legacy.size() * 3 + test_tx.full.size());
+  ASSERT_EQ(tx.inputs.size(), 2u);
+  EXPECT_EQ(tx.inputs[1].witness.size(), 1u + 1u + 72u + 1u + 33u);
+  EXPECT_EQ(tx.inputs[1].witness[0], 2);
+  EXPECT_EQ(tx.txid, doubleHash(test_tx.legacy));
+  EXPECT_EQ(tx.wtxid, doubleHash(test_tx.full));
+  EXPECT_NE(tx.txid, tx.wtxid);
+}
+
+// Test that truncations and malformed encodings are rejected
+TEST(TransactionTEST, RejectsMalformed) {
+  const TestTx test_tx = makeTx(9, 1, 10, true);
+  for (size_t size = 0; size < test_tx.full.size(); ++size) {
+    const std::vector<uint8_t> truncated(test_tx.full.begin(),
+                                         test_tx.full.begin() + size);
+    Block::Transaction tx;
+    size_t offset = 0;
+    EXPECT_FALSE(Block::parseTransaction(truncated, offset, tx))
+        << "size " << size;
+    EXPECT_EQ(offset, 0u);
+  }
+
+  // Segwit serialization with only empty witnesses
+  std::vector<uint8_t> superfluous = {0x02, 0x00, 0x00, 0x00, 0x00, 0x01};
+  const TestTx legacy = makeTx(9, 1, 10, false);
+  superfluous.insert(superfluous.end(), legacy.legacy.begin() + 4,
+                     legacy.legacy.end() - 4);
+  superfluous.push_back(0x00);
+  putLE32(superfluous, 0);
+  Block::Transaction tx;
+  size_t offset = 0;
+  EXPECT_FALSE(Block::parseTransaction(superfluous, offset, tx));
+
+  // An input count no buffer could hold
+  std::vector<uint8_t> huge = {0x01, 0x00, 0x00, 0x00, 0xfe,
+                               0xff, 0xff, 0xff, 0x0f};
+  huge.resize(200);
+  offset = 0;
+  EXPECT_FALSE(Block::parseTransaction(huge, offset, tx));
+}
+
+// Test Merkle root re-derivation on the genesis block
+TEST(BlockParserTEST, GenesisMerkleRoot) {
+  std::vector<uint8_t> block = fromHex(GENESIS_HEADER);
+  block.push_back(0x01);
+  const std::vector<uint8_t> coinbase = fromHex(GENESIS_COINBASE);
+  block.insert(block.end(), coinbase.begin(), coinbase.end());
+
+  const Block::BlockParser parser(1);
+  EXPECT_TRUE(parser.checkMerkleRoot(block));
+
+  block[block.size() - 10] ^= 1;
+  EXPECT_FALSE(parser.checkMerkleRoot(block));
+
+  block.push_back(0x00);
+  std::vector<Block::Transaction> txs;
+  EXPECT_FALSE(parser.parse(block, txs));
+}
+
+// Test that the threaded, batched block path matches per-transaction
+// streaming on a large mixed block
+TEST(BlockParserTEST, ParallelMatchesStreaming) {
+  std::vector<uint8_t> body;
+  const size_t count = 3000;
+  putCompact(body, count);
+  for (uint32_t i = 0; i < count; ++i) {
+    // Small and large, legacy and segwit
+    const TestTx tx = makeTx(i, 1 + i % 3, i % 5 == 0 ? 300 : 0, i % 2 == 0);
+    body.insert(body.end(), tx.full.begin(), tx.full.end());
+  }
+  Block::PackedHeader header;
+  std::vector<uint8_t> block(header.data(),
+                             header.data() + Block::PackedHeader::SIZE);
+  block.insert(block.end(), body.begin(), body.end());
+
+  const Block::BlockParser parser(4);
+  std::vector<Block::Transaction> txs;
+  ASSERT_TRUE(parser.parse(block, txs));
+  ASSERT_EQ(txs.size(), count);
+
+  size_t offset = Block::PackedHeader::SIZE + 3;
+  for (size_t i = 0; i < count; ++i) {
+    Block::Transaction tx;
+    ASSERT_TRUE(Block::parseTransaction(block, offset, tx));
+    EXPECT_EQ(txs[i].txid, tx.txid) << "tx " << i;
+    EXPECT_EQ(txs[i].wtxid, tx.wtxid) << "tx " << i;
+  }
+
+  // Reusing the views gives the same result
+  ASSERT_TRUE(parser.parse(block, txs));
+  EXPECT_EQ(txs.size(), count);
+
+  const Hash root = Block::BlockParser::computeMerkleRoot(txs);
+  std::copy(root.begin(), root.end(),
+            block.begin() + Block::PackedHeader::MERKLE_ROOT_OFFSET);
+  EXPECT_TRUE(parser.checkMerkleRoot(block));
+}
@@ -0,0 +1,121 @@
+// system includes
+#include <algorithm>
+#include <iterator>
+#include <cstdint>
+#include <vector>
+
+// Google Test includes
+#include <gtest/gtest.h>
+
+// project includes
+#include "block/merkle.h"
+#include "block/transaction.h"
+#include "block/witnessCommitment.h"
+#include "sha256/sha256.h"
+#include "types/types.h"
+
+static Hash doubleHash(const uint8_t *data, size_t size) {
+  Hash first;
+  Hash second;
+  SHA256::sha256_bytes(data, size, first.data());
+  SHA256::sha256_bytes(first.data(), first.size(), second.data());
+  return second;
+}
+
+static std::vector<Hash> makeWtxids(size_t count, uint8_t seed) {
+  std::vector<Hash> wtxids(count);
+  for (size_t i = 0; i < count; ++i) {
+    wtxids[i].fill(static_cast<uint8_t>(seed + i));
+  }
+  return wtxids;
+}
+
+// A coinbase with a payout and a commitment output
+static std::vector<uint8_t> makeCoinbase(const Block::WitnessCommitment &wc) {
+  // Version, one input spending the null outpoint, then two outputs: 50 BTC
+  // to OP_TRUE and the commitment
+  static const uint8_t head[] = {
+      0x02, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00, 0x00,
+      0x00, 0xff, 0xff, 0xff, 0xff, 0x03, 0x01, 0x02, 0x03, 0xff, 0xff, 0xff,
+      0xff, 0x02, 0x00, 0xf2, 0x05, 0x2a, 0x01, 0x00, 0x00, 0x00, 0x01, 0x51};
+  const auto output = wc.getOutput();
+  std::vector<uint8_t> tx;
+  tx.reserve(sizeof(head) + output.size() + 4);
+  tx.resize(sizeof(head));
+  std::copy(std::begin(head), std::end(head), tx.begin());
+  for (const uint8_t byte : output) {
+    tx.push_back(byte);
+  }
+  tx.resize(tx.size() + 4, 0x00); // lock time
+  return tx;
+}
+
+// Test the commitment hash and the serialized output layout
+TEST(WitnessCommitmentTEST, CommitmentAndOutput) {
+  Hash reserved;
+  reserved.fill(0x5a);
+  Block::WitnessCommitment wc(reserved);
+  const std::vector<Hash> wtxids = makeWtxids(5, 1);
+  wc.update(wtxids);
+
+  std::vector<Hash> leaves = {Hash{}};
+  leaves.insert(leaves.end(), wtxids.begin(), wtxids.end());
+  EXPECT_EQ(wc.getWitnessRoot(), Block::computeMerkleRoot(leaves));
+
+  uint8_t message[64];
+  std::copy(wc.getWitnessRoot().begin(), wc.getWitnessRoot().end(), message);
+  std::copy(reserved.begin(), reserved.end(), message + 32);
+  EXPECT_EQ(wc.getCommitment(), doubleHash(message, sizeof(message)));
+
+  const std::vector<uint8_t> output(wc.getOutput().begin(),
+                                    wc.getOutput().end());
+  ASSERT_EQ(output.size(), 47u);
+  EXPECT_EQ(std::vector<uint8_t>(output.begin(), output.begin() + 15),
+            (std::vector<uint8_t>{0, 0, 0, 0, 0, 0, 0, 0, 0x26, 0x6a, 0x24,
+                                  0xaa, 0x21, 0xa9, 0xed}));
+  EXPECT_TRUE(std::equal(wc.getCommitment().begin(), wc.getCommitment().end(),
+                         output.begin() + 15));
+  EXPECT_EQ(wc.getScript().size(), Block::WitnessCommitment::SCRIPT_SIZE);
+}
+
+// Test that a template coinbase is patched in place when the set changes
+TEST(WitnessCommitmentTEST, SwapIntoCoinbase) {
+  Block::WitnessCommitment wc;
+  wc.update(makeWtxids(3, 10));
+  std::vector<uint8_t> coinbase = makeCoinbase(wc);
+
+  const std::optional<size_t> offset = Block::WitnessCommitment::find(coinbase);
+  ASSERT_TRUE(offset.has_value());
+  EXPECT_EQ(*offset, coinbase.size() - 4 - 32);
+
+  wc.update(makeWtxids(7, 50));
+  wc.swapInto(coinbase, *offset);
+  EXPECT_EQ(coinbase, makeCoinbase(wc));
+
+  EXPECT_THROW(wc.swapInto(coinbase, *offset - 1), std::invalid_argument);
+  EXPECT_THROW(wc.swapInto(coinbase, coinbase.size()), std::invalid_argument);
+}
+
+// Test that parsed transactions and bare wtxids commit identically
+TEST(WitnessCommitmentTEST, UpdateFromTransactions) {
+  std::vector<Block::Transaction> txs(4);
+  for (size_t i = 0; i < txs.size(); ++i) {
+    txs[i].wtxid.fill(static_cast<uint8_t>(0x80 + i));
+  }
+  Block::WitnessCommitment from_txs;
+  from_txs.update(txs);
+
+  std::vector<Hash> wtxids;
+  for (size_t i = 1; i < txs.size(); ++i) {
+    wtxids.push_back(txs[i].wtxid);
+  }
+  Block::WitnessCommitment from_wtxids;
+  from_wtxids.update(wtxids);
+  EXPECT_EQ(from_txs.getCommitment(), from_wtxids.getCommitment());
+
+  // A lone coinbase commits to a zero root
+  Block::WitnessCommitment empty;
+  EXPECT_EQ(empty.getWitnessRoot(), Hash{});
+}
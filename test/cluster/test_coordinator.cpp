@@ -0,0 +1,297 @@
+// system includes
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <sys/wait.h>
+#include <unistd.h>
+#include <vector>
+
+// Google Test includes
+#include <gtest/gtest.h>
+
+// project includes
+#include "cluster/coordinator.h"
+#include "cluster/node.h"
+#include "cluster/protocol.h"
+
+// With one-second leases, a node leases this many indices per unit
+static constexpr uint64_t INDEX_RATE = uint64_t{1} << 32;
+
+static Cluster::CoordinatorConfig localConfig() {
+  Cluster::CoordinatorConfig config;
+  config.host = "127.0.0.1";
+  config.port = 0;
+  config.leaseTime = std::chrono::milliseconds(1000);
+  return config;
+}
+
+static Stratum::Notify makeJob(const std::string &jobId) {
+  Stratum::Notify notify;
+  notify.jobId = jobId;
+  notify.coinbase1.assign(60, 0x11);
+  notify.coinbase2.assign(40, 0x22);
+  notify.version = 0x20000000;
+  notify.bits = 0x1d00ffff;
+  notify.time = 1700000000;
+  notify.clean = true;
+  return notify;
+}
+
+// A node that records what it is sent
+struct TestNode {
+  TestNode(uint16_t port, const std::string &name, uint64_t rate)
+      : node(Cluster::NodeConfig{"127.0.0.1", port, name, rate * INDEX_RATE,
+                                 std::chrono::milliseconds(5000)}) {
+    node.setJobHandler(
+        [this](const Cluster::Job &job) { jobs.push_back(job.id); });
+    node.setLeaseHandler(
+        [this](const Cluster::Lease &lease) { leases.push_back(lease); });
+    node.connect();
+  }
+
+  Cluster::Node node;
+  std::vector<uint32_t> jobs;
+  std::vector<Cluster::Lease> leases;
+};
+
+// Poll nodes until a condition holds or five seconds pass
+template <typename Condition>
+static bool pollUntil(const std::vector<TestNode *> &nodes,
+                      Condition condition) {
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (!condition()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    for (TestNode *node : nodes) {
+      node->node.poll(std::chrono::milliseconds(1));
+    }
+  }
+  return true;
+}
+
+static Cluster::NodeInfo findNode(const Cluster::Coordinator &coordinator,
+                                  uint32_t id) {
+  for (const Cluster::NodeInfo &info : coordinator.getNodes()) {
+    if (info.id == id) {
+      return info;
+    }
+  }
+  return {};
+}
+
+// Test leases, progress, solutions, a node leaving, one joining and a new
+// job
+TEST(CoordinatorTEST, Leases) {
+  Cluster::Coordinator coordinator(localConfig());
+  std::mutex mutex;
+  std::vector<Cluster::Submission> submissions;
+  std::vector<std::string> job_ids;
+  coordinator.setSolutionHandler([&](const Cluster::Submission &submission) {
+    std::lock_guard<std::mutex> lock(mutex);
+    submissions.push_back(submission);
+    job_ids.emplace_back(submission.jobId);
+    submissions.back().jobId = {};
+    submissions.back().extranonce2 = {};
+    submissions.back().time = submission.extranonce2[0];
+  });
+  // The handler runs on the coordinator thread after the frames are answered
+  const auto submitted = [&] {
+    std::lock_guard<std::mutex> lock(mutex);
+    return submissions.size();
+  };
+  coordinator.start();
+  const uint8_t extranonce1[] = {8, 0, 0, 2};
+  // 256 extranonce2 values times 4 versions
+  EXPECT_EQ(coordinator.setJob(makeJob("up1"), extranonce1, 1, 0x6000), 1u);
+
+  TestNode a(coordinator.getPort(), "a", 4);
+  auto b = std::make_unique<TestNode>(coordinator.getPort(), "b", 8);
+  EXPECT_EQ(a.node.getId(), 1u);
+  EXPECT_EQ(b->node.getId(), 2u);
+  ASSERT_TRUE(pollUntil({&a, b.get()}, [&] {
+    return a.leases.size() == 1 && b->leases.size() == 1;
+  }));
+  EXPECT_EQ(a.jobs, std::vector<uint32_t>{1});
+  EXPECT_EQ(a.leases[0].range, (Cluster::WorkRange{0, 4}));
+  EXPECT_EQ(b->leases[0].range, (Cluster::WorkRange{4, 12}));
+
+  // Index 2 is extranonce2 0 with the second version bit; index 5 is b's
+  a.node.submit(1, 2, 1700000001, 42);
+  a.node.submit(1, 5, 1700000001, 43);
+  a.node.reportProgress(1, 3, 0);
+  ASSERT_TRUE(pollUntil(
+      {&a}, [&] { return a.leases.size() == 2 && submitted() == 1; }));
+  EXPECT_EQ(a.leases[1].range, (Cluster::WorkRange{12, 16}));
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    ASSERT_EQ(submissions.size(), 1u);
+    EXPECT_EQ(submissions[0].node, 1u);
+    EXPECT_EQ(job_ids[0], "up1");
+    EXPECT_EQ(submissions[0].time, 0u); // extranonce2[0]
+    EXPECT_EQ(submissions[0].versionBits, 0x4000u);
+    EXPECT_EQ(submissions[0].nonce, 42u);
+  }
+  Cluster::NodeInfo info = findNode(coordinator, 1);
+  EXPECT_EQ(info.name, "a");
+  EXPECT_EQ(info.searched, 3u);
+  EXPECT_EQ(info.solutions, 1u);
+  EXPECT_EQ(info.rejected, 1u);
+
+  // b leaves without searching; a gets the first half of its lease
+  b.reset();
+  ASSERT_TRUE(pollUntil({&a}, [&] {
+    return coordinator.getNodes().size() == 1;
+  }));
+  a.node.reportProgress(1, 16, 0);
+  ASSERT_TRUE(pollUntil({&a}, [&] { return a.leases.size() == 3; }));
+  EXPECT_EQ(a.leases[2].range, (Cluster::WorkRange{4, 8}));
+  EXPECT_EQ(findNode(coordinator, 1).searched, 8u);
+
+  // c joins and gets the other half
+  TestNode c(coordinator.getPort(), "c", 4);
+  ASSERT_TRUE(pollUntil({&c}, [&] { return c.leases.size() == 1; }));
+  EXPECT_EQ(c.leases[0].range, (Cluster::WorkRange{8, 12}));
+
+  // A new job starts over; solutions for the last one still count
+  EXPECT_EQ(coordinator.setJob(makeJob("up2"), extranonce1, 1, 0x6000), 2u);
+  ASSERT_TRUE(pollUntil({&a, &c}, [&] {
+    return a.leases.size() == 4 && c.leases.size() == 2;
+  }));
+  EXPECT_EQ(a.jobs, (std::vector<uint32_t>{1, 2}));
+  EXPECT_EQ(a.leases[3].job, 2u);
+  EXPECT_EQ(a.leases[3].range.begin + c.leases[1].range.begin, 4u);
+  a.node.submit(1, 13, 1700000002, 44);
+  a.node.submit(1, 9, 1700000002, 45);
+  ASSERT_TRUE(pollUntil({&a}, [&] {
+    return findNode(coordinator, 1).rejected == 2 && submitted() == 2;
+  }));
+  std::lock_guard<std::mutex> lock(mutex);
+  ASSERT_EQ(submissions.size(), 2u);
+  EXPECT_EQ(job_ids[1], "up1");
+  EXPECT_EQ(submissions[1].time, 3u); // extranonce2 of index 13
+  EXPECT_EQ(submissions[1].versionBits, 0x2000u);
+}
+
+// A node process that searches every lease at once and finds a solution
+// at its first index; exits once the coordinator hangs up
+static int runNode(uint16_t port, uint64_t rate) {
+  try {
+    Cluster::Node node(Cluster::NodeConfig{"127.0.0.1", port,
+                                           "node" + std::to_string(rate),
+                                           rate * INDEX_RATE,
+                                           std::chrono::milliseconds(5000)});
+    std::vector<Cluster::Lease> leases;
+    node.setLeaseHandler(
+        [&](const Cluster::Lease &lease) { leases.push_back(lease); });
+    node.connect();
+    while (node.poll(std::chrono::milliseconds(100))) {
+      for (const Cluster::Lease &lease : leases) {
+        node.submit(lease.job, lease.range.begin, 0, 0);
+        node.reportProgress(lease.job, lease.range.end, 0);
+      }
+      leases.clear();
+    }
+    return 0;
+  } catch (...) {
+    return 1;
+  }
+}
+
+// Test that nodes in separate processes search the space exactly once
+TEST(CoordinatorTEST, Processes) {
+  auto coordinator = std::make_unique<Cluster::Coordinator>(localConfig());
+  std::mutex mutex;
+  std::vector<uint8_t> found; // extranonce2 of each solution
+  coordinator->setSolutionHandler([&](const Cluster::Submission &submission) {
+    std::lock_guard<std::mutex> lock(mutex);
+    found.push_back(submission.extranonce2[0]);
+  });
+  const uint8_t extranonce1[] = {1, 2, 3, 4};
+  coordinator->setJob(makeJob("up"), extranonce1, 1, 0);
+
+  // Fork before the coordinator thread exists; the listener queues them
+  std::vector<pid_t> children;
+  for (uint64_t rate = 1; rate <= 3; ++rate) {
+    const pid_t pid = ::fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+      ::_exit(runNode(coordinator->getPort(), rate));
+    }
+    children.push_back(pid);
+  }
+  coordinator->start();
+
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(10);
+  std::vector<Cluster::NodeInfo> nodes;
+  uint64_t searched = 0;
+  while (std::chrono::steady_clock::now() < deadline) {
+    nodes = coordinator->getNodes();
+    searched = 0;
+    for (const Cluster::NodeInfo &node : nodes) {
+      searched += node.searched;
+    }
+    if (nodes.size() == 3 && searched == 256) {
+      break;
+    }
+    ::usleep(1000);
+  }
+  ASSERT_EQ(nodes.size(), 3u);
+  EXPECT_EQ(searched, 256u);
+
+  // The leases tile the space, each sized to its node
+  std::vector<Cluster::WorkRange> all;
+  size_t lease_count = 0;
+  for (const Cluster::NodeInfo &node : nodes) {
+    const uint64_t rate = node.hashrate / INDEX_RATE;
+    for (const Cluster::WorkRange &range : node.leases) {
+      EXPECT_TRUE(range.size() == rate || range.end == 256) << node.name;
+    }
+    EXPECT_EQ(node.rejected, 0u);
+    all.insert(all.end(), node.leases.begin(), node.leases.end());
+    lease_count += node.leases.size();
+  }
+  std::sort(all.begin(), all.end(),
+            [](const Cluster::WorkRange &x, const Cluster::WorkRange &y) {
+              return x.begin < y.begin;
+            });
+  uint64_t next = 0;
+  for (const Cluster::WorkRange &range : all) {
+    EXPECT_EQ(range.begin, next);
+    next = range.end;
+  }
+  EXPECT_EQ(next, 256u);
+
+  // Every solution was aggregated, each from a different lease
+  const auto wait =
+      std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (std::chrono::steady_clock::now() < wait) {
+    {
+      std::lock_guard<std::mutex> lock(mutex);
+      if (found.size() == lease_count) {
+        break;
+      }
+    }
+    ::usleep(1000);
+  }
+  {
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_EQ(found.size(), lease_count);
+    std::sort(found.begin(), found.end());
+    EXPECT_EQ(std::adjacent_find(found.begin(), found.end()), found.end());
+  }
+
+  // Closing the coordinator ends the node processes
+  coordinator.reset();
+  for (const pid_t pid : children) {
+    int status = 0;
+    ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+  }
+}
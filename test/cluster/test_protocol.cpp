@@ -0,0 +1,182 @@
+// system includes
+#include <cstdint>
+#include <span>
+#include <stdexcept>
+#include <vector>
+
+// Google Test includes
+#include <gtest/gtest.h>
+
+// project includes
+#include "cluster/protocol.h"
+
+// Decode the single frame in bytes
+template <typename Message>
+static bool roundTrip(const std::vector<uint8_t> &bytes,
+                      Cluster::MessageType expected, Message &message) {
+  size_t offset = 0;
+  Cluster::MessageType type{};
+  std::span<const uint8_t> payload;
+  return Cluster::readFrame(bytes, offset, type, payload) ==
+             Cluster::FrameStatus::Complete &&
+         offset == bytes.size() && type == expected &&
+         Cluster::decode(payload, message);
+}
+
+// Test that every message survives encoding
+TEST(ProtocolTEST, RoundTrip) {
+  std::vector<uint8_t> bytes;
+  Cluster::Hello hello;
+  hello.hashrate = 120000000000000; // 120 TH/s
+  hello.name = "rack-7";
+  Cluster::encode(bytes, hello);
+  // Type, length, version, 9-byte hashrate, name
+  EXPECT_EQ(bytes.size(), 1u + 1u + 4u + 9u + 1u + 6u);
+  Cluster::Hello hello_out;
+  ASSERT_TRUE(roundTrip(bytes, Cluster::MessageType::Hello, hello_out));
+  EXPECT_EQ(hello_out.version, Cluster::PROTOCOL_VERSION);
+  EXPECT_EQ(hello_out.hashrate, hello.hashrate);
+  EXPECT_EQ(hello_out.name, "rack-7");
+
+  Cluster::Job job;
+  job.id = 7;
+  job.notify.jobId = "4f2a";
+  job.notify.prevHash[31] = 0xee;
+  job.notify.coinbase1.assign(300, 0x11); // a 3-byte CompactSize
+  job.notify.coinbase2 = {0x22, 0x23};
+  job.notify.merkleBranch.assign(3, Hash{0x33});
+  job.notify.version = 0x20000000;
+  job.notify.bits = 0x17034219;
+  job.notify.time = 1700000000;
+  job.notify.clean = true;
+  job.extranonce1 = {8, 0, 0, 2};
+  job.extranonce2Size = 4;
+  job.versionMask = 0x1fffe000;
+  bytes.clear();
+  Cluster::encode(bytes, job);
+  Cluster::Job job_out;
+  ASSERT_TRUE(roundTrip(bytes, Cluster::MessageType::Job, job_out));
+  EXPECT_EQ(job_out.id, 7u);
+  EXPECT_EQ(job_out.notify.jobId, "4f2a");
+  EXPECT_EQ(job_out.notify.prevHash, job.notify.prevHash);
+  EXPECT_EQ(job_out.notify.coinbase1, job.notify.coinbase1);
+  EXPECT_EQ(job_out.notify.coinbase2, job.notify.coinbase2);
+  EXPECT_EQ(job_out.notify.merkleBranch, job.notify.merkleBranch);
+  EXPECT_EQ(job_out.notify.version, job.notify.version);
+  EXPECT_EQ(job_out.notify.bits, job.notify.bits);
+  EXPECT_EQ(job_out.notify.time, job.notify.time);
+  EXPECT_TRUE(job_out.notify.clean);
+  EXPECT_EQ(job_out.extranonce1, job.extranonce1);
+  EXPECT_EQ(job_out.extranonce2Size, 4u);
+  EXPECT_EQ(job_out.versionMask, 0x1fffe000u);
+
+  bytes.clear();
+  Cluster::encode(bytes, Cluster::Lease{7, {100, 164}});
+  Cluster::Lease lease;
+  ASSERT_TRUE(roundTrip(bytes, Cluster::MessageType::Lease, lease));
+  EXPECT_EQ(lease.job, 7u);
+  EXPECT_EQ(lease.range, (Cluster::WorkRange{100, 164}));
+
+  bytes.clear();
+  Cluster::encode(bytes, Cluster::Progress{7, 130, 5000});
+  EXPECT_EQ(bytes.size(), 2u + 4u + 8u + 3u);
+  Cluster::Progress progress;
+  ASSERT_TRUE(roundTrip(bytes, Cluster::MessageType::Progress, progress));
+  EXPECT_EQ(progress.position, 130u);
+  EXPECT_EQ(progress.hashrate, 5000u);
+
+  bytes.clear();
+  Cluster::encode(bytes, Cluster::Solution{7, 131, 1700000001, 0xdeadbeef});
+  Cluster::Solution solution;
+  ASSERT_TRUE(roundTrip(bytes, Cluster::MessageType::Solution, solution));
+  EXPECT_EQ(solution.index, 131u);
+  EXPECT_EQ(solution.time, 1700000001u);
+  EXPECT_EQ(solution.nonce, 0xdeadbeefu);
+
+  bytes.clear();
+  Cluster::encode(bytes, Cluster::Welcome{3});
+  Cluster::Welcome welcome;
+  ASSERT_TRUE(roundTrip(bytes, Cluster::MessageType::Welcome, welcome));
+  EXPECT_EQ(welcome.node, 3u);
+}
+
+// Test partial, oversized and malformed frames
+TEST(ProtocolTEST, Framing) {
+  std::vector<uint8_t> bytes;
+  Cluster::encode(bytes, Cluster::Progress{1, 2, 3});
+  Cluster::encode(bytes, Cluster::Welcome{4});
+
+  size_t offset = 0;
+  Cluster::MessageType type{};
+  std::span<const uint8_t> payload;
+  for (size_t size = 0; size < 14; ++size) {
+    EXPECT_EQ(Cluster::readFrame(std::span<const uint8_t>(bytes).first(size),
+                                 offset, type, payload),
+              Cluster::FrameStatus::Incomplete);
+    EXPECT_EQ(offset, 0u);
+  }
+  ASSERT_EQ(Cluster::readFrame(bytes, offset, type, payload),
+            Cluster::FrameStatus::Complete);
+  EXPECT_EQ(type, Cluster::MessageType::Progress);
+  ASSERT_EQ(Cluster::readFrame(bytes, offset, type, payload),
+            Cluster::FrameStatus::Complete);
+  EXPECT_EQ(type, Cluster::MessageType::Welcome);
+  EXPECT_EQ(Cluster::readFrame(bytes, offset, type, payload),
+            Cluster::FrameStatus::Incomplete);
+
+  // A 4-byte length that fits in one, and one over the limit
+  const std::vector<uint8_t> padded = {5, 0xfe, 1, 0, 0, 0, 0};
+  offset = 0;
+  EXPECT_EQ(Cluster::readFrame(padded, offset, type, payload),
+            Cluster::FrameStatus::Malformed);
+  const std::vector<uint8_t> huge = {5, 0xfe, 0, 0, 0, 1};
+  EXPECT_EQ(Cluster::readFrame(huge, offset, type, payload),
+            Cluster::FrameStatus::Malformed);
+
+  // Payloads with missing or extra bytes
+  Cluster::Welcome welcome;
+  const uint8_t short_payload[] = {1, 2, 3};
+  EXPECT_FALSE(Cluster::decode(short_payload, welcome));
+  const uint8_t long_payload[] = {1, 2, 3, 4, 5};
+  EXPECT_FALSE(Cluster::decode(long_payload, welcome));
+  Cluster::Lease lease;
+  const uint8_t empty_lease[20] = {};
+  EXPECT_FALSE(Cluster::decode(empty_lease, lease));
+}
+
+// Test the index to extranonce2 and version bits mapping
+TEST(ProtocolTEST, WorkSpace) {
+  const Cluster::WorkSpace space(2, 0x1fffe000);
+  EXPECT_EQ(space.size(), uint64_t{1} << 32);
+
+  uint8_t extranonce2[2];
+  uint32_t version_bits = 0;
+  space.at(0, extranonce2, version_bits);
+  EXPECT_EQ(extranonce2[0], 0);
+  EXPECT_EQ(extranonce2[1], 0);
+  EXPECT_EQ(version_bits, 0u);
+  space.at(1, extranonce2, version_bits);
+  EXPECT_EQ(version_bits, 0x2000u);
+  space.at(0xffff, extranonce2, version_bits);
+  EXPECT_EQ(version_bits, 0x1fffe000u);
+  EXPECT_EQ(extranonce2[1], 0);
+  space.at(0x10000, extranonce2, version_bits);
+  EXPECT_EQ(version_bits, 0u);
+  EXPECT_EQ(extranonce2[1], 1);
+  space.at(0x0102ffff, extranonce2, version_bits);
+  EXPECT_EQ(extranonce2[0], 1);
+  EXPECT_EQ(extranonce2[1], 2);
+  EXPECT_EQ(version_bits, 0x1fffe000u);
+
+  // Without version rolling
+  const Cluster::WorkSpace plain(4, 0);
+  uint8_t wide[4];
+  plain.at(0x01020304, wide, version_bits);
+  EXPECT_EQ(wide[0], 1);
+  EXPECT_EQ(wide[3], 4);
+  EXPECT_EQ(version_bits, 0u);
+
+  EXPECT_THROW(Cluster::WorkSpace(8, 0), std::invalid_argument);
+  EXPECT_THROW(Cluster::WorkSpace(6, 0x1fffe000), std::invalid_argument);
+  EXPECT_NO_THROW(Cluster::WorkSpace(5, 0x1fffe000));
+}
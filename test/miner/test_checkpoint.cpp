@@ -0,0 +1,116 @@
+// system includes
+#include <chrono>
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <string>
+#include <thread>
+
+// Google Test includes
+#include <gtest/gtest.h>
+
+// project includes
+#include "miner/checkpoint.h"
+
+// Checkpoint file under the temp directory, removed afterwards
+struct TempFile {
+  explicit TempFile(const std::string &name)
+      : path((std::filesystem::temp_directory_path() / name).string()) {
+    std::filesystem::remove(path);
+  }
+  ~TempFile() { std::filesystem::remove(path); }
+  std::string path;
+};
+
+static Miner::Progress makeProgress(uint64_t nextNonce) {
+  Miner::Progress progress;
+  progress.jobId = 42;
+  progress.extranonce = 0xabcdef;
+  progress.version = 0x20002000;
+  progress.timestamp = 1700000003;
+  progress.nextNonce = nextNonce;
+  return progress;
+}
+
+// Test progress survives closing and reopening the file
+TEST(CheckpointTEST, StoreAndReload) {
+  TempFile file("hfm_checkpoint_reload");
+  {
+    Miner::Checkpoint checkpoint(file.path, 2, std::chrono::seconds(10));
+    Miner::Progress progress;
+    EXPECT_FALSE(checkpoint.load(0, progress));
+    checkpoint.store(1, makeProgress(1000));
+    checkpoint.store(1, makeProgress(2000));
+    checkpoint.store(1, makeProgress(3000));
+  }
+
+  Miner::Checkpoint checkpoint(file.path, 2, std::chrono::seconds(10));
+  Miner::Progress progress;
+  EXPECT_FALSE(checkpoint.load(0, progress));
+  ASSERT_TRUE(checkpoint.load(1, progress));
+  EXPECT_EQ(progress.jobId, 42);
+  EXPECT_EQ(progress.extranonce, 0xabcdef);
+  EXPECT_EQ(progress.version, 0x20002000);
+  EXPECT_EQ(progress.timestamp, 1700000003);
+  EXPECT_EQ(progress.nextNonce, 3000);
+  EXPECT_FALSE(checkpoint.load(2, progress));
+}
+
+// Test a torn write falls back to the previous record
+TEST(CheckpointTEST, TornWriteKeepsPreviousRecord) {
+  TempFile file("hfm_checkpoint_torn");
+  {
+    Miner::Checkpoint checkpoint(file.path, 1, std::chrono::seconds(10));
+    checkpoint.store(0, makeProgress(1000)); // slot 1, sequence 1
+    checkpoint.store(0, makeProgress(2000)); // slot 0, sequence 2
+  }
+
+  // Corrupt the newest record: 64-byte file header, then slot 0
+  {
+    std::fstream stream(file.path,
+                        std::ios::in | std::ios::out | std::ios::binary);
+    stream.seekp(64 + 24);
+    stream.put(0x55);
+  }
+
+  Miner::Checkpoint checkpoint(file.path, 1, std::chrono::seconds(10));
+  Miner::Progress progress;
+  ASSERT_TRUE(checkpoint.load(0, progress));
+  EXPECT_EQ(progress.nextNonce, 1000);
+}
+
+// Test records are discarded when the worker count changes
+TEST(CheckpointTEST, ResetOnLayoutChange) {
+  TempFile file("hfm_checkpoint_layout");
+  {
+    Miner::Checkpoint checkpoint(file.path, 2, std::chrono::seconds(10));
+    checkpoint.store(0, makeProgress(1000));
+  }
+
+  Miner::Checkpoint checkpoint(file.path, 4, std::chrono::seconds(10));
+  EXPECT_EQ(checkpoint.getWorkerCount(), 4);
+  Miner::Progress progress;
+  EXPECT_FALSE(checkpoint.load(0, progress));
+}
+
+// Test the background thread flushes periodically
+TEST(CheckpointTEST, BackgroundSync) {
+  TempFile file("hfm_checkpoint_sync");
+  Miner::Checkpoint checkpoint(file.path, 1, std::chrono::milliseconds(1));
+  checkpoint.store(0, makeProgress(1000));
+
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(20);
+  while (checkpoint.getSyncCount() < 3 &&
+         std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  EXPECT_GE(checkpoint.getSyncCount(), 3);
+}
+
+// Test an unusable path is reported
+TEST(CheckpointTEST, OpenFailureThrows) {
+  EXPECT_THROW(Miner::Checkpoint("/nonexistent/dir/checkpoint", 1,
+                                 std::chrono::seconds(1)),
+               std::system_error);
+}
@@ -0,0 +1,271 @@
+// system includes
+#include <chrono>
+#include <filesystem>
+#include <mutex>
+#include <set>
+#include <string>
+#include <thread>
+#include <tuple>
+#include <vector>
+
+// Google Test includes
+#include <gtest/gtest.h>
+
+// project includes
+#include "block/blockHeader.h"
+#include "miner/checkpoint.h"
+#include "miner/engine.h"
+#include "miner/topology.h"
+#include "types/uint256.h"
+
+// Collects shares reported by the engine's worker threads
+struct ShareSink {
+  std::mutex mutex;
+  std::vector<Miner::Share> shares;
+
+  Miner::Engine::ShareCallback callback() {
+    return [this](const Miner::Share &share) {
+      std::lock_guard<std::mutex> lock(mutex);
+      shares.push_back(share);
+    };
+  }
+
+  size_t size() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return shares.size();
+  }
+};
+
+// Poll a condition until it holds or a generous timeout expires
+template <typename Predicate> static bool waitFor(Predicate predicate) {
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(20);
+  while (!predicate()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+// Build a job whose header hashes are non-trivial
+static Miner::Job makeJob(uint64_t id, const uint256 &target) {
+  Miner::Job job;
+  job.id = id;
+  job.header.setVersion(0x20000000);
+  job.header.setTimestamp(1700000000);
+  job.header.setBits(0x1d00ffff);
+  Hash merkle_hash;
+  merkle_hash.fill(static_cast<unsigned char>(id));
+  job.header.setMerkleRoot(merkle_hash);
+  job.targets = {target};
+  return job;
+}
+
+// Test shares reported by the workers reproduce and meet their target
+TEST(EngineTEST, ReportsValidShares) {
+  ShareSink sink;
+  Miner::EngineConfig config;
+  config.threads = 2;
+  Miner::Engine engine(config, sink.callback());
+
+  // Top byte zero: roughly 1 in 256 hashes
+  const uint256 target = uint256().SetCompact(0x2000ffff);
+  Miner::Job job = makeJob(7, target);
+  engine.setJob(job);
+
+  ASSERT_TRUE(waitFor([&] { return sink.size() >= 4; }));
+  engine.stop();
+
+  std::lock_guard<std::mutex> lock(sink.mutex);
+  for (const auto &share : sink.shares) {
+    Block::BlockHeader check = job.header;
+    check.setNonce(share.nonce);
+    check.setVersion(share.version);
+    check.setTimestamp(share.timestamp);
+    EXPECT_EQ(share.jobId, 7);
+    EXPECT_EQ(check.calculateBlockHash(), share.hash);
+    EXPECT_TRUE(MeetsTarget(share.hash, target));
+  }
+  EXPECT_GT(engine.getHashCount(), 0);
+}
+
+// Test workers search disjoint nonce ranges
+TEST(EngineTEST, WorkersSearchDisjointRanges) {
+  ShareSink sink;
+  Miner::EngineConfig config;
+  config.threads = 3;
+  config.checkInterval = 64;
+  Miner::Engine engine(config, sink.callback());
+
+  // Every hash is a hit, so every attempted nonce is reported
+  engine.setJob(makeJob(1, ~uint256()));
+  ASSERT_TRUE(waitFor([&] { return sink.size() >= 3000; }));
+  engine.stop();
+
+  std::lock_guard<std::mutex> lock(sink.mutex);
+  std::set<std::tuple<uint32_t, uint32_t, uint32_t>> seen;
+  for (const auto &share : sink.shares) {
+    EXPECT_TRUE(
+        seen.emplace(share.nonce, share.version, share.timestamp).second)
+        << "nonce " << share.nonce << " searched twice";
+  }
+}
+
+// Test a new job replaces the old one and the switch latency is measured
+TEST(EngineTEST, JobSwitchByEpoch) {
+  ShareSink sink;
+  Miner::EngineConfig config;
+  config.threads = 2;
+  Miner::Engine engine(config, sink.callback());
+
+  // A target of 1 is out of reach, so the first job never produces shares
+  const uint64_t first = engine.setJob(makeJob(1, uint256(1)));
+  ASSERT_TRUE(waitFor([&] { return engine.getSwitchedEpoch() == first; }));
+
+  const uint64_t second = engine.setJob(makeJob(2, ~uint256()));
+  EXPECT_EQ(second, first + 1);
+  EXPECT_EQ(engine.getEpoch(), second);
+  ASSERT_TRUE(waitFor([&] { return engine.getSwitchedEpoch() == second; }));
+  EXPECT_GT(engine.getLastSwitchLatency().count(), 0);
+  EXPECT_GE(engine.getMaxSwitchLatency(), engine.getLastSwitchLatency());
+
+  ASSERT_TRUE(waitFor([&] { return sink.size() > 0; }));
+  engine.stop();
+
+  std::lock_guard<std::mutex> lock(sink.mutex);
+  for (const auto &share : sink.shares) {
+    EXPECT_EQ(share.jobId, 2);
+    EXPECT_EQ(share.epoch, second);
+  }
+}
+
+// Test stopping twice is harmless
+TEST(EngineTEST, StopIsIdempotent) {
+  ShareSink sink;
+  Miner::EngineConfig config;
+  config.threads = 1;
+  Miner::Engine engine(config, sink.callback());
+
+  EXPECT_EQ(engine.getThreadCount(), 1);
+  engine.stop();
+  engine.stop();
+}
+
+// Test workers are placed on CPUs the process may use
+TEST(EngineTEST, WorkersPlacedOnAllowedCpus) {
+  ShareSink sink;
+  Miner::Engine engine(Miner::EngineConfig{}, sink.callback());
+
+  const Miner::Topology topology = Miner::Topology::detect();
+  EXPECT_EQ(engine.getThreadCount(), topology.getDefaultThreadCount());
+
+  std::set<unsigned int> allowed;
+  for (const Miner::CpuInfo &cpu : topology.getCpus()) {
+    allowed.insert(cpu.id);
+  }
+  const std::vector<Miner::CpuInfo> cpus = engine.getWorkerCpus();
+  ASSERT_EQ(cpus.size(), engine.getThreadCount());
+  for (const Miner::CpuInfo &cpu : cpus) {
+    EXPECT_TRUE(allowed.count(cpu.id));
+  }
+}
+
+// Test a restarted engine resumes the same job from its checkpoint
+TEST(EngineTEST, ResumesFromCheckpoint) {
+  const std::string path =
+      (std::filesystem::temp_directory_path() / "hfm_engine_checkpoint")
+          .string();
+  std::filesystem::remove(path);
+
+  Miner::EngineConfig config;
+  config.threads = 1;
+  config.checkInterval = 256;
+  config.checkpointPath = path;
+
+  // First run: an unreachable target, stopped part way through the range
+  Miner::Job job = makeJob(5, uint256(1));
+  job.extranonce = 77;
+  {
+    ShareSink sink;
+    Miner::Engine engine(config, sink.callback());
+    engine.setJob(job);
+    ASSERT_TRUE(waitFor([&] { return engine.getHashCount() >= 2048; }));
+  }
+
+  uint64_t saved_nonce;
+  {
+    Miner::Checkpoint checkpoint(path, 1, std::chrono::seconds(10));
+    Miner::Progress progress;
+    ASSERT_TRUE(checkpoint.load(0, progress));
+    EXPECT_EQ(progress.jobId, 5);
+    EXPECT_EQ(progress.extranonce, 77);
+    saved_nonce = progress.nextNonce;
+    EXPECT_GE(saved_nonce, 2048);
+  }
+
+  // Second run of the same work: every hash is a hit, so the first share
+  // shows where scanning restarted
+  job.targets = {~uint256()};
+  {
+    ShareSink sink;
+    Miner::Engine engine(config, sink.callback());
+    engine.setJob(job);
+    ASSERT_TRUE(waitFor([&] { return sink.size() > 0; }));
+    engine.stop();
+    std::lock_guard<std::mutex> lock(sink.mutex);
+    EXPECT_EQ(sink.shares.front().nonce, saved_nonce);
+  }
+
+  // Different extranonce: a different search space, started from scratch
+  job.extranonce = 78;
+  {
+    ShareSink sink;
+    Miner::Engine engine(config, sink.callback());
+    engine.setJob(job);
+    ASSERT_TRUE(waitFor([&] { return sink.size() > 0; }));
+    engine.stop();
+    std::lock_guard<std::mutex> lock(sink.mutex);
+    EXPECT_EQ(sink.shares.front().nonce, 0);
+  }
+  std::filesystem::remove(path);
+}
+
+// Test a share is reported before the checkpoint moves past its nonce
+TEST(EngineTEST, CheckpointFollowsShares) {
+  const std::string path =
+      (std::filesystem::temp_directory_path() / "hfm_engine_share_order")
+          .string();
+  std::filesystem::remove(path);
+
+  Miner::EngineConfig config;
+  config.threads = 1;
+  config.checkInterval = 256;
+  config.checkpointPath = path;
+
+  // Every hash is a hit; the callback runs on the worker that stores
+  std::mutex mutex;
+  size_t shares = 0;
+  size_t ahead = 0;
+  Miner::Engine *engine_ptr = nullptr;
+  Miner::Engine engine(config, [&](const Miner::Share &share) {
+    Miner::Progress progress;
+    std::lock_guard<std::mutex> lock(mutex);
+    ++shares;
+    if (engine_ptr->getCheckpoint()->load(0, progress) &&
+        progress.jobId == share.jobId && progress.nextNonce > share.nonce) {
+      ++ahead;
+    }
+  });
+  engine_ptr = &engine;
+  engine.setJob(makeJob(9, ~uint256()));
+  ASSERT_TRUE(waitFor([&] {
+    std::lock_guard<std::mutex> lock(mutex);
+    return shares >= 2048;
+  }));
+  engine.stop();
+  std::lock_guard<std::mutex> lock(mutex);
+  EXPECT_EQ(ahead, 0u);
+  std::filesystem::remove(path);
+}
@@ -0,0 +1,140 @@
+// system includes
+#include <chrono>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Google Test includes
+#include <gtest/gtest.h>
+
+// project includes
+#include "block/blockHeader.h"
+#include "miner/engine.h"
+#include "miner/jobPipeline.h"
+#include "types/uint256.h"
+
+// Collects shares reported by the engine's worker threads
+struct ShareSink {
+  std::mutex mutex;
+  std::vector<Miner::Share> shares;
+
+  Miner::Engine::ShareCallback callback() {
+    return [this](const Miner::Share &share) {
+      std::lock_guard<std::mutex> lock(mutex);
+      shares.push_back(share);
+    };
+  }
+
+  size_t size() {
+    std::lock_guard<std::mutex> lock(mutex);
+    return shares.size();
+  }
+};
+
+// Poll a condition until it holds or a generous timeout expires
+template <typename Predicate> static bool waitFor(Predicate predicate) {
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(20);
+  while (!predicate()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+// The header a job with the given id is expected to carry
+static Block::BlockHeader expectedHeader(uint64_t id) {
+  Block::BlockHeader header;
+  Hash merkle_hash;
+  merkle_hash.fill(static_cast<unsigned char>(id));
+  header.setMerkleRoot(merkle_hash);
+  header.setVersion(0x20000000 | static_cast<uint32_t>(id));
+  header.setTimestamp(1700000000 + static_cast<uint32_t>(id));
+  return header;
+}
+
+// Builder that fills a job slowly, field by field
+static Miner::Engine::JobBuilder slowBuilder(uint64_t id) {
+  return [id](Miner::Job &job) {
+    const Block::BlockHeader header = expectedHeader(id);
+    job.id = id;
+    job.header.setMerkleRoot(header.getMerkleRoot());
+    std::this_thread::sleep_for(std::chrono::milliseconds(2));
+    job.header.setVersion(header.getVersion());
+    job.header.setTimestamp(header.getTimestamp());
+    job.targets = {~uint256()};
+  };
+}
+
+// Test jobs are built on the producer thread and reach the workers
+TEST(JobPipelineTEST, BuildsOnProducerThread) {
+  ShareSink sink;
+  Miner::EngineConfig config;
+  config.threads = 2;
+  Miner::Engine engine(config, sink.callback());
+  Miner::JobPipeline pipeline(engine);
+
+  std::thread::id builder_thread;
+  pipeline.submit([&builder_thread](Miner::Job &job) {
+    builder_thread = std::this_thread::get_id();
+    slowBuilder(1)(job);
+  });
+  pipeline.flush();
+
+  EXPECT_NE(builder_thread, std::this_thread::get_id());
+  EXPECT_EQ(pipeline.getPublishedCount(), 1);
+  EXPECT_GT(pipeline.getLastBuildTime().count(), 0);
+  ASSERT_TRUE(waitFor([&] { return engine.getSwitchedEpoch() == 1; }));
+  ASSERT_TRUE(waitFor([&] { return sink.size() > 0; }));
+}
+
+// Test workers never observe a partially built job
+TEST(JobPipelineTEST, WorkersNeverSeeHalfBuiltJobs) {
+  ShareSink sink;
+  Miner::EngineConfig config;
+  config.threads = 2;
+  config.checkInterval = 32;
+  Miner::Engine engine(config, sink.callback());
+  Miner::JobPipeline pipeline(engine);
+
+  for (uint64_t id = 1; id <= 10; ++id) {
+    pipeline.submit(slowBuilder(id));
+    pipeline.flush();
+    std::this_thread::sleep_for(std::chrono::milliseconds(3));
+  }
+  ASSERT_TRUE(waitFor([&] { return engine.getSwitchedEpoch() == 10; }));
+  engine.stop();
+
+  // Every share must hash exactly as the fully built header of its job
+  std::lock_guard<std::mutex> lock(sink.mutex);
+  ASSERT_FALSE(sink.shares.empty());
+  for (const auto &share : sink.shares) {
+    Block::BlockHeader check = expectedHeader(share.jobId);
+    EXPECT_EQ(share.version, check.getVersion());
+    EXPECT_EQ(share.timestamp, check.getTimestamp());
+    check.setNonce(share.nonce);
+    EXPECT_EQ(check.calculateBlockHash(), share.hash);
+  }
+}
+
+// Test submissions arriving during a build are coalesced to the newest
+TEST(JobPipelineTEST, CoalescesStaleSubmissions) {
+  ShareSink sink;
+  Miner::EngineConfig config;
+  config.threads = 1;
+  Miner::Engine engine(config, sink.callback());
+  Miner::JobPipeline pipeline(engine);
+
+  for (uint64_t id = 1; id <= 20; ++id) {
+    pipeline.submit(slowBuilder(id));
+  }
+  pipeline.flush();
+
+  EXPECT_EQ(pipeline.getPublishedCount() + pipeline.getDroppedCount(), 20);
+  EXPECT_GT(pipeline.getDroppedCount(), 0);
+  ASSERT_TRUE(waitFor([&] {
+    return engine.getSwitchedEpoch() == pipeline.getPublishedCount();
+  }));
+}
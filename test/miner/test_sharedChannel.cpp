@@ -0,0 +1,289 @@
+// system includes
+#include <algorithm>
+#include <chrono>
+#include <csignal>
+#include <cstdint>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <sys/wait.h>
+#include <system_error>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+// Google Test includes
+#include <gtest/gtest.h>
+
+// project includes
+#include "block/blockHeader.h"
+#include "block/packedHeader.h"
+#include "miner/engine.h"
+#include "miner/sharedChannel.h"
+#include "sha256/sha256.h"
+#include "types/uint256.h"
+
+using Role = Miner::SharedChannel::Role;
+
+// A segment name no other test process uses
+static std::string segmentName(const std::string &test) {
+  return "/hfm-test-" + test + "-" + std::to_string(::getpid());
+}
+
+static Block::PackedHeader makeHeader(uint32_t seed) {
+  Block::PackedHeader header;
+  header.setVersion(0x20000000 | seed);
+  header.setPrevBlockHash(Hash{static_cast<uint8_t>(seed)});
+  header.setMerkleRoot(Hash{0x5a, static_cast<uint8_t>(seed >> 8)});
+  header.setTimestamp(1700000000 + seed);
+  header.setBits(0x1d00ffff);
+  return header;
+}
+
+// Test job contents, the midstate and cursors of independent readers
+TEST(SharedChannelTEST, Jobs) {
+  Miner::SharedChannelConfig config;
+  config.jobSlots = 4;
+  Miner::SharedChannel owner(segmentName("jobs"), Role::Owner, config);
+  Miner::SharedChannel peer(segmentName("jobs"), Role::Peer);
+
+  uint64_t first = 0;
+  uint64_t second = 0;
+  Miner::SharedJob job;
+  EXPECT_FALSE(peer.readJob(first, job));
+
+  const Block::PackedHeader header = makeHeader(1);
+  const uint256 target(0xffff);
+  EXPECT_EQ(owner.publishJob(7, 42, header, target), 0u);
+  ASSERT_TRUE(peer.readJob(first, job));
+  EXPECT_EQ(first, 1u);
+  EXPECT_EQ(job.id, 7u);
+  EXPECT_EQ(job.extranonce, 42u);
+  EXPECT_TRUE(std::equal(job.header.data(), job.header.data() + 80,
+                         header.data()));
+  EXPECT_EQ(job.target, target);
+  EXPECT_FALSE(peer.readJob(first, job));
+
+  // Finishing from the midstate gives the header's hash
+  SHA256::SHA256::Context context = job.getMidstate();
+  job.header.setNonce(12345);
+  SHA256::SHA256::append(context, job.header.data() + 64, 16);
+  Hash single;
+  SHA256::SHA256::finalize_bytes(context, single.data());
+  Hash hash;
+  SHA256::SHA256::bytes(single.data(), single.size(), hash.data());
+  EXPECT_EQ(hash, Block::BlockHeader(job.header).calculateBlockHash());
+
+  // A lapped reader skips to the newest job; the other one is not moved
+  for (uint32_t i = 2; i <= 9; ++i) {
+    owner.publishJob(i, 0, makeHeader(i), target);
+  }
+  EXPECT_EQ(owner.getJobCount(), 9u);
+  ASSERT_TRUE(peer.readJob(first, job));
+  EXPECT_EQ(job.id, 9u);
+  EXPECT_EQ(first, 9u);
+  EXPECT_EQ(job.header.getTimestamp(), 1700000009u);
+  ASSERT_TRUE(owner.readJob(second, job));
+  EXPECT_EQ(job.id, 9u);
+
+  // Nobody slept, so no wake syscall was made
+  EXPECT_EQ(owner.getWakeCount(), 0u);
+  EXPECT_FALSE(peer.waitJob(first, job, std::chrono::microseconds(1000)));
+}
+
+// Test a full result ring and result order
+TEST(SharedChannelTEST, Results) {
+  Miner::SharedChannelConfig config;
+  config.resultSlots = 8;
+  Miner::SharedChannel owner(segmentName("results"), Role::Owner, config);
+  Miner::SharedChannel peer(segmentName("results"), Role::Peer);
+
+  Miner::Share share;
+  EXPECT_FALSE(owner.popResult(share));
+  for (uint32_t round = 0; round < 3; ++round) {
+    for (uint32_t i = 0; i < 8; ++i) {
+      share.nonce = round * 8 + i;
+      EXPECT_TRUE(peer.pushResult(share));
+    }
+    EXPECT_FALSE(peer.pushResult(share));
+    for (uint32_t i = 0; i < 8; ++i) {
+      ASSERT_TRUE(owner.popResult(share));
+      EXPECT_EQ(share.nonce, round * 8 + i);
+    }
+    EXPECT_FALSE(owner.popResult(share));
+  }
+}
+
+// Test concurrent result producers; each producer's results stay in order
+TEST(SharedChannelTEST, Producers) {
+  Miner::SharedChannelConfig config;
+  config.resultSlots = 64;
+  config.spinCount = 64;
+  Miner::SharedChannel owner(segmentName("producers"), Role::Owner, config);
+
+  constexpr uint32_t PRODUCERS = 4;
+  constexpr uint32_t SHARES = 20000;
+  std::vector<std::thread> producers;
+  for (uint32_t p = 0; p < PRODUCERS; ++p) {
+    producers.emplace_back([&owner, p] {
+      Miner::Share share;
+      share.jobId = p;
+      for (uint32_t i = 0; i < SHARES; ++i) {
+        share.nonce = i;
+        while (!owner.pushResult(share)) {
+          std::this_thread::yield();
+        }
+      }
+    });
+  }
+
+  std::vector<uint32_t> next(PRODUCERS, 0);
+  Miner::Share share;
+  for (uint32_t i = 0; i < PRODUCERS * SHARES; ++i) {
+    ASSERT_TRUE(owner.waitResult(share, std::chrono::seconds(5)));
+    ASSERT_LT(share.jobId, PRODUCERS);
+    ASSERT_EQ(share.nonce, next[share.jobId]++);
+  }
+  for (std::thread &producer : producers) {
+    producer.join();
+  }
+  EXPECT_FALSE(owner.popResult(share));
+}
+
+// A hashing process: answers every job with a share until the channel
+// closes
+static int runWorker(const std::string &name, uint32_t worker) {
+  try {
+    Miner::SharedChannelConfig config;
+    config.spinCount = 256;
+    Miner::SharedChannel channel(name, Role::Peer, config);
+    uint64_t cursor = 0;
+    Miner::SharedJob job;
+    while (channel.waitJob(cursor, job, std::chrono::microseconds(-1))) {
+      Miner::Share share;
+      share.jobId = job.id;
+      share.nonce = worker;
+      share.timestamp = job.header.getTimestamp();
+      while (!channel.pushResult(share)) {
+        ::usleep(100);
+      }
+    }
+    return channel.isClosed() ? 0 : 2;
+  } catch (...) {
+    return 1;
+  }
+}
+
+// Test jobs and shares crossing process boundaries, and closing
+TEST(SharedChannelTEST, Processes) {
+  const std::string name = segmentName("processes");
+  Miner::SharedChannelConfig config;
+  config.spinCount = 256;
+  auto owner =
+      std::make_unique<Miner::SharedChannel>(name, Role::Owner, config);
+
+  constexpr uint32_t WORKERS = 3;
+  constexpr uint32_t JOBS = 200;
+  std::vector<pid_t> children;
+  for (uint32_t w = 0; w < WORKERS; ++w) {
+    const pid_t pid = ::fork();
+    ASSERT_GE(pid, 0);
+    if (pid == 0) {
+      ::_exit(runWorker(name, w));
+    }
+    children.push_back(pid);
+  }
+
+  // Each job is answered by every worker before the next is published
+  for (uint32_t job = 1; job <= JOBS; ++job) {
+    owner->publishJob(job, 0, makeHeader(job), uint256(1));
+    uint32_t answered = 0;
+    Miner::Share share;
+    for (uint32_t i = 0; i < WORKERS; ++i) {
+      ASSERT_TRUE(owner->waitResult(share, std::chrono::seconds(5)));
+      EXPECT_EQ(share.jobId, job);
+      EXPECT_EQ(share.timestamp, 1700000000 + job);
+      answered |= 1u << share.nonce;
+    }
+    EXPECT_EQ(answered, (1u << WORKERS) - 1);
+  }
+
+  // Destroying the owner closes the channel and ends the workers
+  owner.reset();
+  for (const pid_t pid : children) {
+    int status = 0;
+    ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+    EXPECT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+  }
+}
+
+// Whether a process is asleep, per /proc/<pid>/stat
+static bool isSleeping(pid_t pid) {
+  std::ifstream stat("/proc/" + std::to_string(pid) + "/stat");
+  std::string line;
+  std::getline(stat, line);
+  const size_t end = line.rfind(')');
+  return end != std::string::npos && end + 2 < line.size() &&
+         line[end + 2] == 'S';
+}
+
+// Test that a reader killed while asleep stops costing wake syscalls
+TEST(SharedChannelTEST, DeadWaiter) {
+  const std::string name = segmentName("dead");
+  Miner::SharedChannelConfig config;
+  config.spinCount = 0;
+  Miner::SharedChannel owner(name, Role::Owner, config);
+
+  const pid_t pid = ::fork();
+  ASSERT_GE(pid, 0);
+  if (pid == 0) {
+    Miner::SharedChannel peer(name, Role::Peer, config);
+    uint64_t cursor = 0;
+    Miner::SharedJob job;
+    peer.waitJob(cursor, job, std::chrono::microseconds(-1));
+    ::_exit(0);
+  }
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (!isSleeping(pid) && std::chrono::steady_clock::now() < deadline) {
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  std::this_thread::sleep_for(std::chrono::milliseconds(20));
+  ::kill(pid, SIGKILL);
+  int status = 0;
+  ASSERT_EQ(::waitpid(pid, &status, 0), pid);
+  ASSERT_TRUE(WIFSIGNALED(status));
+
+  // The first job finds nobody asleep and takes the dead waiter back
+  owner.publishJob(1, 0, makeHeader(1), uint256(1));
+  EXPECT_EQ(owner.getWakeCount(), 1u);
+  for (uint32_t job = 2; job <= 10; ++job) {
+    owner.publishJob(job, 0, makeHeader(job), uint256(1));
+  }
+  EXPECT_EQ(owner.getWakeCount(), 1u);
+
+  // A new reader can still be woken
+  std::thread reader([&name, &config] {
+    Miner::SharedChannel peer(name, Role::Peer, config);
+    uint64_t cursor = 10;
+    Miner::SharedJob job;
+    EXPECT_TRUE(peer.waitJob(cursor, job, std::chrono::seconds(5)));
+    EXPECT_EQ(job.id, 11u);
+  });
+  std::this_thread::sleep_for(std::chrono::milliseconds(50));
+  owner.publishJob(11, 0, makeHeader(11), uint256(1));
+  reader.join();
+}
+
+// Test invalid sizes and attaching to a missing segment
+TEST(SharedChannelTEST, InvalidConfig) {
+  Miner::SharedChannelConfig config;
+  config.jobSlots = 12;
+  EXPECT_THROW(
+      Miner::SharedChannel(segmentName("invalid"), Role::Owner, config),
+      std::invalid_argument);
+  EXPECT_THROW(Miner::SharedChannel(segmentName("missing"), Role::Peer),
+               std::system_error);
+}
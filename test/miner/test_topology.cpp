@@ -0,0 +1,168 @@
+// system includes
+#include <filesystem>
+#include <fstream>
+#include <set>
+#include <string>
+#include <vector>
+
+// Google Test includes
+#include <gtest/gtest.h>
+
+// project includes
+#include "miner/topology.h"
+
+// A throwaway sysfs/cgroup tree under the temp directory
+class FakeSysfs {
+public:
+  explicit FakeSysfs(const std::string &name)
+      : mRoot(std::filesystem::temp_directory_path() / name) {
+    std::filesystem::remove_all(mRoot);
+  }
+  ~FakeSysfs() { std::filesystem::remove_all(mRoot); }
+
+  void write(const std::string &path, const std::string &content) {
+    const std::filesystem::path file = mRoot / path;
+    std::filesystem::create_directories(file.parent_path());
+    std::ofstream(file) << content << "\n";
+  }
+
+  // Two packages, two cores each, two SMT threads per core; package N is
+  // NUMA node N. Linux numbers the first thread of every core first.
+  void writeTwoSocketHost() {
+    write("sys/devices/system/cpu/online", "0-7");
+    const int packages[8] = {0, 0, 1, 1, 0, 0, 1, 1};
+    const int cores[8] = {0, 1, 0, 1, 0, 1, 0, 1};
+    for (int cpu = 0; cpu < 8; ++cpu) {
+      const std::string base =
+          "sys/devices/system/cpu/cpu" + std::to_string(cpu) + "/topology/";
+      write(base + "physical_package_id", std::to_string(packages[cpu]));
+      write(base + "core_id", std::to_string(cores[cpu]));
+    }
+    write("sys/devices/system/node/node0/cpulist", "0-1,4-5");
+    write("sys/devices/system/node/node1/cpulist", "2-3,6-7");
+  }
+
+  std::string root() const { return mRoot.string(); }
+
+private:
+  std::filesystem::path mRoot;
+};
+
+TEST(TopologyTEST, ParseCpuList) {
+  EXPECT_EQ(Miner::Topology::parseCpuList("0-3,8,10-11"),
+            (std::vector<unsigned int>{0, 1, 2, 3, 8, 10, 11}));
+  EXPECT_EQ(Miner::Topology::parseCpuList("5"),
+            (std::vector<unsigned int>{5}));
+  EXPECT_TRUE(Miner::Topology::parseCpuList("").empty());
+  EXPECT_TRUE(Miner::Topology::parseCpuList("3-1").empty());
+  EXPECT_TRUE(Miner::Topology::parseCpuList("a-b").empty());
+}
+
+TEST(TopologyTEST, ReadsSysfsTopology) {
+  FakeSysfs sysfs("hfm_topology_sysfs");
+  sysfs.writeTwoSocketHost();
+
+  const Miner::Topology topology = Miner::Topology::detect(sysfs.root());
+  ASSERT_EQ(topology.getCpus().size(), 8u);
+  EXPECT_FALSE(topology.getCpuQuota().has_value());
+  EXPECT_EQ(topology.getDefaultThreadCount(), 8u);
+
+  const Miner::CpuInfo &cpu6 = topology.getCpus()[6];
+  EXPECT_EQ(cpu6.id, 6u);
+  EXPECT_EQ(cpu6.package, 1);
+  EXPECT_EQ(cpu6.core, 0);
+  EXPECT_EQ(cpu6.node, 1);
+}
+
+TEST(TopologyTEST, PlacementPrefersPhysicalCores) {
+  FakeSysfs sysfs("hfm_topology_placement");
+  sysfs.writeTwoSocketHost();
+  const Miner::Topology topology = Miner::Topology::detect(sysfs.root());
+
+  // The first four workers land on four distinct physical cores
+  const std::vector<Miner::CpuInfo> four = topology.placement(4);
+  ASSERT_EQ(four.size(), 4u);
+  std::set<std::pair<int, int>> cores;
+  for (const Miner::CpuInfo &cpu : four) {
+    cores.emplace(cpu.package, cpu.core);
+  }
+  EXPECT_EQ(cores.size(), 4u);
+  EXPECT_EQ(four[0].id, 0u);
+  EXPECT_EQ(four[1].id, 1u);
+  EXPECT_EQ(four[2].id, 2u);
+  EXPECT_EQ(four[3].id, 3u);
+
+  // Eight workers use every CPU once; more wrap around
+  const std::vector<Miner::CpuInfo> eight = topology.placement(8);
+  std::set<unsigned int> ids;
+  for (const Miner::CpuInfo &cpu : eight) {
+    ids.insert(cpu.id);
+  }
+  EXPECT_EQ(ids.size(), 8u);
+  EXPECT_EQ(topology.placement(9)[8].id, eight[0].id);
+}
+
+TEST(TopologyTEST, CgroupV2CpusetAndQuota) {
+  FakeSysfs sysfs("hfm_topology_cgroup_v2");
+  sysfs.writeTwoSocketHost();
+  sysfs.write("sys/fs/cgroup/cpuset.cpus.effective", "2-3,6-7");
+  sysfs.write("sys/fs/cgroup/cpu.max", "250000 100000");
+
+  const Miner::Topology topology = Miner::Topology::detect(sysfs.root());
+  ASSERT_EQ(topology.getCpus().size(), 4u);
+  EXPECT_EQ(topology.getCpus()[0].id, 2u);
+  ASSERT_TRUE(topology.getCpuQuota().has_value());
+  EXPECT_DOUBLE_EQ(*topology.getCpuQuota(), 2.5);
+  // A 2.5 CPU quota runs two workers rather than four throttled ones
+  EXPECT_EQ(topology.getDefaultThreadCount(), 2u);
+
+  sysfs.write("sys/fs/cgroup/cpu.max", "max 100000");
+  EXPECT_FALSE(
+      Miner::Topology::detect(sysfs.root()).getCpuQuota().has_value());
+}
+
+// The quota comes from the process's own cgroup or the tightest ancestor
+TEST(TopologyTEST, CgroupV2NestedQuota) {
+  FakeSysfs sysfs("hfm_topology_cgroup_nested");
+  sysfs.writeTwoSocketHost();
+  sysfs.write("proc/self/cgroup", "0::/miners.slice/hfm.scope");
+  sysfs.write("sys/fs/cgroup/miners.slice/cpu.max", "max 100000");
+  sysfs.write("sys/fs/cgroup/miners.slice/hfm.scope/cpu.max",
+              "150000 100000");
+
+  ASSERT_TRUE(
+      Miner::Topology::detect(sysfs.root()).getCpuQuota().has_value());
+  EXPECT_DOUBLE_EQ(*Miner::Topology::detect(sysfs.root()).getCpuQuota(),
+                   1.5);
+
+  sysfs.write("sys/fs/cgroup/miners.slice/cpu.max", "100000 100000");
+  EXPECT_DOUBLE_EQ(*Miner::Topology::detect(sysfs.root()).getCpuQuota(),
+                   1.0);
+
+  // Without a limit on the way the root file still counts
+  sysfs.write("sys/fs/cgroup/miners.slice/cpu.max", "max 100000");
+  sysfs.write("sys/fs/cgroup/miners.slice/hfm.scope/cpu.max", "max 100000");
+  sysfs.write("sys/fs/cgroup/cpu.max", "300000 100000");
+  EXPECT_DOUBLE_EQ(*Miner::Topology::detect(sysfs.root()).getCpuQuota(),
+                   3.0);
+}
+
+TEST(TopologyTEST, CgroupV1Quota) {
+  FakeSysfs sysfs("hfm_topology_cgroup_v1");
+  sysfs.writeTwoSocketHost();
+  sysfs.write("sys/fs/cgroup/cpu/cpu.cfs_quota_us", "50000");
+  sysfs.write("sys/fs/cgroup/cpu/cpu.cfs_period_us", "100000");
+
+  const Miner::Topology topology = Miner::Topology::detect(sysfs.root());
+  ASSERT_TRUE(topology.getCpuQuota().has_value());
+  EXPECT_DOUBLE_EQ(*topology.getCpuQuota(), 0.5);
+  // A fractional quota still runs one worker
+  EXPECT_EQ(topology.getDefaultThreadCount(), 1u);
+}
+
+TEST(TopologyTEST, DetectsRunningSystem) {
+  const Miner::Topology topology = Miner::Topology::detect();
+  EXPECT_FALSE(topology.getCpus().empty());
+  EXPECT_GE(topology.getDefaultThreadCount(), 1u);
+  EXPECT_LE(topology.getDefaultThreadCount(), topology.getCpus().size());
+}
@@ -0,0 +1,119 @@
+#ifndef __HTTP_STAND_IN_H__
+#define __HTTP_STAND_IN_H__
+
+// system includes
+#include <arpa/inet.h>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <netinet/in.h>
+#include <poll.h>
+#include <stdexcept>
+#include <string>
+#include <sys/socket.h>
+#include <thread>
+#include <unistd.h>
+
+/// \brief Loopback HTTP server standing in for a node's RPC port.
+/// \note Answers every request with the same status and body, then closes
+/// the connection, and keeps the last request for inspection. Test-only.
+class HttpStandIn {
+public:
+  HttpStandIn(int status, std::string body)
+      : mStatus(status), mBody(std::move(body)), mListener(-1), mPort(0),
+        mStop(false) {
+    mListener = ::socket(AF_INET, SOCK_STREAM, 0);
+    sockaddr_in address{};
+    address.sin_family = AF_INET;
+    address.sin_addr.s_addr = htonl(INADDR_LOOPBACK);
+    socklen_t length = sizeof(address);
+    if (mListener < 0 ||
+        ::bind(mListener, reinterpret_cast<sockaddr *>(&address), length) !=
+            0 ||
+        ::listen(mListener, 16) != 0 ||
+        ::getsockname(mListener, reinterpret_cast<sockaddr *>(&address),
+                      &length) != 0) {
+      throw std::runtime_error("Cannot start HTTP stand-in");
+    }
+    mPort = ntohs(address.sin_port);
+    mThread = std::thread([this] { serve(); });
+  }
+
+  ~HttpStandIn() {
+    mStop = true;
+    mThread.join();
+    ::close(mListener);
+  }
+
+  uint16_t getPort() const { return mPort; }
+
+  std::string getLastRequest() const {
+    std::lock_guard<std::mutex> lock(mMutex);
+    return mLastRequest;
+  }
+
+private:
+  void serve() {
+    while (!mStop) {
+      pollfd listener{mListener, POLLIN, 0};
+      if (::poll(&listener, 1, 20) <= 0) {
+        continue;
+      }
+      const int fd = ::accept(mListener, nullptr, nullptr);
+      if (fd < 0) {
+        continue;
+      }
+      std::string request = readRequest(fd);
+      {
+        std::lock_guard<std::mutex> lock(mMutex);
+        mLastRequest = std::move(request);
+      }
+      const std::string response =
+          "HTTP/1.1 " + std::to_string(mStatus) +
+          " Stand-in\r\nContent-Type: application/json\r\nContent-Length: " +
+          std::to_string(mBody.size()) + "\r\nConnection: close\r\n\r\n" +
+          mBody;
+      for (size_t sent = 0; sent < response.size();) {
+        const ssize_t n = ::send(fd, response.data() + sent,
+                                 response.size() - sent, MSG_NOSIGNAL);
+        if (n <= 0) {
+          break;
+        }
+        sent += static_cast<size_t>(n);
+      }
+      ::close(fd);
+    }
+  }
+
+  // Headers, then Content-Length bytes of body
+  static std::string readRequest(int fd) {
+    std::string request;
+    char buffer[4096];
+    size_t expected = std::string::npos;
+    while (request.size() < expected) {
+      const ssize_t n = ::recv(fd, buffer, sizeof(buffer), 0);
+      if (n <= 0) {
+        break;
+      }
+      request.append(buffer, static_cast<size_t>(n));
+      const size_t end = request.find("\r\n\r\n");
+      const size_t length = request.find("Content-Length: ");
+      if (end != std::string::npos && length != std::string::npos &&
+          length < end) {
+        expected = end + 4 + std::stoul(request.substr(length + 16));
+      }
+    }
+    return request;
+  }
+
+  int mStatus;
+  std::string mBody;
+  int mListener;
+  uint16_t mPort;
+  std::atomic<bool> mStop;
+  std::thread mThread;
+  mutable std::mutex mMutex;
+  std::string mLastRequest;
+};
+
+#endif // __HTTP_STAND_IN_H__
@@ -0,0 +1,96 @@
+// system includes
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <iterator>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+
+// Google Test includes
+#include <gtest/gtest.h>
+
+// project includes
+#include "block/blockTemplate.h"
+#include "httpStandIn.h"
+#include "net/rpcClient.h"
+
+// The recorded templates of the block tests
+static std::string readTemplateFile(const std::string &name) {
+  const std::filesystem::path path =
+      std::filesystem::path(__FILE__).parent_path().parent_path() / "block" /
+      "data" / name;
+  std::ifstream file(path, std::ios::binary);
+  EXPECT_TRUE(file) << path;
+  return std::string((std::istreambuf_iterator<char>(file)),
+                     std::istreambuf_iterator<char>());
+}
+
+static Net::RpcConfig standInConfig(const HttpStandIn &server) {
+  Net::RpcConfig config;
+  config.port = server.getPort();
+  config.user = "miner";
+  config.password = "secret";
+  config.timeout = std::chrono::milliseconds(2000);
+  return config;
+}
+
+// Test fetching and parsing a template served over HTTP
+TEST(RpcClientTEST, GetBlockTemplate) {
+  const std::string result = readTemplateFile("getblocktemplate_regtest.json");
+  HttpStandIn server(200, "{\"result\": " + result +
+                              ", \"error\": null, \"id\": 1}\n");
+  Net::RpcClient client(standInConfig(server));
+  Block::BlockTemplateParser parser;
+
+  const Block::BlockTemplate &gbt = client.getBlockTemplate(parser);
+  EXPECT_EQ(gbt.height, 205u);
+  EXPECT_EQ(gbt.transactions.size(), 3u);
+
+  const std::string request = server.getLastRequest();
+  EXPECT_EQ(request.rfind("POST / HTTP/1.1\r\n", 0), 0u);
+  // base64("miner:secret")
+  EXPECT_NE(request.find("\r\nAuthorization: Basic bWluZXI6c2VjcmV0\r\n"),
+            std::string::npos);
+  const size_t body = request.find("\r\n\r\n") + 4;
+  EXPECT_EQ(request.substr(body),
+            R"({"jsonrpc": "1.0", "id": 1, "method": "getblocktemplate", )"
+            R"("params": [{"rules": ["segwit"]}]})");
+
+  // Buffers are reused by the next call
+  EXPECT_EQ(client.getBlockTemplate(parser).height, 205u);
+  EXPECT_NE(server.getLastRequest().find("\"id\": 2,"), std::string::npos);
+}
+
+// Test the HTTP statuses a node answers with
+TEST(RpcClientTEST, Statuses) {
+  {
+    // JSON-RPC errors come with status 500 and reach the parser
+    HttpStandIn server(500, R"({"result": null, "error": {"code": -9, )"
+                            R"("message": "Bitcoin Core is not connected!"}, )"
+                            R"("id": 1})");
+    Net::RpcClient client(standInConfig(server));
+    Block::BlockTemplateParser parser;
+    EXPECT_THROW(client.getBlockTemplate(parser), std::runtime_error);
+    EXPECT_NE(client.call("getblockcount").find("not connected"),
+              std::string_view::npos);
+  }
+  {
+    HttpStandIn server(401, "");
+    Net::RpcClient client(standInConfig(server));
+    EXPECT_THROW(client.call("getblockcount"), std::runtime_error);
+  }
+}
+
+// Test that a closed port is reported as a socket error
+TEST(RpcClientTEST, ConnectionRefused) {
+  uint16_t port = 0;
+  {
+    HttpStandIn server(200, "{}");
+    port = server.getPort();
+  }
+  Net::RpcConfig config;
+  config.port = port;
+  Net::RpcClient client(config);
+  EXPECT_THROW(client.call("getblockcount"), std::system_error);
+}
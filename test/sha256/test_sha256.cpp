@@ -377,4 +377,110 @@ TEST(SHA256_Functions, Sha256Hex_LargeInput) {
     char c = output[i];
     EXPECT_TRUE((c >= '0' && c <= '9') || (c >= 'a' && c <= 'f'));
   }
-}
\ No newline at end of file
+}
+
+// Test the batch kernel against two one-shot hashes, across full lane
+// groups and tails hashed one by one or padded into a batch
+TEST(SHA256_Batch, Double80_MatchesOneShot) {
+  for (size_t count : {size_t{0}, size_t{1}, SHA256::SHA256::LANES - 1,
+                       SHA256::SHA256::LANES, SHA256::SHA256::LANES + 3,
+                       SHA256::SHA256::LANES * 3 / 2, size_t{100}}) {
+    std::vector<uint8_t> input(count * 80);
+    for (size_t i = 0; i < input.size(); ++i) {
+      input[i] = static_cast<uint8_t>(i * 31 + 7);
+    }
+    std::vector<uint8_t> batch(count * 32);
+    SHA256::sha256d_80_bytes(input.data(), count, batch.data());
+
+    for (size_t m = 0; m < count; ++m) {
+      uint8_t first[32];
+      uint8_t expected[32];
+      SHA256::sha256_bytes(input.data() + m * 80, 80, first);
+      SHA256::sha256_bytes(first, 32, expected);
+      EXPECT_EQ(std::memcmp(batch.data() + m * 32, expected, 32), 0)
+          << "message " << m << " of " << count;
+    }
+  }
+}
+
+// Test the batch kernel on the genesis block header
+TEST(SHA256_Batch, Double80_GenesisHeader) {
+  const std::string header_hex =
+      "0100000000000000000000000000000000000000000000000000000000000000"
+      "000000003ba3edfd7a7b12b27ac72c3e67768f617fc81bc3888a51323a9fb8aa"
+      "4b1e5e4a29ab5f49ffff001d1dac2b7c";
+  std::vector<uint8_t> header;
+  for (size_t i = 0; i < header_hex.size(); i += 2) {
+    header.push_back(
+        static_cast<uint8_t>(std::stoul(header_hex.substr(i, 2), nullptr, 16)));
+  }
+  Hash hash;
+  SHA256::SHA256::double_bytes_80(header.data(), 1, hash.data());
+  // Stored little-endian: the displayed hash reversed
+  EXPECT_EQ(SHA256::hashArrayToString(hash),
+            "6fe28c0ab6f1b372c1a6a246ae63f74f931e8365e15a089c68d6190000000000");
+}
+
+// Test the variable-length batch kernel on every padding boundary, mixed
+// block counts, partial groups and messages past the batch limit
+TEST(SHA256_Batch, DoubleMany_MatchesOneShot) {
+  std::vector<size_t> lengths;
+  for (size_t len = 0; len <= 130; ++len) {
+    lengths.push_back(len);
+  }
+  lengths.push_back(SHA256::SHA256::BATCH_MAX_BLOCKS * 64 - 9);
+  lengths.push_back(SHA256::SHA256::BATCH_MAX_BLOCKS * 64 - 8);
+  lengths.push_back(1000);
+
+  std::vector<std::vector<uint8_t>> messages;
+  for (size_t len : lengths) {
+    std::vector<uint8_t> message(len);
+    for (size_t i = 0; i < len; ++i) {
+      message[i] = static_cast<uint8_t>(i * 13 + len);
+    }
+    messages.push_back(std::move(message));
+  }
+
+  std::vector<const void *> src;
+  std::vector<size_t> n_bytes;
+  std::vector<Hash> batch(messages.size());
+  std::vector<void *> dst;
+  for (size_t m = 0; m < messages.size(); ++m) {
+    src.push_back(messages[m].data());
+    n_bytes.push_back(messages[m].size());
+    dst.push_back(batch[m].data());
+  }
+  SHA256::SHA256::double_bytes_many(src.data(), n_bytes.data(), src.size(),
+                                    dst.data());
+
+  for (size_t m = 0; m < messages.size(); ++m) {
+    Hash first;
+    Hash expected;
+    SHA256::sha256_bytes(messages[m].data(), messages[m].size(), first.data());
+    SHA256::sha256_bytes(first.data(), first.size(), expected.data());
+    EXPECT_EQ(batch[m], expected) << "length " << messages[m].size();
+  }
+}
+
+// Test that appending in uneven pieces matches a one-shot hash
+TEST(SHA256_Context, AppendPiecesMatchesOneShot) {
+  std::vector<uint8_t> input(300);
+  for (size_t i = 0; i < input.size(); ++i) {
+    input[i] = static_cast<uint8_t>(i);
+  }
+  Hash expected;
+  SHA256::sha256_bytes(input.data(), input.size(), expected.data());
+
+  for (size_t piece : {size_t{1}, size_t{7}, size_t{63}, size_t{64},
+                       size_t{65}, size_t{200}}) {
+    SHA256::sha256 ctx;
+    SHA256::sha256_init(&ctx);
+    for (size_t i = 0; i < input.size(); i += piece) {
+      SHA256::sha256_append(&ctx, input.data() + i,
+                            std::min(piece, input.size() - i));
+    }
+    Hash hash;
+    SHA256::sha256_finalize_bytes(&ctx, hash.data());
+    EXPECT_EQ(hash, expected) << "piece " << piece;
+  }
+}
@@ -0,0 +1,250 @@
+// system includes
+#include <chrono>
+#include <cstdint>
+#include <optional>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+// Google Test includes
+#include <gtest/gtest.h>
+
+// project includes
+#include "block/miningJob.h"
+#include "stratum/client.h"
+#include "stratum/mockPool.h"
+#include "stratum/notify.h"
+
+static const std::string SUBSCRIBED =
+    R"([[["mining.set_difficulty","1"],["mining.notify","1"]],"08000002",4])";
+
+static const std::string NOTIFY =
+    R"({"id":null,"method":"mining.notify","params":["job7",)"
+    R"("4d16b6f85af6e2198f44ae2a6de67f78487ae5611b77c6c0440b921e00000000",)"
+    R"("01000000010000000000000000000000000000000000000000000000000000000000)"
+    R"(000000ffffffff20020862062f503253482f04b8864e5008",)"
+    R"("072f736c7573682f000000000100f2052a010000001976a914d23fcdf86f7e756a64a7)"
+    R"(a9688ef9903327048ed988ac00000000",)"
+    R"(["aaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaaa"],)"
+    R"("20000000","1c2ac4af","504e86b9",true]})";
+
+static Stratum::ClientConfig poolConfig(const Stratum::MockPool &pool) {
+  Stratum::ClientConfig config;
+  config.port = pool.getPort();
+  config.user = "worker.1";
+  config.timeout = std::chrono::milliseconds(5000);
+  return config;
+}
+
+// Poll until a condition holds
+template <typename Condition>
+static void pollUntil(Stratum::Client &client, Condition condition) {
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (!condition() && std::chrono::steady_clock::now() < deadline) {
+    client.poll(std::chrono::milliseconds(50));
+  }
+}
+
+// Test the handshake, a job, a share and its result
+TEST(ClientTEST, MiningSession) {
+  Stratum::MockPool pool;
+  std::string authorize_params;
+  std::string submit_params;
+  std::thread server([&] {
+    pool.accept();
+    pool.reply(pool.expect("mining.configure"),
+               R"({"version-rolling":true,"version-rolling.mask":"1fffe000"})");
+    pool.reply(pool.expect("mining.subscribe"), SUBSCRIBED);
+    const Stratum::MockPool::Request authorize =
+        pool.expect("mining.authorize");
+    authorize_params = authorize.params;
+    pool.reply(authorize, "true");
+    pool.send(R"({"id":null,"method":"mining.set_difficulty","params":[0.5]})");
+    pool.send(NOTIFY);
+    const Stratum::MockPool::Request submit = pool.expect("mining.submit");
+    submit_params = submit.params;
+    pool.reply(submit, "true");
+    pool.close();
+  });
+
+  Stratum::Client client(poolConfig(pool));
+  std::vector<std::string> job_ids;
+  std::optional<Hash> root;
+  client.setJobHandler(
+      [&](const Stratum::Notify &notify, const Block::MiningJob &job) {
+        job_ids.push_back(notify.jobId);
+        const uint8_t extranonce2[] = {0, 0, 0, 1};
+        root = job.computeMerkleRoot(extranonce2);
+        EXPECT_EQ(job.getHeader().getVersion(), 0x20000000u);
+        EXPECT_EQ(job.getMerkleBranch().size(), 1u);
+      });
+  std::vector<Stratum::SubmitResult> results;
+  client.setResultHandler([&](const Stratum::SubmitResult &result) {
+    results.push_back(result);
+  });
+
+  client.connect();
+  EXPECT_TRUE(client.isConnected());
+  EXPECT_EQ(client.getExtranonce2Size(), 4u);
+  ASSERT_EQ(client.getExtranonce1().size(), 4u);
+  EXPECT_EQ(client.getExtranonce1()[3], 0x02);
+  EXPECT_EQ(client.getVersionMask(), 0x1fffe000u);
+
+  pollUntil(client, [&] { return !job_ids.empty(); });
+  ASSERT_EQ(job_ids, std::vector<std::string>{"job7"});
+  EXPECT_EQ(client.getDifficulty(), 0.5);
+
+  // The root is the coinbase txid folded with the branch
+  Block::MiningJob expected;
+  Stratum::Notify notify;
+  const std::string params = NOTIFY.substr(NOTIFY.find("[\"job7"));
+  ASSERT_TRUE(Stratum::parseNotify(params.substr(0, params.size() - 1),
+                                   notify));
+  const uint8_t extranonce1[] = {0x08, 0, 0, 0x02};
+  expected.set(notify.coinbase1, extranonce1, 4, notify.coinbase2,
+               notify.merkleBranch, notify.getHeader());
+  const uint8_t extranonce2[] = {0, 0, 0, 1};
+  EXPECT_EQ(root, expected.computeMerkleRoot(extranonce2));
+
+  const uint64_t id =
+      client.submit("job7", extranonce2, 0x504e86ba, 0xdeadbeef, 0x2000);
+  pollUntil(client, [&] { return !results.empty(); });
+  ASSERT_EQ(results.size(), 1u);
+  EXPECT_EQ(results[0].id, id);
+  EXPECT_TRUE(results[0].accepted);
+
+  // The pool hangs up
+  pollUntil(client, [&] { return !client.isConnected(); });
+  EXPECT_FALSE(client.poll(std::chrono::milliseconds(0)));
+  server.join();
+
+  EXPECT_EQ(authorize_params, R"(["worker.1","x"])");
+  EXPECT_EQ(submit_params, R"(["worker.1","job7","00000001","504e86ba",)"
+                           R"("deadbeef","00002000"])");
+}
+
+// Test that members may come in any order and that junk is skipped
+TEST(ClientTEST, LenientParsing) {
+  Stratum::MockPool pool;
+  std::thread server([&] {
+    pool.accept();
+    // A pool without version rolling
+    pool.reply(pool.expect("mining.configure"), "null",
+               R"([20, "Not supported", null])");
+    pool.reply(pool.expect("mining.subscribe"), SUBSCRIBED);
+    pool.reply(pool.expect("mining.authorize"), "true");
+    pool.send("not json");
+    pool.send(R"({"method":"client.show_message","params":["hello"]})");
+    const std::string params = NOTIFY.substr(NOTIFY.find("[\"job7"));
+    pool.send(R"({"params":)" + params.substr(0, params.size() - 1) +
+              R"(,"method":"mining.notify","id":null})");
+    pool.expect("mining.submit");
+  });
+
+  Stratum::Client client(poolConfig(pool));
+  int jobs = 0;
+  client.setJobHandler(
+      [&](const Stratum::Notify &, const Block::MiningJob &) { ++jobs; });
+  client.connect();
+  EXPECT_EQ(client.getVersionMask(), 0u);
+  pollUntil(client, [&] { return jobs > 0; });
+  EXPECT_EQ(jobs, 1);
+
+  const uint8_t extranonce2[] = {1, 2, 3, 4};
+  client.submit("job7", extranonce2, 0, 0);
+  // Shares leave when the loop next runs
+  client.poll(std::chrono::milliseconds(1000));
+  server.join();
+}
+
+// Test a refused worker and a closed port
+TEST(ClientTEST, Failures) {
+  {
+    Stratum::MockPool pool;
+    std::thread server([&] {
+      pool.accept();
+      pool.reply(pool.expect("mining.configure"), "{}");
+      pool.reply(pool.expect("mining.subscribe"), SUBSCRIBED);
+      pool.reply(pool.expect("mining.authorize"), "false");
+    });
+    Stratum::Client client(poolConfig(pool));
+    EXPECT_THROW(client.connect(), std::runtime_error);
+    EXPECT_FALSE(client.isConnected());
+    server.join();
+  }
+
+  uint16_t port = 0;
+  {
+    Stratum::MockPool pool;
+    port = pool.getPort();
+  }
+  Stratum::ClientConfig config;
+  config.port = port;
+  Stratum::Client client(config);
+  EXPECT_THROW(client.connect(), std::system_error);
+}
+
+// Test a session driven by a mock pool script
+TEST(ClientTEST, Script) {
+  Stratum::MockPool pool;
+  std::thread server([&] {
+    std::istringstream script(
+        "# handshake\n"
+        "accept\n"
+        "expect mining.subscribe\n"
+        "reply " +
+        SUBSCRIBED +
+        "\n"
+        "expect mining.authorize\n"
+        "reply true\n"
+        "\n"
+        "send " +
+        NOTIFY +
+        "\n"
+        "send {\"id\":null,\"method\":\"mining.set_version_mask\","
+        "\"params\":[\"00ffe000\"]}\n"
+        "expect mining.submit\n"
+        "error [23, \"Low difficulty share\", null]\n"
+        "sleep 10\n"
+        "close\n");
+    pool.runScript(script);
+  });
+
+  Stratum::ClientConfig config = poolConfig(pool);
+  config.versionRollingMask = 0;
+  Stratum::Client client(config);
+  std::string job_id;
+  client.setJobHandler(
+      [&](const Stratum::Notify &notify, const Block::MiningJob &) {
+        job_id = notify.jobId;
+      });
+  std::optional<Stratum::SubmitResult> result;
+  std::string error;
+  client.setResultHandler([&](const Stratum::SubmitResult &submitted) {
+    result = submitted;
+    error = submitted.error;
+  });
+  client.connect();
+  pollUntil(client, [&] { return client.getVersionMask() != 0; });
+  EXPECT_EQ(job_id, "job7");
+  EXPECT_EQ(client.getVersionMask(), 0x00ffe000u);
+
+  const uint8_t extranonce2[] = {0, 0, 0, 0};
+  client.submit(job_id, extranonce2, 1, 2);
+  pollUntil(client, [&] { return result.has_value(); });
+  ASSERT_TRUE(result);
+  EXPECT_FALSE(result->accepted);
+  EXPECT_NE(error.find("Low difficulty"), std::string::npos);
+
+  // stop() from another thread ends run()
+  std::thread stopper([&] { client.stop(); });
+  client.run();
+  stopper.join();
+  server.join();
+  std::istringstream bogus("bogus");
+  EXPECT_THROW(pool.runScript(bogus), std::invalid_argument);
+}
@@ -0,0 +1,130 @@
+// system includes
+#include <cstdint>
+#include <string>
+#include <string_view>
+
+// Google Test includes
+#include <gtest/gtest.h>
+
+// project includes
+#include "block/packedHeader.h"
+#include "stratum/notify.h"
+#include "types/types.h"
+
+// The example job from the original Stratum mining documentation
+static const std::string EXAMPLE =
+    R"(["bf", )"
+    R"("4d16b6f85af6e2198f44ae2a6de67f78487ae5611b77c6c0440b921e00000000",)"
+    R"( "01000000010000000000000000000000000000000000000000000000000000000000)"
+    R"(000000ffffffff20020862062f503253482f04b8864e5008",)"
+    R"( "072f736c7573682f000000000100f2052a010000001976a914d23fcdf86f7e756a)"
+    R"(64a7a9688ef9903327048ed988ac00000000", [], "00000002", "1c2ac4af",)"
+    R"( "504e86b9", false])";
+
+// Test decoding every field of a notification
+TEST(NotifyTEST, ParseExample) {
+  Stratum::Notify notify;
+  ASSERT_TRUE(Stratum::parseNotify(EXAMPLE, notify));
+  EXPECT_EQ(notify.jobId, "bf");
+  // Each word of the previous block hash is byte-reversed on the wire
+  EXPECT_EQ(notify.prevHash[0], 0xf8);
+  EXPECT_EQ(notify.prevHash[3], 0x4d);
+  EXPECT_EQ(notify.prevHash[4], 0x19);
+  EXPECT_EQ(notify.prevHash[27], 0x44);
+  EXPECT_EQ(notify.prevHash[31], 0x00);
+  EXPECT_EQ(notify.coinbase1.size(), 58u);
+  EXPECT_EQ(notify.coinbase2.size(), 51u);
+  EXPECT_EQ(notify.coinbase2[0], 0x07);
+  EXPECT_TRUE(notify.merkleBranch.empty());
+  EXPECT_EQ(notify.version, 2u);
+  EXPECT_EQ(notify.bits, 0x1c2ac4afu);
+  EXPECT_EQ(notify.time, 0x504e86b9u);
+  EXPECT_FALSE(notify.clean);
+
+  const Block::PackedHeader header = notify.getHeader();
+  EXPECT_EQ(header.getVersion(), 2u);
+  EXPECT_EQ(header.getBits(), 0x1c2ac4afu);
+  EXPECT_EQ(header.getPrevBlockHash(), notify.prevHash);
+}
+
+// Test that a second job reuses the buffers of the first
+TEST(NotifyTEST, ReusesBuffers) {
+  const std::string hash(64, 'a');
+  const std::string params = "[\"1\", \"" + hash + "\", \"00\", \"11\", [\"" +
+                             hash + "\", \"" + hash +
+                             "\"], \"20000000\", \"207fffff\", \"00000001\","
+                             " true, \"extra\", [1, 2]]";
+  Stratum::Notify notify;
+  ASSERT_TRUE(Stratum::parseNotify(EXAMPLE, notify));
+  ASSERT_TRUE(Stratum::parseNotify(params, notify));
+  EXPECT_EQ(notify.merkleBranch.size(), 2u);
+  EXPECT_EQ(notify.merkleBranch[1][31], 0xaa);
+  EXPECT_TRUE(notify.clean);
+
+  const uint8_t *coinbase1 = notify.coinbase1.data();
+  const Hash *branch = notify.merkleBranch.data();
+  ASSERT_TRUE(Stratum::parseNotify(params, notify));
+  EXPECT_EQ(notify.coinbase1.data(), coinbase1);
+  EXPECT_EQ(notify.merkleBranch.data(), branch);
+}
+
+// Test malformed notifications
+TEST(NotifyTEST, Rejects) {
+  Stratum::Notify notify;
+  EXPECT_FALSE(Stratum::parseNotify("{}", notify));
+  EXPECT_FALSE(Stratum::parseNotify("[\"1\"]", notify));
+  std::string bad = EXAMPLE;
+  size_t pos = bad.find("1c2ac4af");
+  ASSERT_NE(pos, std::string::npos);
+  bad.replace(pos, 8, "1c2ac4a");
+  EXPECT_FALSE(Stratum::parseNotify(bad, notify));
+  bad = EXAMPLE;
+  pos = bad.find("false");
+  ASSERT_NE(pos, std::string::npos);
+  bad.replace(pos, 5, "0");
+  EXPECT_FALSE(Stratum::parseNotify(bad, notify));
+}
+
+// Test that formatting and parsing a job round-trip
+TEST(NotifyTEST, Format) {
+  Stratum::Notify notify;
+  ASSERT_TRUE(Stratum::parseNotify(EXAMPLE, notify));
+  notify.jobId = "a\"b";
+  notify.merkleBranch.assign(2, Hash{});
+  notify.merkleBranch[1].fill(0xab);
+  notify.clean = true;
+
+  std::string line = "stale";
+  Stratum::formatNotify(notify, line);
+  ASSERT_EQ(line.back(), '\n');
+  const std::string prefix =
+      R"({"id":null,"method":"mining.notify","params":["a\"b",)"
+      R"("4d16b6f85af6e2198f44ae2a6de67f78487ae5611b77c6c0440b921e00000000",)";
+  EXPECT_EQ(line.substr(0, prefix.size()), prefix);
+
+  const size_t params = line.find('[');
+  Stratum::Notify parsed;
+  ASSERT_TRUE(Stratum::parseNotify(
+      std::string_view(line).substr(params, line.size() - params - 2),
+      parsed));
+  EXPECT_EQ(parsed.jobId, notify.jobId);
+  EXPECT_EQ(parsed.prevHash, notify.prevHash);
+  EXPECT_EQ(parsed.coinbase1, notify.coinbase1);
+  EXPECT_EQ(parsed.coinbase2, notify.coinbase2);
+  EXPECT_EQ(parsed.merkleBranch, notify.merkleBranch);
+  EXPECT_EQ(parsed.version, notify.version);
+  EXPECT_EQ(parsed.bits, notify.bits);
+  EXPECT_EQ(parsed.time, notify.time);
+  EXPECT_TRUE(parsed.clean);
+}
+
+// Test the 32-bit hex fields
+TEST(NotifyTEST, Hex32) {
+  uint32_t value = 0;
+  EXPECT_TRUE(Stratum::decodeHex32("1fffe000", value));
+  EXPECT_EQ(value, 0x1fffe000u);
+  EXPECT_FALSE(Stratum::decodeHex32("1fffe00", value));
+  char hex[8];
+  Stratum::encodeHex32(0x504e86b9, hex);
+  EXPECT_EQ(std::string(hex, 8), "504e86b9");
+}
@@ -0,0 +1,260 @@
+// system includes
+#include <chrono>
+#include <cstdint>
+#include <mutex>
+#include <set>
+#include <stdexcept>
+#include <string>
+#include <system_error>
+#include <thread>
+#include <vector>
+
+// Google Test includes
+#include <gtest/gtest.h>
+
+// project includes
+#include "block/miningJob.h"
+#include "stratum/client.h"
+#include "stratum/notify.h"
+#include "stratum/server.h"
+#include "stratum/swarm.h"
+#include "util/endian.h"
+
+static Stratum::ServerConfig localConfig() {
+  Stratum::ServerConfig config;
+  config.host = "127.0.0.1";
+  config.port = 0;
+  config.threads = 2;
+  return config;
+}
+
+// A job whose line is a little over twice coinbaseSize bytes
+static Stratum::Notify makeJob(const std::string &jobId, bool clean,
+                               size_t coinbaseSize = 100) {
+  Stratum::Notify notify;
+  notify.jobId = jobId;
+  notify.prevHash[0] = 0xaa;
+  notify.coinbase1.assign(coinbaseSize, 0x11);
+  notify.coinbase2.assign(40, 0x22);
+  notify.merkleBranch.assign(2, Hash{0x33});
+  notify.version = 0x20000000;
+  notify.bits = 0x1d00ffff;
+  notify.time = 1700000000;
+  notify.clean = clean;
+  return notify;
+}
+
+// Poll until a condition holds or five seconds pass
+template <typename Condition> static bool waitUntil(Condition condition) {
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (!condition()) {
+    if (std::chrono::steady_clock::now() > deadline) {
+      return false;
+    }
+    std::this_thread::sleep_for(std::chrono::milliseconds(1));
+  }
+  return true;
+}
+
+// Test a broadcast to a swarm and the extranonce1s handed out
+TEST(ServerTEST, Broadcast) {
+  Stratum::Server server(localConfig());
+  server.start();
+  Stratum::Swarm swarm("127.0.0.1", server.getPort(), 500);
+  EXPECT_EQ(server.getConnectionCount(), 500u);
+
+  std::set<uint32_t> extranonces;
+  for (size_t i = 0; i < swarm.size(); ++i) {
+    const std::span<const uint8_t> extranonce1 = swarm.getExtranonce1(i);
+    ASSERT_EQ(extranonce1.size(), 4u);
+    extranonces.insert(util::ReadBE32(extranonce1.data()));
+  }
+  EXPECT_EQ(extranonces.size(), swarm.size());
+
+  for (int i = 0; i < 3; ++i) {
+    const std::string job_id = "job" + std::to_string(i);
+    const auto start = std::chrono::steady_clock::now();
+    server.broadcast(makeJob(job_id, i == 0));
+    const std::vector<Stratum::Swarm::TimePoint> arrivals =
+        swarm.waitForJob(job_id, std::chrono::seconds(10));
+    for (const Stratum::Swarm::TimePoint arrival : arrivals) {
+      ASSERT_GE(arrival, start);
+    }
+  }
+  ASSERT_TRUE(
+      waitUntil([&] { return server.getBroadcastStats().broadcasts == 3; }));
+  const Stratum::BroadcastStats stats = server.getBroadcastStats();
+  EXPECT_GT(stats.p50.count(), 0);
+  EXPECT_LE(stats.p50, stats.p99);
+  EXPECT_LE(stats.p99, stats.max);
+  EXPECT_EQ(server.getSlowDisconnects(), 0u);
+
+  // Miners joining later get the current job
+  Stratum::Swarm late("127.0.0.1", server.getPort(), 1);
+  EXPECT_NE(late.waitForJob("job2", std::chrono::seconds(5))[0],
+            Stratum::Swarm::TimePoint());
+  server.stop();
+}
+
+// Test a client session: version rolling, a job and shares
+TEST(ServerTEST, ClientSession) {
+  Stratum::ServerConfig config = localConfig();
+  config.difficulty = 0.5;
+  config.versionRollingMask = 0x00ffe000;
+  Stratum::Server server(config);
+  std::mutex mutex;
+  std::vector<Stratum::Submission> submissions;
+  std::vector<std::string> workers;
+  server.setSubmitHandler([&](const Stratum::Submission &submission) {
+    std::lock_guard<std::mutex> lock(mutex);
+    submissions.push_back(submission);
+    workers.emplace_back(submission.worker);
+    // Keep only what outlives the call
+    submissions.back().extranonce1 = {};
+    submissions.back().worker = {};
+    submissions.back().jobId = {};
+    submissions.back().extranonce2 = {};
+    return submission.nonce % 2 == 0;
+  });
+  server.start();
+  server.broadcast(makeJob("job1", true));
+
+  Stratum::ClientConfig client_config;
+  client_config.port = server.getPort();
+  client_config.user = "worker.1";
+  client_config.timeout = std::chrono::milliseconds(5000);
+  Stratum::Client client(client_config);
+  std::string job_id;
+  client.setJobHandler(
+      [&](const Stratum::Notify &notify, const Block::MiningJob &job) {
+        job_id = notify.jobId;
+        EXPECT_EQ(job.getMerkleBranch().size(), 2u);
+      });
+  std::vector<Stratum::SubmitResult> results;
+  client.setResultHandler([&](const Stratum::SubmitResult &result) {
+    results.push_back(result);
+  });
+  client.connect();
+  EXPECT_EQ(client.getExtranonce1().size(), 4u);
+  EXPECT_EQ(client.getExtranonce2Size(), 4u);
+  EXPECT_EQ(client.getVersionMask(), 0x00ffe000u);
+
+  const auto deadline =
+      std::chrono::steady_clock::now() + std::chrono::seconds(5);
+  while (job_id.empty() && std::chrono::steady_clock::now() < deadline) {
+    client.poll(std::chrono::milliseconds(50));
+  }
+  EXPECT_EQ(job_id, "job1");
+  EXPECT_EQ(client.getDifficulty(), 0.5);
+
+  const uint8_t extranonce2[] = {1, 2, 3, 4};
+  client.submit(job_id, extranonce2, 1700000001, 2, 0x2000);
+  client.submit(job_id, extranonce2, 1700000001, 3);
+  // Outside the negotiated mask
+  client.submit(job_id, extranonce2, 1700000001, 4, 0x1);
+  while (results.size() < 3 && std::chrono::steady_clock::now() < deadline) {
+    client.poll(std::chrono::milliseconds(50));
+  }
+  ASSERT_EQ(results.size(), 3u);
+  EXPECT_TRUE(results[0].accepted);
+  EXPECT_FALSE(results[1].accepted);
+  EXPECT_FALSE(results[2].accepted);
+
+  std::lock_guard<std::mutex> lock(mutex);
+  ASSERT_EQ(submissions.size(), 2u);
+  EXPECT_EQ(workers[0], "worker.1");
+  EXPECT_EQ(submissions[0].time, 1700000001u);
+  EXPECT_EQ(submissions[0].nonce, 2u);
+  EXPECT_EQ(submissions[0].versionBits, 0x2000u);
+  EXPECT_EQ(submissions[1].versionBits, 0u);
+  EXPECT_EQ(submissions[0].connection, submissions[1].connection);
+}
+
+// Test that clean jobs replace queued ones and that a miner that stops
+// reading is dropped once too much is queued for it
+TEST(ServerTEST, SlowReader) {
+  Stratum::ServerConfig config = localConfig();
+  config.maxQueuedBytes = 64 * 1024;
+  Stratum::Server server(config);
+  server.start();
+  Stratum::Swarm swarm("127.0.0.1", server.getPort(), 2);
+  swarm.setReading(0, false);
+
+  // ~20 KB jobs, far more than the socket buffers hold, paced by the
+  // miner still reading
+  for (int i = 0; i < 1000; ++i) {
+    const std::string job_id = "clean" + std::to_string(i);
+    server.broadcast(makeJob(job_id, true, 10000));
+    ASSERT_NE(swarm.waitForJob(job_id, std::chrono::seconds(10))[1],
+              Stratum::Swarm::TimePoint());
+  }
+  EXPECT_EQ(server.getSlowDisconnects(), 0u);
+  swarm.setReading(0, true);
+  const std::vector<Stratum::Swarm::TimePoint> arrivals =
+      swarm.waitForJob("clean999", std::chrono::seconds(10));
+  EXPECT_NE(arrivals[0], Stratum::Swarm::TimePoint());
+
+  swarm.setReading(0, false);
+  for (int i = 0; i < 1000; ++i) {
+    const std::string job_id = "job" + std::to_string(i);
+    server.broadcast(makeJob(job_id, false, 10000));
+    ASSERT_NE(swarm.waitForJob(job_id, std::chrono::seconds(10))[1],
+              Stratum::Swarm::TimePoint());
+  }
+  EXPECT_EQ(server.getSlowDisconnects(), 1u);
+  EXPECT_TRUE(waitUntil([&] { return server.getConnectionCount() == 1; }));
+}
+
+// Test that a paused connection whose peer half-closes wakes no loop and
+// is closed once it is read again
+TEST(ServerTEST, SlowReaderHalfClose) {
+  Stratum::ServerConfig config = localConfig();
+  config.maxQueuedBytes = 64 * 1024;
+  Stratum::Server server(config);
+  server.start();
+  Stratum::Swarm swarm("127.0.0.1", server.getPort(), 2);
+  swarm.setReading(0, false);
+
+  // ~20 KB jobs until the socket buffers are full and the connection is
+  // paused; one more job never takes it past maxQueuedBytes
+  int jobs = 0;
+  while (server.getPausedCount() == 0) {
+    ASSERT_LT(jobs, 1000);
+    const std::string job_id = "job" + std::to_string(jobs++);
+    server.broadcast(makeJob(job_id, false, 10000));
+    ASSERT_NE(swarm.waitForJob(job_id, std::chrono::seconds(10))[1],
+              Stratum::Swarm::TimePoint());
+  }
+  EXPECT_EQ(server.getSlowDisconnects(), 0u);
+  swarm.halfClose(0);
+
+  std::this_thread::sleep_for(std::chrono::milliseconds(200));
+  EXPECT_EQ(server.getPausedWakeups(), 0u);
+  EXPECT_EQ(server.getConnectionCount(), 2u);
+
+  swarm.setReading(0, true);
+  swarm.waitForJob("job" + std::to_string(jobs - 1), std::chrono::seconds(10));
+  EXPECT_TRUE(waitUntil([&] { return server.getConnectionCount() == 1; }));
+  EXPECT_EQ(server.getPausedCount(), 0u);
+}
+
+// Test settings the server refuses
+TEST(ServerTEST, InvalidConfig) {
+  Stratum::ServerConfig config = localConfig();
+  config.extranonce1Size = 0;
+  EXPECT_THROW(Stratum::Server server(config), std::invalid_argument);
+  config.extranonce1Size = 4;
+  config.extranonce2Size = 9;
+  EXPECT_THROW(Stratum::Server server(config), std::invalid_argument);
+  config.extranonce2Size = 4;
+  config.host = "pool.example";
+  EXPECT_THROW(Stratum::Server server(config), std::invalid_argument);
+}
+
+// Test that a swarm which cannot connect throws and cleans up
+TEST(SwarmTEST, Unreachable) {
+  EXPECT_THROW(Stratum::Swarm("127.0.0.1", 1, 3), std::system_error);
+  EXPECT_THROW(Stratum::Swarm("pool.example", 3333, 1),
+               std::invalid_argument);
+}
@@ -0,0 +1,161 @@
+// system includes
+#include <stdexcept>
+
+// Google Test includes
+#include <gtest/gtest.h>
+
+// project includes
+#include "types/types.h"
+#include "types/uint256.h"
+
+// Genesis block target (bits 0x1d00ffff)
+static constexpr uint256 GENESIS_TARGET(
+    "00000000ffff0000000000000000000000000000000000000000000000000000");
+
+// Test construction from integers and limb layout
+TEST(Uint256Test, ConstructFromUint64) {
+  uint256 value(0x0123456789ABCDEFULL);
+
+  EXPECT_EQ(value.GetLimb(0), 0x0123456789ABCDEFULL);
+  EXPECT_EQ(value.GetLimb(1), 0);
+  EXPECT_EQ(value.GetLimb(2), 0);
+  EXPECT_EQ(value.GetLimb(3), 0);
+  EXPECT_EQ(value.data()[0], 0xEF);
+  EXPECT_EQ(value.data()[7], 0x01);
+  EXPECT_EQ(value.Bits(), 57);
+}
+
+// Test hex round trip through the consteval constructor
+TEST(Uint256Test, HexRoundTrip) {
+  EXPECT_EQ(GENESIS_TARGET.GetHex(),
+            "00000000ffff0000000000000000000000000000000000000000000000000000");
+  EXPECT_EQ(GENESIS_TARGET.GetLimb(3), 0x00000000FFFF0000ULL);
+  EXPECT_EQ(GENESIS_TARGET.Bits(), 224);
+}
+
+// Test numeric comparison, most significant limb first
+TEST(Uint256Test, Compare) {
+  uint256 small(1);
+  uint256 large = uint256(1) << 200;
+
+  EXPECT_LT(small, large);
+  EXPECT_GT(large, small);
+  EXPECT_EQ(small, uint256(1));
+  EXPECT_NE(small, large);
+  EXPECT_LT(small.CompareTo(large), 0);
+  EXPECT_EQ(large.CompareTo(large), 0);
+}
+
+// Test shifts across limb boundaries
+TEST(Uint256Test, Shifts) {
+  uint256 value(0x8000000000000001ULL);
+
+  uint256 left = value << 1;
+  EXPECT_EQ(left.GetLimb(0), 0x0000000000000002ULL);
+  EXPECT_EQ(left.GetLimb(1), 0x0000000000000001ULL);
+
+  uint256 far = value << 192;
+  EXPECT_EQ(far.GetLimb(3), 0x8000000000000001ULL);
+  EXPECT_EQ((far >> 192), value);
+
+  EXPECT_TRUE((value << 256).IsNull());
+  EXPECT_TRUE((value >> 64).IsNull());
+}
+
+// Test addition and subtraction with carries
+TEST(Uint256Test, AddSubtract) {
+  uint256 value(0xFFFFFFFFFFFFFFFFULL);
+  value += uint256(1);
+  EXPECT_EQ(value.GetLimb(0), 0);
+  EXPECT_EQ(value.GetLimb(1), 1);
+
+  value -= uint256(1);
+  EXPECT_EQ(value, uint256(0xFFFFFFFFFFFFFFFFULL));
+
+  uint256 max = ~uint256();
+  ++max;
+  EXPECT_TRUE(max.IsNull());
+}
+
+// Test multiplication and division by small integers
+TEST(Uint256Test, SmallMultiplyDivide) {
+  uint256 value = uint256(0xFFFFFFFFFFFFFFFFULL) * 0xFFFFFFFFu;
+  EXPECT_EQ(value.GetLimb(0), 0xFFFFFFFF00000001ULL);
+  EXPECT_EQ(value.GetLimb(1), 0x00000000FFFFFFFEULL);
+
+  EXPECT_EQ(value / 0xFFFFFFFFu, uint256(0xFFFFFFFFFFFFFFFFULL));
+  EXPECT_EQ(GENESIS_TARGET * 4u / 4u, GENESIS_TARGET);
+  EXPECT_THROW(value /= 0u, std::domain_error);
+}
+
+// Test full division, including the work inversion used for chain work
+TEST(Uint256Test, FullDivision) {
+  uint256 numerator = uint256(1) << 255;
+  EXPECT_EQ(numerator / (uint256(1) << 128), uint256(1) << 127);
+  EXPECT_TRUE((uint256(5) / uint256(7)).IsNull());
+
+  // Work for the genesis target: 2^256 / (target + 1)
+  uint256 work = (~GENESIS_TARGET / (GENESIS_TARGET + uint256(1))) + uint256(1);
+  EXPECT_EQ(work, uint256(0x0000000100010001ULL));
+
+  EXPECT_THROW(numerator /= uint256(), std::domain_error);
+}
+
+// Test SetCompact/GetCompact against Bitcoin's reference vectors
+TEST(Uint256Test, CompactEncoding) {
+  bool negative = false;
+  bool overflow = false;
+  uint256 value;
+
+  value.SetCompact(0x01003456, &negative, &overflow);
+  EXPECT_TRUE(value.IsNull());
+  EXPECT_EQ(value.GetCompact(), 0U);
+
+  value.SetCompact(0x01123456, &negative, &overflow);
+  EXPECT_EQ(value, uint256(0x12));
+  EXPECT_EQ(value.GetCompact(), 0x01120000U);
+  EXPECT_FALSE(negative);
+  EXPECT_FALSE(overflow);
+
+  value.SetCompact(0x02123456);
+  EXPECT_EQ(value, uint256(0x1234));
+  EXPECT_EQ(value.GetCompact(), 0x02123400U);
+
+  value.SetCompact(0x05009234);
+  EXPECT_EQ(value, uint256(0x92340000));
+  EXPECT_EQ(value.GetCompact(), 0x05009234U);
+
+  value.SetCompact(0x04923456, &negative, &overflow);
+  EXPECT_EQ(value, uint256(0x12345600));
+  EXPECT_TRUE(negative);
+  EXPECT_EQ(value.GetCompact(negative), 0x04923456U);
+
+  value.SetCompact(0x20123456, &negative, &overflow);
+  EXPECT_EQ(value, uint256(0x123456) << 232);
+  EXPECT_EQ(value.GetCompact(), 0x20123456U);
+  EXPECT_FALSE(overflow);
+
+  value.SetCompact(0xFF123456, &negative, &overflow);
+  EXPECT_TRUE(overflow);
+}
+
+// Test compact decoding of the genesis bits
+TEST(Uint256Test, CompactGenesis) {
+  constexpr uint256 target = uint256().SetCompact(0x1d00ffff);
+  static_assert(target.GetCompact() == 0x1d00ffff);
+
+  EXPECT_EQ(target, GENESIS_TARGET);
+}
+
+// Test the word-wise proof-of-work target check
+TEST(Uint256Test, MeetsTarget) {
+  Hash below{};
+  below[27] = 0xFF; // 0x00000000ff000000...
+  Hash above{};
+  above[28] = 0x01; // 0x0000000100000000...
+  Hash equal = GENESIS_TARGET.ToHash();
+
+  EXPECT_TRUE(MeetsTarget(below, GENESIS_TARGET));
+  EXPECT_FALSE(MeetsTarget(above, GENESIS_TARGET));
+  EXPECT_TRUE(MeetsTarget(equal, GENESIS_TARGET));
+}
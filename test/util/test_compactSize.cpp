@@ -0,0 +1,58 @@
+// system includes
+#include <cstdint>
+#include <vector>
+
+// Google Test includes
+#include <gtest/gtest.h>
+
+// project includes
+#include "util/compactSize.h"
+
+// Test that values round-trip at every encoding boundary
+TEST(CompactSizeTest, RoundTrip) {
+  for (uint64_t value :
+       {uint64_t{0}, uint64_t{0xfc}, uint64_t{0xfd}, uint64_t{0xffff},
+        uint64_t{0x10000}, uint64_t{0xffffffff}, uint64_t{0x100000000},
+        uint64_t{0xffffffffffffffff}}) {
+    uint8_t buffer[util::MAX_COMPACT_SIZE_LENGTH];
+    const size_t written = util::WriteCompactSize(buffer, value);
+    EXPECT_EQ(written, util::CompactSizeLength(value));
+
+    size_t offset = 0;
+    uint64_t decoded = 0;
+    ASSERT_TRUE(util::ReadCompactSize(std::span<const uint8_t>(buffer, written),
+                                      offset, decoded));
+    EXPECT_EQ(decoded, value);
+    EXPECT_EQ(offset, written);
+  }
+}
+
+// Test the wire format of each width
+TEST(CompactSizeTest, Encoding) {
+  uint8_t buffer[util::MAX_COMPACT_SIZE_LENGTH];
+  EXPECT_EQ(util::WriteCompactSize(buffer, 0xfc), 1u);
+  EXPECT_EQ(buffer[0], 0xfc);
+  EXPECT_EQ(util::WriteCompactSize(buffer, 0x1234), 3u);
+  EXPECT_EQ(std::vector<uint8_t>(buffer, buffer + 3),
+            (std::vector<uint8_t>{0xfd, 0x34, 0x12}));
+  EXPECT_EQ(util::WriteCompactSize(buffer, 0x12345678), 5u);
+  EXPECT_EQ(std::vector<uint8_t>(buffer, buffer + 5),
+            (std::vector<uint8_t>{0xfe, 0x78, 0x56, 0x34, 0x12}));
+}
+
+// Test that truncated and non-canonical encodings are rejected
+TEST(CompactSizeTest, RejectsInvalid) {
+  const std::vector<std::vector<uint8_t>> invalid = {
+      {},
+      {0xfd, 0x01},
+      {0xfe, 0x01, 0x02, 0x03},
+      {0xfd, 0xfc, 0x00},                   // fits in one byte
+      {0xfe, 0xff, 0xff, 0x00, 0x00},       // fits in three bytes
+      {0xff, 0x00, 0x00, 0x00, 0x01, 0x00, 0x00, 0x00, 0x00}}; // five bytes
+  for (const std::vector<uint8_t> &bytes : invalid) {
+    size_t offset = 0;
+    uint64_t value = 0;
+    EXPECT_FALSE(util::ReadCompactSize(bytes, offset, value));
+    EXPECT_EQ(offset, 0u);
+  }
+}
@@ -0,0 +1,67 @@
+// system includes
+#include <atomic>
+#include <cstdint>
+#include <thread>
+#include <vector>
+
+// Google Test includes
+#include <gtest/gtest.h>
+
+// project includes
+#include "util/concurrentHashSet.h"
+
+using Insert = util::ConcurrentHashSet::Insert;
+
+// Test inserting, looking up and clearing, including the edge keys
+TEST(ConcurrentHashSetTest, InsertAndClear) {
+  util::ConcurrentHashSet set(100);
+  EXPECT_GE(set.getCapacity(), 100u);
+  for (const uint64_t key : {uint64_t{0}, uint64_t{1}, ~uint64_t{0},
+                             ~uint64_t{0} - 1, uint64_t{1} << 63}) {
+    EXPECT_FALSE(set.contains(key));
+    EXPECT_EQ(set.insert(key), Insert::Inserted) << key;
+    EXPECT_EQ(set.insert(key), Insert::Present) << key;
+    EXPECT_TRUE(set.contains(key));
+  }
+  set.clear();
+  EXPECT_EQ(set.size(), 0u);
+  EXPECT_FALSE(set.contains(0));
+  EXPECT_FALSE(set.contains(~uint64_t{0}));
+}
+
+// Test that a full set still answers for the keys it holds
+TEST(ConcurrentHashSetTest, Full) {
+  util::ConcurrentHashSet set(10);
+  uint64_t key = 0;
+  while (set.insert(key) == Insert::Inserted) {
+    ++key;
+  }
+  EXPECT_EQ(set.size(), set.getCapacity());
+  EXPECT_EQ(set.insert(key), Insert::Full);
+  EXPECT_EQ(set.insert(0), Insert::Present);
+  EXPECT_FALSE(set.contains(key));
+}
+
+// Test that each key is new to exactly one of several racing threads
+TEST(ConcurrentHashSetTest, ConcurrentInserts) {
+  const uint64_t keys = 50000;
+  util::ConcurrentHashSet set(keys);
+  std::atomic<uint64_t> inserted{0};
+  std::vector<std::thread> threads;
+  for (int t = 0; t < 4; ++t) {
+    threads.emplace_back([&, t] {
+      uint64_t mine = 0;
+      for (uint64_t i = 0; i < keys; ++i) {
+        // Every thread inserts every key, in a different order
+        const uint64_t key = (i * 7919 + static_cast<uint64_t>(t)) % keys;
+        mine += set.insert(key * 0x100000001ULL) == Insert::Inserted;
+      }
+      inserted += mine;
+    });
+  }
+  for (std::thread &thread : threads) {
+    thread.join();
+  }
+  EXPECT_EQ(inserted.load(), keys);
+  EXPECT_EQ(set.size(), keys);
+}
@@ -70,3 +70,33 @@ TEST(EndianTest, Roundtrip_64bit_LittleEndian) {
 
   EXPECT_EQ(restored, original);
 }
+
+// Test ReadLE32/ReadLE64/ReadBE32 decode from byte buffers
+TEST(EndianTest, ReadFromBytes) {
+  const uint8_t bytes[8] = {0x01, 0x02, 0x03, 0x04, 0x05, 0x06, 0x07, 0x08};
+
+  EXPECT_EQ(util::ReadLE32(bytes), 0x04030201U);
+  EXPECT_EQ(util::ReadBE32(bytes), 0x01020304U);
+  EXPECT_EQ(util::ReadLE64(bytes), 0x0807060504030201ULL);
+
+  constexpr uint8_t const_bytes[4] = {0xEF, 0xBE, 0xAD, 0xDE};
+  static_assert(util::ReadLE32(const_bytes) == 0xDEADBEEF);
+}
+
+// Test WriteLE32/WriteLE64/WriteBE32 round trip through the readers
+TEST(EndianTest, WriteToBytes) {
+  uint8_t bytes[8] = {0};
+
+  util::WriteLE32(bytes, 0xDEADBEEF);
+  EXPECT_EQ(bytes[0], 0xEF);
+  EXPECT_EQ(bytes[3], 0xDE);
+
+  util::WriteBE32(bytes, 0xDEADBEEF);
+  EXPECT_EQ(bytes[0], 0xDE);
+  EXPECT_EQ(util::ReadBE32(bytes), 0xDEADBEEFU);
+
+  util::WriteLE64(bytes, 0x0123456789ABCDEFULL);
+  EXPECT_EQ(bytes[0], 0xEF);
+  EXPECT_EQ(bytes[7], 0x01);
+  EXPECT_EQ(util::ReadLE64(bytes), 0x0123456789ABCDEFULL);
+}
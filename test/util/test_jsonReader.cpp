@@ -0,0 +1,160 @@
+// system includes
+#include <string>
+#include <vector>
+
+// Google Test includes
+#include <gtest/gtest.h>
+
+// project includes
+#include "util/jsonReader.h"
+
+using util::JsonToken;
+
+// Read every token of a document
+static std::vector<JsonToken> tokens(std::string_view text) {
+  util::JsonReader reader(text);
+  std::vector<JsonToken> result;
+  JsonToken token;
+  do {
+    token = reader.next();
+    result.push_back(token);
+  } while (token != JsonToken::End && token != JsonToken::Error);
+  return result;
+}
+
+// Test the token sequence of a nested document and the raw values
+TEST(JsonReaderTest, TokenSequence) {
+  util::JsonReader reader(
+      R"( {"a": [1, -2.5e3, "x"], "b": {"c": true, "d": null}, "e": false} )");
+  EXPECT_EQ(reader.next(), JsonToken::BeginObject);
+  EXPECT_EQ(reader.next(), JsonToken::Key);
+  EXPECT_EQ(reader.getValue(), "a");
+  EXPECT_EQ(reader.next(), JsonToken::BeginArray);
+  EXPECT_EQ(reader.getDepth(), 2u);
+  EXPECT_EQ(reader.next(), JsonToken::Number);
+  int64_t number = 0;
+  EXPECT_TRUE(reader.getInt(number));
+  EXPECT_EQ(number, 1);
+  EXPECT_EQ(reader.next(), JsonToken::Number);
+  EXPECT_EQ(reader.getValue(), "-2.5e3");
+  EXPECT_FALSE(reader.getInt(number));
+  EXPECT_EQ(reader.next(), JsonToken::String);
+  EXPECT_EQ(reader.getValue(), "x");
+  EXPECT_EQ(reader.next(), JsonToken::EndArray);
+  EXPECT_EQ(reader.next(), JsonToken::Key);
+  EXPECT_EQ(reader.next(), JsonToken::BeginObject);
+  EXPECT_EQ(reader.next(), JsonToken::Key);
+  EXPECT_EQ(reader.next(), JsonToken::True);
+  EXPECT_EQ(reader.next(), JsonToken::Key);
+  EXPECT_EQ(reader.next(), JsonToken::Null);
+  EXPECT_EQ(reader.next(), JsonToken::EndObject);
+  EXPECT_EQ(reader.next(), JsonToken::Key);
+  EXPECT_EQ(reader.getValue(), "e");
+  EXPECT_EQ(reader.next(), JsonToken::False);
+  EXPECT_EQ(reader.next(), JsonToken::EndObject);
+  EXPECT_EQ(reader.next(), JsonToken::End);
+  EXPECT_EQ(reader.getDepth(), 0u);
+}
+
+// Test that skipValue() steps over whole nested values
+TEST(JsonReaderTest, SkipValue) {
+  util::JsonReader reader(R"({"skip": {"x": [1, [2, {}]], "y": "z"}, "k": 7})");
+  EXPECT_EQ(reader.next(), JsonToken::BeginObject);
+  EXPECT_EQ(reader.next(), JsonToken::Key);
+  EXPECT_TRUE(reader.skipValue());
+  EXPECT_EQ(reader.next(), JsonToken::Key);
+  EXPECT_EQ(reader.getValue(), "k");
+  EXPECT_TRUE(reader.skipValue());
+  EXPECT_EQ(reader.next(), JsonToken::EndObject);
+  EXPECT_EQ(reader.next(), JsonToken::End);
+}
+
+// Test escape decoding, including a surrogate pair
+TEST(JsonReaderTest, Escapes) {
+  util::JsonReader reader(R"("a\"b\\c\/\né😀")");
+  ASSERT_EQ(reader.next(), JsonToken::String);
+  EXPECT_TRUE(reader.hasEscapes());
+  std::string text;
+  ASSERT_TRUE(reader.getString(text));
+  EXPECT_EQ(text, "a\"b\\c/\n\xc3\xa9\xf0\x9f\x98\x80");
+
+  util::JsonReader lone(R"("\udc00")");
+  ASSERT_EQ(lone.next(), JsonToken::String);
+  EXPECT_FALSE(lone.getString(text));
+}
+
+// Test integer range checks
+TEST(JsonReaderTest, Integers) {
+  util::JsonReader reader("[18446744073709551615, -1, 9223372036854775808]");
+  reader.next();
+  uint64_t unsigned_value = 0;
+  int64_t signed_value = 0;
+  ASSERT_EQ(reader.next(), JsonToken::Number);
+  EXPECT_TRUE(reader.getUint(unsigned_value));
+  EXPECT_EQ(unsigned_value, 18446744073709551615u);
+  ASSERT_EQ(reader.next(), JsonToken::Number);
+  EXPECT_FALSE(reader.getUint(unsigned_value));
+  EXPECT_TRUE(reader.getInt(signed_value));
+  EXPECT_EQ(signed_value, -1);
+  ASSERT_EQ(reader.next(), JsonToken::Number);
+  EXPECT_FALSE(reader.getInt(signed_value));
+}
+
+// Test floating-point numbers (Stratum difficulties)
+TEST(JsonReaderTest, Doubles) {
+  util::JsonReader reader("[0.001, 65536, 1e400]");
+  reader.next();
+  double value = 0;
+  ASSERT_EQ(reader.next(), JsonToken::Number);
+  EXPECT_TRUE(reader.getDouble(value));
+  EXPECT_DOUBLE_EQ(value, 0.001);
+  ASSERT_EQ(reader.next(), JsonToken::Number);
+  EXPECT_TRUE(reader.getDouble(value));
+  EXPECT_EQ(value, 65536.0);
+  ASSERT_EQ(reader.next(), JsonToken::Number);
+  EXPECT_FALSE(reader.getDouble(value));
+}
+
+// Test that grammar violations are reported
+TEST(JsonReaderTest, RejectsMalformed) {
+  for (const char *text :
+       {"", "{", "[1,]", "{\"a\":1,}", "{\"a\" 1}", "{1:2}", "[1 2]", "01",
+        "1.", "-", "tru", "\"open", "\"a\x01\"", "[1]]", "{} {}", "[}"}) {
+    EXPECT_EQ(tokens(text).back(), JsonToken::Error) << text;
+  }
+
+  std::string deep(util::JsonReader::MAX_DEPTH + 1, '[');
+  EXPECT_EQ(tokens(deep).back(), JsonToken::Error);
+}
+
+// Test scalar top-level documents
+TEST(JsonReaderTest, ScalarDocument) {
+  EXPECT_EQ(tokens(" 42 "),
+            (std::vector<JsonToken>{JsonToken::Number, JsonToken::End}));
+  EXPECT_EQ(tokens("null"),
+            (std::vector<JsonToken>{JsonToken::Null, JsonToken::End}));
+}
+
+// Test that long strings end, escape and fail at every position of a word
+TEST(JsonReaderTest, LongStrings) {
+  for (size_t at = 0; at < 24; ++at) {
+    const std::string plain(at, 'f');
+    const std::string end_text = "\"" + plain + "\"";
+    util::JsonReader end_reader(end_text);
+    ASSERT_EQ(end_reader.next(), JsonToken::String) << at;
+    EXPECT_EQ(end_reader.getValue(), plain);
+    EXPECT_FALSE(end_reader.hasEscapes());
+
+    std::string escaped = std::string(24, 'f');
+    escaped.replace(at, 1, "\\\"");
+    const std::string escape_text = "\"" + escaped + "\"";
+    util::JsonReader escape_reader(escape_text);
+    ASSERT_EQ(escape_reader.next(), JsonToken::String) << at;
+    EXPECT_EQ(escape_reader.getValue(), escaped);
+    EXPECT_TRUE(escape_reader.hasEscapes());
+
+    std::string control = std::string(24, 'f');
+    control[at] = '\t';
+    EXPECT_EQ(tokens("\"" + control + "\"").back(), JsonToken::Error) << at;
+  }
+}
@@ -1,3 +1,8 @@
+// system includes
+#include <cstring>
+#include <string>
+#include <string_view>
+
 // Google Test includes
 #include <gtest/gtest.h>
 
@@ -36,3 +41,60 @@ TEST(TranscodeTest, ConstevalHexDigit) {
   constexpr uint8_t resultf = util::ConstevalHexDigit('f');
   EXPECT_EQ(resultf, 0x0F);
 }
+
+// Test DecodeHex with mixed case and invalid input
+TEST(TranscodeTest, DecodeHex) {
+  uint8_t out[4] = {};
+  EXPECT_TRUE(util::DecodeHex("00fFa9Ed", out));
+  EXPECT_EQ(out[0], 0x00);
+  EXPECT_EQ(out[1], 0xff);
+  EXPECT_EQ(out[2], 0xa9);
+  EXPECT_EQ(out[3], 0xed);
+
+  EXPECT_TRUE(util::DecodeHex("", out));
+  EXPECT_FALSE(util::DecodeHex("abc", out));
+  EXPECT_FALSE(util::DecodeHex("0g", out));
+  EXPECT_FALSE(util::DecodeHex("a ", out));
+}
+
+// Test that EncodeHex undoes DecodeHex
+TEST(TranscodeTest, EncodeHex) {
+  const uint8_t bytes[] = {0x00, 0xff, 0xa9, 0x3e};
+  char hex[8];
+  util::EncodeHex(bytes, hex);
+  EXPECT_EQ(std::string(hex, sizeof(hex)), "00ffa93e");
+  uint8_t out[4] = {};
+  EXPECT_TRUE(util::DecodeHex(std::string_view(hex, sizeof(hex)), out));
+  EXPECT_EQ(std::memcmp(out, bytes, sizeof(out)), 0);
+}
+
+// Test that AppendHex appends what EncodeHex writes
+TEST(TranscodeTest, AppendHex) {
+  const uint8_t bytes[] = {0x00, 0xff, 0xa9, 0x3e};
+  std::string out = "x";
+  util::AppendHex(out, bytes);
+  util::AppendHex(out, {});
+  EXPECT_EQ(out, "x00ffa93e");
+}
+
+// Test that AppendJsonString escapes what JSON requires and nothing else
+TEST(TranscodeTest, AppendJsonString) {
+  std::string out = "x";
+  util::AppendJsonString(out, "a\"b\\c\n\x1f/\xc3\xa9");
+  EXPECT_EQ(out, "x\"a\\\"b\\\\c\\u000a\\u001f/\xc3\xa9\"");
+}
+
+// Test EncodeBase64 against the RFC 4648 vectors
+TEST(TranscodeTest, EncodeBase64) {
+  const auto encode = [](const std::string &text) {
+    return util::EncodeBase64(std::span<const uint8_t>(
+        reinterpret_cast<const uint8_t *>(text.data()), text.size()));
+  };
+  EXPECT_EQ(encode(""), "");
+  EXPECT_EQ(encode("f"), "Zg==");
+  EXPECT_EQ(encode("fo"), "Zm8=");
+  EXPECT_EQ(encode("foo"), "Zm9v");
+  EXPECT_EQ(encode("foob"), "Zm9vYg==");
+  EXPECT_EQ(encode("fooba"), "Zm9vYmE=");
+  EXPECT_EQ(encode("foobar"), "Zm9vYmFy");
+}